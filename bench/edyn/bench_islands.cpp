@@ -0,0 +1,63 @@
+#include "common/bench_common.hpp"
+
+using namespace edyn_bench;
+
+// Same number of bodies either split into many small stacks far apart from
+// one another, which results in many small islands, or arranged in a single
+// large pyramid, which results in one giant island.
+
+static void BM_many_small_islands(benchmark::State &state) {
+    auto world = bench_world();
+    make_ground(world.registry);
+
+    // Pyramids of 3 levels have 14 bodies each.
+    auto num_pyramids = static_cast<size_t>(state.range(0));
+    auto num_per_side = static_cast<size_t>(std::ceil(std::sqrt(edyn::scalar(num_pyramids))));
+    size_t num_bodies = 0;
+
+    for (size_t i = 0; i < num_pyramids; ++i) {
+        auto origin = edyn::vector3{edyn::scalar(i % num_per_side) * 6, 0, edyn::scalar(i / num_per_side) * 6};
+        num_bodies += make_pyramid(world.registry, edyn::box_shape{0.5, 0.5, 0.5},
+                                   edyn::quaternion_identity, 1.01, 3, origin);
+    }
+
+    world.warm_up(10);
+
+    for (auto _ : state) {
+        world.step();
+    }
+
+    world.report(state);
+    state.counters["bodies"] = static_cast<double>(num_bodies);
+}
+
+static void BM_one_giant_island(benchmark::State &state) {
+    auto world = bench_world();
+    make_ground(world.registry);
+
+    // Use the pyramid with the closest number of bodies to the small islands
+    // scene, i.e. 14 bodies per small pyramid.
+    auto target_num_bodies = static_cast<size_t>(state.range(0)) * 14;
+    size_t num_levels = 1;
+    size_t num_pyramid_bodies = 1;
+
+    while (num_pyramid_bodies < target_num_bodies) {
+        ++num_levels;
+        num_pyramid_bodies += num_levels * num_levels;
+    }
+
+    auto num_bodies = make_pyramid(world.registry, edyn::box_shape{0.5, 0.5, 0.5},
+                                   edyn::quaternion_identity, 1.01, num_levels, edyn::vector3_zero);
+
+    world.warm_up(10);
+
+    for (auto _ : state) {
+        world.step();
+    }
+
+    world.report(state);
+    state.counters["bodies"] = static_cast<double>(num_bodies);
+}
+
+BENCHMARK(BM_many_small_islands)->Arg(16)->Arg(64)->Arg(256)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_one_giant_island)->Arg(16)->Arg(64)->Arg(256)->UseRealTime()->Unit(benchmark::kMillisecond);
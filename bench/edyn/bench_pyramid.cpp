@@ -0,0 +1,42 @@
+#include "common/bench_common.hpp"
+
+using namespace edyn_bench;
+
+static void run_pyramid(benchmark::State &state, const edyn::shapes_variant_t &shape,
+                        const edyn::quaternion &orientation, edyn::scalar size) {
+    auto world = bench_world();
+    make_ground(world.registry);
+    auto num_bodies = make_pyramid(world.registry, shape, orientation, size,
+                                   static_cast<size_t>(state.range(0)), edyn::vector3_zero);
+    world.warm_up(10);
+
+    for (auto _ : state) {
+        world.step();
+    }
+
+    world.report(state);
+    state.counters["bodies"] = static_cast<double>(num_bodies);
+}
+
+static void BM_pyramid_box(benchmark::State &state) {
+    run_pyramid(state, edyn::box_shape{0.5, 0.5, 0.5}, edyn::quaternion_identity, 1.01);
+}
+
+static void BM_pyramid_sphere(benchmark::State &state) {
+    run_pyramid(state, edyn::sphere_shape{0.5}, edyn::quaternion_identity, 1.01);
+}
+
+static void BM_pyramid_cylinder(benchmark::State &state) {
+    // Stand cylinders up, since their axis is along x.
+    run_pyramid(state, edyn::cylinder_shape{0.5, 0.5},
+                edyn::quaternion_axis_angle({0, 0, 1}, edyn::half_pi), 1.01);
+}
+
+static void BM_pyramid_polyhedron(benchmark::State &state) {
+    run_pyramid(state, make_prism_shape(0.5, 0.5, 8), edyn::quaternion_identity, 1.01);
+}
+
+BENCHMARK(BM_pyramid_box)->Arg(5)->Arg(10)->Arg(15)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_pyramid_sphere)->Arg(5)->Arg(10)->Arg(15)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_pyramid_cylinder)->Arg(5)->Arg(10)->Arg(15)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_pyramid_polyhedron)->Arg(5)->Arg(10)->Arg(15)->UseRealTime()->Unit(benchmark::kMillisecond);
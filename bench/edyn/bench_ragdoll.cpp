@@ -0,0 +1,34 @@
+#include "common/bench_common.hpp"
+
+using namespace edyn_bench;
+
+static void BM_ragdoll_pile(benchmark::State &state) {
+    auto world = bench_world();
+    make_ground(world.registry);
+
+    // Drop rag dolls on top of one another in a few columns so that they
+    // form piles with many contacts and joints.
+    auto num_ragdolls = static_cast<size_t>(state.range(0));
+    constexpr size_t num_columns = 4;
+    auto rng = random_generator(7);
+
+    for (size_t i = 0; i < num_ragdolls; ++i) {
+        auto def = edyn::ragdoll_simple_def{};
+        auto column = i % num_columns;
+        auto row = i / num_columns;
+        def.position = {edyn::scalar(column) * 2, 1 + edyn::scalar(row) * edyn::scalar(0.6), 0};
+        def.orientation = edyn::quaternion_axis_angle({0, 1, 0}, rng.next(0, edyn::pi2)) *
+                          edyn::quaternion_axis_angle({1, 0, 0}, edyn::half_pi);
+        edyn::make_ragdoll(world.registry, def);
+    }
+
+    world.warm_up(60);
+
+    for (auto _ : state) {
+        world.step();
+    }
+
+    world.report(state);
+}
+
+BENCHMARK(BM_ragdoll_pile)->Arg(8)->Arg(32)->Arg(64)->UseRealTime()->Unit(benchmark::kMillisecond);
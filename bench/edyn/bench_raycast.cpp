@@ -0,0 +1,65 @@
+#include "common/bench_common.hpp"
+
+using namespace edyn_bench;
+
+static void BM_raycast_storm(benchmark::State &state) {
+    auto world = bench_world();
+    make_ground(world.registry);
+
+    // Scatter bodies of different shapes in a volume.
+    auto rng = random_generator(3);
+    auto prism = make_prism_shape(0.5, 0.5, 8);
+    constexpr edyn::scalar extent = 50;
+
+    for (size_t i = 0; i < 2000; ++i) {
+        auto def = edyn::rigidbody_def();
+        def.kind = edyn::rigidbody_kind::rb_static;
+        def.presentation = false;
+
+        switch (i % 4) {
+        case 0:
+            def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+            break;
+        case 1:
+            def.shape = edyn::sphere_shape{0.5};
+            break;
+        case 2:
+            def.shape = edyn::capsule_shape{0.3, 0.5};
+            break;
+        default:
+            def.shape = prism;
+        }
+
+        def.position = {rng.next(-extent, extent), rng.next(0, 10), rng.next(-extent, extent)};
+        def.orientation = edyn::normalize(edyn::quaternion{rng.next(-1, 1), rng.next(-1, 1), rng.next(-1, 1), 1});
+        edyn::make_rigidbody(world.registry, def);
+    }
+
+    world.warm_up(2);
+
+    // Rays from above towards the ground.
+    auto num_rays = static_cast<size_t>(state.range(0));
+    auto rays = std::vector<std::pair<edyn::vector3, edyn::vector3>>{};
+
+    for (size_t i = 0; i < num_rays; ++i) {
+        auto p0 = edyn::vector3{rng.next(-extent, extent), 20, rng.next(-extent, extent)};
+        auto p1 = edyn::vector3{rng.next(-extent, extent), -1, rng.next(-extent, extent)};
+        rays.emplace_back(p0, p1);
+    }
+
+    size_t num_hits = 0;
+
+    for (auto _ : state) {
+        for (auto &[p0, p1] : rays) {
+            auto result = edyn::raycast(world.registry, p0, p1);
+            num_hits += result.entity != entt::null;
+        }
+    }
+
+    state.counters["rays/s"] = benchmark::Counter(static_cast<double>(state.iterations() * num_rays),
+                                                  benchmark::Counter::kIsRate);
+    state.counters["hit_ratio"] = static_cast<double>(num_hits) / (state.iterations() * num_rays);
+    state.counters["peak_rss_MB"] = static_cast<double>(peak_memory_bytes()) / (1024 * 1024);
+}
+
+BENCHMARK(BM_raycast_storm)->Arg(1000)->Arg(10000)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,98 @@
+#include "common/bench_common.hpp"
+#include <edyn/comp/tag.hpp>
+#include <edyn/networking/comp/networked_comp.hpp>
+#include <edyn/networking/packet/registry_snapshot.hpp>
+#include <edyn/networking/util/server_snapshot_exporter.hpp>
+#include <edyn/networking/util/client_snapshot_importer.hpp>
+#include <edyn/serialization/memory_archive.hpp>
+
+using namespace edyn_bench;
+
+static void make_networked_bodies(entt::registry &registry, size_t num_bodies) {
+    auto rng = random_generator(5);
+    auto defs = std::vector<edyn::rigidbody_def>{};
+
+    for (size_t i = 0; i < num_bodies; ++i) {
+        auto def = edyn::rigidbody_def();
+        def.mass = 10;
+        def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+        def.presentation = false;
+        def.networked = true;
+        def.update_inertia();
+        def.position = {rng.next(-100, 100), rng.next(1, 20), rng.next(-100, 100)};
+        def.linvel = {rng.next(-1, 1), rng.next(-1, 1), rng.next(-1, 1)};
+        defs.push_back(def);
+    }
+
+    edyn::batch_rigidbodies(registry, defs);
+}
+
+static void export_snapshot(const entt::registry &registry, edyn::server_snapshot_exporter &exporter,
+                            edyn::packet::registry_snapshot &snap, std::vector<uint8_t> &buffer) {
+    snap = {};
+    auto networked_view = registry.view<edyn::networked_tag>();
+    snap.entities.assign(networked_view.begin(), networked_view.end());
+    exporter.export_all(registry, snap);
+
+    buffer.clear();
+    auto archive = edyn::memory_output_archive(buffer);
+    archive(snap);
+}
+
+static void BM_snapshot_export(benchmark::State &state) {
+    auto world = bench_world();
+    make_networked_bodies(world.registry, static_cast<size_t>(state.range(0)));
+    world.warm_up(2);
+
+    auto exporter = edyn::server_snapshot_exporter_impl(edyn::networked_components);
+    auto snap = edyn::packet::registry_snapshot{};
+    auto buffer = std::vector<uint8_t>{};
+
+    for (auto _ : state) {
+        export_snapshot(world.registry, exporter, snap, buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+
+    state.counters["snapshot_bytes"] = static_cast<double>(buffer.size());
+    state.counters["bytes/s"] = benchmark::Counter(static_cast<double>(state.iterations() * buffer.size()),
+                                                   benchmark::Counter::kIsRate);
+    state.counters["peak_rss_MB"] = static_cast<double>(peak_memory_bytes()) / (1024 * 1024);
+}
+
+static void BM_snapshot_import(benchmark::State &state) {
+    auto world = bench_world();
+    make_networked_bodies(world.registry, static_cast<size_t>(state.range(0)));
+    world.warm_up(2);
+
+    auto exporter = edyn::server_snapshot_exporter_impl(edyn::networked_components);
+    auto snap = edyn::packet::registry_snapshot{};
+    auto buffer = std::vector<uint8_t>{};
+    export_snapshot(world.registry, exporter, snap, buffer);
+
+    // Import into a separate registry where all remote entities are mapped
+    // to local entities beforehand, as a client would have after receiving
+    // the entity creation packets.
+    auto client_registry = entt::registry{};
+    auto emap = edyn::entity_map{};
+
+    for (auto remote_entity : snap.entities) {
+        emap.insert(remote_entity, client_registry.create());
+    }
+
+    auto importer = edyn::client_snapshot_importer_impl(edyn::networked_components);
+
+    for (auto _ : state) {
+        auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+        auto received = edyn::packet::registry_snapshot{};
+        input(received);
+        importer.import(client_registry, emap, received);
+    }
+
+    state.counters["snapshot_bytes"] = static_cast<double>(buffer.size());
+    state.counters["bytes/s"] = benchmark::Counter(static_cast<double>(state.iterations() * buffer.size()),
+                                                   benchmark::Counter::kIsRate);
+    state.counters["peak_rss_MB"] = static_cast<double>(peak_memory_bytes()) / (1024 * 1024);
+}
+
+BENCHMARK(BM_snapshot_export)->Arg(256)->Arg(4096)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_snapshot_import)->Arg(256)->Arg(4096)->UseRealTime()->Unit(benchmark::kMicrosecond);
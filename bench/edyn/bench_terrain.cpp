@@ -0,0 +1,93 @@
+#include "common/bench_common.hpp"
+#include <cmath>
+
+using namespace edyn_bench;
+
+namespace {
+
+class null_page_loader : public edyn::triangle_mesh_page_loader_base {
+public:
+    // All submeshes are created in memory, thus nothing has to be loaded.
+    void load(size_t) override {}
+
+    entt::sink<entt::sigh<loaded_mesh_func_t>> on_load_sink() override {
+        return {m_loaded_signal};
+    }
+
+private:
+    entt::sigh<loaded_mesh_func_t> m_loaded_signal;
+};
+
+}
+
+static void make_terrain(entt::registry &registry, edyn::scalar extent, size_t num_vertices_per_side) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    edyn::make_plane_mesh(extent, extent, num_vertices_per_side, num_vertices_per_side, vertices, indices);
+
+    // Rolling hills.
+    for (auto &v : vertices) {
+        v.y = std::sin(v.x * edyn::scalar(0.1)) * std::cos(v.z * edyn::scalar(0.13)) * 3 +
+              std::sin(v.x * edyn::scalar(0.37) + v.z * edyn::scalar(0.21)) * edyn::scalar(0.5);
+    }
+
+    auto trimesh = std::make_shared<edyn::paged_triangle_mesh>(std::make_shared<null_page_loader>());
+    edyn::create_paged_triangle_mesh(*trimesh, vertices.begin(), vertices.end(),
+                                     indices.begin(), indices.end(), 256, {});
+
+    auto def = edyn::rigidbody_def();
+    def.kind = edyn::rigidbody_kind::rb_static;
+    def.shape = edyn::paged_mesh_shape{trimesh};
+    def.presentation = false;
+    edyn::make_rigidbody(registry, def);
+}
+
+static void BM_paged_terrain(benchmark::State &state) {
+    auto world = bench_world();
+    constexpr edyn::scalar extent = 200;
+    make_terrain(world.registry, extent, 257);
+
+    // Drop a grid of boxes, spheres and cylinders on the terrain.
+    auto num_bodies = static_cast<size_t>(state.range(0));
+    auto num_per_side = static_cast<size_t>(std::ceil(std::sqrt(edyn::scalar(num_bodies))));
+    auto spacing = extent * edyn::scalar(0.8) / num_per_side;
+    auto rng = random_generator(13);
+    auto defs = std::vector<edyn::rigidbody_def>{};
+
+    for (size_t i = 0; i < num_bodies; ++i) {
+        auto def = edyn::rigidbody_def();
+        def.mass = 10;
+        def.presentation = false;
+        def.sleeping_disabled = true;
+
+        switch (i % 3) {
+        case 0:
+            def.shape = edyn::box_shape{0.4, 0.3, 0.5};
+            break;
+        case 1:
+            def.shape = edyn::sphere_shape{0.4};
+            break;
+        default:
+            def.shape = edyn::cylinder_shape{0.3, 0.4};
+        }
+
+        def.update_inertia();
+        def.position = {
+            (edyn::scalar(i % num_per_side) - edyn::scalar(num_per_side) / 2) * spacing,
+            5 + rng.next(0, 5),
+            (edyn::scalar(i / num_per_side) - edyn::scalar(num_per_side) / 2) * spacing};
+        def.orientation = edyn::quaternion_axis_angle({0, 1, 0}, rng.next(0, edyn::pi2));
+        defs.push_back(def);
+    }
+
+    edyn::batch_rigidbodies(world.registry, defs);
+    world.warm_up(60);
+
+    for (auto _ : state) {
+        world.step();
+    }
+
+    world.report(state);
+}
+
+BENCHMARK(BM_paged_terrain)->Arg(256)->Arg(1024)->Arg(4096)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,196 @@
+#include "bench_common.hpp"
+#include <edyn/comp/island.hpp>
+#include <edyn/comp/tag.hpp>
+#include <edyn/shapes/convex_mesh.hpp>
+#include <cmath>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace edyn_bench {
+
+// Maximum time to wait for all islands to finish a step. Islands can be
+// merged while a step is pending, in which case the merged island might
+// not report the step.
+constexpr double max_step_wait_time = 1.0;
+
+bench_world::bench_world() {
+    edyn::init();
+    edyn::attach(registry);
+    edyn::set_paused(registry, true);
+    edyn::set_profiling_enabled(registry, true, 1 << 16);
+}
+
+bench_world::~bench_world() {
+    edyn::detach(registry);
+    edyn::deinit();
+}
+
+size_t bench_world::count_awake_islands() const {
+    size_t count = 0;
+    auto island_view = registry.view<edyn::island>(entt::exclude<edyn::sleeping_tag>);
+
+    for ([[maybe_unused]] auto entity : island_view) {
+        ++count;
+    }
+
+    return count;
+}
+
+void bench_world::consume_samples(size_t &num_finished_steps) {
+    m_samples.clear();
+    edyn::consume_profile_samples(registry, m_samples);
+
+    for (auto &sample : m_samples) {
+        m_stage_time[static_cast<size_t>(sample.stage)] += sample.duration;
+
+        if (sample.stage == edyn::profile_stage::finish_step) {
+            ++num_finished_steps;
+        }
+    }
+}
+
+void bench_world::step() {
+    // Let the coordinator create islands for new entities before stepping.
+    size_t num_finished_steps = 0;
+    edyn::update(registry);
+    consume_samples(num_finished_steps);
+
+    num_finished_steps = 0;
+    edyn::step_simulation(registry);
+    auto deadline = edyn::performance_time() + max_step_wait_time;
+
+    while (num_finished_steps < count_awake_islands()) {
+        edyn::update(registry);
+        consume_samples(num_finished_steps);
+
+        if (edyn::performance_time() > deadline) {
+            break;
+        }
+
+        std::this_thread::yield();
+    }
+
+    ++m_num_steps;
+}
+
+void bench_world::warm_up(size_t num_steps) {
+    for (size_t i = 0; i < num_steps; ++i) {
+        step();
+    }
+
+    m_stage_time.fill(0);
+    m_num_steps = 0;
+}
+
+void bench_world::report(benchmark::State &state) const {
+    state.counters["steps/s"] = benchmark::Counter(static_cast<double>(m_num_steps), benchmark::Counter::kIsRate);
+
+    for (size_t i = 0; i < num_profile_stages; ++i) {
+        auto name = std::string(edyn::profile_stage_name(static_cast<edyn::profile_stage>(i))) + "_ms";
+        state.counters[name] = m_num_steps > 0 ? m_stage_time[i] * 1000 / m_num_steps : 0;
+    }
+
+    state.counters["peak_rss_MB"] = static_cast<double>(peak_memory_bytes()) / (1024 * 1024);
+}
+
+entt::entity make_ground(entt::registry &registry) {
+    auto def = edyn::rigidbody_def();
+    def.kind = edyn::rigidbody_kind::rb_static;
+    def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    def.presentation = false;
+    return edyn::make_rigidbody(registry, def);
+}
+
+size_t make_pyramid(entt::registry &registry, const edyn::shapes_variant_t &shape,
+                    const edyn::quaternion &orientation, edyn::scalar size,
+                    size_t num_levels, const edyn::vector3 &origin) {
+    auto def = edyn::rigidbody_def();
+    def.mass = 10;
+    def.shape = shape;
+    def.orientation = orientation;
+    def.presentation = false;
+    // Keep the amount of work constant in every step.
+    def.sleeping_disabled = true;
+    def.update_inertia();
+
+    auto defs = std::vector<edyn::rigidbody_def>{};
+
+    for (size_t level = 0; level < num_levels; ++level) {
+        auto num_bodies_per_side = num_levels - level;
+        auto half_extent = size * (num_bodies_per_side - 1) / 2;
+
+        for (size_t i = 0; i < num_bodies_per_side; ++i) {
+            for (size_t k = 0; k < num_bodies_per_side; ++k) {
+                def.position = origin + edyn::vector3{
+                    size * i - half_extent,
+                    size * (level + edyn::scalar(0.5)),
+                    size * k - half_extent};
+                defs.push_back(def);
+            }
+        }
+    }
+
+    edyn::batch_rigidbodies(registry, defs);
+
+    return defs.size();
+}
+
+edyn::polyhedron_shape make_prism_shape(edyn::scalar radius, edyn::scalar half_height, size_t num_sides) {
+    auto mesh = std::make_shared<edyn::convex_mesh>();
+
+    for (auto y : {-half_height, half_height}) {
+        for (size_t i = 0; i < num_sides; ++i) {
+            auto angle = edyn::pi2 * i / num_sides;
+            mesh->vertices.push_back({radius * std::cos(angle), y, radius * std::sin(angle)});
+        }
+    }
+
+    auto add_face = [&](const std::vector<uint32_t> &indices) {
+        mesh->faces.push_back(static_cast<uint32_t>(mesh->indices.size()));
+        mesh->faces.push_back(static_cast<uint32_t>(indices.size()));
+        mesh->indices.insert(mesh->indices.end(), indices.begin(), indices.end());
+    };
+
+    auto n = static_cast<uint32_t>(num_sides);
+    auto bottom = std::vector<uint32_t>{};
+    auto top = std::vector<uint32_t>{};
+
+    // Faces are counter-clockwise when seen from outside.
+    for (uint32_t i = 0; i < n; ++i) {
+        bottom.push_back(i);
+        top.push_back(2 * n - 1 - i);
+    }
+
+    add_face(bottom);
+    add_face(top);
+
+    for (uint32_t i = 0; i < n; ++i) {
+        auto j = (i + 1) % n;
+        add_face({n + i, n + j, j, i});
+    }
+
+    mesh->initialize();
+
+    return edyn::polyhedron_shape(mesh);
+}
+
+size_t peak_memory_bytes() {
+#if defined(__APPLE__)
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);
+#elif defined(__unix__)
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+    // Value is in kilobytes.
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#else
+    return 0;
+#endif
+}
+
+}
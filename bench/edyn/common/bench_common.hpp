@@ -0,0 +1,116 @@
+#ifndef BENCH_EDYN_COMMON_BENCH_COMMON_HPP
+#define BENCH_EDYN_COMMON_BENCH_COMMON_HPP
+
+#include <array>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <edyn/edyn.hpp>
+
+namespace edyn_bench {
+
+constexpr size_t num_profile_stages = static_cast<size_t>(edyn::profile_stage::coordinator_sync) + 1;
+
+/**
+ * @brief A registry with Edyn attached where the simulation only advances
+ * when `step` is called, which makes scenes reproducible regardless of how
+ * long each step takes. The step profiler is enabled to collect the time
+ * spent in each stage.
+ */
+class bench_world {
+public:
+    bench_world();
+    ~bench_world();
+
+    /**
+     * @brief Steps all awake islands once and blocks until all of them have
+     * finished the step.
+     */
+    void step();
+
+    /**
+     * @brief Steps the simulation a number of times, usually to let a scene
+     * settle before measuring, then resets the statistics.
+     * @param num_steps Number of steps.
+     */
+    void warm_up(size_t num_steps);
+
+    /**
+     * @brief Assigns benchmark counters with the number of steps per second,
+     * the average time spent in each stage per step summed over all islands
+     * and the peak memory usage of the process.
+     * @param state Benchmark state.
+     */
+    void report(benchmark::State &state) const;
+
+    entt::registry registry;
+
+private:
+    size_t count_awake_islands() const;
+    void consume_samples(size_t &num_finished_steps);
+
+    std::vector<edyn::profile_sample> m_samples;
+    std::array<double, num_profile_stages> m_stage_time {};
+    size_t m_num_steps {0};
+};
+
+/**
+ * @brief Creates a static plane at the origin facing upwards.
+ */
+entt::entity make_ground(entt::registry &registry);
+
+/**
+ * @brief Creates a square pyramid of dynamic rigid bodies where each layer
+ * sits in the gaps between the bodies in the layer below.
+ * @param registry Data source.
+ * @param shape Shape of all bodies.
+ * @param orientation Orientation of all bodies.
+ * @param size Distance between the centers of adjacent bodies.
+ * @param num_levels Number of layers. The bottom layer has `num_levels^2` bodies.
+ * @param origin Position of the center of the bottom layer.
+ * @return Number of rigid bodies created.
+ */
+size_t make_pyramid(entt::registry &registry, const edyn::shapes_variant_t &shape,
+                    const edyn::quaternion &orientation, edyn::scalar size,
+                    size_t num_levels, const edyn::vector3 &origin);
+
+/**
+ * @brief Creates a prism polyhedron with its axis along y.
+ * @param radius Distance from the axis to the vertices.
+ * @param half_height Half the height of the prism.
+ * @param num_sides Number of side faces.
+ */
+edyn::polyhedron_shape make_prism_shape(edyn::scalar radius, edyn::scalar half_height, size_t num_sides);
+
+/**
+ * @brief Peak resident memory of the process in bytes, or zero if not
+ * available on this platform.
+ */
+size_t peak_memory_bytes();
+
+/**
+ * @brief Small deterministic random number generator, so that scenes are
+ * identical on all platforms.
+ */
+class random_generator {
+public:
+    explicit random_generator(uint32_t seed) : m_state(seed ? seed : 1) {}
+
+    // Returns a number in [0, 1].
+    edyn::scalar next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return static_cast<edyn::scalar>(m_state & 0xffffff) / edyn::scalar(0xffffff);
+    }
+
+    edyn::scalar next(edyn::scalar min, edyn::scalar max) {
+        return min + (max - min) * next();
+    }
+
+private:
+    uint32_t m_state;
+};
+
+}
+
+#endif // BENCH_EDYN_COMMON_BENCH_COMMON_HPP
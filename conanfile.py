@@ -22,6 +22,7 @@ class EdynConan(ConanFile):
         "enable_sanitizer": [True, False],
         "floating_type": ["float", "double"],
         "build_tests": [True, False],
+        "build_benchmarks": [True, False],
     }
     default_options = {
         "shared": False,
@@ -30,6 +31,7 @@ class EdynConan(ConanFile):
         "enable_sanitizer": False,
         "floating_type": "float",
         "build_tests": False,
+        "build_benchmarks": False,
         "gtest:no_main": False,
     }
     settings = "os", "arch", "compiler", "build_type"
@@ -49,16 +51,19 @@ class EdynConan(ConanFile):
         self.requires("entt/3.10.1")
         if self.options.build_tests:
             self.requires("gtest/1.11.0", private=True)
+        if self.options.build_benchmarks:
+            self.requires("benchmark/1.6.1", private=True)
 
     def export_sources(self):
         self.copy("AUTHORS")
         self.copy("LICENSE")
         self.copy("CMakeLists.txt")
-        for folder in ("cmake", "docs", "examples", "include", "src", "test"):
+        for folder in ("bench", "cmake", "docs", "examples", "include", "src", "test"):
             shutil.copytree(folder, os.path.join(self.export_sources_folder , folder))
 
     def package_id(self):
         del self.info.options.build_tests
+        del self.info.options.build_benchmarks
 
     def build(self):
         def no_backslashes(path: str) -> str:
@@ -76,6 +81,7 @@ class EdynConan(ConanFile):
         cmake.verbose = True
         cmake.definitions["EDYN_BUILD_EXAMPLES"] = self.options.build_tests
         cmake.definitions["EDYN_BUILD_TESTS"] = self.options.build_tests
+        cmake.definitions["EDYN_BUILD_BENCHMARKS"] = self.options.build_benchmarks
         cmake.definitions["EDYN_INSTALL"] = True
         cmake.definitions["EDYN_CONFIG_DOUBLE"] = self.options.floating_type == "double"
         cmake.definitions["EDYN_DISABLE_ASSERT"] = not self.options.enable_assert
@@ -7,6 +7,7 @@
 #include "edyn/comp/island.hpp"
 #include "edyn/math/constants.hpp"
 #include "edyn/collision/dynamic_tree.hpp"
+#include "edyn/collision/sweep_and_prune.hpp"
 #include "edyn/util/entity_pair.hpp"
 
 namespace edyn {
@@ -37,6 +38,14 @@ class broadphase_main {
                                                  const aabb_view_t &aabb_view,
                                                  const multi_resident_view_t &resident_view,
                                                  const tree_view_view_t &tree_view_view) const;
+    void find_intersecting_non_procedural(entt::entity island_entity, const tree_view &island_tree,
+                                          const AABB &island_aabb,
+                                          const aabb_view_t &aabb_view,
+                                          const multi_resident_view_t &resident_view,
+                                          entity_pair_vector &results) const;
+    void update_sweep_and_prune(const aabb_view_t &aabb_view,
+                                const multi_resident_view_t &resident_view,
+                                const tree_view_view_t &tree_view_view);
 
 public:
     broadphase_main(entt::registry &);
@@ -57,13 +66,16 @@ public:
     void on_construct_tree_view(entt::registry &, entt::entity);
     void on_construct_static_kinematic_tag(entt::registry &, entt::entity);
     void on_construct_aabb(entt::registry &, entt::entity);
+    void on_update_aabb(entt::registry &, entt::entity);
     void on_destroy_tree_resident(entt::registry &, entt::entity);
 
 private:
     entt::registry *m_registry;
     dynamic_tree m_island_tree; // Tree for island AABBs.
     dynamic_tree m_np_tree; // Tree for non-procedural entities.
+    sweep_and_prune m_island_sap; // Island AABBs when using sweep-and-prune.
     std::vector<entity_pair_vector> m_pair_results;
+    std::vector<entt::entity> m_moved_np_entities; // Kinematic entities whose AABB was updated.
 
     bool should_collide(entt::entity, entt::entity) const;
 };
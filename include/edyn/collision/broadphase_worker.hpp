@@ -1,15 +1,19 @@
 #ifndef EDYN_COLLISION_BROADPHASE_WORKER_HPP
 #define EDYN_COLLISION_BROADPHASE_WORKER_HPP
 
+#include <array>
+#include <memory>
 #include <vector>
 #include <entt/entity/fwd.hpp>
 #include "edyn/comp/aabb.hpp"
 #include "edyn/util/entity_pair.hpp"
 #include "edyn/collision/dynamic_tree.hpp"
+#include "edyn/collision/sweep_and_prune.hpp"
 
 namespace edyn {
 
 struct job;
+class entity_map;
 
 class broadphase_worker {
     // Offset applied to AABBs when querying the trees.
@@ -18,10 +22,26 @@ class broadphase_worker {
     // Separation threshold for new manifolds.
     constexpr static auto m_separation_threshold = contact_breaking_threshold * scalar(1.3);
 
+    // An entity is only queried again once its AABB leaves the AABB of its
+    // last query inflated by this margin. Since both entities of a pair can
+    // move by up to twice this margin relative to each other without
+    // querying, the query offset is increased by three times the margin
+    // so no pair is missed.
+    constexpr static auto m_requery_margin = contact_breaking_threshold * scalar(0.05);
+    constexpr static auto m_query_offset = vector3_one * -(contact_breaking_threshold + m_requery_margin * scalar(3));
+
     void init_new_aabb_entities();
+    void update_moved_entities();
+
+    void collide_tree(const dynamic_tree &tree, entt::entity entity, const AABB &offset_aabb,
+                      bool entity_first = true);
+    void collide_tree_async(const dynamic_tree &tree, entt::entity entity, const AABB &offset_aabb,
+                            size_t result_index, bool entity_first = true);
+    void collide_sap(size_t index);
+    void collide_sap_async(size_t index);
 
-    void collide_tree(const dynamic_tree &tree, entt::entity entity, const AABB &offset_aabb);
-    void collide_tree_async(const dynamic_tree &tree, entt::entity entity, const AABB &offset_aabb, size_t result_index);
+    bool use_sweep_and_prune() const;
+    void prefetch_paged_meshes();
 
     void common_update();
 
@@ -39,18 +59,55 @@ public:
      */
     tree_view view() const;
 
+    /**
+     * @brief Returns a view of the procedural dynamic tree with entities
+     * mapped into another registry, usually the coordinator's, so that it
+     * can be shared with it without copying or remapping the nodes. The
+     * nodes are written into a small ring of buffers which are reused once
+     * no view refers to them anymore, thus a view can be published every
+     * step without allocations. Entities without a mapping are set to null.
+     * @param emap Maps entities of the other registry into this registry.
+     * @return Tree view of the procedural dynamic tree.
+     */
+    tree_view publish_view(const entity_map &emap);
+
+    /**
+     * @brief Number of tree nodes moved in the last update.
+     */
+    size_t num_tree_moves() const {
+        return m_num_tree_moves;
+    }
+
     template<typename Func>
     void raycast(vector3 p0, vector3 p1, Func func);
 
     void on_construct_aabb(entt::registry &, entt::entity);
+    void on_update_aabb(entt::registry &, entt::entity);
     void on_destroy_tree_resident(entt::registry &, entt::entity);
+    void on_destroy_contact_manifold(entt::registry &, entt::entity);
 
 private:
     entt::registry *m_registry;
     dynamic_tree m_tree; // Procedural dynamic tree.
     dynamic_tree m_np_tree; // Non-procedural dynamic tree.
     std::vector<entt::entity> m_new_aabb_entities;
+    // Entities that must be queried in the next update, such as bodies of
+    // destroyed manifolds and entities whose AABB was replaced externally.
+    std::vector<entt::entity> m_requery_entities;
+    // Procedural and non-procedural entities which moved enough to be
+    // queried in the current update.
+    std::vector<entt::entity> m_moved_entities;
+    std::vector<entt::entity> m_moved_np_entities;
+    sweep_and_prune m_sap; // Procedural entities when using sweep-and-prune.
     std::vector<entity_pair_vector> m_pair_results;
+    std::vector<uint8_t> m_pair_contained; // Scratch for `contains_many`.
+    entity_pair_vector m_new_pairs;
+    std::vector<entt::entity> m_new_manifolds;
+    size_t m_num_tree_moves {0};
+
+    // Node buffers shared with published tree views.
+    std::array<std::shared_ptr<tree_view::node_vector>, 3> m_view_buffers;
+    size_t m_view_buffer_index {0};
 };
 
 template<typename Func>
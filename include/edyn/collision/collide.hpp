@@ -8,6 +8,8 @@
 
 namespace edyn {
 
+struct polyhedron_collision_cache;
+
 struct collision_context {
     vector3 posA;
     quaternion ornA;
@@ -19,6 +21,10 @@ struct collision_context {
 
     scalar threshold;
 
+    // Results of the previous collision test between the same pair of
+    // polyhedrons. Optional and not carried over to swapped contexts.
+    polyhedron_collision_cache *polyhedron_cache {nullptr};
+
     collision_context swapped() const {
         return {posB, ornB, aabbB,
                 posA, ornA, aabbA,
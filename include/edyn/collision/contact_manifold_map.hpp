@@ -1,17 +1,46 @@
 #ifndef EDYN_COLLISION_CONTACT_MANIFOLD_MAP
 #define EDYN_COLLISION_CONTACT_MANIFOLD_MAP
 
-#include <map>
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 #include <utility>
 #include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
 #include "edyn/util/entity_pair.hpp"
 
 namespace edyn {
 
 /**
  * @brief Maps a pair of entities to their contact manifold.
+ * Pairs are stored in a flat open-addressing table with linear probing,
+ * keyed by both entities packed into one integer in increasing order, thus
+ * a lookup usually touches a single cache line.
  */
 class contact_manifold_map {
+    using key_type = uint64_t;
+
+    // Key of an empty slot. A pair of null entities is never inserted.
+    static constexpr key_type empty_key = ~key_type(0);
+
+    static key_type make_key(entt::entity first, entt::entity second) {
+        auto a = static_cast<key_type>(entt::to_integral(first));
+        auto b = static_cast<key_type>(entt::to_integral(second));
+        return a < b ? (a << 32) | b : (b << 32) | a;
+    }
+
+    size_t slot_of(key_type key) const {
+        // Fibonacci hashing spreads consecutive entity identifiers over
+        // the entire table.
+        return static_cast<size_t>((key * 0x9e3779b97f4a7c15ull) >> m_shift);
+    }
+
+    size_t find(key_type key) const;
+    void insert(key_type key, entt::entity value);
+    void erase(key_type key);
+    void rehash(size_t capacity);
+
 public:
     contact_manifold_map(entt::registry &);
 
@@ -25,6 +54,17 @@ public:
     /*! @copydoc contains */
     bool contains(entt::entity, entt::entity) const;
 
+    /**
+     * @brief Checks whether a contact manifold exists for each pair in a
+     * range. The hashes of a batch of pairs are calculated before probing,
+     * which allows the memory accesses to overlap.
+     * @param first Iterator to the first `entity_pair`.
+     * @param last Iterator past the last `entity_pair`.
+     * @param result Output iterator where a boolean is written per pair.
+     */
+    template<typename Iterator, typename OutputIterator>
+    void contains_many(Iterator first, Iterator last, OutputIterator result) const;
+
     /**
      * @brief Gets the manifold entity joining a pair of entities.
      * @param pair The pair of entities.
@@ -35,13 +75,59 @@ public:
     /*! @copydoc get */
     entt::entity get(entt::entity, entt::entity) const;
 
+    /**
+     * @brief Number of pairs with a contact manifold.
+     */
+    size_t size() const {
+        return m_size;
+    }
+
     void on_construct_contact_manifold(entt::registry &, entt::entity);
     void on_destroy_contact_manifold(entt::registry &, entt::entity);
 
 private:
-    std::map<entity_pair, entt::entity> m_pair_map;
+    // Keys and values are kept in separate arrays so probing only touches
+    // the keys.
+    std::vector<key_type> m_keys;
+    std::vector<entt::entity> m_values;
+    size_t m_size {0};
+    unsigned m_shift {64};
 };
 
+template<typename Iterator, typename OutputIterator>
+void contact_manifold_map::contains_many(Iterator first, Iterator last, OutputIterator result) const {
+    if (m_size == 0) {
+        for (; first != last; ++first) {
+            *result++ = false;
+        }
+        return;
+    }
+
+    constexpr size_t batch_size = 16;
+    std::array<key_type, batch_size> keys;
+    std::array<size_t, batch_size> slots;
+    const auto mask = m_keys.size() - 1;
+
+    while (first != last) {
+        size_t count = 0;
+
+        for (; first != last && count < batch_size; ++first, ++count) {
+            keys[count] = make_key(first->first, first->second);
+            slots[count] = slot_of(keys[count]);
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            auto slot = slots[i];
+
+            while (m_keys[slot] != keys[i] && m_keys[slot] != empty_key) {
+                slot = (slot + 1) & mask;
+            }
+
+            *result++ = m_keys[slot] == keys[i];
+        }
+    }
+}
+
 }
 
 #endif // EDYN_COLLISION_CONTACT_MANIFOLD_MAP
@@ -8,11 +8,10 @@
 #include "edyn/math/geom.hpp"
 #include "edyn/collision/tree_node.hpp"
 #include "edyn/collision/query_tree.hpp"
+#include "edyn/collision/tree_view.hpp"
 
 namespace edyn {
 
-class tree_view;
-
 /**
  * @brief Dynamic bounding volume hierarchy tree for broad-phase collision detection.
  *
@@ -99,6 +98,18 @@ public:
 
     tree_view view() const;
 
+    /**
+     * @brief Writes all nodes into an array which can be shared by a
+     * `tree_view`. The array is resized and its memory is reused.
+     * @tparam Func Inferred function parameter type.
+     * @param nodes Destination array.
+     * @param map_entity Function which takes the entity of a leaf node and
+     * returns the entity to be assigned to the node in the array.
+     * @return Id of the root node.
+     */
+    template<typename Func>
+    tree_node_id_t copy_nodes(tree_view::node_vector &nodes, Func map_entity) const;
+
 private:
     tree_node_id_t m_root;
 
@@ -111,6 +122,19 @@ void dynamic_tree::query(const AABB &aabb, Func func) const {
     query_tree(*this, m_root, null_tree_node_id, aabb, func);
 }
 
+template<typename Func>
+tree_node_id_t dynamic_tree::copy_nodes(tree_view::node_vector &nodes, Func map_entity) const {
+    nodes.resize(m_nodes.size());
+
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        auto &node = m_nodes[i];
+        auto entity = node.entity == entt::null ? node.entity : map_entity(node.entity);
+        nodes[i] = tree_view::tree_node{entity, node.aabb, node.child1, node.child2};
+    }
+
+    return m_root;
+}
+
 template<typename Func>
 void dynamic_tree::raycast(vector3 p0, vector3 p1, Func func) const {
     raycast_tree(*this, m_root, null_tree_node_id, p0, p1, func);
@@ -0,0 +1,62 @@
+#ifndef EDYN_COLLISION_GJK_EPA_HPP
+#define EDYN_COLLISION_GJK_EPA_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "edyn/math/scalar.hpp"
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+struct convex_mesh;
+
+/**
+ * @brief Simplex of the last GJK query between two convex meshes. Its
+ * vertices are stored as pairs of vertex indices of each mesh, which remain
+ * valid as the meshes move, thus the next query for the same pair can start
+ * from it instead of starting from scratch.
+ */
+struct gjk_simplex {
+    std::array<uint32_t, 4> indexA;
+    std::array<uint32_t, 4> indexB;
+    uint8_t size {0};
+};
+
+struct gjk_epa_result {
+    // Unit vector pointing towards A along which the distance between the
+    // shapes is measured.
+    vector3 normal;
+
+    // Distance between the shapes, which is negative if they intersect, in
+    // which case it's the penetration depth.
+    scalar distance;
+};
+
+/**
+ * @brief Calculates the distance between two convex meshes using the
+ * Gilbert-Johnson-Keerthi algorithm. If they intersect, the penetration depth
+ * is calculated using the Expanding Polytope Algorithm. Support points are
+ * found by walking over the vertex adjacency of the meshes, thus the cost
+ * grows slowly with the number of vertices, unlike the separating axis test
+ * where all pairs of edges must be visited.
+ * @param meshA First convex mesh.
+ * @param verticesA Rotated vertices of `meshA`.
+ * @param posA Position of first mesh.
+ * @param meshB Second convex mesh.
+ * @param verticesB Rotated vertices of `meshB`.
+ * @param posB Position of second mesh.
+ * @param simplex Simplex of the previous query between these meshes, which is
+ * updated. Use an empty simplex if there's none.
+ * @param result Distance and normal.
+ * @return Whether the query succeeded. It fails for degenerate configurations
+ * where the penetration depth can't be calculated reliably, such as shapes
+ * barely touching, in which case another method must be used.
+ */
+bool gjk_epa(const convex_mesh &meshA, const std::vector<vector3> &verticesA, const vector3 &posA,
+             const convex_mesh &meshB, const std::vector<vector3> &verticesB, const vector3 &posB,
+             gjk_simplex &simplex, gjk_epa_result &result);
+
+}
+
+#endif // EDYN_COLLISION_GJK_EPA_HPP
@@ -2,6 +2,8 @@
 #define EDYN_COLLISION_NARROWPHASE_HPP
 
 #include <array>
+#include <vector>
+#include <cstdint>
 #include <entt/entity/fwd.hpp>
 #include "edyn/comp/aabb.hpp"
 #include "edyn/comp/origin.hpp"
@@ -12,6 +14,7 @@
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_point.hpp"
 #include "edyn/collision/collision_result.hpp"
+#include "edyn/collision/polyhedron_collision_cache.hpp"
 #include "edyn/util/collision_util.hpp"
 #include "edyn/context/settings.hpp"
 
@@ -20,16 +23,6 @@ namespace edyn {
 struct job;
 
 class narrowphase {
-    struct contact_point_construction_info {
-        std::array<collision_result::collision_point, max_contacts> point;
-        size_t count {0};
-    };
-
-    struct contact_point_destruction_info {
-        std::array<contact_manifold::contact_id_type, max_contacts> point_id;
-        size_t count {0};
-    };
-
     void clear_contact_manifold_events();
 
 public:
@@ -50,10 +43,14 @@ public:
     void update_contact_manifolds(Iterator begin, Iterator end,
                                   ContactManifoldView &manifold_view);
 
+    void on_construct_contact_manifold(entt::registry &, entt::entity);
+
 private:
     entt::registry *m_registry;
-    std::vector<contact_point_construction_info> m_cp_construction_infos;
-    std::vector<contact_point_destruction_info> m_cp_destruction_infos;
+    // Whether contact points were created or destroyed in each manifold
+    // during an async update, in the order of the manifold view.
+    std::vector<uint8_t> m_manifold_changed;
+    std::vector<entt::entity> m_dirty_entities;
 };
 
 template<typename Iterator>
@@ -66,10 +63,13 @@ template<typename ContactManifoldView, typename Iterator>
 void narrowphase::update_contact_manifolds(Iterator begin, Iterator end,
                                            ContactManifoldView &manifold_view) {
     auto events_view = m_registry->view<contact_manifold_events>();
+    auto polyhedron_cache_view = m_registry->view<polyhedron_collision_cache>();
     auto body_view = m_registry->view<AABB, shape_index, position, orientation>();
     auto tr_view = m_registry->view<position, orientation>();
     auto origin_view = m_registry->view<origin>();
     auto vel_view = m_registry->view<angvel>();
+    auto linvel_view = m_registry->view<linvel>();
+    auto ccd_view = m_registry->view<ccd_tag>();
     auto rolling_view = m_registry->view<rolling_tag>();
     auto material_view = m_registry->view<material>();
     auto orn_view = m_registry->view<orientation>();
@@ -82,8 +82,16 @@ void narrowphase::update_contact_manifolds(Iterator begin, Iterator end,
         entt::entity manifold_entity = *it;
         auto &manifold = manifold_view.template get<contact_manifold>(manifold_entity);
         auto &events = events_view.get<contact_manifold_events>(manifold_entity);
+        auto *polyhedron_cache = polyhedron_cache_view.contains(manifold_entity) ?
+            &polyhedron_cache_view.get<polyhedron_collision_cache>(manifold_entity) : nullptr;
         collision_result result;
-        detect_collision(manifold.body, result, body_view, origin_view, views_tuple);
+
+        if (ccd_view.contains(manifold.body[0]) || ccd_view.contains(manifold.body[1])) {
+            detect_collision_ccd(manifold.body, result, body_view, origin_view,
+                                 linvel_view, vel_view, views_tuple, dt);
+        } else {
+            detect_collision(manifold.body, result, body_view, origin_view, views_tuple, polyhedron_cache);
+        }
 
         process_collision(manifold_entity, manifold, events, result, tr_view, vel_view,
                           rolling_view, origin_view, orn_view, material_view,
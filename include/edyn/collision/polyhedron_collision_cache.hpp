@@ -0,0 +1,54 @@
+#ifndef EDYN_COLLISION_POLYHEDRON_COLLISION_CACHE_HPP
+#define EDYN_COLLISION_POLYHEDRON_COLLISION_CACHE_HPP
+
+#include <cstdint>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/collision/gjk_epa.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Assigned to contact manifolds between two polyhedrons to store
+ * the results of the last collision test, which are used to speed up the
+ * next one. It is local to the island worker and is not shared.
+ */
+struct polyhedron_collision_cache {
+    enum class axis_type : uint8_t {
+        none,
+        face_A, // Face normal of A.
+        face_B, // Face normal of B.
+        edge // Cross product of an edge of A and an edge of B.
+    };
+
+    // Feature that produced the separating axis, i.e. the axis of minimum
+    // penetration or maximum separation.
+    axis_type type {axis_type::none};
+
+    // Index into `relevant_normals` of the polyhedron for a face axis or
+    // indices into `relevant_edges` of A and B for an edge axis.
+    uint32_t indexA {0};
+    uint32_t indexB {0};
+
+    // Indices of the support vertices last found on each polyhedron, where
+    // the next support queries start.
+    uint32_t supportA {0};
+    uint32_t supportB {0};
+
+    // Orientation and position of B relative to A when the separating axis
+    // was last searched.
+    quaternion relative_orn {quaternion_identity};
+    vector3 relative_pos {vector3_zero};
+
+    // Whether to find the separating axis using GJK and EPA instead of the
+    // separating axis test, which is decided once based on the vertex count
+    // of the meshes.
+    bool use_gjk_epa {false};
+
+    // Simplex of the last GJK query, where the next one starts.
+    gjk_simplex simplex;
+};
+
+}
+
+#endif // EDYN_COLLISION_POLYHEDRON_COLLISION_CACHE_HPP
@@ -70,6 +70,10 @@ public:
         return m_nodes[id];
     }
 
+    size_t memory_size() const {
+        return m_nodes.capacity() * sizeof(tree_node);
+    }
+
     template<typename Func>
     void query(const AABB &aabb, Func func) const;
 
@@ -0,0 +1,170 @@
+#ifndef EDYN_COLLISION_SWEEP_AND_PRUNE_HPP
+#define EDYN_COLLISION_SWEEP_AND_PRUNE_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <entt/entity/fwd.hpp>
+#include "edyn/comp/aabb.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Incremental sweep-and-prune broad-phase. AABBs are kept sorted by
+ * their minimum along the axis with the greatest variance. Since bodies move
+ * little between steps, the previous order is reused and an insertion sort
+ * restores it in nearly linear time. Bounds are stored as structure-of-arrays
+ * so the overlap test in the other two axes can be vectorized.
+ */
+class sweep_and_prune {
+    struct entry {
+        AABB aabb;
+        entt::entity entity;
+    };
+
+    void sort_and_build(bool full_sort);
+
+public:
+    /**
+     * @brief Synchronizes the structure with the current set of entities and
+     * their AABBs and sorts them.
+     * @param first Iterator to the first current entity.
+     * @param last Iterator past the last current entity.
+     * @param contains Function object with signature `bool(entt::entity)`
+     * which returns whether an entity is still present.
+     * @param get_aabb Function object with signature `AABB(entt::entity)`
+     * which returns the current AABB of an entity.
+     * @param margin All AABBs are inflated by this amount. Two entities
+     * overlap if their AABBs are within twice this distance.
+     */
+    template<typename Iterator, typename ContainsFunc, typename AABBFunc>
+    void update(Iterator first, Iterator last, ContainsFunc contains, AABBFunc get_aabb, scalar margin);
+
+    /**
+     * @brief Number of entities.
+     */
+    size_t size() const {
+        return m_entries.size();
+    }
+
+    /**
+     * @brief Entity at a position in the sorted order.
+     */
+    entt::entity entity(size_t index) const {
+        return m_entries[index].entity;
+    }
+
+    /**
+     * @brief Invokes a function for each entity whose inflated AABB overlaps
+     * the inflated AABB of the entity at `index` and comes after it in the
+     * sorted order, thus each pair is visited only once when all indices
+     * are swept.
+     * @param index Position in the sorted order.
+     * @param func Function object with signature `void(entt::entity)`.
+     */
+    template<typename Func>
+    void sweep(size_t index, Func func) const;
+
+private:
+    std::vector<entry> m_entries;
+    std::vector<entt::entity> m_scratch;
+    std::array<std::vector<scalar>, 3> m_min;
+    std::array<std::vector<scalar>, 3> m_max;
+    size_t m_axis {0};
+    size_t m_next_axis {0};
+};
+
+template<typename Iterator, typename ContainsFunc, typename AABBFunc>
+void sweep_and_prune::update(Iterator first, Iterator last, ContainsFunc contains, AABBFunc get_aabb, scalar margin) {
+    // Remove entities which are not present anymore while keeping the order.
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [&](const entry &e) {
+        return !contains(e.entity);
+    }), m_entries.end());
+
+    // Insert new entities.
+    size_t count = 0;
+
+    for (auto it = first; it != last; ++it) {
+        ++count;
+    }
+
+    auto num_new_entities = count - m_entries.size();
+
+    if (num_new_entities > 0) {
+        m_scratch.clear();
+
+        for (auto &e : m_entries) {
+            m_scratch.push_back(e.entity);
+        }
+
+        std::sort(m_scratch.begin(), m_scratch.end());
+
+        for (auto it = first; it != last; ++it) {
+            entt::entity entity = *it;
+
+            if (!std::binary_search(m_scratch.begin(), m_scratch.end(), entity)) {
+                m_entries.push_back({AABB{}, entity});
+            }
+        }
+    }
+
+    const auto inflation = vector3_one * -margin;
+
+    for (auto &e : m_entries) {
+        e.aabb = get_aabb(e.entity).inset(inflation);
+    }
+
+    // Fall back to a full sort if too many entities were added since the
+    // insertion sort would degrade to quadratic time.
+    auto full_sort = num_new_entities > m_entries.size() / 4;
+    sort_and_build(full_sort);
+}
+
+template<typename Func>
+void sweep_and_prune::sweep(size_t index, Func func) const {
+    const auto axis_a = m_axis;
+    const auto axis_b = (m_axis + 1) % 3;
+    const auto axis_c = (m_axis + 2) % 3;
+
+    auto &min_a = m_min[axis_a];
+    auto &min_b = m_min[axis_b];
+    auto &max_b = m_max[axis_b];
+    auto &min_c = m_min[axis_c];
+    auto &max_c = m_max[axis_c];
+
+    const auto max_index_a = m_max[axis_a][index];
+    const auto min_index_b = min_b[index];
+    const auto max_index_b = max_b[index];
+    const auto min_index_c = min_c[index];
+    const auto max_index_c = max_c[index];
+
+    // Entries are sorted by minimum along the sweep axis, thus all candidates
+    // lie before the first entry that starts after this entry ends.
+    auto end = static_cast<size_t>(std::upper_bound(min_a.begin() + index + 1, min_a.end(), max_index_a) - min_a.begin());
+
+    // Test overlap along the other axes in fixed-size chunks without branches
+    // so the loop can be vectorized, then report the overlapping entities.
+    constexpr size_t chunk_size = 16;
+    std::array<uint8_t, chunk_size> overlap;
+
+    for (size_t chunk_begin = index + 1; chunk_begin < end; chunk_begin += chunk_size) {
+        auto count = std::min(chunk_size, end - chunk_begin);
+
+        for (size_t k = 0; k < count; ++k) {
+            auto j = chunk_begin + k;
+            overlap[k] = (min_b[j] <= max_index_b) & (min_index_b <= max_b[j]) &
+                         (min_c[j] <= max_index_c) & (min_index_c <= max_c[j]);
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+            if (overlap[k]) {
+                func(m_entries[chunk_begin + k].entity);
+            }
+        }
+    }
+}
+
+}
+
+#endif // EDYN_COLLISION_SWEEP_AND_PRUNE_HPP
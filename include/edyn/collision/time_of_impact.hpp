@@ -0,0 +1,160 @@
+#ifndef EDYN_COLLISION_TIME_OF_IMPACT_HPP
+#define EDYN_COLLISION_TIME_OF_IMPACT_HPP
+
+#include <type_traits>
+#include "edyn/collision/collide.hpp"
+
+namespace edyn {
+
+/**
+ * @brief State of a body for a time of impact query.
+ */
+struct toi_body {
+    vector3 origin;
+    quaternion orn;
+    AABB aabb;
+    vector3 linvel;
+    vector3 angvel;
+};
+
+/**
+ * @brief Radius of a sphere centered at the origin of the shape which
+ * contains the entire shape.
+ */
+template<typename ShapeType>
+scalar shape_bounding_radius(const ShapeType &shape) {
+    auto aabb = shape_aabb(shape, vector3_zero, quaternion_identity);
+    return length(max(abs(aabb.min), abs(aabb.max)));
+}
+
+/**
+ * @brief Whether collision detection for a shape can be performed at any
+ * orientation. Polyhedrons and compounds rely on vertices rotated to the
+ * current orientation, thus their rotation is ignored when advancing.
+ */
+template<typename ShapeType>
+constexpr bool toi_rotates_v =
+    !std::is_same_v<ShapeType, polyhedron_shape> &&
+    !std::is_same_v<ShapeType, compound_shape>;
+
+/**
+ * @brief Upper bound of the speed at which any point of two moving shapes
+ * approach one another.
+ */
+template<typename ShapeA, typename ShapeB>
+scalar toi_max_relative_speed(const ShapeA &shA, const toi_body &a,
+                              const ShapeB &shB, const toi_body &b) {
+    auto speed = length(a.linvel - b.linvel);
+
+    if constexpr(toi_rotates_v<ShapeA>) {
+        auto angspd = length(a.angvel);
+
+        if (angspd > EDYN_EPSILON) {
+            speed += angspd * shape_bounding_radius(shA);
+        }
+    }
+
+    if constexpr(toi_rotates_v<ShapeB>) {
+        auto angspd = length(b.angvel);
+
+        if (angspd > EDYN_EPSILON) {
+            speed += angspd * shape_bounding_radius(shB);
+        }
+    }
+
+    return speed;
+}
+
+/**
+ * @brief Finds the time at which two moving shapes first come within
+ * `tolerance` of each other using conservative advancement. At each iteration
+ * the distance between the shapes is calculated with `collide` and both are
+ * advanced by the longest time during which they certainly can't touch,
+ * i.e. the distance divided by an upper bound of the approach speed.
+ * Reference: Brian Mirtich, Impulse-based Dynamic Simulation of Rigid Body
+ * Systems, section 2.3.2.
+ * @param shA Shape of first body.
+ * @param a State of first body.
+ * @param shB Shape of second body.
+ * @param b State of second body.
+ * @param dt Length of the time interval.
+ * @param tolerance Distance at which the shapes are considered to be touching.
+ * @param result Collision points at the time of impact with pivots in object
+ * space, as returned by `collide` for the advanced poses.
+ * @return Time of impact in [0, dt], or a value greater than `dt` if the shapes
+ * don't touch within the interval, in which case `result` is empty.
+ */
+template<typename ShapeA, typename ShapeB>
+scalar time_of_impact(const ShapeA &shA, const toi_body &a,
+                      const ShapeB &shB, const toi_body &b,
+                      scalar dt, scalar tolerance, collision_result &result) {
+    constexpr auto max_iterations = 20;
+    auto max_speed = toi_max_relative_speed(shA, a, shB, b);
+    auto threshold = max_speed * dt + tolerance;
+    auto time = scalar(0);
+
+    for (auto i = 0; i < max_iterations; ++i) {
+        auto ctx = collision_context{};
+        ctx.posA = a.origin + a.linvel * time;
+        ctx.ornA = a.orn;
+        ctx.aabbA = {a.aabb.min + a.linvel * time, a.aabb.max + a.linvel * time};
+        ctx.posB = b.origin + b.linvel * time;
+        ctx.ornB = b.orn;
+        ctx.aabbB = {b.aabb.min + b.linvel * time, b.aabb.max + b.linvel * time};
+        ctx.threshold = threshold;
+
+        if constexpr(toi_rotates_v<ShapeA>) {
+            ctx.ornA = integrate(a.orn, a.angvel, time);
+        }
+
+        if constexpr(toi_rotates_v<ShapeB>) {
+            ctx.ornB = integrate(b.orn, b.angvel, time);
+        }
+
+        result.num_points = 0;
+        collide(shA, shB, ctx, result);
+
+        // Farther apart than they can travel in the interval.
+        if (result.num_points == 0) {
+            return large_scalar;
+        }
+
+        auto distance = result.point[0].distance;
+        auto normal = result.point[0].normal;
+
+        for (size_t j = 1; j < result.num_points; ++j) {
+            if (result.point[j].distance < distance) {
+                distance = result.point[j].distance;
+                normal = result.point[j].normal;
+            }
+        }
+
+        if (distance <= tolerance) {
+            return time;
+        }
+
+        // The normal points towards A, thus the shapes approach along the
+        // normal if the relative linear velocity points against it.
+        auto approach_speed = max_speed - length(a.linvel - b.linvel) - dot(a.linvel - b.linvel, normal);
+
+        if (approach_speed <= EDYN_EPSILON) {
+            result.num_points = 0;
+            return large_scalar;
+        }
+
+        time += distance / approach_speed;
+
+        if (time > dt) {
+            result.num_points = 0;
+            return large_scalar;
+        }
+    }
+
+    // Did not converge, which happens when the shapes approach very slowly.
+    // Consider the last iteration to be the impact.
+    return time;
+}
+
+}
+
+#endif // EDYN_COLLISION_TIME_OF_IMPACT_HPP
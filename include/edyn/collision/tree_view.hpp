@@ -2,6 +2,7 @@
 #define EDYN_COLLISION_TREE_VIEW_HPP
 
 #include <vector>
+#include <memory>
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/entity.hpp>
 #include "edyn/collision/tree_node.hpp"
@@ -14,7 +15,9 @@ namespace edyn {
  * @brief View of a tree.
  *
  * Can be used to take a snapshot of a `dynamic_tree` and share it with other
- * parts of the application.
+ * parts of the application. The nodes are immutable and reference counted,
+ * thus copying a `tree_view` does not copy the nodes, which allows island
+ * workers to publish their trees to the coordinator without copies.
  */
 class tree_view {
 public:
@@ -30,6 +33,8 @@ public:
         }
     };
 
+    using node_vector = std::vector<tree_node>;
+
     /**
      * @brief Creates an empty tree view.
      */
@@ -42,8 +47,19 @@ public:
      * @param nodes All tree nodes.
      * @param root_id The id of the root node in the vector of nodes.
      */
-    tree_view(const std::vector<tree_node> &nodes, tree_node_id_t root_id)
-        : m_nodes(nodes)
+    tree_view(node_vector nodes, tree_node_id_t root_id)
+        : m_nodes(std::make_shared<const node_vector>(std::move(nodes)))
+        , m_root(root_id)
+    {}
+
+    /**
+     * @brief Initializes a `tree_view` which shares the given nodes. They
+     * must not be modified while any view refers to them.
+     * @param nodes All tree nodes.
+     * @param root_id The id of the root node in the vector of nodes.
+     */
+    tree_view(std::shared_ptr<const node_vector> nodes, tree_node_id_t root_id)
+        : m_nodes(std::move(nodes))
         , m_root(root_id)
     {}
 
@@ -68,16 +84,12 @@ public:
     template<typename Func>
     void each(Func func) const;
 
-    /*! @copydoc each */
-    template<typename Func>
-    void each(Func func);
-
     /**
      * @brief Returns a reference to the tree node for the give id.
      * @return Reference to the node for the requested node id.
      */
     const tree_node & get_node(tree_node_id_t id) const {
-        return m_nodes[id];
+        return (*m_nodes)[id];
     }
 
     /**
@@ -95,7 +107,7 @@ public:
      */
     AABB root_aabb() const {
         if (m_root != null_tree_node_id) {
-            return m_nodes[m_root].aabb;
+            return (*m_nodes)[m_root].aabb;
         }
 
         return {vector3_zero, vector3_zero};
@@ -111,7 +123,7 @@ public:
      * @return Approximate number of nodes in the tree.
      */
     size_t size() const {
-        return m_nodes.size();
+        return m_nodes ? m_nodes->size() : 0;
     }
 
     /**
@@ -120,13 +132,26 @@ public:
      */
     size_t count_leaves() const {
         size_t count = 0;
-        for (auto &node : m_nodes) {
+        if (!m_nodes) {
+            return count;
+        }
+        for (auto &node : *m_nodes) {
             count += static_cast<size_t>(node.leaf());
         }
         return count;
     }
 
-    std::vector<tree_node> m_nodes;
+    /**
+     * @brief Returns the shared array of nodes, which is null if the view
+     * is empty.
+     * @return Shared pointer to the nodes.
+     */
+    const std::shared_ptr<const node_vector> & nodes() const {
+        return m_nodes;
+    }
+
+private:
+    std::shared_ptr<const node_vector> m_nodes;
     tree_node_id_t m_root;
 };
 
@@ -137,16 +162,11 @@ void tree_view::query(const AABB &aabb, Func func) const {
 
 template<typename Func>
 void tree_view::each(Func func) const {
-    for (const auto &node : m_nodes) {
-        if (node.entity != entt::null) {
-            func(node);
-        }
+    if (!m_nodes) {
+        return;
     }
-}
 
-template<typename Func>
-void tree_view::each(Func func) {
-    for (auto &node : m_nodes) {
+    for (const auto &node : *m_nodes) {
         if (node.entity != entt::null) {
             func(node);
         }
@@ -67,6 +67,7 @@ using shared_components_t = decltype(std::tuple_cat(std::tuple<
     shape_index,
     rigidbody_tag,
     rolling_tag,
+    ccd_tag,
     roll_direction,
     tree_view,
     discontinuity
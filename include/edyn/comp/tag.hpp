@@ -71,6 +71,21 @@ struct rolling_tag {};
  */
 struct external_tag {};
 
+/**
+ * A rigid body with continuous collision detection enabled. Its AABB is
+ * expanded to enclose its motion during the next step and speculative
+ * contacts are created at the time of impact, which prevents fast moving
+ * bodies from tunneling through others.
+ */
+struct ccd_tag {};
+
+/**
+ * An entity whose AABB changed since the last broad-phase update. Assigned by
+ * `edyn::update_aabbs` and removed by the broad-phase, which only moves and
+ * queries these entities in its trees.
+ */
+struct aabb_changed_tag {};
+
 }
 
 #endif // EDYN_COMP_TAG_HPP
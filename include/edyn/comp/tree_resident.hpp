@@ -1,6 +1,7 @@
 #ifndef EDYN_COMP_TREE_RESIDENT_HPP
 #define EDYN_COMP_TREE_RESIDENT_HPP
 
+#include "edyn/comp/aabb.hpp"
 #include "edyn/collision/tree_node.hpp"
 
 namespace edyn {
@@ -8,6 +9,15 @@ namespace edyn {
 struct tree_resident {
     tree_node_id_t id;
     bool procedural;
+
+    // AABB of the entity when it was last used to query the trees for new
+    // pairs. Used by the island broad-phase to skip queries for entities that
+    // have barely moved since.
+    AABB query_aabb {};
+
+    // Whether the entity must be queried in the next update regardless of
+    // how much it moved.
+    bool requery {true};
 };
 
 }
@@ -66,6 +66,15 @@ inline constexpr auto contact_position_correction_rate = scalar(0.2);
  */
 inline constexpr auto contact_position_solver_min_error = scalar(-0.005);
 
+/**
+ * The separating axis found in the last collision test between two
+ * polyhedrons is reused without searching again if the position and
+ * orientation of one relative to the other changed by less than these
+ * values since then. Angular tolerance is in radians.
+ */
+inline constexpr auto separating_axis_linear_tolerance = scalar(0.002);
+inline constexpr auto separating_axis_angular_tolerance = scalar(0.005);
+
 }
 
 #endif // EDYN_CONFIG_CONSTANTS_HPP
@@ -18,6 +18,36 @@ std::unique_ptr<registry_operation_builder> make_reg_op_builder_default();
 using should_collide_func_t = decltype(&should_collide_default);
 
 struct component_index_source;
+class step_profiler;
+
+/**
+ * @brief Defines how constraint rows are traversed in each velocity iteration
+ * of the constraint solver.
+ */
+enum class constraint_solver_mode {
+    // Rows are solved one at a time in the order they were created.
+    sequential,
+    // Rows are grouped by graph color into structure-of-arrays batches and
+    // multiple independent rows are solved at once using SIMD instructions.
+    batched,
+    // Same as `batched` with the batches of each color being distributed
+    // among worker threads, which lets a single large island make use of
+    // multiple cores.
+    parallel
+};
+
+/**
+ * @brief Defines how the broad-phase finds pairs of bodies with intersecting
+ * AABBs. Both produce the same set of pairs.
+ */
+enum class broadphase_backend {
+    // Each body queries a dynamic AABB tree. Performs well in most scenes,
+    // especially with many bodies at rest or far apart.
+    dynamic_tree,
+    // Incremental sweep-and-prune over AABBs sorted along one axis. Usually
+    // faster in dense scenes with thousands of small moving bodies.
+    sweep_and_prune
+};
 
 struct settings {
     scalar fixed_dt {scalar(1.0 / 60)};
@@ -28,6 +58,24 @@ struct settings {
     unsigned num_solver_position_iterations {3};
     unsigned num_restitution_iterations {8};
     unsigned num_individual_restitution_iterations {3};
+    constraint_solver_mode solver_mode {constraint_solver_mode::sequential};
+    broadphase_backend broadphase {broadphase_backend::dynamic_tree};
+
+    // Pairs of polyhedrons where either one has at least this many vertices
+    // are tested with GJK and EPA instead of the separating axis test, whose
+    // cost grows with the product of the number of edges of both.
+    unsigned polyhedron_gjk_epa_min_vertices {64};
+
+    // Calculate AABBs of boxes, spheres, capsules and cylinders in SIMD
+    // batches. Otherwise they're calculated one at a time with `shape_aabb`.
+    bool batched_aabb_update {true};
+
+    // Submeshes of paged triangle meshes in the path of moving dynamic bodies
+    // are requested this many seconds ahead of contact. Zero disables it.
+    scalar paged_mesh_prefetch_horizon {scalar(0.5)};
+    // Maximum number of submesh loads in flight per paged triangle mesh for
+    // prefetching to start a new one.
+    unsigned paged_mesh_max_prefetch_loads {4};
 
     make_reg_op_builder_func_t make_reg_op_builder {&make_reg_op_builder_default};
     std::shared_ptr<component_index_source> index_source;
@@ -36,6 +84,9 @@ struct settings {
     external_system_func_t external_system_post_step {nullptr};
     should_collide_func_t should_collide_func {&should_collide_default};
 
+    // Receives timing samples of each simulation stage if set.
+    std::shared_ptr<step_profiler> profiler;
+
     using clear_actions_func_t = void(entt::registry &);
     clear_actions_func_t *clear_actions_func {nullptr};
 
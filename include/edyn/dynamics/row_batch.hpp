@@ -0,0 +1,147 @@
+#ifndef EDYN_DYNAMICS_ROW_BATCH_HPP
+#define EDYN_DYNAMICS_ROW_BATCH_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+struct row_cache;
+struct constraint_row;
+class job_dispatcher;
+struct delta_linvel;
+struct delta_angvel;
+
+/**
+ * Width in bytes of the vector registers of the target, i.e. 16 for SSE and
+ * NEON and 32 for AVX.
+ */
+#if defined(__AVX__)
+inline constexpr size_t row_batch_alignment = 32;
+#else
+inline constexpr size_t row_batch_alignment = 16;
+#endif
+
+/**
+ * Number of constraint rows solved simultaneously in a batch, which is the
+ * number of scalars that fit in a vector register.
+ */
+inline constexpr size_t row_batch_size = row_batch_alignment / sizeof(scalar);
+
+/**
+ * Maximum number of colors assigned to rows. Rows that cannot be assigned any
+ * color are solved one by one after all batches.
+ */
+inline constexpr size_t max_row_colors = 64;
+
+/**
+ * Minimum number of batches a color must have for it to be split among
+ * workers when solving in parallel. Smaller colors are solved in the calling
+ * thread since the dispatch overhead would be greater than the gains.
+ */
+inline constexpr size_t min_parallel_row_batches = 32;
+
+/**
+ * @brief A group of constraint rows laid out as structure-of-arrays, where
+ * each array element is a lane. No two rows in a batch act on the same
+ * dynamic rigid body, thus all lanes can be solved at once. The loops over
+ * lanes are written such that the compiler is able to pack them into single
+ * vector instructions.
+ */
+struct alignas(row_batch_alignment) row_batch {
+    // Jacobian diagonals, indexed by element, axis and lane.
+    scalar J[4][3][row_batch_size];
+
+    // Jacobian diagonals multiplied by the inverse mass or inverse inertia of
+    // the respective rigid body, i.e. the change in velocity per unit of
+    // impulse.
+    scalar MJ[4][3][row_batch_size];
+
+    // Effective mass (J M^-1 J^T)^-1.
+    scalar eff_mass[row_batch_size];
+
+    // Right hand side Jv + bias.
+    scalar rhs[row_batch_size];
+
+    // Index of the original row in `row_cache::rows` for each lane. Limits
+    // and impulses are kept in the original rows since they can change in
+    // between iterations.
+    size_t row_index[row_batch_size];
+
+    // Delta velocities of the rigid bodies in each lane. Null for bodies that
+    // are not affected by impulses, i.e. static and kinematic bodies.
+    delta_linvel *dvA[row_batch_size];
+    delta_angvel *dwA[row_batch_size];
+    delta_linvel *dvB[row_batch_size];
+    delta_angvel *dwB[row_batch_size];
+};
+
+/**
+ * @brief Constraint rows of a `row_cache` grouped by graph color into batches.
+ */
+struct row_batch_cache {
+    void clear();
+
+    std::vector<row_batch> batches;
+
+    // Index of the first batch of each color in `batches` followed by the
+    // number of batches. Batches of different colors can share bodies and
+    // must be solved one color after the other. Batches of the same color
+    // share no bodies and can be solved in any order.
+    std::vector<size_t> color_offsets;
+
+    // Indices of rows which could not fill a complete batch or could not be
+    // assigned a color. These are solved one by one after all batches.
+    std::vector<size_t> remainder_rows;
+
+    // Scratch data used during coloring. Kept here to reuse memory.
+    std::vector<std::vector<size_t>> color_rows;
+    std::unordered_map<const delta_linvel *, uint64_t> body_colors;
+};
+
+/**
+ * @brief Colors the rows in the cache such that no two rows of the same
+ * color act on the same dynamic rigid body and packs each color into
+ * batches. Must be called after the rows are prepared and before the
+ * velocity iterations.
+ * @param cache Prepared constraint rows.
+ * @param batch_cache Batch cache to be filled.
+ */
+void make_row_batches(const row_cache &cache, row_batch_cache &batch_cache);
+
+/**
+ * @brief Solves all rows in a batch simultaneously and applies the resulting
+ * impulses to the delta velocities of the rigid bodies.
+ * @param batch The batch to be solved.
+ * @param cache Row cache which contains the limits and impulses of the rows.
+ */
+void solve_row_batch(const row_batch &batch, row_cache &cache);
+
+/**
+ * @brief Solves all batches one color at a time, followed by the remainder
+ * rows, i.e. one Gauss-Seidel iteration over all rows.
+ * @param batch_cache Batches created by `make_row_batches`.
+ * @param cache Row cache which contains the limits and impulses of the rows.
+ */
+void solve_row_batches(const row_batch_cache &batch_cache, row_cache &cache);
+
+/**
+ * @brief Solves all batches one color at a time, splitting the batches of
+ * each color among the workers of a job dispatcher, followed by the remainder
+ * rows which are solved in the calling thread. Since batches of the same
+ * color do not share bodies, the result is the same as `solve_row_batches`
+ * regardless of how the work is distributed.
+ * @param dispatcher Job dispatcher where the parallel jobs will be run.
+ * @param batch_cache Batches created by `make_row_batches`.
+ * @param cache Row cache which contains the limits and impulses of the rows.
+ */
+void solve_row_batches_parallel(job_dispatcher &dispatcher,
+                                const row_batch_cache &batch_cache,
+                                row_cache &cache);
+
+}
+
+#endif // EDYN_DYNAMICS_ROW_BATCH_HPP
@@ -5,6 +5,7 @@
 #include <entt/entity/fwd.hpp>
 #include "edyn/math/scalar.hpp"
 #include "edyn/dynamics/row_cache.hpp"
+#include "edyn/dynamics/row_batch.hpp"
 
 namespace edyn {
 
@@ -17,9 +18,17 @@ public:
 
     void update(scalar dt);
 
+    /**
+     * @brief Number of constraint rows solved in the last update.
+     */
+    size_t num_rows() const {
+        return m_row_cache.rows.size();
+    }
+
 private:
     entt::registry *m_registry;
     row_cache m_row_cache;
+    row_batch_cache m_row_batch_cache;
 };
 
 }
@@ -40,6 +40,7 @@
 #include "collision/contact_manifold_map.hpp"
 #include "context/settings.hpp"
 #include "collision/raycast.hpp"
+#include "util/step_profiler.hpp"
 #include <entt/entity/registry.hpp>
 
 namespace edyn {
@@ -434,6 +435,115 @@ unsigned get_solver_individual_restitution_iterations(const entt::registry &regi
  */
 void set_solver_individual_restitution_iterations(entt::registry &registry, unsigned iterations);
 
+/**
+ * @brief Get the mode used to solve constraint rows.
+ * @param registry Data source.
+ * @return Constraint solver mode.
+ */
+constraint_solver_mode get_solver_mode(const entt::registry &registry);
+
+/**
+ * @brief Set the mode used to solve constraint rows. In batched mode, rows
+ * that do not share any rigid body are solved simultaneously in SIMD lanes,
+ * which speeds up large islands at the cost of solving the rows in a
+ * different order. In parallel mode, batches are also distributed among
+ * worker threads, which allows a single large island to use multiple cores.
+ * @param registry Data source.
+ * @param mode Constraint solver mode.
+ */
+void set_solver_mode(entt::registry &registry, constraint_solver_mode mode);
+
+/**
+ * @brief Get the broad-phase collision detection backend.
+ * @param registry Data source.
+ * @return Broad-phase backend.
+ */
+broadphase_backend get_broadphase_backend(const entt::registry &registry);
+
+/**
+ * @brief Set the broad-phase collision detection backend. Both backends find
+ * the same set of pairs. Sweep-and-prune is usually faster in scenes with many
+ * moving bodies, where refitting the dynamic tree is costly.
+ * @param registry Data source.
+ * @param backend Broad-phase backend.
+ */
+void set_broadphase_backend(entt::registry &registry, broadphase_backend backend);
+
+/**
+ * @brief Configure prefetching of paged triangle mesh submeshes. The AABB of
+ * each moving dynamic body is swept along its velocity over a time horizon
+ * and the submeshes it intersects are loaded ahead of contact.
+ * @param registry Data source.
+ * @param horizon Time in seconds to look ahead. Zero disables prefetching.
+ * @param max_pending_loads Maximum number of submesh loads in flight per
+ * paged triangle mesh for prefetching to start another.
+ */
+void set_paged_mesh_prefetch(entt::registry &registry, scalar horizon, unsigned max_pending_loads);
+
+/**
+ * @brief Get the minimum number of vertices of a polyhedron for collisions
+ * with other polyhedrons to be tested using GJK and EPA.
+ * @param registry Data source.
+ * @return Minimum number of vertices.
+ */
+unsigned get_polyhedron_gjk_epa_min_vertices(const entt::registry &registry);
+
+/**
+ * @brief Set the minimum number of vertices of a polyhedron for collisions
+ * with other polyhedrons to be tested using GJK and EPA instead of the
+ * separating axis test, which is faster for simple shapes such as boxes but
+ * becomes expensive as the number of edges grows. Only affects contact
+ * manifolds created afterwards.
+ * @param registry Data source.
+ * @param min_vertices Minimum number of vertices.
+ */
+void set_polyhedron_gjk_epa_min_vertices(entt::registry &registry, unsigned min_vertices);
+
+/**
+ * @brief Enable or disable the calculation of AABBs of boxes, spheres,
+ * capsules and cylinders in SIMD batches. When disabled, AABBs are calculated
+ * one at a time, which gives the same results.
+ * @param registry Data source.
+ * @param enabled Whether AABBs should be calculated in batches.
+ */
+void set_batched_aabb_update_enabled(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Check whether AABBs are calculated in SIMD batches.
+ * @param registry Data source.
+ * @return Whether AABBs are calculated in batches.
+ */
+bool is_batched_aabb_update_enabled(const entt::registry &registry);
+
+/**
+ * @brief Enable or disable the step profiler. When enabled, island workers
+ * and the island coordinator record the duration of each stage of the
+ * simulation step, which can be obtained with `consume_profile_samples`.
+ * Disabling the profiler discards all samples not yet consumed.
+ * @param registry Data source.
+ * @param enabled Whether profiling should be enabled.
+ * @param capacity Maximum number of samples kept until they're consumed.
+ * Samples recorded when full are dropped.
+ */
+void set_profiling_enabled(entt::registry &registry, bool enabled, size_t capacity = 16384);
+
+/**
+ * @brief Check whether the step profiler is enabled.
+ * @param registry Data source.
+ * @return Whether profiling is enabled.
+ */
+bool is_profiling_enabled(const entt::registry &registry);
+
+/**
+ * @brief Move all profile samples recorded since the last call into a vector.
+ * Samples of different islands are recorded concurrently, thus they're not
+ * sorted by time. They can be written to a file with `write_chrome_trace`.
+ * @param registry Data source.
+ * @param samples Samples are appended to this vector.
+ * @return Number of samples appended.
+ */
+size_t consume_profile_samples(entt::registry &registry, std::vector<profile_sample> &samples);
+
 /**
  * @brief Use the provided material when two rigid bodies with the given
  * material ids collide.
@@ -16,7 +16,8 @@ struct aabb_of_interest {
     // The AABB of interest.
     AABB aabb {vector3_one * -500, vector3_one * 500};
 
-    // Islands whose AABB intersects this AABB of interest.
+    // Islands whose AABB intersects this AABB of interest. It's maintained by
+    // the `aabb_of_interest_manager`.
     entt::sparse_set island_entities {};
 
     // Entities in the islands above, including nodes and edges. This is used
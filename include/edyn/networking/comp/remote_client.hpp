@@ -2,10 +2,13 @@
 #define EDYN_NETWORKING_REMOTE_CLIENT_HPP
 
 #include <vector>
+#include <unordered_map>
 #include <entt/entity/fwd.hpp>
 #include "edyn/util/entity_map.hpp"
 #include "edyn/networking/packet/edyn_packet.hpp"
 #include "edyn/networking/util/clock_sync.hpp"
+#include "edyn/networking/util/snapshot_encoding.hpp"
+#include "edyn/networking/util/snapshot_scheduling.hpp"
 
 namespace edyn {
 
@@ -39,6 +42,20 @@ struct remote_client {
     // Rate of registry snapshots, i.e. registry snapshots sent per second.
     double snapshot_rate {10};
 
+    // Sequence number of the last encoded registry snapshot that was sent.
+    uint32_t snapshot_sequence {0};
+
+    // Sequence number of the latest registry snapshot acknowledged by the
+    // client, which is used as baseline to encode the next snapshots.
+    uint32_t acked_snapshot_sequence {0};
+
+    // Values in the registry snapshots recently sent.
+    snapshot_baseline_history snapshot_baselines;
+
+    // Entities which were left out of the previous registry snapshots due to
+    // the byte budget, with their accumulated priority and components.
+    deferred_snapshot_entity_map deferred_snapshot_entities;
+
     // Whether this client will be given temporary ownership of all entities in
     // the island where entities owned by it reside, thus allowing the state of
     // those entities to be set by the client.
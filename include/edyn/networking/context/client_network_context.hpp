@@ -6,6 +6,7 @@
 #include "edyn/networking/util/client_snapshot_importer.hpp"
 #include "edyn/networking/util/client_snapshot_exporter.hpp"
 #include "edyn/networking/util/clock_sync.hpp"
+#include "edyn/networking/util/snapshot_encoding.hpp"
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/entity.hpp>
 #include <entt/entity/sparse_set.hpp>
@@ -70,6 +71,10 @@ struct client_network_context {
     std::shared_ptr<client_snapshot_exporter> snapshot_exporter;
 
     clock_sync_data clock_sync;
+
+    // Values in the registry snapshots recently received, used to decode
+    // registry snapshots encoded relative to them.
+    snapshot_baseline_history snapshot_baselines;
 };
 
 }
@@ -11,6 +11,7 @@
 #include "edyn/networking/packet/time_response.hpp"
 #include "edyn/networking/packet/server_settings.hpp"
 #include "edyn/networking/packet/set_aabb_of_interest.hpp"
+#include "edyn/networking/packet/snapshot_ack.hpp"
 #include <variant>
 
 namespace edyn::packet {
@@ -31,7 +32,8 @@ struct edyn_packet {
         time_request,
         time_response,
         server_settings,
-        set_aabb_of_interest
+        set_aabb_of_interest,
+        snapshot_ack
     > var;
 };
 
@@ -45,7 +47,8 @@ using timed_packets_tuple_t = std::tuple<
 using unreliable_packets_tuple_t = std::tuple<
     packet::registry_snapshot,
     packet::time_request,
-    packet::time_response
+    packet::time_response,
+    packet::snapshot_ack
 >;
 
 template<typename Archive>
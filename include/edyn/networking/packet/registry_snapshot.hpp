@@ -1,6 +1,7 @@
 #ifndef EDYN_NETWORKING_UTIL_REGISTRY_SNAPSHOT_HPP
 #define EDYN_NETWORKING_UTIL_REGISTRY_SNAPSHOT_HPP
 
+#include <cstdint>
 #include <vector>
 #include "edyn/util/entity_map.hpp"
 #include "edyn/util/tuple_util.hpp"
@@ -15,12 +16,26 @@ namespace edyn::packet {
  * the array of entities and, if the component type is not empty, it also
  * contains an array of components in a 1-to-1 relationship with the entity
  * index array.
+ *
+ * Snapshots sent from server to client can be encoded, in which case the pools
+ * of transforms and velocities are bit-packed into `quantized_pools`, possibly
+ * as the difference relative to a previous snapshot, the baseline. See
+ * `encode_registry_snapshot`.
  */
 struct registry_snapshot {
     double timestamp;
     std::vector<entt::entity> entities;
     std::vector<pool_snapshot> pools;
 
+    // Sequence number of an encoded snapshot. Zero if not encoded.
+    uint32_t sequence {0};
+
+    // Sequence number of the snapshot used as baseline. Zero if none.
+    uint32_t baseline_sequence {0};
+
+    // Bit-packed quantized pools.
+    std::vector<uint8_t> quantized_pools;
+
     void convert_remloc(const entt::registry &registry, const entity_map &emap) {
         for (auto &entity : entities) {
             entity = emap.at(entity);
@@ -37,6 +52,12 @@ void serialize(Archive &archive, registry_snapshot &snapshot) {
     archive(snapshot.timestamp);
     archive(snapshot.entities);
     archive(snapshot.pools);
+    archive(snapshot.sequence);
+
+    if (snapshot.sequence != 0) {
+        archive(snapshot.baseline_sequence);
+        archive(snapshot.quantized_pools);
+    }
 }
 
 }
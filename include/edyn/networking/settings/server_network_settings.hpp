@@ -1,6 +1,9 @@
 #ifndef EDYN_NETWORKING_SETTINGS_SERVER_NETWORK_SETTINGS_HPP
 #define EDYN_NETWORKING_SETTINGS_SERVER_NETWORK_SETTINGS_HPP
 
+#include <cstdint>
+#include "edyn/math/scalar.hpp"
+
 namespace edyn {
 
 struct server_network_settings {
@@ -15,6 +18,46 @@ struct server_network_settings {
     // longer be delayed, they'll be applied immediately instead, which can lead
     // to jitter.
     double max_playout_delay {2};
+
+    // Whether to quantize transforms and velocities in registry snapshots sent
+    // to clients and encode them as the difference relative to the latest
+    // snapshot acknowledged by each client.
+    bool snapshot_encoding_enabled {true};
+
+    // Number of bits per position coordinate. Positions are quantized relative
+    // to the AABB of interest of the client.
+    uint8_t snapshot_position_bits {20};
+
+    // Number of bits for each of the three smallest components of orientation
+    // quaternions.
+    uint8_t snapshot_orientation_bits {12};
+
+    // Number of bits per velocity coordinate and the range of velocities which
+    // are quantized. Greater velocities are sent at full precision.
+    uint8_t snapshot_velocity_bits {14};
+    scalar snapshot_max_linear_velocity {64};
+    scalar snapshot_max_angular_velocity {32};
+
+    // Islands and static entities leave the AABB of interest of a client only
+    // once they're farther than this distance away from it, which prevents
+    // entities near the boundary from being repeatedly created and destroyed
+    // in the client.
+    scalar aabb_of_interest_margin {1};
+
+    // Approximate maximum size in bytes of the component data in each
+    // registry snapshot sent to a client. Entities which do not fit are
+    // deferred to later snapshots, in order of priority. Zero means unlimited.
+    unsigned snapshot_byte_budget {0};
+
+    // Weights of the priority of entities in registry snapshots, which is
+    // accumulated in every snapshot where an entity is deferred. The priority
+    // is divided by `1 + d / snapshot_priority_distance` where `d` is the
+    // distance to the closest entity owned by the client, multiplied by
+    // `1 + v * snapshot_priority_velocity` where `v` is its speed and
+    // multiplied by `snapshot_priority_owned` if owned by the client.
+    scalar snapshot_priority_distance {10};
+    scalar snapshot_priority_velocity {0.1};
+    scalar snapshot_priority_owned {4};
 };
 
 }
@@ -0,0 +1,94 @@
+#ifndef EDYN_NETWORKING_UTIL_AABB_OF_INTEREST_MANAGER_HPP
+#define EDYN_NETWORKING_UTIL_AABB_OF_INTEREST_MANAGER_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/sparse_set.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/collision/dynamic_tree.hpp"
+
+namespace edyn {
+
+struct aabb_of_interest;
+
+/**
+ * @brief Keeps track of the entities contained in the AABB of interest of each
+ * client incrementally. The AABBs of interest are kept in a dynamic tree which
+ * is queried with the AABBs of islands that moved and, conversely, islands are
+ * queried with the AABBs of interest that moved. The entities of each island
+ * are collected only when its nodes, edges or the owners of its entities
+ * change. The owner of an entity must be changed via `emplace`, `replace` or
+ * `patch` for it to be noticed. Entities are reference counted per client
+ * since they can be reached via multiple islands.
+ */
+class aabb_of_interest_manager {
+    struct island_info {
+        // Last known AABB of the island.
+        AABB aabb;
+        bool has_aabb {false};
+
+        // Nodes, edges (except contact manifolds) and their owners.
+        std::vector<entt::entity> entities;
+
+        // Clients whose AABB of interest contains this island.
+        std::vector<entt::entity> client_entities;
+    };
+
+    struct client_info {
+        tree_node_id_t node_id;
+
+        // Last known AABB of interest.
+        AABB aabb;
+
+        // Number of times each entity was reached by this client.
+        std::unordered_map<entt::entity, unsigned> entity_refs;
+
+        // Non-procedural entities in the AABB of interest and their owners.
+        std::vector<entt::entity> np_entities;
+
+        // Entities whose reference count went from or to zero in this update.
+        std::vector<entt::entity> touched_entities;
+    };
+
+    void add_refs(client_info &, const std::vector<entt::entity> &);
+    void remove_refs(client_info &, const std::vector<entt::entity> &);
+    void set_interest(entt::entity island_entity, island_info &,
+                      entt::entity client_entity, client_info &,
+                      aabb_of_interest &, bool interested);
+    void update_island_clients(entt::entity island_entity, island_info &);
+    void update_client_islands(entt::entity client_entity, client_info &, aabb_of_interest &);
+    void update_client_np_entities(client_info &, const aabb_of_interest &);
+    void collect_island_entities(entt::entity island_entity, std::vector<entt::entity> &);
+    void refresh_island(entt::entity island_entity);
+    AABB expanded(const AABB &) const;
+
+public:
+    aabb_of_interest_manager(entt::registry &);
+    ~aabb_of_interest_manager();
+
+    aabb_of_interest_manager(const aabb_of_interest_manager &) = delete;
+    aabb_of_interest_manager & operator=(const aabb_of_interest_manager &) = delete;
+
+    void update();
+
+    void on_island_changed(entt::entity);
+    void on_destroy_island(entt::registry &, entt::entity);
+    void on_destroy_aabb_of_interest(entt::registry &, entt::entity);
+    void on_entity_owner_changed(entt::registry &, entt::entity);
+
+private:
+    entt::registry *m_registry;
+    dynamic_tree m_client_tree;
+    std::unordered_map<entt::entity, island_info> m_islands;
+    std::unordered_map<entt::entity, client_info> m_clients;
+    entt::sparse_set m_changed_islands;
+
+    // Islands leave an AABB of interest only after moving farther than this
+    // distance away from it, to prevent flapping.
+    scalar m_margin {0};
+};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_AABB_OF_INTEREST_MANAGER_HPP
@@ -30,12 +30,12 @@ namespace detail {
             for (auto &pair : m_data) {
                 auto remote_entity = pair.first;
 
-                if (!emap.contains(remote_entity)) {
+                auto local_entity = emap.find(remote_entity);
+
+                if (local_entity == entt::null) {
                     continue;
                 }
 
-                auto local_entity = emap.at(remote_entity);
-
                 if (!registry.valid(local_entity)) {
                     continue;
                 }
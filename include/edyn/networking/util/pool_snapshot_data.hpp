@@ -1,7 +1,9 @@
 #ifndef EDYN_NETWORKING_UTIL_POOL_SNAPSHOT_DATA_HPP
 #define EDYN_NETWORKING_UTIL_POOL_SNAPSHOT_DATA_HPP
 
+#include <cstdint>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <vector>
 #include <utility>
@@ -16,7 +18,7 @@
 namespace edyn {
 
 struct pool_snapshot_data {
-    using index_type = uint8_t;
+    using index_type = uint16_t;
     std::vector<index_type> entity_indices;
 
     virtual ~pool_snapshot_data() = default;
@@ -28,6 +30,11 @@ struct pool_snapshot_data {
                                        const entity_map &emap) = 0;
     virtual entt::id_type get_type_id() const = 0;
 
+    // Append an element of another pool of the same type, assigning it to
+    // the entity at `entity_index`.
+    virtual void insert_from(const pool_snapshot_data &other, size_t element_index,
+                             index_type entity_index) = 0;
+
     bool empty() const {
         return entity_indices.empty();
     }
@@ -47,7 +54,7 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
     }
 
     void write(memory_output_archive &archive) override {
-        index_type num_entities = static_cast<index_type>(entity_indices.size());
+        auto num_entities = static_cast<uint32_t>(entity_indices.size());
         archive(num_entities);
 
         for (auto &idx : entity_indices) {
@@ -62,8 +69,13 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
     }
 
     void read(memory_input_archive &archive) override {
-        index_type num_entities;
+        uint32_t num_entities;
         archive(num_entities);
+
+        if (archive.failed()) {
+            return;
+        }
+
         entity_indices.resize(num_entities);
 
         for (auto &idx : entity_indices) {
@@ -89,16 +101,15 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
                 auto entity_index = entity_indices[i];
                 auto remote_entity = pool_entities[entity_index];
 
-                if (emap.contains(remote_entity)) {
-                    auto local_entity = emap.at(remote_entity);
+                auto local_entity = emap.find(remote_entity);
 
-                    if (registry.valid(local_entity) && registry.all_of<Component>(local_entity)) {
-                        auto &comp = components[i];
-                        internal::map_child_entity(registry, emap, comp);
-                        registry.patch<Component>(local_entity, [&](auto &&current) {
-                            merge_component(current, comp);
-                        });
-                    }
+                if (local_entity != entt::null && registry.valid(local_entity) &&
+                    registry.all_of<Component>(local_entity)) {
+                    auto &comp = components[i];
+                    internal::map_child_entity(registry, emap, comp);
+                    registry.patch<Component>(local_entity, [&](auto &&current) {
+                        merge_component(current, comp);
+                    });
                 }
             }
         }
@@ -108,11 +119,13 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
                     const std::vector<entt::entity> &pool_entities) {
         auto view = registry.view<Component, networked_tag>();
 
-        for (index_type idx = 0; idx < pool_entities.size(); ++idx) {
+        EDYN_ASSERT(pool_entities.size() <= std::numeric_limits<index_type>::max() + size_t(1));
+
+        for (size_t idx = 0; idx < pool_entities.size(); ++idx) {
             auto entity = pool_entities[idx];
 
             if (view.contains(entity)) {
-                entity_indices.push_back(idx);
+                entity_indices.push_back(static_cast<index_type>(idx));
 
                 if constexpr(!is_empty_type) {
                     auto [comp] = view.get(entity);
@@ -134,7 +147,7 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
         EDYN_ASSERT(registry.all_of<networked_tag>(entity));
 
         auto idx = std::distance(pool_entities.begin(), found_it);
-        entity_indices.push_back(idx);
+        entity_indices.push_back(static_cast<index_type>(idx));
 
         if constexpr(!is_empty_type) {
             auto [comp] = view.get(entity);
@@ -142,6 +155,17 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
         }
     }
 
+    void insert_from(const pool_snapshot_data &other, size_t element_index,
+                     index_type entity_index) override {
+        EDYN_ASSERT(other.get_type_id() == get_type_id());
+        entity_indices.push_back(entity_index);
+
+        if constexpr(!is_empty_type) {
+            auto &typed_other = static_cast<const pool_snapshot_data_impl<Component> &>(other);
+            components.push_back(typed_other.components[element_index]);
+        }
+    }
+
     template<typename It>
     void insert(const entt::registry &registry, It first, It last,
                 const std::vector<entt::entity> &pool_entities) {
@@ -158,7 +182,7 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
             EDYN_ASSERT(registry.all_of<networked_tag>(entity));
 
             auto idx = std::distance(pool_entities.begin(), found_it);
-            entity_indices.push_back(idx);
+            entity_indices.push_back(static_cast<index_type>(idx));
 
             if constexpr(!is_empty_type) {
                 auto [comp] = view.get(entity);
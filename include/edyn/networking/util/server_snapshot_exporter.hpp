@@ -3,6 +3,11 @@
 
 #include <entt/core/type_info.hpp>
 #include <entt/entity/registry.hpp>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
 #include <type_traits>
 #include "edyn/networking/comp/entity_owner.hpp"
 #include "edyn/networking/comp/network_dirty.hpp"
@@ -14,6 +19,17 @@ namespace edyn {
 extern bool(*g_is_networked_input_component)(entt::id_type);
 extern bool(*g_is_action_list_component)(entt::id_type);
 
+/**
+ * @brief Pool of components of many entities, where the index of the entity
+ * of each element is kept separately in a wider type than
+ * `pool_snapshot_data::index_type`, thus allowing any number of entities.
+ * The `entity_indices` of the pool data are not used.
+ */
+struct indexed_pool_snapshot {
+    pool_snapshot pool;
+    std::vector<uint32_t> entity_indices;
+};
+
 class server_snapshot_exporter {
 public:
     virtual ~server_snapshot_exporter() = default;
@@ -24,6 +40,14 @@ public:
     // Write all dirty entities and components into a snapshot.
     virtual void export_dirty(const entt::registry &registry, packet::registry_snapshot &snap,
                               entt::entity dest_client_entity) = 0;
+
+    // Write the components of an entity with the type ids in the range
+    // `[first_id, last_id)` into pools, including input components, regardless
+    // of destination. The given entity index is assigned to each element.
+    virtual void export_components(const entt::registry &registry, entt::entity entity,
+                                   uint32_t entity_index, const entt::id_type *first_id,
+                                   const entt::id_type *last_id,
+                                   std::vector<indexed_pool_snapshot> &pools) = 0;
 };
 
 template<typename... Components>
@@ -38,6 +62,45 @@ class server_snapshot_exporter_impl : public server_snapshot_exporter {
             internal::snapshot_insert_entity<Components>(registry, entity, snap, ComponentIndex) : void(0)), ...);
     }
 
+    template<typename Component>
+    static void export_indexed(const entt::registry &registry, entt::entity entity,
+                               uint32_t entity_index, unsigned component_index,
+                               std::vector<indexed_pool_snapshot> &pools) {
+        auto view = registry.view<Component>();
+
+        if (!view.contains(entity)) {
+            return;
+        }
+
+        auto pool_it = std::find_if(pools.begin(), pools.end(), [component_index](auto &&pool) {
+            return pool.pool.component_index == component_index;
+        });
+
+        if (pool_it == pools.end()) {
+            auto &pool = pools.emplace_back();
+            pool.pool.component_index = component_index;
+            pool.pool.ptr.reset(new pool_snapshot_data_impl<Component>);
+            pool_it = std::prev(pools.end());
+        }
+
+        if constexpr(!std::is_empty_v<Component>) {
+            auto *typed_pool = static_cast<pool_snapshot_data_impl<Component> *>(pool_it->pool.ptr.get());
+            auto [comp] = view.get(entity);
+            typed_pool->components.push_back(comp);
+        }
+
+        pool_it->entity_indices.push_back(entity_index);
+    }
+
+    template<unsigned... ComponentIndex>
+    void export_by_type_id(const entt::registry &registry,
+                           entt::entity entity, uint32_t entity_index, entt::id_type id,
+                           std::vector<indexed_pool_snapshot> &pools,
+                           std::integer_sequence<unsigned, ComponentIndex...>) {
+        ((entt::type_index<Components>::value() == id ?
+            export_indexed<Components>(registry, entity, entity_index, ComponentIndex, pools) : void(0)), ...);
+    }
+
 public:
     server_snapshot_exporter_impl(std::tuple<Components...>) {}
 
@@ -69,6 +132,17 @@ public:
             });
         }
     }
+
+    void export_components(const entt::registry &registry, entt::entity entity,
+                           uint32_t entity_index, const entt::id_type *first_id,
+                           const entt::id_type *last_id,
+                           std::vector<indexed_pool_snapshot> &pools) override {
+        constexpr auto indices = std::make_integer_sequence<unsigned, sizeof...(Components)>{};
+
+        for (auto it = first_id; it != last_id; ++it) {
+            export_by_type_id(registry, entity, entity_index, *it, pools, indices);
+        }
+    }
 };
 
 }
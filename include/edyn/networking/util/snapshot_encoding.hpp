@@ -0,0 +1,119 @@
+#ifndef EDYN_NETWORKING_UTIL_SNAPSHOT_ENCODING_HPP
+#define EDYN_NETWORKING_UTIL_SNAPSHOT_ENCODING_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <entt/core/fwd.hpp>
+#include <entt/entity/fwd.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/math/quaternion.hpp"
+
+namespace edyn {
+
+namespace packet {
+    struct registry_snapshot;
+}
+
+/**
+ * @brief Parameters of the quantisation of transforms and velocities in
+ * registry snapshots.
+ */
+struct snapshot_quantization {
+    // Positions are encoded as fixed-point values relative to these bounds,
+    // which are usually the AABB of interest of the destination client.
+    // Positions outside of the bounds are sent at full precision.
+    AABB bounds {vector3_one * -500, vector3_one * 500};
+
+    // Number of bits per position coordinate.
+    uint8_t position_bits {20};
+
+    // Number of bits for each of the three smallest quaternion components.
+    uint8_t orientation_bits {12};
+
+    // Number of bits per velocity coordinate. Velocities greater than the
+    // maximum are sent at full precision.
+    uint8_t velocity_bits {14};
+    scalar max_linear_velocity {64};
+    scalar max_angular_velocity {32};
+};
+
+// Quantized value of a vector or quaternion. Vectors use the first three
+// elements. Quaternions are stored in the smallest-three form where the first
+// element is the index of the largest component.
+using quantized_value = std::array<uint32_t, 4>;
+
+quantized_value quantize_vector3(const vector3 &v, const vector3 &min, const vector3 &max, unsigned bits);
+vector3 dequantize_vector3(const quantized_value &value, const vector3 &min, const vector3 &max, unsigned bits);
+
+quantized_value quantize_quaternion(const quaternion &q, unsigned bits);
+quaternion dequantize_quaternion(const quantized_value &value, unsigned bits);
+
+/**
+ * @brief Number of bits taken by a component in an encoded snapshot, not
+ * including its entity index. Values are assumed to be in range and not delta
+ * encoded, which makes it an upper bound in most cases.
+ * @param type_id Type id of the component.
+ * @param quant Quantisation parameters.
+ * @return Number of bits, or zero if components of this type are not encoded.
+ */
+size_t quantized_component_bits(entt::id_type type_id, const snapshot_quantization &quant);
+
+/**
+ * @brief Quantized values sent in a registry snapshot, which can be used as
+ * the reference to encode further snapshots once the remote end acknowledges
+ * having received it.
+ */
+struct snapshot_baseline {
+    uint32_t sequence;
+
+    // Quantized position, orientation, linear and angular velocity, in this
+    // order, keyed by entity in the registry space of the sender.
+    std::array<std::unordered_map<entt::entity, quantized_value>, 4> values;
+};
+
+/**
+ * @brief The most recent baselines sent or received.
+ */
+struct snapshot_baseline_history {
+    static constexpr size_t max_size = 32;
+    std::vector<snapshot_baseline> baselines;
+
+    const snapshot_baseline * find(uint32_t sequence) const;
+    void push(snapshot_baseline &&baseline);
+};
+
+/**
+ * @brief Removes the position, orientation and velocity pools from the
+ * snapshot and bit-packs their quantized values into
+ * `registry_snapshot::quantized_pools`. Values are delta encoded against the
+ * given baseline if it's available. The quantized values are recorded as a
+ * new baseline in the history.
+ * @param snap Snapshot to be encoded.
+ * @param quant Quantisation parameters.
+ * @param history Baselines previously sent to the destination.
+ * @param sequence Sequence number of this snapshot, which must be non-zero.
+ * @param baseline_sequence Sequence number of the last snapshot acknowledged
+ * by the destination, or zero if none.
+ */
+void encode_registry_snapshot(packet::registry_snapshot &snap,
+                              const snapshot_quantization &quant,
+                              snapshot_baseline_history &history,
+                              uint32_t sequence, uint32_t baseline_sequence);
+
+/**
+ * @brief Unpacks pools encoded with `encode_registry_snapshot` back into the
+ * snapshot and records its values as a new baseline in the history.
+ * @param snap Snapshot to be decoded.
+ * @param history Baselines previously received from the source.
+ * @return Whether decoding succeeded. It fails if the data is corrupt or the
+ * baseline is not in the history.
+ */
+bool decode_registry_snapshot(packet::registry_snapshot &snap,
+                              snapshot_baseline_history &history);
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_SNAPSHOT_ENCODING_HPP
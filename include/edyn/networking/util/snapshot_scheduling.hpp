@@ -0,0 +1,61 @@
+#ifndef EDYN_NETWORKING_UTIL_SNAPSHOT_SCHEDULING_HPP
+#define EDYN_NETWORKING_UTIL_SNAPSHOT_SCHEDULING_HPP
+
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+#include <entt/core/fwd.hpp>
+#include <entt/entity/fwd.hpp>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Entity which was left out of the registry snapshots of a client due
+ * to the byte budget. Its components are kept until it is sent since they
+ * might not be marked as network dirty anymore by then.
+ */
+struct deferred_snapshot_entity {
+    // Accumulated priority.
+    scalar priority {0};
+
+    // Type ids of the components to be sent.
+    std::vector<entt::id_type> component_ids;
+};
+
+using deferred_snapshot_entity_map = std::unordered_map<entt::entity, deferred_snapshot_entity>;
+
+/**
+ * @brief Entity which can be included in a registry snapshot for a client.
+ */
+struct snapshot_candidate {
+    entt::entity entity;
+
+    // Index of the entity in the snapshot cache.
+    size_t cache_index;
+
+    // Estimated size of the entity and its components in a snapshot.
+    size_t size;
+
+    // Priority in this snapshot, not including the accumulated priority.
+    scalar priority;
+};
+
+/**
+ * @brief Selects the candidates with the highest accumulated priority which
+ * fit in the byte budget. At least one candidate is selected even if it does
+ * not fit. The candidates left out are deferred with their accumulated
+ * priority, keeping their component ids if they were already deferred. The
+ * deferred entities which are not candidates anymore are discarded.
+ * @param candidates Candidates, which are reduced to the selected ones.
+ * @param byte_budget Maximum size of the selected candidates. There is no
+ * limit if zero.
+ * @param deferred Entities deferred in previous snapshots.
+ */
+void schedule_snapshot_candidates(std::vector<snapshot_candidate> &candidates,
+                                  size_t byte_budget,
+                                  deferred_snapshot_entity_map &deferred);
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_SNAPSHOT_SCHEDULING_HPP
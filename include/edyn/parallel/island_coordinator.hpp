@@ -97,6 +97,12 @@ public:
         return entt::sink{m_contact_point_destroyed_signal};
     }
 
+    // Triggered when the nodes or edges of an island change. It can be
+    // triggered multiple times for the same island in a single update.
+    auto island_changed_sink() {
+        return entt::sink{m_island_changed_signal};
+    }
+
     template<typename Message, typename... Args>
     void send_island_message(entt::entity island_entity, Args &&... args) {
         auto &ctx = m_island_ctx_map.at(island_entity);
@@ -116,6 +122,7 @@ private:
     entt::sigh<void(entt::entity)> m_contact_ended_signal;
     entt::sigh<void(entt::entity, contact_manifold::contact_id_type)> m_contact_point_created_signal;
     entt::sigh<void(entt::entity, contact_manifold::contact_id_type)> m_contact_point_destroyed_signal;
+    entt::sigh<void(entt::entity)> m_island_changed_signal;
 
     std::vector<entt::entity> m_new_graph_nodes;
     std::vector<entt::entity> m_new_graph_edges;
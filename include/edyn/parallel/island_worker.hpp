@@ -14,6 +14,7 @@
 #include "edyn/parallel/message_queue.hpp"
 #include "edyn/parallel/entity_graph.hpp"
 #include "edyn/util/entity_map.hpp"
+#include "edyn/util/step_profiler.hpp"
 
 namespace edyn {
 
@@ -83,6 +84,9 @@ public:
     void on_construct_polyhedron_shape(entt::registry &, entt::entity);
     void on_construct_compound_shape(entt::registry &, entt::entity);
     void on_destroy_rotated_mesh_list(entt::registry &, entt::entity);
+    step_profiler * profiler() const;
+    void begin_profile_stage();
+    void end_profile_stage(profile_stage stage);
 
     void on_island_reg_ops(const msg::island_reg_ops &msg);
     void on_set_paused(const msg::set_paused &msg);
@@ -108,11 +112,14 @@ public:
 private:
     entt::registry m_registry;
     entt::entity m_island_entity;
+    entt::entity m_remote_island_entity;
     entity_map m_entity_map;
     solver m_solver;
     message_queue_in_out m_message_queue;
 
     double m_step_start_time;
+    double m_stage_start_time;
+    size_t m_last_reg_op_bytes;
     std::optional<double> m_sleep_timestamp;
 
     state m_state;
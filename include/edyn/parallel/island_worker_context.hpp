@@ -54,8 +54,9 @@ public:
     /**
      * Sends current registry operations and clears it up, making it ready for more
      * updates.
+     * @return Size of the registry operations in bytes.
      */
-    void send_reg_ops();
+    size_t send_reg_ops();
 
     /**
      * Ensures messages are delivered and processed by waking up the worker
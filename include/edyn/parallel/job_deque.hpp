@@ -0,0 +1,112 @@
+#ifndef EDYN_PARALLEL_JOB_DEQUE_HPP
+#define EDYN_PARALLEL_JOB_DEQUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "edyn/parallel/job.hpp"
+
+namespace edyn {
+
+/**
+ * Storage for one job which can be read by one thread while another thread
+ * writes to it without causing a data race. The job is copied in and out
+ * word by word using relaxed atomics, which compiles down to regular loads
+ * and stores. This is necessary in the work-stealing deque where a thief
+ * might read a slot that is concurrently being reused by the owner, in which
+ * case the value that was read is discarded.
+ */
+class atomic_job_slot {
+public:
+    static constexpr size_t num_words = sizeof(job) / sizeof(uint64_t);
+
+    void store(const job &);
+    job load() const;
+
+private:
+    std::atomic<uint64_t> m_words[num_words];
+};
+
+/**
+ * @brief Lock-free work-stealing deque of jobs. The owner thread pushes and
+ * pops jobs at the bottom while other threads steal jobs from the top. The
+ * buffer grows as needed. Old buffers are kept alive until destruction since
+ * thieves could still be reading from them.
+ *
+ * References:
+ *  - Dynamic Circular Work-Stealing Deque, David Chase and Yossi Lev, 2005
+ *  - Correct and Efficient Work-Stealing for Weak Memory Models, Nhat Minh
+ *    Lê, Antoniu Pop, Albert Cohen and Francesco Zappa Nardelli, 2013
+ */
+class job_deque {
+    class buffer {
+    public:
+        buffer(int64_t capacity);
+
+        int64_t capacity() const {
+            return m_capacity;
+        }
+
+        void put(int64_t index, const job &j) {
+            m_slots[index & m_mask].store(j);
+        }
+
+        job get(int64_t index) const {
+            return m_slots[index & m_mask].load();
+        }
+
+    private:
+        int64_t m_capacity;
+        int64_t m_mask;
+        std::unique_ptr<atomic_job_slot[]> m_slots;
+    };
+
+    buffer * grow(buffer *, int64_t bottom, int64_t top);
+
+public:
+    job_deque(int64_t initial_capacity = 1024);
+
+    job_deque(const job_deque &) = delete;
+    job_deque & operator=(const job_deque &) = delete;
+
+    /**
+     * @brief Inserts a job at the bottom. Must only be called by the owner.
+     * @param j The job.
+     */
+    void push(const job &j);
+
+    /**
+     * @brief Removes a job from the bottom. Must only be called by the owner.
+     * @param j Output job.
+     * @return Whether a job was removed.
+     */
+    bool pop(job &j);
+
+    /**
+     * @brief Removes a job from the top. Can be called from any thread.
+     * @param j Output job.
+     * @return Whether a job was stolen. Can fail spuriously if another thread
+     * takes the same job at the same time.
+     */
+    bool steal(job &j);
+
+    /**
+     * @brief Whether the deque appears to be empty. The result is only a
+     * snapshot since the deque might be modified concurrently.
+     */
+    bool empty() const;
+
+private:
+    std::atomic<int64_t> m_top;
+    std::atomic<int64_t> m_bottom;
+    std::atomic<buffer *> m_buffer;
+
+    // All buffers ever allocated, including the current one. Only accessed
+    // by the owner.
+    std::vector<std::unique_ptr<buffer>> m_buffers;
+};
+
+}
+
+#endif // EDYN_PARALLEL_JOB_DEQUE_HPP
@@ -7,8 +7,11 @@
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <condition_variable>
 #include "edyn/parallel/worker.hpp"
+#include "edyn/parallel/job_queue.hpp"
 #include "edyn/parallel/job_scheduler.hpp"
+#include "edyn/parallel/job_injection_queue.hpp"
 
 namespace edyn {
 
@@ -17,7 +20,12 @@ class job_queue;
 class job_queue_scheduler;
 
 /**
- * Manages a set of worker threads and dispatches jobs to them.
+ * Manages a set of worker threads and dispatches jobs to them. Each worker
+ * has a work-stealing deque where jobs scheduled from the worker's own thread
+ * are inserted. Jobs scheduled from other threads go into a shared injection
+ * queue. Idle workers take jobs from their own deque first, then from the
+ * injection queue and then steal from other workers, starting at a random
+ * victim. Workers sleep when there is no work anywhere.
  */
 class job_dispatcher {
 public:
@@ -34,7 +42,9 @@ public:
     bool running() const;
 
     /**
-     * Schedules a job to run asynchronously in a worker thread.
+     * Schedules a job to run asynchronously in a worker thread. If called from
+     * one of this dispatcher's workers, the job is inserted into its own deque
+     * and is likely to run in the same thread, unless another worker steals it.
      */
     void async(const job &);
 
@@ -81,8 +91,26 @@ public:
     size_t num_workers() const;
 
 private:
+    void run_worker(worker &);
+    bool try_get_job(worker &, job &);
+    bool has_pending_jobs() const;
+    void wait_for_jobs();
+    void notify_workers();
+
     std::vector<std::unique_ptr<std::thread>> m_threads;
-    std::map<std::thread::id, std::unique_ptr<worker>> m_workers;
+    std::vector<std::unique_ptr<worker>> m_workers;
+
+    // Jobs scheduled from threads which are not workers of this dispatcher.
+    job_injection_queue m_injection_queue;
+
+    std::atomic<bool> m_running {false};
+
+    // Sleeping workers and the number of notifications sent to them which
+    // have not yet been consumed.
+    std::atomic<size_t> m_num_sleeping {0};
+    size_t m_num_wakeups {0};
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
 
     // Job queue for regular threads.
     std::vector<job_queue *> m_queues;
@@ -93,8 +121,6 @@ private:
     static thread_local job_queue m_queue;
 
     job_scheduler m_scheduler;
-
-    std::atomic<size_t> m_start;
 };
 
 }
@@ -0,0 +1,63 @@
+#ifndef EDYN_PARALLEL_JOB_INJECTION_QUEUE_HPP
+#define EDYN_PARALLEL_JOB_INJECTION_QUEUE_HPP
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include "edyn/parallel/job.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Multi-producer multi-consumer queue of jobs used to feed jobs from
+ * threads that are not workers of a `job_dispatcher` into its workers. It is
+ * a bounded lock-free ring buffer where each cell has a sequence number which
+ * tells whether it is ready to be written or read. If the ring is ever full,
+ * jobs go into a mutex-protected overflow queue instead of blocking.
+ *
+ * Reference:
+ *  - Bounded MPMC queue, Dmitry Vyukov
+ *    https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+class job_injection_queue {
+    struct cell {
+        std::atomic<size_t> sequence;
+        job data;
+    };
+
+    bool try_push_ring(const job &);
+    bool try_pop_ring(job &);
+
+public:
+    job_injection_queue(size_t capacity = 4096);
+
+    job_injection_queue(const job_injection_queue &) = delete;
+    job_injection_queue & operator=(const job_injection_queue &) = delete;
+
+    void push(const job &);
+
+    bool try_pop(job &);
+
+    /**
+     * @brief Whether the queue appears to be empty. The result is only a
+     * snapshot since the queue might be modified concurrently.
+     */
+    bool empty() const;
+
+private:
+    size_t m_mask;
+    std::unique_ptr<cell[]> m_cells;
+
+    // Keep producer and consumer positions in separate cache lines.
+    alignas(64) std::atomic<size_t> m_enqueue_pos;
+    alignas(64) std::atomic<size_t> m_dequeue_pos;
+
+    std::mutex m_overflow_mutex;
+    std::deque<job> m_overflow;
+    std::atomic<size_t> m_overflow_size;
+};
+
+}
+
+#endif // EDYN_PARALLEL_JOB_INJECTION_QUEUE_HPP
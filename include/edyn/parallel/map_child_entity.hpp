@@ -21,12 +21,7 @@ void map_child_entity_meta(const entity_map &emap, const entt::meta_type &meta_t
             // If the member is an entity, assign the local value or null if
             // it's unavailable.
             auto remote_entity = data.get(entt::meta_handle(value)).cast<entt::entity>();
-            auto local_entity = entt::entity{entt::null};
-
-            if (emap.contains(remote_entity)) {
-                local_entity = emap.at(remote_entity);
-            }
-
+            auto local_entity = emap.find(remote_entity);
             data.set(entt::meta_handle(value), local_entity);
         } else if (data.type().is_sequence_container()) {
             auto seq = data.get(entt::meta_handle(value)).as_sequence_container();
@@ -2,28 +2,54 @@
 #define EDYN_PARALLEL_MESSAGE_QUEUE_HPP
 
 #include <array>
-#include <cstdint>
+#include <atomic>
+#include <memory>
 #include <mutex>
-#include <shared_mutex>
-#include <queue>
+#include <vector>
 #include <cstdint>
 #include <algorithm>
+#include <type_traits>
 #include <entt/entity/fwd.hpp>
 #include <entt/signal/fwd.hpp>
-#include <entt/core/type_info.hpp>
+#include <entt/signal/sigh.hpp>
+#include "edyn/config/config.h"
+#include "edyn/parallel/spsc_ring.hpp"
 
 namespace edyn {
 
+namespace detail {
+    inline std::atomic<size_t> message_type_counter {0};
+
+    /**
+     * Sequential index assigned to each message type on first use. Used to
+     * look up the pool of a message type in constant time.
+     */
+    template<typename Message>
+    size_t message_type_index() {
+        static const size_t index = message_type_counter.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+}
+
 /**
  * @brief A message queue intended for single-producer single-consumer usage
- * between two threads.
+ * between two threads. Messages of each type are stored in a bounded
+ * wait-free ring buffer, thus sending and receiving messages does not lock
+ * or allocate. If the ring is full, messages go into an overflow queue
+ * protected by a mutex until the consumer catches up.
  */
 class message_queue {
+    // Maximum number of distinct message types.
+    static constexpr size_t max_message_types = 64;
+
+    // Number of messages of each type that can be in flight before
+    // overflowing.
+    static constexpr size_t ring_capacity = 64;
+
     // Based on `entt::dispatcher`.
     struct basic_pool {
         virtual ~basic_pool() = default;
         virtual void publish() = 0;
-        virtual entt::id_type type_id() const = 0;
     };
 
     template<typename Message>
@@ -31,55 +57,105 @@ class message_queue {
         using signal_type = entt::sigh<void(Message &)>;
         using sink_type = typename signal_type::sink_type;
 
+        pool_handler() : m_ring(ring_capacity) {}
+
         template<typename... Args>
         void push(Args &&... args) {
-            // Expected to be called from the producer thread only.
-            auto lock = std::lock_guard(m_mutex);
+            // Expected to be called from the producer thread only. Once a
+            // message overflows, all following messages must go into the
+            // overflow queue until the consumer takes them, to preserve order.
+            if (!m_overflowed.load(std::memory_order_acquire) &&
+                m_ring.try_emplace(std::forward<Args>(args)...)) {
+                return;
+            }
+
+            auto lock = std::lock_guard(m_overflow_mutex);
             if constexpr(std::is_aggregate_v<Message>) {
-                m_messages.push_back(Message{std::forward<Args>(args)...});
+                m_overflow.push_back(Message{std::forward<Args>(args)...});
             } else {
-                m_messages.emplace_back(std::forward<Args>(args)...);
+                m_overflow.emplace_back(std::forward<Args>(args)...);
             }
+            m_overflowed.store(true, std::memory_order_release);
         }
 
         void publish() override {
             // Expected to be called from the consumer thread only.
-            auto lock = std::unique_lock(m_mutex);
-            auto messages = std::move(m_messages);
-            lock.unlock();
+            if (!m_overflowed.load(std::memory_order_acquire)) {
+                // Only publish messages which are already in the ring since
+                // the producer could be adding more concurrently.
+                for (auto count = m_ring.size(); count > 0; --count) {
+                    publish_front();
+                }
+
+                return;
+            }
+
+            // All messages in the ring are older than the messages in the
+            // overflow queue and no more messages are added to the ring until
+            // the overflow queue is taken.
+            while (m_ring.front()) {
+                publish_front();
+            }
+
+            {
+                auto lock = std::lock_guard(m_overflow_mutex);
+                // Swap instead of move to reuse the memory of both vectors.
+                m_overflow.swap(m_overflow_consumer);
+                m_overflowed.store(false, std::memory_order_release);
+            }
 
-            for (auto &msg : messages) {
+            for (auto &msg : m_overflow_consumer) {
                 m_signal.publish(msg);
             }
+
+            m_overflow_consumer.clear();
         }
 
         sink_type sink() {
             return entt::sink{m_signal};
         }
-#if defined(ENTT_NOEXCEPT)
-        entt::id_type type_id() const ENTT_NOEXCEPT override {
-            return entt::type_index<Message>::value();
-        }
-#else
-        entt::id_type type_id() const noexcept override {
-            return entt::type_index<Message>::value();
-        }
-#endif
 
     private:
-        std::mutex m_mutex;
+        void publish_front() {
+            m_signal.publish(*m_ring.front());
+            m_ring.pop();
+        }
+
         signal_type m_signal{};
-        std::vector<Message> m_messages;
+        spsc_ring<Message> m_ring;
+        std::atomic<bool> m_overflowed {false};
+        std::mutex m_overflow_mutex;
+        std::vector<Message> m_overflow;
+        std::vector<Message> m_overflow_consumer;
     };
 
     template<typename Message>
     pool_handler<Message> & assure() {
         static_assert(std::is_same_v<Message, std::decay_t<Message>>, "Invalid event type");
 
-        auto it = std::find_if(m_pools.begin(), m_pools.end(),
-            [id = entt::type_index<Message>::value()](const auto &cpool) { return id == cpool->type_id(); });
-        return static_cast<pool_handler<Message> &>(it == m_pools.cend() ?
-            *m_pools.emplace_back(new pool_handler<Message>{}) : **it);
+        // Fast path where the pool already exists.
+        auto index = detail::message_type_index<Message>();
+        EDYN_ASSERT(index < max_message_types);
+        auto *pool = m_pools_by_type[index].load(std::memory_order_acquire);
+
+        if (pool) {
+            return static_cast<pool_handler<Message> &>(*pool);
+        }
+
+        // Pools are created by either thread on first use of a message type.
+        auto lock = std::lock_guard(m_mutex);
+        pool = m_pools_by_type[index].load(std::memory_order_relaxed);
+
+        if (!pool) {
+            auto num_pools = m_num_pools.load(std::memory_order_relaxed);
+            EDYN_ASSERT(num_pools < max_message_types);
+            pool = new pool_handler<Message>{};
+            m_pools[num_pools].reset(pool);
+            m_num_pools.store(num_pools + 1, std::memory_order_release);
+            m_pools_by_type[index].store(pool, std::memory_order_release);
+        }
+
+        return static_cast<pool_handler<Message> &>(*pool);
     }
 
     template<typename Message>
@@ -98,19 +174,26 @@ class message_queue {
 
     void update() const {
         // Expected to be called from the consumer thread only.
-        auto lock = std::shared_lock(m_mutex);
-        for (auto &pool : m_pools) {
-            if (pool) {
-                pool->publish();
-            }
+        auto num_pools = m_num_pools.load(std::memory_order_acquire);
+
+        for (size_t i = 0; i < num_pools; ++i) {
+            m_pools[i]->publish();
         }
     }
 
     friend class message_queue_input;
     friend class message_queue_output;
 
-    mutable std::shared_mutex m_mutex;
-    std::vector<std::unique_ptr<basic_pool>> m_pools;
+    // Protects creation of pools.
+    std::mutex m_mutex;
+
+    // Pools in order of creation. Entries are never moved, which allows the
+    // consumer to iterate over them while the producer creates new pools.
+    std::array<std::unique_ptr<basic_pool>, max_message_types> m_pools;
+    std::atomic<size_t> m_num_pools {0};
+
+    // Pool of each message type, indexed by `detail::message_type_index`.
+    std::array<std::atomic<basic_pool *>, max_message_types> m_pools_by_type {};
 };
 
 class message_queue_input {
@@ -18,7 +18,8 @@ struct parallel_for_context {
     const IndexType last;
     const IndexType step;
     const IndexType chunk_size;
-    size_t count;
+    std::atomic<IndexType> remaining;
+    std::atomic<int> ref_counter;
     bool done;
     std::mutex mutex;
     std::condition_variable cv;
@@ -30,43 +31,43 @@ struct parallel_for_context {
         , last(last)
         , step(step)
         , chunk_size(chunk_size)
-        , count(num_jobs)
+        , remaining(last - first)
+        , ref_counter(static_cast<int>(num_jobs) + 1) // Plus one for the calling thread.
         , done(false)
         , func(func)
     {}
 
-    ~parallel_for_context() {
-        EDYN_ASSERT(count == 0);
-    }
+    void complete(IndexType progress) {
+        auto prev_remaining = remaining.fetch_sub(progress, std::memory_order_acq_rel);
+        EDYN_ASSERT(prev_remaining >= progress);
+
+        if (prev_remaining != progress) {
+            return;
+        }
 
-    void decrement() {
-        std::lock_guard lock(mutex);
-        EDYN_ASSERT(count > 0);
-        --count;
-        done = count == 0;
-
-        // Normally, `notify_one` would be called without the lock being held.
-        // However, according to
-        // https://en.cppreference.com/w/cpp/thread/condition_variable/notify_one:
-        // "Notifying while under the lock may nevertheless be necessary when precise
-        // scheduling of events is required, e.g. if the waiting thread would exit
-        // the program if the condition is satisfied, causing destruction of the
-        // notifying thread's condition_variable."
-        // If the lock would be released right here, there is a very slim chance
-        // that `wait()` would be called in the other thread right after, before
-        // `notify_one()` below, where the lock would be acquired and the predicate
-        // would test true, causing `parallel_for` to return, thus destroying this
-        // object (since it is in the stack) and then everything down from here is
-        // undefined behavior.
-        if (done) {
-            cv.notify_one();
+        {
+            std::lock_guard lock(mutex);
+            done = true;
         }
+
+        // The thread calling this function holds a reference to this context,
+        // thus it is safe to notify after the lock is released even if the
+        // waiting thread returns in between.
+        cv.notify_one();
     }
 
     void wait() {
         std::unique_lock lock(mutex);
         cv.wait(lock, [&] { return done; });
     }
+
+    // Returns whether this was the last reference, in which case the context
+    // must be deleted.
+    bool release() {
+        auto ref_count = ref_counter.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        EDYN_ASSERT(ref_count >= 0);
+        return ref_count == 0;
+    }
 };
 
 template<typename IndexType, typename Function>
@@ -83,6 +84,8 @@ void run_parallel_for(parallel_for_context<IndexType, Function> &ctx) {
         for (auto i = begin; i < end; i += ctx.step) {
             ctx.func(i);
         }
+
+        ctx.complete(end - begin);
     }
 }
 
@@ -93,9 +96,13 @@ void parallel_for_job_func(job::data_type &data) {
     archive(ctx_ptr);
     auto *ctx = reinterpret_cast<parallel_for_context<IndexType, Function> *>(ctx_ptr);
 
+    // This job could start after all the work has already been completed by
+    // other threads, in which case it does nothing.
     run_parallel_for(*ctx);
 
-    ctx->decrement();
+    if (ctx->release()) {
+        delete ctx;
+    }
 }
 
 } // namespace detail
@@ -133,14 +140,19 @@ void parallel_for(job_dispatcher &dispatcher, IndexType first, IndexType last, I
     // of workers (including this thread).
     auto num_jobs = std::min(num_workers, count - 1);
 
-    // Context that's shared among all jobs.
-    auto context = detail::parallel_for_context<IndexType, Function>(first, last, step, chunk_size, num_jobs, func);
+    // Context that's shared among all jobs. It is allocated in the heap
+    // because this function returns as soon as all elements are processed,
+    // which can happen before all background jobs have started, e.g. when
+    // called from a worker thread whose own queue holds one of these jobs.
+    // It is deallocated by whoever releases the last reference.
+    using context_type = detail::parallel_for_context<IndexType, Function>;
+    auto *context = new context_type(first, last, step, chunk_size, num_jobs, func);
 
     // Job that'll process chunks of data in worker threads.
     auto child_job = job();
     child_job.func = &detail::parallel_for_job_func<IndexType, Function>;
     auto archive = fixed_memory_output_archive(child_job.data.data(), child_job.data.size());
-    auto ctx_ptr = reinterpret_cast<intptr_t>(&context);
+    auto ctx_ptr = reinterpret_cast<intptr_t>(context);
     archive(ctx_ptr);
 
     // Dispatch background jobs.
@@ -149,10 +161,14 @@ void parallel_for(job_dispatcher &dispatcher, IndexType first, IndexType last, I
     }
 
     // Process chunks of the for loop in the current thread as well.
-    detail::run_parallel_for(context);
+    detail::run_parallel_for(*context);
 
-    // Wait all background jobs to finish.
-    context.wait();
+    // Wait for the chunks being processed in other threads to finish.
+    context->wait();
+
+    if (context->release()) {
+        delete context;
+    }
 }
 
 /**
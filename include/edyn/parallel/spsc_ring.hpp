@@ -0,0 +1,136 @@
+#ifndef EDYN_PARALLEL_SPSC_RING_HPP
+#define EDYN_PARALLEL_SPSC_RING_HPP
+
+#include <new>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include "edyn/config/config.h"
+
+namespace edyn {
+
+/**
+ * @brief Bounded wait-free ring buffer for single-producer single-consumer
+ * usage between two threads. Elements are constructed in place in
+ * preallocated storage, thus no allocations happen after construction.
+ * Each side keeps a cached copy of the other side's position to avoid
+ * touching the shared cache line unless necessary.
+ * @tparam T Element type.
+ */
+template<typename T>
+class spsc_ring {
+    using storage_type = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+    T * slot(size_t index) {
+        return std::launder(reinterpret_cast<T *>(&m_slots[index & m_mask]));
+    }
+
+public:
+    /**
+     * @param capacity Maximum number of elements. Must be a power of two.
+     */
+    explicit spsc_ring(size_t capacity)
+        : m_capacity(capacity)
+        , m_mask(capacity - 1)
+        , m_slots(new storage_type[capacity])
+    {
+        EDYN_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    }
+
+    spsc_ring(const spsc_ring &) = delete;
+    spsc_ring & operator=(const spsc_ring &) = delete;
+
+    ~spsc_ring() {
+        while (front()) {
+            pop();
+        }
+    }
+
+    /**
+     * @brief Constructs an element at the back. Must only be called by the
+     * producer.
+     * @return False if the ring is full, in which case nothing is constructed.
+     */
+    template<typename... Args>
+    bool try_emplace(Args &&... args) {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail - m_head_cache == m_capacity) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+
+            if (tail - m_head_cache == m_capacity) {
+                return false;
+            }
+        }
+
+        if constexpr(std::is_aggregate_v<T>) {
+            new (&m_slots[tail & m_mask]) T{std::forward<Args>(args)...};
+        } else {
+            new (&m_slots[tail & m_mask]) T(std::forward<Args>(args)...);
+        }
+
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @brief Element at the front. Must only be called by the consumer.
+     * @return Pointer to the element or null if the ring is empty.
+     */
+    T * front() {
+        auto head = m_head.load(std::memory_order_relaxed);
+
+        if (head == m_tail_cache) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+
+            if (head == m_tail_cache) {
+                return nullptr;
+            }
+        }
+
+        return slot(head);
+    }
+
+    /**
+     * @brief Destroys the element at the front. Must only be called by the
+     * consumer after `front` returned a valid element.
+     */
+    void pop() {
+        auto head = m_head.load(std::memory_order_relaxed);
+        EDYN_ASSERT(head != m_tail_cache);
+        slot(head)->~T();
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Number of elements available to the consumer. Must only be
+     * called by the consumer. More elements might be added concurrently.
+     */
+    size_t size() {
+        m_tail_cache = m_tail.load(std::memory_order_acquire);
+        return m_tail_cache - m_head.load(std::memory_order_relaxed);
+    }
+
+private:
+    size_t m_capacity;
+    size_t m_mask;
+    std::unique_ptr<storage_type[]> m_slots;
+
+    // Consumer state: position of next element to be consumed and cached
+    // copy of the producer's position. Kept in a separate cache line from
+    // the producer state.
+    alignas(64) std::atomic<size_t> m_head {0};
+    size_t m_tail_cache {0};
+
+    // Producer state: position of next element to be produced and cached
+    // copy of the consumer's position.
+    alignas(64) std::atomic<size_t> m_tail {0};
+    size_t m_head_cache {0};
+};
+
+}
+
+#endif // EDYN_PARALLEL_SPSC_RING_HPP
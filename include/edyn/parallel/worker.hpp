@@ -1,61 +1,52 @@
 #ifndef EDYN_PARALLEL_WORKER_HPP
 #define EDYN_PARALLEL_WORKER_HPP
 
-#include <atomic>
-#include <memory>
-#include "edyn/parallel/job_queue.hpp"
+#include <cstdint>
+#include "edyn/parallel/job_deque.hpp"
 
 namespace edyn {
 
 /**
- * A worker that runs jobs in a thread.
+ * A worker that runs jobs in a thread. Jobs scheduled from within the
+ * worker's thread go into its deque, which other workers steal from when
+ * they run out of jobs.
  */
 class worker {
 public:
-    void push_job(const job &j) {
-        m_queue.push(j);
-        ++m_size;
+    worker(size_t index)
+        : m_index(index)
+        // Seed must not be zero.
+        , m_random_state(static_cast<uint32_t>(index) * 2654435761u + 1u)
+    {}
+
+    size_t index() const {
+        return m_index;
     }
 
-    void run() {
-        m_running = true;
-
-        for (;;) {
-            auto j = m_queue.pop();
-            j();
-            --m_size;
-
-            if (!m_running) {
-                break;
-            }
-        }
-    }
-
-    void once() {
-        job j;
-        while (m_queue.try_pop(j)) {
-            j();
-            --m_size;
-        }
-    }
-
-    void stop() {
-        m_running = false;
-        m_queue.push(job::noop()); // Unblock queue with a no-op job.
-    }
-
-    size_t size() {
-        return m_size.load();
+    job_deque &get_deque() {
+        return m_deque;
     }
 
-    job_queue &get_queue() {
-        return m_queue;
+    /**
+     * Picks a random worker index other than this worker's to steal from.
+     * Requires at least two workers.
+     */
+    size_t random_victim(size_t num_workers) {
+        // Xorshift32.
+        auto x = m_random_state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        m_random_state = x;
+
+        auto victim = static_cast<size_t>(x) % (num_workers - 1);
+        return victim < m_index ? victim : victim + 1;
     }
 
 private:
-    std::atomic_bool m_running {false};
-    job_queue m_queue;
-    std::atomic<size_t> m_size {0};
+    size_t m_index;
+    job_deque m_deque;
+    uint32_t m_random_state;
 };
 
 }
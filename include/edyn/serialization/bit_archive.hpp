@@ -0,0 +1,134 @@
+#ifndef EDYN_SERIALIZATION_BIT_ARCHIVE_HPP
+#define EDYN_SERIALIZATION_BIT_ARCHIVE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "edyn/config/config.h"
+
+namespace edyn {
+
+/**
+ * @brief Writes values using the specified number of bits into a byte buffer.
+ * Bits are written least significant first.
+ */
+class bit_output_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = std::vector<data_type>;
+
+    bit_output_archive(buffer_type &buffer)
+        : m_buffer(&buffer)
+        , m_bit_position(buffer.size() * 8)
+    {}
+
+    void write_bits(uint64_t value, unsigned num_bits) {
+        EDYN_ASSERT(num_bits <= 64);
+
+        for (unsigned i = 0; i < num_bits; ++i) {
+            auto byte_idx = m_bit_position / 8;
+
+            if (byte_idx == m_buffer->size()) {
+                m_buffer->push_back(0);
+            }
+
+            if ((value >> i) & 1) {
+                (*m_buffer)[byte_idx] |= data_type(1 << (m_bit_position % 8));
+            }
+
+            ++m_bit_position;
+        }
+    }
+
+    void write_bool(bool value) {
+        write_bits(value ? 1 : 0, 1);
+    }
+
+    void write_float(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_bits(bits, 32);
+    }
+
+    void write_double(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_bits(bits, 64);
+    }
+
+    size_t bit_position() const {
+        return m_bit_position;
+    }
+
+private:
+    buffer_type *m_buffer;
+    size_t m_bit_position;
+};
+
+/**
+ * @brief Reads values written by a `bit_output_archive`.
+ */
+class bit_input_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = const data_type*;
+
+    bit_input_archive(buffer_type buffer, size_t size)
+        : m_buffer(buffer)
+        , m_size(size)
+        , m_bit_position(0)
+        , m_failed(false)
+    {}
+
+    uint64_t read_bits(unsigned num_bits) {
+        EDYN_ASSERT(num_bits <= 64);
+
+        if (m_failed || m_bit_position + num_bits > m_size * 8) {
+            m_failed = true;
+            return 0;
+        }
+
+        uint64_t value = 0;
+
+        for (unsigned i = 0; i < num_bits; ++i) {
+            auto bit = (m_buffer[m_bit_position / 8] >> (m_bit_position % 8)) & 1;
+            value |= uint64_t(bit) << i;
+            ++m_bit_position;
+        }
+
+        return value;
+    }
+
+    bool read_bool() {
+        return read_bits(1) != 0;
+    }
+
+    float read_float() {
+        auto bits = static_cast<uint32_t>(read_bits(32));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double read_double() {
+        auto bits = read_bits(64);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    bool failed() const {
+        return m_failed;
+    }
+
+private:
+    buffer_type m_buffer;
+    const size_t m_size;
+    size_t m_bit_position;
+    bool m_failed;
+};
+
+}
+
+#endif // EDYN_SERIALIZATION_BIT_ARCHIVE_HPP
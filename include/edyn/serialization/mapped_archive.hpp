@@ -0,0 +1,190 @@
+#ifndef EDYN_SERIALIZATION_MAPPED_ARCHIVE_HPP
+#define EDYN_SERIALIZATION_MAPPED_ARCHIVE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "edyn/serialization/s11n_util.hpp"
+
+namespace edyn {
+
+// Alignment of arrays in a mapped archive.
+constexpr size_t mapped_archive_alignment = 16;
+
+namespace detail {
+    template<typename T>
+    struct is_std_vector : std::false_type {};
+
+    template<typename T, typename Alloc>
+    struct is_std_vector<std::vector<T, Alloc>> : std::true_type {};
+
+    inline size_t align_mapped_offset(size_t offset) {
+        return (offset + mapped_archive_alignment - 1) & ~(mapped_archive_alignment - 1);
+    }
+}
+
+/**
+ * @brief Output archive which writes vectors of trivially copyable types as
+ * a 64-bit element count followed by the raw elements, aligned in the buffer,
+ * so they can be copied in bulk from a memory-mapped file by a
+ * `mapped_input_archive`. Other types are serialized as usual.
+ */
+class mapped_output_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = std::vector<data_type>;
+    using is_input = std::false_type;
+    using is_output = std::true_type;
+
+    mapped_output_archive(buffer_type &buffer)
+        : m_buffer(&buffer)
+    {}
+
+    template<typename T>
+    void operator()(T &t) {
+        if constexpr(std::is_fundamental_v<T>) {
+            write_bytes(&t, sizeof(T));
+        } else if constexpr(detail::is_std_vector<T>::value) {
+            write_vector(t);
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+private:
+    void write_bytes(const void *data, size_t size) {
+        auto idx = m_buffer->size();
+        m_buffer->resize(idx + size);
+
+        if (size > 0) {
+            std::memcpy(m_buffer->data() + idx, data, size);
+        }
+    }
+
+    void align() {
+        m_buffer->resize(detail::align_mapped_offset(m_buffer->size()));
+    }
+
+    template<typename T>
+    void write_vector(std::vector<T> &vector) {
+        auto count = static_cast<uint64_t>(vector.size());
+        align();
+        write_bytes(&count, sizeof(count));
+        align();
+
+        if constexpr(std::is_same_v<T, bool>) {
+            for (bool value : vector) {
+                auto byte = static_cast<uint8_t>(value);
+                write_bytes(&byte, sizeof(byte));
+            }
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>);
+            write_bytes(vector.data(), vector.size() * sizeof(T));
+        }
+    }
+
+    buffer_type *m_buffer;
+};
+
+/**
+ * @brief Input archive which reads the layout written by a
+ * `mapped_output_archive`, usually straight from a memory-mapped file. Each
+ * vector is filled with a single copy.
+ */
+class mapped_input_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = const data_type*;
+    using is_input = std::true_type;
+    using is_output = std::false_type;
+
+    mapped_input_archive(buffer_type buffer, size_t size)
+        : m_buffer(buffer)
+        , m_size(size)
+    {}
+
+    template<typename T>
+    void operator()(T &t) {
+        if constexpr(std::is_fundamental_v<T>) {
+            read_bytes(&t, sizeof(T));
+        } else if constexpr(detail::is_std_vector<T>::value) {
+            read_vector(t);
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+    bool failed() const {
+        return m_failed;
+    }
+
+private:
+    void read_bytes(void *data, size_t size) {
+        if (m_failed) return;
+
+        if (m_position + size > m_size) {
+            m_failed = true;
+            return;
+        }
+
+        if (size > 0) {
+            std::memcpy(data, m_buffer + m_position, size);
+        }
+
+        m_position += size;
+    }
+
+    void align() {
+        m_position = detail::align_mapped_offset(m_position);
+    }
+
+    template<typename T>
+    void read_vector(std::vector<T> &vector) {
+        uint64_t count = 0;
+        align();
+        read_bytes(&count, sizeof(count));
+        align();
+
+        if (m_failed || count > (m_size - std::min(m_position, m_size)) / sizeof(T)) {
+            m_failed = true;
+            vector.clear();
+            return;
+        }
+
+        if constexpr(std::is_same_v<T, bool>) {
+            vector.resize(count);
+
+            for (size_t i = 0; i < count; ++i) {
+                vector[i] = m_buffer[m_position + i] != 0;
+            }
+
+            m_position += count;
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>);
+            vector.resize(count);
+            read_bytes(vector.data(), count * sizeof(T));
+        }
+    }
+
+    buffer_type m_buffer;
+    size_t m_size;
+    size_t m_position {0};
+    bool m_failed {false};
+};
+
+}
+
+#endif // EDYN_SERIALIZATION_MAPPED_ARCHIVE_HPP
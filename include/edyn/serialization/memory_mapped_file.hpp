@@ -0,0 +1,61 @@
+#ifndef EDYN_SERIALIZATION_MEMORY_MAPPED_FILE_HPP
+#define EDYN_SERIALIZATION_MEMORY_MAPPED_FILE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace edyn {
+
+/**
+ * @brief A read-only view of an entire file mapped into the address space of
+ * the process. Pages are only read from disk when first touched.
+ */
+class memory_mapped_file {
+public:
+    memory_mapped_file() = default;
+    memory_mapped_file(const memory_mapped_file &) = delete;
+    memory_mapped_file & operator=(const memory_mapped_file &) = delete;
+    ~memory_mapped_file();
+
+    /**
+     * @brief Maps a file. Any previously mapped file is unmapped.
+     * @param path Path of file.
+     * @return Whether the file was mapped successfully.
+     */
+    bool open(const std::string &path);
+
+    void close();
+
+    bool is_open() const {
+        return m_data != nullptr;
+    }
+
+    const uint8_t * data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    /**
+     * @brief Hints the operating system that a range will be accessed soon,
+     * so it can start reading the pages in the background.
+     * @param offset Start of range in bytes.
+     * @param size Size of range in bytes.
+     */
+    void will_need(size_t offset, size_t size) const;
+
+private:
+    const uint8_t *m_data {nullptr};
+    size_t m_size {0};
+#if defined(_WIN32)
+    void *m_file_handle {nullptr};
+    void *m_mapping_handle {nullptr};
+#endif
+};
+
+}
+
+#endif // EDYN_SERIALIZATION_MEMORY_MAPPED_FILE_HPP
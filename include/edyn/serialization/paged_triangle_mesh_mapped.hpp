@@ -0,0 +1,112 @@
+#ifndef EDYN_SERIALIZATION_PAGED_TRIANGLE_MESH_MAPPED_HPP
+#define EDYN_SERIALIZATION_PAGED_TRIANGLE_MESH_MAPPED_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <entt/signal/sigh.hpp>
+#include "edyn/shapes/paged_triangle_mesh.hpp"
+#include "edyn/shapes/triangle_mesh_page_loader.hpp"
+#include "edyn/serialization/memory_mapped_file.hpp"
+#include "edyn/parallel/job.hpp"
+
+namespace edyn {
+
+/**
+ * Layout of a file written by `write_mapped_paged_triangle_mesh`:
+ * - A `mapped_paged_triangle_mesh_header`.
+ * - The tree of submeshes written with a `mapped_output_archive`.
+ * - A `mapped_submesh_entry` for each submesh.
+ * - The submeshes, each written with a `mapped_output_archive` and starting
+ *   at a multiple of `mapped_submesh_alignment`, so that paging in a submesh
+ *   only touches the pages that belong to it.
+ * Data is stored in the native representation, thus a file can only be read
+ * on platforms with the same endianness and size of `scalar`.
+ */
+struct mapped_paged_triangle_mesh_header {
+    static constexpr uint32_t current_version = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t scalar_size;
+    uint64_t tree_offset;
+    uint64_t tree_size;
+    uint64_t table_offset;
+    uint64_t num_submeshes;
+};
+
+struct mapped_submesh_entry {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t num_vertices;
+    uint64_t num_indices;
+};
+
+constexpr size_t mapped_submesh_alignment = 4096;
+
+/**
+ * @brief Writes a `paged_triangle_mesh` to a file in the memory-mapped layout.
+ * All submeshes must be loaded.
+ * @param path Path of file.
+ * @param paged_tri_mesh Mesh to be written.
+ * @return Whether the file was written successfully.
+ */
+bool write_mapped_paged_triangle_mesh(const std::string &path,
+                                      paged_triangle_mesh &paged_tri_mesh);
+
+/**
+ * @brief Page loader which maps a file written with
+ * `write_mapped_paged_triangle_mesh` into memory. Submeshes are copied
+ * straight from the mapped pages in the background, with one copy per array,
+ * and all derived data such as normals, edges and the triangle tree is
+ * stored in the file, thus nothing has to be rebuilt.
+ */
+class paged_triangle_mesh_mapped_loader : public triangle_mesh_page_loader_base {
+public:
+    paged_triangle_mesh_mapped_loader() = default;
+
+    /**
+     * @brief Maps a file and validates its header.
+     * @param path Path of file.
+     * @return Whether the file is valid.
+     */
+    bool open(const std::string &path);
+
+    void close();
+
+    bool is_open() const {
+        return m_file.is_open();
+    }
+
+    void load(size_t index) override;
+
+    entt::sink<entt::sigh<loaded_mesh_func_t>> on_load_sink() override {
+        return {m_loaded_signal};
+    }
+
+    friend bool read_mapped_paged_triangle_mesh(paged_triangle_mesh_mapped_loader &loader,
+                                                paged_triangle_mesh &paged_tri_mesh);
+    friend void load_mapped_mesh_job_func(job::data_type &);
+
+private:
+    memory_mapped_file m_file;
+    std::vector<mapped_submesh_entry> m_submeshes;
+    entt::sigh<loaded_mesh_func_t> m_loaded_signal;
+};
+
+/**
+ * @brief Reads the tree and the list of submeshes of a `paged_triangle_mesh`
+ * which uses the given loader as its page loader. Submeshes are loaded on
+ * demand afterwards.
+ * @param loader An open loader.
+ * @param paged_tri_mesh Mesh to be initialized.
+ * @return Whether the data is valid.
+ */
+bool read_mapped_paged_triangle_mesh(paged_triangle_mesh_mapped_loader &loader,
+                                     paged_triangle_mesh &paged_tri_mesh);
+
+void load_mapped_mesh_job_func(job::data_type &);
+
+}
+
+#endif // EDYN_SERIALIZATION_PAGED_TRIANGLE_MESH_MAPPED_HPP
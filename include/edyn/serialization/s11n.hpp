@@ -3,6 +3,7 @@
 #include "edyn/serialization/static_tree_s11n.hpp"
 #include "edyn/serialization/triangle_mesh_s11n.hpp"
 #include "edyn/serialization/paged_triangle_mesh_s11n.hpp"
+#include "edyn/serialization/paged_triangle_mesh_mapped.hpp"
 #include "edyn/serialization/entt_s11n.hpp"
 #include "edyn/serialization/file_archive.hpp"
 #include "edyn/serialization/memory_archive.hpp"
\ No newline at end of file
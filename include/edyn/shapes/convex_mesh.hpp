@@ -41,6 +41,12 @@ struct convex_mesh {
     std::vector<vector3> relevant_normals;
     std::vector<vector3> relevant_edges;
 
+    // Each subsequent pair of integers represents the index of the first
+    // neighbor of a vertex in the `neighbor_indices` array and the number of
+    // neighbors of the vertex. Vertices are neighbors if they share an edge.
+    std::vector<uint32_t> vertex_neighbors;
+    std::vector<uint32_t> neighbor_indices;
+
     /**
      * @brief Initializes calculated properties. Call this after vertices,
      * indices and faces are assigned.
@@ -110,11 +116,27 @@ struct convex_mesh {
      */
     std::array<vector3, 2> get_rotated_edge(const rotated_mesh &, size_t idx) const;
 
+    /**
+     * @brief Finds the vertex which is furthest along a direction by walking
+     * over the vertex adjacency, which is much cheaper than visiting all
+     * vertices. Since the mesh is convex, the walk cannot get stuck in a local
+     * maximum. Starting at the vertex found in a previous query with a
+     * similar direction, it usually takes only a few steps.
+     * @param points Vertex positions, which can be the rotated vertices of
+     * this mesh.
+     * @param dir A direction vector (non-zero).
+     * @param start_idx Index of vertex where the walk starts.
+     * @return Index of the support vertex.
+     */
+    uint32_t support_vertex_index(const std::vector<vector3> &points, const vector3 &dir,
+                                  uint32_t start_idx = 0) const;
+
     void shift_to_centroid();
     void calculate_normals();
     void calculate_edges();
     void calculate_relevant_normals();
     void calculate_relevant_edges();
+    void calculate_vertex_neighbors();
 
 #ifdef EDYN_DEBUG
     void validate() const;
@@ -130,6 +152,10 @@ struct rotated_mesh {
     std::vector<vector3> vertices;
     std::vector<vector3> relevant_normals;
     std::vector<vector3> relevant_edges;
+
+    // Orientation applied to the mesh in the last update. Rotated meshes are
+    // updated on demand and only if the orientation changed.
+    quaternion orientation {quaternion_identity};
 };
 
 /**
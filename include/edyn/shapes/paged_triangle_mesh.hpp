@@ -5,6 +5,7 @@
 #include <vector>
 #include <atomic>
 #include <memory>
+#include <string>
 #include "edyn/math/constants.hpp"
 #include "edyn/shapes/triangle_mesh.hpp"
 #include "edyn/shapes/triangle_mesh_page_loader.hpp"
@@ -13,6 +14,7 @@ namespace edyn {
 
 class paged_triangle_mesh_file_input_archive;
 class paged_triangle_mesh_file_output_archive;
+class paged_triangle_mesh_mapped_loader;
 class finish_load_mesh_job;
 
 // Forward declaration of `detail::submesh_builder` needed by `friend`
@@ -29,10 +31,26 @@ public:
     struct triangle_mesh_node {
         size_t num_vertices;
         size_t num_indices;
+        // Bytes allocated by the triangle mesh the last time it was loaded.
+        // Zero if it was never loaded.
+        size_t size_bytes {0};
         // Triangle mesh pointer. Will be nullptr if mesh is not loaded.
         std::shared_ptr<triangle_mesh> trimesh;
     };
 
+    struct cache_statistics {
+        // Number of visits to a submesh that was in the cache.
+        size_t num_hits;
+        // Number of submesh loads requested.
+        size_t num_misses;
+        // Number of submeshes unloaded to stay within the budget.
+        size_t num_evictions;
+        // Bytes allocated by all submeshes in the cache.
+        size_t size_bytes;
+        // Number of submeshes in the cache.
+        size_t num_resident;
+    };
+
     paged_triangle_mesh(std::shared_ptr<triangle_mesh_page_loader_base> loader);
 
     /**
@@ -194,6 +212,25 @@ public:
         });
     }
 
+    /**
+     * @brief Starts loading submeshes which intersect the given AABB and are
+     * not in the cache yet, as long as the number of loads in flight stays
+     * within a budget. Usually called with a region a body is about to enter
+     * so the submeshes are available before contact.
+     * @param aabb Query AABB.
+     * @param max_pending_loads No new loads are started if this many are
+     * already in flight.
+     */
+    void prefetch(const AABB &aabb, size_t max_pending_loads);
+
+    /**
+     * @brief Number of submeshes requested from the page loader which have
+     * not been assigned yet.
+     */
+    size_t num_pending_loads() const {
+        return m_num_pending_loads.load(std::memory_order_relaxed);
+    }
+
     /**
      * @brief Get AABB of entire mesh.
      * @return AABB of mesh.
@@ -208,6 +245,22 @@ public:
      */
     size_t cache_num_vertices() const;
 
+    /**
+     * @brief Returns the number of bytes allocated by the submeshes currently
+     * in the cache.
+     */
+    size_t cache_size_bytes() const {
+        return m_cache_size_bytes.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the cache hit, miss and eviction counters accumulated
+     * since the last reset and the current size of the cache.
+     */
+    cache_statistics get_cache_statistics() const;
+
+    void reset_cache_statistics();
+
     size_t num_submeshes() const {
         return m_cache.size();
     }
@@ -222,6 +275,13 @@ public:
 
     void assign_mesh(size_t index, std::shared_ptr<triangle_mesh>);
 
+    /**
+     * @brief Clears the loading state of a submesh which the page loader
+     * failed to load, so that it can be requested again.
+     * @param index Submesh index.
+     */
+    void cancel_load(size_t index);
+
     auto & get_page_loader() {
         return *m_page_loader;
     }
@@ -230,12 +290,12 @@ public:
     bool has_per_vertex_restitution() const;
 
     /**
-     * @brief Maximum number of vertices in the cache. Before a new triangle mesh
-     * is loaded, if the number of vertices would exceed this number, the
-     * least recently visited nodes will be unloaded until the new total
-     * number of vertices stays below this value.
+     * @brief Maximum number of bytes allocated by the submeshes in the cache.
+     * Before a new triangle mesh is loaded, if its size would take the total
+     * above this value, submeshes which have not been visited recently are
+     * unloaded until the new total stays below this value.
      */
-    size_t m_max_cache_num_vertices = 1 << 13;
+    size_t m_max_cache_size_bytes = 1 << 22;
 
     template<typename VertexIterator, typename IndexIterator>
     friend void create_paged_triangle_mesh(
@@ -256,16 +316,35 @@ public:
     friend void serialize(paged_triangle_mesh_file_input_archive &archive,
                           paged_triangle_mesh &paged_tri_mesh);
 
+    friend bool write_mapped_paged_triangle_mesh(const std::string &path,
+                                                 paged_triangle_mesh &paged_tri_mesh);
+
+    friend bool read_mapped_paged_triangle_mesh(paged_triangle_mesh_mapped_loader &loader,
+                                                paged_triangle_mesh &paged_tri_mesh);
+
 private:
+    void init_cache();
     void load_node_if_needed(size_t trimesh_idx);
     void mark_recent_visit(size_t trimesh_idx);
-    void unload_least_recently_visited_node();
+    bool evict_one();
 
     static_tree m_tree;
     std::vector<triangle_mesh_node> m_cache;
-    std::vector<size_t> m_lru_indices;
-    std::mutex m_lru_mutex;
     std::unique_ptr<std::atomic<bool>[]> m_is_loading_submesh;
+
+    // The cache uses the CLOCK approximation of LRU. Visits set the reference
+    // bit of a submesh without locking. When space is needed, the hand sweeps
+    // over the resident submeshes, clearing reference bits, and unloads the
+    // first one whose bit is already clear.
+    std::unique_ptr<std::atomic<bool>[]> m_referenced;
+    std::vector<size_t> m_resident;
+    size_t m_clock_hand {0};
+    mutable std::mutex m_cache_mutex;
+    std::atomic<size_t> m_cache_size_bytes {0};
+    std::atomic<size_t> m_num_hits {0};
+    std::atomic<size_t> m_num_misses {0};
+    std::atomic<size_t> m_num_evictions {0};
+    std::atomic<size_t> m_num_pending_loads {0};
     std::shared_ptr<triangle_mesh_page_loader_base> m_page_loader;
 };
 
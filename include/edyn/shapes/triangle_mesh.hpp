@@ -78,6 +78,17 @@ public:
         return m_triangle_tree.root_aabb();
     }
 
+    /**
+     * @brief Number of bytes allocated for all arrays.
+     */
+    size_t memory_size() const;
+
+    /**
+     * @brief Estimates the memory size of a mesh before it's loaded, given
+     * the number of vertices and triangles.
+     */
+    static size_t estimate_memory_size(size_t num_vertices, size_t num_triangles);
+
     vector3 get_vertex_position(size_t vertex_idx) const {
         EDYN_ASSERT(vertex_idx < m_vertices.size());
         return m_vertices[vertex_idx];
@@ -2,7 +2,7 @@
 #define EDYN_SHAPES_TRIANGLE_MESH_PAGE_LOADER_HPP
 
 #include <memory>
-#include <entt/signal/fwd.hpp>
+#include <entt/signal/sigh.hpp>
 
 namespace edyn {
 
@@ -16,6 +16,16 @@ public:
 
     using loaded_mesh_func_t = void(size_t, std::shared_ptr<triangle_mesh>);
     virtual entt::sink<entt::sigh<loaded_mesh_func_t>> on_load_sink() = 0;
+
+    // Called with the index of a submesh which could not be loaded, which can
+    // be requested again afterwards.
+    using load_failed_func_t = void(size_t);
+    entt::sink<entt::sigh<load_failed_func_t>> on_load_failed_sink() {
+        return {m_load_failed_signal};
+    }
+
+protected:
+    entt::sigh<load_failed_func_t> m_load_failed_signal;
 };
 
 
@@ -6,10 +6,11 @@
 namespace edyn {
 
 /**
- * @brief Update AABBs of all entities that contain a shape.
- * @remark It's important to call this after the rotated meshes of all
- * polyhedrons are updated because they will be used to calculate the AABBs of
- * polyhedrons.
+ * @brief Update AABBs of all entities that contain a shape. Entities whose
+ * AABB changed are marked with an `edyn::aabb_changed_tag`. AABBs of boxes,
+ * spheres, capsules and cylinders are calculated in batches unless
+ * `settings::batched_aabb_update` is disabled. AABBs of bodies with an
+ * `edyn::ccd_tag` are expanded to enclose their motion during the next step.
  * @param registry The registry to be updated.
  */
 void update_aabbs(entt::registry &registry);
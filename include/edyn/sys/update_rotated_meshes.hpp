@@ -11,14 +11,25 @@ struct quaternion;
 
 /**
  * @brief Updates the rotated mesh of all polyhedron shapes, including the ones
- * in compound shapes.
+ * in compound shapes. Rotated meshes which are up to date with the current
+ * orientation are skipped.
  * @param registry Source of shapes.
  */
 void update_rotated_meshes(entt::registry &registry);
 
+/**
+ * @brief Updates the rotated meshes of the bodies in contact manifolds.
+ * Rotated meshes are only needed in collision detection, thus they're updated
+ * on demand right before the narrowphase instead of after every step, which
+ * spares all polyhedrons that are not close to anything. Rotated meshes which
+ * are up to date with the current orientation are skipped.
+ * @param registry Source of shapes and manifolds.
+ */
+void update_contact_rotated_meshes(entt::registry &registry);
+
 /**
  * @brief Updates the rotated mesh of a single entity, which is assumed to have
- * either a polyhedron or a compound shape.
+ * either a polyhedron or a compound shape, if its orientation has changed.
  * @param registry Data source.
  * @param entity Entity to be updated.
  */
@@ -26,7 +37,7 @@ void update_rotated_mesh(entt::registry &registry, entt::entity entity);
 
 /**
  * @brief Updates rotated mesh by appliying a rotation to the vertex positions
- * and face normals of a mesh.
+ * and face normals of a mesh, and stores the rotation in it.
  * @param rotated The rotated mesh to be updated.
  * @param mesh The source convex mesh.
  * @param orn Rotation to be applied.
@@ -0,0 +1,71 @@
+#ifndef EDYN_UTIL_AABB_BATCH_HPP
+#define EDYN_UTIL_AABB_BATCH_HPP
+
+#include <cstddef>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * Width in bytes of the vector registers of the target, i.e. 16 for SSE and
+ * NEON and 32 for AVX.
+ */
+#if defined(__AVX__)
+inline constexpr size_t aabb_batch_alignment = 32;
+#else
+inline constexpr size_t aabb_batch_alignment = 16;
+#endif
+
+/**
+ * Number of AABBs calculated at once in a batch. Two vector registers worth
+ * of scalars, so that each kernel has enough independent work per iteration.
+ */
+inline constexpr size_t aabb_batch_size = aabb_batch_alignment / sizeof(scalar) * 2;
+
+/**
+ * @brief Transforms and shape parameters of a group of entities with the same
+ * shape type, stored as structure-of-arrays with one lane per entity, and
+ * the resulting AABBs.
+ */
+struct aabb_batch {
+    // Position components.
+    alignas(aabb_batch_alignment) scalar pos[3][aabb_batch_size];
+    // Orientation components, in x, y, z, w order.
+    alignas(aabb_batch_alignment) scalar orn[4][aabb_batch_size];
+    // Shape parameters. Box: half extents. Sphere: radius in the first
+    // element. Capsule and cylinder: radius and half length.
+    alignas(aabb_batch_alignment) scalar params[3][aabb_batch_size];
+    // Resulting AABBs.
+    alignas(aabb_batch_alignment) scalar min[3][aabb_batch_size];
+    alignas(aabb_batch_alignment) scalar max[3][aabb_batch_size];
+};
+
+/**
+ * @brief Calculates the AABBs of all boxes in a batch.
+ * @param batch Batch with transforms and half extents.
+ */
+void box_aabb_batch(aabb_batch &batch);
+
+/**
+ * @brief Calculates the AABBs of all spheres in a batch.
+ * @param batch Batch with positions and radii.
+ */
+void sphere_aabb_batch(aabb_batch &batch);
+
+/**
+ * @brief Calculates the AABBs of all capsules in a batch. Capsules are
+ * aligned with the x axis in object space.
+ * @param batch Batch with transforms, radii and half lengths.
+ */
+void capsule_aabb_batch(aabb_batch &batch);
+
+/**
+ * @brief Calculates the AABBs of all cylinders in a batch. Cylinders are
+ * aligned with the x axis in object space.
+ * @param batch Batch with transforms, radii and half lengths.
+ */
+void cylinder_aabb_batch(aabb_batch &batch);
+
+}
+
+#endif // EDYN_UTIL_AABB_BATCH_HPP
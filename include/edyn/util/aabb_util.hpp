@@ -47,6 +47,18 @@ AABB point_cloud_aabb(const std::vector<vector3> &points);
 AABB point_cloud_aabb(const std::vector<vector3> &points,
                       const vector3 &pos, const quaternion &orn);
 
+/**
+ * @brief Calculates the AABB of a convex mesh with a transformation using
+ * support queries, which visit only a few vertices along each axis instead of
+ * rotating all of them. The result is the same as calling `point_cloud_aabb`
+ * with the vertices of the mesh.
+ * @param mesh A convex mesh.
+ * @param pos Position of mesh.
+ * @param orn Orientation of mesh.
+ * @return AABB of transformed mesh.
+ */
+AABB convex_mesh_aabb(const convex_mesh &mesh, const vector3 &pos, const quaternion &orn);
+
 // Calculate AABB for all types of shapes.
 AABB shape_aabb(const plane_shape &sh, const vector3 &pos, const quaternion &orn);
 AABB shape_aabb(const sphere_shape &sh, const vector3 &pos, const quaternion &orn);
@@ -10,6 +10,7 @@
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/origin.hpp"
 #include "edyn/comp/angvel.hpp"
+#include "edyn/comp/linvel.hpp"
 #include "edyn/shapes/shapes.hpp"
 #include "edyn/collision/contact_point.hpp"
 #include "edyn/collision/contact_manifold.hpp"
@@ -18,6 +19,9 @@
 
 namespace edyn {
 
+class material_mix_table;
+struct polyhedron_collision_cache;
+
 /**
  * Update distance of persisted contact points.
  */
@@ -61,6 +65,19 @@ size_t find_nearest_contact_rolling(const collision_result &result, const vector
                                     const vector3 &origin, const quaternion &orn,
                                     const vector3 &angvel, scalar dt);
 
+/**
+ * Inserts a contact point created from a result point into a manifold and
+ * records the event, but does not mark the manifold as dirty. It does not
+ * modify the registry, thus it can be called in parallel for different
+ * manifolds.
+ */
+void insert_contact_point(contact_manifold &manifold,
+                          contact_manifold_events &events,
+                          const collision_result::collision_point &rp,
+                          const orientation_view_t &, const material_view_t &,
+                          const mesh_shape_view_t &, const paged_mesh_shape_view_t &,
+                          const material_mix_table &);
+
 /**
  * Creates a contact point from a result point and inserts it into a
  * manifold. The contact is inserted at the index assigned to the last
@@ -96,11 +113,29 @@ using origin_view_t = entt::basic_view<entt::entity, entt::get_t<origin>, entt::
 
 /**
  * Detects collision between two bodies and adds closest points to the given
- * collision result
+ * collision result. If both bodies are polyhedrons, the results of the
+ * previous call for the same pair can be provided in a cache to speed it up.
  */
 void detect_collision(std::array<entt::entity, 2> body, collision_result &,
                       const detect_collision_body_view_t &, const origin_view_t &,
-                      const tuple_of_shape_views_t &);
+                      const tuple_of_shape_views_t &,
+                      polyhedron_collision_cache *polyhedron_cache = nullptr);
+
+using linvel_view_t = entt::basic_view<entt::entity, entt::get_t<linvel>, entt::exclude_t<>>;
+using angvel_view_t = entt::basic_view<entt::entity, entt::get_t<angvel>, entt::exclude_t<>>;
+
+/**
+ * Detects collision between two bodies where at least one of them has
+ * continuous collision detection enabled. If they're not touching, the time
+ * of impact within the next step of length `dt` is calculated and speculative
+ * contact points are created at the poses of impact, with the distance being
+ * the current separation along the normal. No points are created if they
+ * won't touch during the step.
+ */
+void detect_collision_ccd(std::array<entt::entity, 2> body, collision_result &,
+                          const detect_collision_body_view_t &, const origin_view_t &,
+                          const linvel_view_t &, const angvel_view_t &,
+                          const tuple_of_shape_views_t &, scalar dt);
 
 /**
  * Processes a collision result and inserts/replaces points into the manifold.
@@ -4,6 +4,7 @@
 #include <entt/entity/registry.hpp>
 #include "edyn/comp/dirty.hpp"
 #include "edyn/math/vector3.hpp"
+#include "edyn/util/entity_pair.hpp"
 
 namespace edyn {
 
@@ -61,6 +62,20 @@ void make_contact_manifold(entt::entity contact_entity, entt::registry &,
                            entt::entity body0, entt::entity body1,
                            scalar separation_threshold);
 
+/**
+ * @brief Creates a contact manifold for each pair of entities. Manifold
+ * entities and their common components are created in bulk, which is faster
+ * than calling `make_contact_manifold` for each pair.
+ * @param registry Data source.
+ * @param pairs Pairs of rigid bodies.
+ * @param separation_threshold Separation threshold assigned to all manifolds.
+ * @param manifold_entities The new manifold entities are appended to this
+ * vector, in the same order as the pairs.
+ */
+void make_contact_manifolds(entt::registry &registry, const entity_pair_vector &pairs,
+                            scalar separation_threshold,
+                            std::vector<entt::entity> &manifold_entities);
+
 void swap_manifold(contact_manifold &manifold);
 
 scalar get_effective_mass(const constraint_row &);
@@ -1,63 +1,247 @@
 #ifndef EDYN_UTIL_ENTITY_MAP_HPP
 #define EDYN_UTIL_ENTITY_MAP_HPP
 
-#include <map>
+#include <vector>
+#include <cstdint>
+#include <utility>
 #include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include "edyn/config/config.h"
 
 namespace edyn {
 
+namespace detail {
+
+/**
+ * @brief Open addressing hash table mapping entities to entities using linear
+ * probing. Slots are stored contiguously and erasure shifts entries back
+ * instead of leaving tombstones, thus lookups remain short.
+ */
+class entity_table {
+    struct slot {
+        entt::entity key {entt::null};
+        entt::entity value {entt::null};
+    };
+
+    static bool is_empty(const slot &s) {
+        return s.key == entt::entity{entt::null};
+    }
+
+    size_t home_index(entt::entity key) const {
+        // Fibonacci hashing spreads sequential entity identifiers.
+        auto hash = static_cast<uint64_t>(entt::to_integral(key)) * UINT64_C(0x9E3779B97F4A7C15);
+        return static_cast<size_t>(hash >> 32) & (m_slots.size() - 1);
+    }
+
+    size_t find_index(entt::entity key) const {
+        if (m_slots.empty()) {
+            return SIZE_MAX;
+        }
+
+        auto mask = m_slots.size() - 1;
+
+        for (auto i = home_index(key);; i = (i + 1) & mask) {
+            auto &s = m_slots[i];
+
+            if (s.key == key) {
+                return i;
+            }
+
+            if (is_empty(s)) {
+                return SIZE_MAX;
+            }
+        }
+    }
+
+    void grow() {
+        auto slots = std::move(m_slots);
+        m_slots.assign(slots.empty() ? 16 : slots.size() * 2, slot{});
+        m_size = 0;
+
+        for (auto &s : slots) {
+            if (!is_empty(s)) {
+                insert_or_assign(s.key, s.value);
+            }
+        }
+    }
+
+public:
+    entt::entity find(entt::entity key) const {
+        auto index = find_index(key);
+        return index == SIZE_MAX ? entt::entity{entt::null} : m_slots[index].value;
+    }
+
+    void insert_or_assign(entt::entity key, entt::entity value) {
+        EDYN_ASSERT(key != entt::entity{entt::null});
+
+        // Keep load factor at or below one half.
+        if ((m_size + 1) * 2 > m_slots.size()) {
+            grow();
+        }
+
+        auto mask = m_slots.size() - 1;
+
+        for (auto i = home_index(key);; i = (i + 1) & mask) {
+            auto &s = m_slots[i];
+
+            if (s.key == key) {
+                s.value = value;
+                return;
+            }
+
+            if (is_empty(s)) {
+                s.key = key;
+                s.value = value;
+                ++m_size;
+                return;
+            }
+        }
+    }
+
+    bool erase(entt::entity key) {
+        auto i = find_index(key);
+
+        if (i == SIZE_MAX) {
+            return false;
+        }
+
+        // Shift back the following entries of the cluster which would become
+        // unreachable once this slot is empty.
+        auto mask = m_slots.size() - 1;
+
+        for (auto j = (i + 1) & mask; !is_empty(m_slots[j]); j = (j + 1) & mask) {
+            auto k = home_index(m_slots[j].key);
+
+            // Move the entry at `j` into `i` if its home index is not in the
+            // cyclic range `(i, j]`.
+            if (i <= j ? (k <= i || k > j) : (k <= i && k > j)) {
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+
+        m_slots[i] = slot{};
+        --m_size;
+        return true;
+    }
+
+    template<typename Func>
+    void each(Func func) const {
+        for (auto &s : m_slots) {
+            if (!is_empty(s)) {
+                func(s.key, s.value);
+            }
+        }
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    std::vector<slot> m_slots;
+    size_t m_size {0};
+};
+
+}
+
+/**
+ * @brief Bidirectional mapping between entities of two registries, usually
+ * from the remote registry to the local registry.
+ */
 class entity_map {
 public:
     void insert(entt::entity entity, entt::entity other) {
-        map[entity] = other;
-        others[other] = entity;
+        map.insert_or_assign(entity, other);
+        others.insert_or_assign(other, entity);
     }
 
     void erase(entt::entity entity) {
-        auto other = map.at(entity);
+        auto other = map.find(entity);
+        EDYN_ASSERT(other != entt::entity{entt::null});
         map.erase(entity);
         others.erase(other);
     }
 
     void erase_other(entt::entity other) {
-        auto entity = others.at(other);
+        auto entity = others.find(other);
+        EDYN_ASSERT(entity != entt::entity{entt::null});
         map.erase(entity);
         others.erase(other);
     }
 
     bool contains(entt::entity entity) const {
-        return map.count(entity) > 0;
+        return map.find(entity) != entt::entity{entt::null};
     }
 
     bool contains_other(entt::entity other) const {
-        return others.count(other) > 0;
+        return others.find(other) != entt::entity{entt::null};
     }
 
     entt::entity at(entt::entity entity) const {
-        return map.at(entity);
+        auto other = map.find(entity);
+        EDYN_ASSERT(other != entt::entity{entt::null});
+        return other;
     }
 
     entt::entity at_other(entt::entity other) const {
-        return others.at(other);
+        auto entity = others.find(other);
+        EDYN_ASSERT(entity != entt::entity{entt::null});
+        return entity;
+    }
+
+    /**
+     * @brief Looks up an entity, which is cheaper than calling `contains`
+     * followed by `at`.
+     * @param entity Entity to be mapped.
+     * @return The mapped entity or `entt::null` if not present.
+     */
+    entt::entity find(entt::entity entity) const {
+        return map.find(entity);
+    }
+
+    entt::entity find_other(entt::entity other) const {
+        return others.find(other);
+    }
+
+    /**
+     * @brief Looks up a range of entities. Unlike `at`, entities which are not
+     * present do not trigger an assertion and are mapped to `entt::null`
+     * instead, thus callers must handle null entities in the result.
+     * @param first Iterator to the first entity.
+     * @param last Iterator past the last entity.
+     * @param result Iterator to the first mapped entity, which can be equal
+     * to `first` to map the entities in place.
+     */
+    template<typename InputIt, typename OutputIt>
+    void find_many(InputIt first, InputIt last, OutputIt result) const {
+        for (; first != last; ++first, ++result) {
+            *result = map.find(*first);
+        }
     }
 
     template<typename Predicate>
     void erase_if(Predicate predicate) {
-        for (auto it = map.begin(); it != map.end();) {
-            if (predicate(it->first, it->second)) {
-                others.erase(it->second);
-                it = map.erase(it);
-            } else {
-                ++it;
+        auto erased = std::vector<entt::entity>{};
+
+        map.each([&](entt::entity entity, entt::entity other) {
+            if (predicate(entity, other)) {
+                erased.push_back(entity);
             }
+        });
+
+        for (auto entity : erased) {
+            erase(entity);
         }
     }
 
     template<typename Func>
     void each(Func func) const {
-        for (auto it = map.begin(); it != map.end(); ++it) {
-            func(it->first, it->second);
-        }
+        map.each(func);
+    }
+
+    size_t size() const {
+        return map.size();
     }
 
     void swap() {
@@ -65,8 +249,8 @@ public:
     }
 
 private:
-    std::map<entt::entity, entt::entity> map;
-    std::map<entt::entity, entt::entity> others;
+    detail::entity_table map;
+    detail::entity_table others;
 };
 
 }
@@ -57,6 +57,13 @@ public:
         return m_range_starts.size();
     }
 
+    /**
+     * Number of bytes allocated for the elements and ranges.
+     */
+    size_t memory_size() const {
+        return m_data.capacity() * sizeof(T) + m_range_starts.capacity() * sizeof(size_t);
+    }
+
     /**
      * Reserves data for the contiguous nested arrays.
      */
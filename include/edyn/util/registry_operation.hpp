@@ -3,6 +3,8 @@
 
 #include <memory>
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 #include <entt/entity/registry.hpp>
 #include "edyn/config/config.h"
 #include "edyn/parallel/map_child_entity.hpp"
@@ -24,111 +26,244 @@ enum class registry_op_type {
 };
 
 /**
- * @brief Registry operation for components.
+ * Alignment of every operation in the buffer of a
+ * `registry_operation_collection`. Components with a stricter alignment are
+ * not supported.
+ */
+inline constexpr size_t registry_operation_alignment = alignof(std::max_align_t);
+
+/**
+ * Unit of allocation of the buffer of a `registry_operation_collection`.
+ */
+struct alignas(registry_operation_alignment) registry_operation_block {
+    std::byte data[registry_operation_alignment];
+};
+
+namespace detail {
+    /**
+     * Scratch buffer of entities reused by registry operations executed in the
+     * current thread to avoid allocations.
+     */
+    inline std::vector<entt::entity> & registry_operation_scratch_entities() {
+        static thread_local std::vector<entt::entity> entities;
+        return entities;
+    }
+
+    inline std::vector<bool> & registry_operation_scratch_marks() {
+        static thread_local std::vector<bool> marks;
+        return marks;
+    }
+
+    /**
+     * Marks an entity as seen in the current thread. Returns false if it was
+     * already marked. Used to skip duplicate entities in bulk operations.
+     */
+    inline bool registry_operation_mark(entt::entity entity) {
+        auto &marks = registry_operation_scratch_marks();
+        auto index = static_cast<size_t>(entt::to_entity(entity));
+
+        if (index >= marks.size()) {
+            marks.resize(index + 1);
+        }
+
+        if (marks[index]) {
+            return false;
+        }
+
+        marks[index] = true;
+        return true;
+    }
+
+    inline void registry_operation_unmark(const std::vector<entt::entity> &entities) {
+        auto &marks = registry_operation_scratch_marks();
+
+        for (auto entity : entities) {
+            marks[static_cast<size_t>(entt::to_entity(entity))] = false;
+        }
+    }
+}
+
+/**
+ * @brief Registry operations for a component type. Stateless: it operates on
+ * entities and components stored in the buffer of a
+ * `registry_operation_collection`.
  */
 class component_operation {
 public:
     virtual ~component_operation() = default;
     virtual void execute(entt::registry &, registry_op_type,
-                         const std::vector<entt::entity> &, entity_map &) const = 0;
+                         const entt::entity *entities, const void *components,
+                         size_t count, entity_map &) const = 0;
     virtual entt::id_type get_type_id() const = 0;
-    virtual void remap(const entity_map &emap) = 0;
+    virtual void remap(void *components, size_t count, const entity_map &emap) const = 0;
+    virtual void copy(const void *src, void *dst, size_t count) const = 0;
+    virtual void destroy(void *components, size_t count) const = 0;
 };
 
 template<typename Component>
-class component_operation_impl : public component_operation {
+class component_operation_impl final : public component_operation {
+    static_assert(alignof(Component) <= registry_operation_alignment);
+
+    static const Component * as_components(const void *components) {
+        return static_cast<const Component *>(components);
+    }
+
+    static Component * as_components(void *components) {
+        return static_cast<Component *>(components);
+    }
+
+    // Whether the component has child entities which must be mapped into
+    // the local registry.
+    static bool has_child_entities() {
+        return static_cast<bool>(entt::resolve<Component>());
+    }
 
     void execute_emplace(entt::registry &registry,
-                         const std::vector<entt::entity> &entities,
-                         const entity_map &entity_map) const {
-        if constexpr(!std::is_empty_v<Component>) {
-            EDYN_ASSERT(entities.size() == components.size());
-        }
+                         const entt::entity *entities, const void *components,
+                         size_t count, const entity_map &entity_map) const {
+        // Gather entities which can receive the component and insert all
+        // components at once.
+        auto &local_entities = detail::registry_operation_scratch_entities();
+        local_entities.clear();
 
-        for (size_t i = 0; i < entities.size(); ++i) {
-            auto remote_entity = entities[i];
+        if constexpr(std::is_empty_v<Component>) {
+            for (size_t i = 0; i < count; ++i) {
+                auto remote_entity = entities[i];
 
-            if (!entity_map.contains(remote_entity)) {
-                continue;
+                auto local_entity = entity_map.find(remote_entity);
+
+                if (local_entity == entt::null) {
+                    continue;
+                }
+
+                if (registry.valid(local_entity) && !registry.all_of<Component>(local_entity) &&
+                    detail::registry_operation_mark(local_entity)) {
+                    local_entities.push_back(local_entity);
+                }
             }
 
-            auto local_entity = entity_map.at(remote_entity);
+            detail::registry_operation_unmark(local_entities);
+            registry.insert<Component>(local_entities.begin(), local_entities.end());
+        } else {
+            static thread_local std::vector<Component> local_components;
+            local_components.clear();
+            auto *comps = as_components(components);
+            auto map_children = has_child_entities();
+            auto skipped = false;
+
+            for (size_t i = 0; i < count; ++i) {
+                auto local_entity = entity_map.find(entities[i]);
+                auto eligible = false;
+
+                if (local_entity != entt::null && registry.valid(local_entity) &&
+                    !registry.all_of<Component>(local_entity) &&
+                    detail::registry_operation_mark(local_entity)) {
+                    local_entities.push_back(local_entity);
+                    eligible = true;
+                }
 
-            if (!registry.valid(local_entity) || registry.all_of<Component>(local_entity)) {
-                continue;
+                if (eligible) {
+                    // Components are only copied if the child entities have
+                    // to be mapped or if an entity was skipped, in which case
+                    // the components are no longer aligned with the entities.
+                    if (map_children) {
+                        auto &comp = local_components.emplace_back(comps[i]);
+                        internal::map_child_entity(registry, entity_map, comp);
+                    } else if (skipped) {
+                        local_components.push_back(comps[i]);
+                    }
+                } else if (!skipped && !map_children) {
+                    // All previous entities were eligible.
+                    skipped = true;
+                    local_components.assign(comps, comps + i);
+                }
             }
 
-            if constexpr(std::is_empty_v<Component>) {
-                registry.emplace<Component>(local_entity);
+            detail::registry_operation_unmark(local_entities);
+
+            if (map_children || skipped) {
+                EDYN_ASSERT(local_components.size() == local_entities.size());
+                registry.insert<Component>(local_entities.begin(), local_entities.end(),
+                                           local_components.begin());
+                local_components.clear();
             } else {
-                auto comp = components[i];
-                internal::map_child_entity(registry, entity_map, comp);
-                registry.emplace<Component>(local_entity, comp);
+                // Insert straight from the buffer.
+                registry.insert<Component>(local_entities.begin(), local_entities.end(), comps);
             }
         }
     }
 
-    template<typename T = Component>
-    typename std::enable_if_t<!std::is_empty_v<T>>
-    execute_replace(entt::registry &registry,
-                    const std::vector<entt::entity> &entities,
-                    const entity_map &entity_map) const {
-        EDYN_ASSERT(entities.size() == components.size());
+    void execute_replace(entt::registry &registry,
+                         const entt::entity *entities, const void *components,
+                         size_t count, const entity_map &entity_map) const {
+        // Replace one by one to trigger update signals. Only copy components
+        // if child entities have to be mapped.
+        auto *comps = as_components(components);
+        auto map_children = has_child_entities();
+        auto &storage = registry.storage<Component>();
 
-        for (size_t i = 0; i < entities.size(); ++i) {
+        for (size_t i = 0; i < count; ++i) {
             auto remote_entity = entities[i];
 
-            if (!entity_map.contains(remote_entity)) {
+            auto local_entity = entity_map.find(remote_entity);
+
+            if (local_entity == entt::null) {
                 continue;
             }
 
-            auto local_entity = entity_map.at(remote_entity);
-
-            if (!registry.valid(local_entity) || !registry.all_of<Component>(local_entity)) {
+            if (!registry.valid(local_entity) || !storage.contains(local_entity)) {
                 continue;
             }
 
-            auto comp = components[i];
-            internal::map_child_entity(registry, entity_map, comp);
-            registry.patch<Component>(local_entity, [&](auto &&current) {
-                merge_component(current, comp);
-            });
+            if (map_children) {
+                auto comp = comps[i];
+                internal::map_child_entity(registry, entity_map, comp);
+                registry.patch<Component>(local_entity, [&](auto &&current) {
+                    merge_component(current, comp);
+                });
+            } else {
+                registry.patch<Component>(local_entity, [&](auto &&current) {
+                    merge_component(current, comps[i]);
+                });
+            }
         }
     }
 
-    void execute_remove(entt::registry &registry,
-                        const std::vector<entt::entity> &entities,
-                        const entity_map &entity_map) const {
-        for (auto remote_entity : entities) {
-            if (!entity_map.contains(remote_entity)) {
-                continue;
-            }
+    void execute_remove(entt::registry &registry, const entt::entity *entities,
+                        size_t count, const entity_map &entity_map) const {
+        auto &local_entities = detail::registry_operation_scratch_entities();
+        local_entities.clear();
+        auto &storage = registry.storage<Component>();
+
+        for (size_t i = 0; i < count; ++i) {
+            auto remote_entity = entities[i];
 
-            auto local_entity = entity_map.at(remote_entity);
+            auto local_entity = entity_map.find(remote_entity);
 
-            if (!registry.valid(local_entity)) {
+            if (local_entity == entt::null) {
                 continue;
             }
 
-            registry.remove<Component>(local_entity);
+            if (registry.valid(local_entity) && storage.contains(local_entity)) {
+                local_entities.push_back(local_entity);
+            }
         }
+
+        registry.remove<Component>(local_entities.begin(), local_entities.end());
     }
 
-    template<typename T = Component>
-    typename std::enable_if_t<std::is_same_v<T, entt::entity>>
-    execute_ent_map(const entt::registry &registry,
-                    const std::vector<entt::entity> &entities,
-                    entity_map &entity_map) const {
+    void execute_ent_map(const entt::registry &registry, const entt::entity *entities,
+                         const void *components, size_t count, entity_map &entity_map) const {
         // Component operations are cleverly used to insert entity mappings,
         // thus not requiring a separate means of doing so. Local entities
         // are inserted as components which are related directly to the
         // entity at the same index in the entities array, which is the
         // remote entity.
-        EDYN_ASSERT(entities.size() == components.size());
+        auto *local_entities = static_cast<const entt::entity *>(components);
 
-        for (size_t i = 0; i < entities.size(); ++i) {
+        for (size_t i = 0; i < count; ++i) {
             auto remote_entity = entities[i];
-            auto local_entity = components[i];
+            auto local_entity = local_entities[i];
 
             if (registry.valid(local_entity)) {
                 entity_map.insert(remote_entity, local_entity);
@@ -137,27 +272,29 @@ class component_operation_impl : public component_operation {
     }
 
 public:
-    static constexpr auto is_empty_type = std::is_empty_v<Component>;
-    std::vector<Component> components;
+    static const component_operation_impl & instance() {
+        static const component_operation_impl op;
+        return op;
+    }
 
     void execute(entt::registry &registry, registry_op_type op,
-                 const std::vector<entt::entity> &entities,
-                 entity_map &entity_map) const override {
+                 const entt::entity *entities, const void *components,
+                 size_t count, entity_map &entity_map) const override {
         switch (op) {
         case registry_op_type::emplace:
-            execute_emplace(registry, entities, entity_map);
+            execute_emplace(registry, entities, components, count, entity_map);
             break;
         case registry_op_type::replace:
-            if constexpr(!is_empty_type) {
-                execute_replace(registry, entities, entity_map);
+            if constexpr(!std::is_empty_v<Component>) {
+                execute_replace(registry, entities, components, count, entity_map);
             }
             break;
         case registry_op_type::remove:
-            execute_remove(registry, entities, entity_map);
+            execute_remove(registry, entities, count, entity_map);
             break;
         case registry_op_type::ent_map:
             if constexpr(std::is_same_v<Component, entt::entity>) {
-                execute_ent_map(registry, entities, entity_map);
+                execute_ent_map(registry, entities, components, count, entity_map);
             }
             break;
         default:
@@ -169,135 +306,196 @@ public:
         return entt::type_index<Component>::value();
     }
 
-    void remap(const entity_map &emap) override {
-        if constexpr(!is_empty_type) {
-            for (auto &comp : components) {
-                internal::map_child_entity_no_validation(emap, comp);
+    void remap([[maybe_unused]] void *components, [[maybe_unused]] size_t count,
+               [[maybe_unused]] const entity_map &emap) const override {
+        if constexpr(!std::is_empty_v<Component>) {
+            auto *comps = as_components(components);
+
+            for (size_t i = 0; i < count; ++i) {
+                internal::map_child_entity_no_validation(emap, comps[i]);
             }
         }
     }
+
+    void copy([[maybe_unused]] const void *src, [[maybe_unused]] void *dst,
+              [[maybe_unused]] size_t count) const override {
+        if constexpr(!std::is_empty_v<Component>) {
+            std::uninitialized_copy_n(as_components(src), count, as_components(dst));
+        }
+    }
+
+    void destroy([[maybe_unused]] void *components, [[maybe_unused]] size_t count) const override {
+        if constexpr(!std::is_empty_v<Component>) {
+            std::destroy_n(as_components(components), count);
+        }
+    }
 };
 
 /**
- * @brief An operation to replicate contents of one registry into another.
+ * @brief Header of an operation to replicate contents of one registry into
+ * another. It is followed in memory by an array of entities and then by an
+ * array of components, if any, in the buffer of a
+ * `registry_operation_collection`.
  */
-class registry_operation final {
+struct registry_operation {
+    registry_op_type operation;
 
-    void execute_create(entt::registry &registry, entity_map &entity_map) const {
-        for (auto remote_entity : entities) {
-            if (entity_map.contains(remote_entity)) {
-                continue;
-            }
+    // Number of entities.
+    uint32_t num_entities;
 
-            auto local_entity = registry.create();
-            entity_map.insert(remote_entity, local_entity);
-        }
-    }
+    // Number of components. Equals the number of entities if any.
+    uint32_t num_components;
 
-    void execute_destroy(entt::registry &registry, entity_map &entity_map) const {
-        for (auto remote_entity : entities) {
-            if (!entity_map.contains(remote_entity)) {
-                continue;
-            }
+    // Offset of the components from the start of this header in bytes.
+    uint32_t components_offset;
 
-            auto local_entity = entity_map.at(remote_entity);
-            entity_map.erase(remote_entity);
+    // Size of this operation in bytes, including the header. The next
+    // operation starts at this offset.
+    uint32_t size;
 
-            if (registry.valid(local_entity)) {
-                registry.destroy(local_entity);
-            }
-        }
+    // Operations for the component type. Null for entity operations, i.e.
+    // create and destroy.
+    const component_operation *components;
+
+    const entt::entity * entities() const {
+        return reinterpret_cast<const entt::entity *>(reinterpret_cast<const std::byte *>(this) + sizeof(registry_operation));
     }
 
-public:
-    registry_op_type operation;
-    std::vector<entt::entity> entities;
-    std::shared_ptr<component_operation> components;
+    entt::entity * entities() {
+        return reinterpret_cast<entt::entity *>(reinterpret_cast<std::byte *>(this) + sizeof(registry_operation));
+    }
 
-    void execute(entt::registry &registry, entity_map &entity_map) const {
-        switch (operation) {
-        case registry_op_type::create:
-            execute_create(registry, entity_map);
-            break;
-        case registry_op_type::destroy:
-            execute_destroy(registry, entity_map);
-            break;
-        default:
-            components->execute(registry, operation, entities, entity_map);
-        }
+    const void * component_data() const {
+        return reinterpret_cast<const std::byte *>(this) + components_offset;
     }
 
-    void remap(const entity_map &emap) {
-        for (auto &entity : entities) {
-            entity = emap.at(entity);
-        }
+    void * component_data() {
+        return reinterpret_cast<std::byte *>(this) + components_offset;
+    }
 
-        components->remap(emap);
+    template<typename Component>
+    const Component * get_components() const {
+        EDYN_ASSERT(components && components->get_type_id() == entt::type_index<Component>::value());
+        return static_cast<const Component *>(component_data());
     }
+
+    void execute(entt::registry &registry, entity_map &entity_map) const;
+
+    void remap(const entity_map &emap);
 };
 
+static_assert(sizeof(registry_operation) % alignof(entt::entity) == 0);
+
+/**
+ * @brief A sequence of registry operations encoded in one contiguous buffer.
+ * Each operation consists of a header followed by the entities and components
+ * it operates on. Created by a `registry_operation_builder`. Moving a
+ * collection does not copy the buffer, thus it can be sent to another thread
+ * without allocations.
+ */
 class registry_operation_collection final {
+    template<typename Func>
+    void for_each_operation(Func func) const {
+        for (size_t offset = 0; offset < m_size;) {
+            auto *op = reinterpret_cast<const registry_operation *>(data() + offset);
+            func(*op);
+            offset += op->size;
+        }
+    }
+
+    template<typename Func>
+    void for_each_operation(Func func) {
+        for (size_t offset = 0; offset < m_size;) {
+            auto *op = reinterpret_cast<registry_operation *>(data() + offset);
+            func(*op);
+            offset += op->size;
+        }
+    }
 
     template<typename Component, typename Func>
     void for_each_comp(registry_op_type op_type, Func func) const {
         auto type_id = entt::type_index<Component>::value();
 
-        for (auto &op : operations) {
-            if (op.operation == op_type && op.components && op.components->get_type_id() == type_id) {
-                if constexpr(std::is_empty_v<Component>) {
+        for_each_operation([&](const registry_operation &op) {
+            if (op.operation != op_type || !op.components || op.components->get_type_id() != type_id) {
+                return;
+            }
+
+            auto *entities = op.entities();
+
+            if constexpr(std::is_empty_v<Component>) {
+                if constexpr(std::is_invocable_v<Func, entt::entity>) {
+                    for (size_t i = 0; i < op.num_entities; ++i) {
+                        func(entities[i]);
+                    }
+                }
+            } else {
+                if (op_type == registry_op_type::remove) {
                     if constexpr(std::is_invocable_v<Func, entt::entity>) {
-                        for (auto entity : op.entities) {
-                            func(entity);
+                        for (size_t i = 0; i < op.num_entities; ++i) {
+                            func(entities[i]);
                         }
                     }
                 } else {
-                    if (op_type == registry_op_type::remove) {
-                        if constexpr(std::is_invocable_v<Func, entt::entity>) {
-                            for (auto entity : op.entities) {
-                                func(entity);
-                            }
-                        }
-                    } else {
-                        auto *components = static_cast<component_operation_impl<Component> *>(op.components.get());
-                        EDYN_ASSERT(op.entities.size() == components->components.size());
-                        for (size_t i = 0; i < op.entities.size(); ++i) {
-                            func(op.entities[i], components->components[i]);
-                        }
+                    EDYN_ASSERT(op.num_entities == op.num_components);
+                    auto *components = op.get_components<Component>();
+
+                    for (size_t i = 0; i < op.num_entities; ++i) {
+                        func(entities[i], components[i]);
                     }
                 }
             }
-        }
+        });
     }
 
     template<typename Func>
-    void for_each_entity(registry_op_type op_type,Func func) const {
-        for (auto &op : operations) {
+    void for_each_entity(registry_op_type op_type, Func func) const {
+        for_each_operation([&](const registry_operation &op) {
             if (op.operation == op_type) {
-                for (auto entity : op.entities) {
-                    func(entity);
+                auto *entities = op.entities();
+
+                for (size_t i = 0; i < op.num_entities; ++i) {
+                    func(entities[i]);
                 }
             }
-        }
+        });
     }
 
-public:
-    std::vector<registry_operation> operations;
+    const std::byte * data() const {
+        return reinterpret_cast<const std::byte *>(m_data.get());
+    }
 
-    void execute(entt::registry &registry,
-                 entity_map &entity_map) const {
-        for (auto &op : operations) {
-            op.execute(registry, entity_map);
-        }
+    std::byte * data() {
+        return reinterpret_cast<std::byte *>(m_data.get());
     }
 
-    bool empty() const {
-        for (auto &op : operations) {
-            if (!op.entities.empty()) {
-                return false;
-            }
-        }
+    void destroy_components();
 
-        return true;
+    friend class registry_operation_builder;
+
+public:
+    registry_operation_collection() = default;
+    registry_operation_collection(const registry_operation_collection &);
+    registry_operation_collection(registry_operation_collection &&) noexcept;
+    registry_operation_collection & operator=(const registry_operation_collection &);
+    registry_operation_collection & operator=(registry_operation_collection &&) noexcept;
+    ~registry_operation_collection();
+
+    void execute(entt::registry &registry, entity_map &entity_map) const;
+
+    /**
+     * @brief Replaces all entities by their local counterpart in the given map.
+     * @param emap Entity map where all entities in this collection are mapped.
+     */
+    void remap(const entity_map &emap);
+
+    bool empty() const;
+
+    /**
+     * @brief Size of the encoded operations in bytes.
+     */
+    size_t size_bytes() const {
+        return m_size;
     }
 
     template<typename Func>
@@ -344,6 +542,10 @@ public:
     void ent_map_for_each(Func func) const {
         for_each_comp<entt::entity>(registry_op_type::ent_map, func);
     }
+
+private:
+    std::unique_ptr<registry_operation_block[]> m_data;
+    size_t m_size {0};
 };
 
 }
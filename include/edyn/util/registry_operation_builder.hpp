@@ -1,8 +1,10 @@
 #ifndef EDYN_UTIL_REGISTRY_OPERATION_BUILDER_HPP
 #define EDYN_UTIL_REGISTRY_OPERATION_BUILDER_HPP
 
+#include <new>
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include <entt/entity/registry.hpp>
 #include "edyn/util/registry_operation.hpp"
 
@@ -10,53 +12,118 @@ namespace edyn {
 
 /**
  * @brief Utility to build a registry operation collection bit by bit.
+ * Entities and components are staged in vectors which keep their memory
+ * in between calls to `finish`, which encodes all staged data into the
+ * contiguous buffer of a `registry_operation_collection` in one go.
  */
 class registry_operation_builder {
+    struct staged_components_base {
+        virtual ~staged_components_base() = default;
+        virtual size_t size() const = 0;
+        virtual size_t component_size() const = 0;
+        virtual size_t component_alignment() const = 0;
+        virtual void move_to(void *dst) = 0;
+    };
+
+    template<typename Component>
+    struct staged_components final : staged_components_base {
+        std::vector<Component> components;
+
+        size_t size() const override {
+            return components.size();
+        }
+
+        size_t component_size() const override {
+            return sizeof(Component);
+        }
+
+        size_t component_alignment() const override {
+            return alignof(Component);
+        }
+
+        void move_to(void *dst) override {
+            std::uninitialized_move(components.begin(), components.end(), static_cast<Component *>(dst));
+            components.clear();
+        }
+    };
+
+    struct staged_operation {
+        registry_op_type operation;
+        std::vector<entt::entity> entities;
+        const component_operation *components {nullptr};
+        std::unique_ptr<staged_components_base> staged;
+        // Whether this operation is part of the collection being built.
+        bool active {false};
+    };
+
+    template<typename Component>
+    static std::vector<Component> & get_components(staged_operation &op) {
+        return static_cast<staged_components<Component> *>(op.staged.get())->components;
+    }
+
+    staged_operation & activate(size_t index) {
+        auto &op = operations[index];
+
+        // Operations are executed in the order they are first used since
+        // the last call to `finish`.
+        if (!op.active) {
+            op.active = true;
+            active_operations.push_back(index);
+        }
+
+        return op;
+    }
+
     template<typename Component>
-    registry_operation & find_or_create_component_operation(registry_op_type op_type) {
+    staged_operation & find_or_create_component_operation(registry_op_type op_type) {
         EDYN_ASSERT(op_type == registry_op_type::emplace ||
                     op_type == registry_op_type::replace ||
                     op_type == registry_op_type::remove ||
                     op_type == registry_op_type::ent_map);
 
-        auto type_id = entt::type_index<Component>::value();
+        auto *component_op = &component_operation_impl<Component>::instance();
 
-        for (auto &op : operations) {
-            if (op.operation == op_type && op.components && op.components->get_type_id() == type_id) {
-                return op;
+        for (size_t i = 0; i < operations.size(); ++i) {
+            auto &op = operations[i];
+            if (op.operation == op_type && op.components == component_op) {
+                return activate(i);
             }
         }
 
         auto &op = operations.emplace_back();
         op.operation = op_type;
-        op.components = std::make_unique<component_operation_impl<Component>>();
-        return op;
+        op.components = component_op;
+
+        if constexpr(!std::is_empty_v<Component>) {
+            op.staged = std::make_unique<staged_components<Component>>();
+        }
+
+        return activate(operations.size() - 1);
     }
 
-    registry_operation & find_or_create_entity_operation(registry_op_type op_type) {
+    staged_operation & find_or_create_entity_operation(registry_op_type op_type) {
         EDYN_ASSERT(op_type == registry_op_type::create ||
                     op_type == registry_op_type::destroy);
 
-        for (auto &op : operations) {
-            if (op.operation == op_type) {
-                return op;
+        for (size_t i = 0; i < operations.size(); ++i) {
+            if (operations[i].operation == op_type) {
+                return activate(i);
             }
         }
 
         auto &op = operations.emplace_back();
         op.operation = op_type;
-        return op;
+        return activate(operations.size() - 1);
     }
 
     template<typename Component, typename ViewType>
-    void insert_components(const ViewType &view, registry_operation &op, entt::entity entity) {
+    void insert_components(const ViewType &view, staged_operation &op, entt::entity entity) {
         op.entities.push_back(entity);
 
         if constexpr(!std::is_empty_v<Component>) {
             if (op.operation != registry_op_type::remove) {
                 auto [comp] = view.get(entity);
-                auto *components = static_cast<component_operation_impl<Component> *>(op.components.get());
-                components->components.push_back(comp);
+                get_components<Component>(op).push_back(comp);
             }
         }
     }
@@ -86,6 +153,10 @@ class registry_operation_builder {
         }
     }
 
+    static size_t align_up(size_t size, size_t alignment) {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
 public:
     virtual ~registry_operation_builder() = default;
 
@@ -153,8 +224,7 @@ public:
     void replace(entt::entity entity, const Component &comp) {
         auto &op = find_or_create_component_operation<Component>(registry_op_type::replace);
         op.entities.push_back(entity);
-        auto *components = static_cast<component_operation_impl<Component> *>(op.components.get());
-        components->components.push_back(comp);
+        get_components<Component>(op).push_back(comp);
     }
 
     template<typename Component, typename It>
@@ -216,13 +286,12 @@ public:
     void add_entity_mapping(entt::entity local_entity, entt::entity remote_entity) {
         auto &op = find_or_create_component_operation<entt::entity>(registry_op_type::ent_map);
         op.entities.push_back(local_entity);
-        auto *components = static_cast<component_operation_impl<entt::entity> *>(op.components.get());
-        components->components.push_back(remote_entity);
+        get_components<entt::entity>(op).push_back(remote_entity);
     }
 
     bool empty() const {
-        for (auto &op : operations) {
-            if (!op.entities.empty()) {
+        for (auto index : active_operations) {
+            if (!operations[index].entities.empty()) {
                 return false;
             }
         }
@@ -231,11 +300,84 @@ public:
     }
 
     registry_operation_collection finish() {
-        return registry_operation_collection{std::move(operations)};
+        // Compute size of buffer. Each operation consists of a header, the
+        // entities and the components, aligned such that the next operation
+        // starts at a properly aligned address.
+        size_t total_size = 0;
+
+        for (auto index : active_operations) {
+            auto &op = operations[index];
+
+            if (op.entities.empty()) {
+                continue;
+            }
+
+            auto size = sizeof(registry_operation) + op.entities.size() * sizeof(entt::entity);
+
+            if (op.staged && op.staged->size() > 0) {
+                size = align_up(size, op.staged->component_alignment());
+                size += op.staged->size() * op.staged->component_size();
+            }
+
+            total_size += align_up(size, registry_operation_alignment);
+        }
+
+        auto collection = registry_operation_collection{};
+
+        if (total_size > 0) {
+            collection.m_data.reset(new registry_operation_block[total_size / sizeof(registry_operation_block)]);
+            collection.m_size = total_size;
+        }
+
+        size_t offset = 0;
+
+        for (auto index : active_operations) {
+            auto &op = operations[index];
+            op.active = false;
+
+            if (op.entities.empty()) {
+                continue;
+            }
+
+            auto *header = new (collection.data() + offset) registry_operation;
+            header->operation = op.operation;
+            header->num_entities = static_cast<uint32_t>(op.entities.size());
+            header->num_components = 0;
+            header->components = op.components;
+
+            auto size = sizeof(registry_operation) + op.entities.size() * sizeof(entt::entity);
+            std::copy(op.entities.begin(), op.entities.end(), header->entities());
+            op.entities.clear();
+
+            if (op.staged && op.staged->size() > 0) {
+                EDYN_ASSERT(op.staged->size() == header->num_entities);
+                size = align_up(size, op.staged->component_alignment());
+                header->num_components = header->num_entities;
+                header->components_offset = static_cast<uint32_t>(size);
+                size += op.staged->size() * op.staged->component_size();
+                op.staged->move_to(header->component_data());
+            } else {
+                header->components_offset = static_cast<uint32_t>(size);
+            }
+
+            header->size = static_cast<uint32_t>(align_up(size, registry_operation_alignment));
+            offset += header->size;
+        }
+
+        EDYN_ASSERT(offset == total_size);
+        active_operations.clear();
+
+        return collection;
     }
 
 private:
-    std::vector<registry_operation> operations;
+    // Staged operations. They are kept in between calls to `finish` to reuse
+    // memory.
+    std::vector<staged_operation> operations;
+
+    // Indices of staged operations used since the last call to `finish` in
+    // order of first use.
+    std::vector<size_t> active_operations;
 };
 
 template<typename... Components>
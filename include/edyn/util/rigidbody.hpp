@@ -62,6 +62,10 @@ struct rigidbody_def {
     // Mark all contacts involving this rigid body as continuous.
     bool continuous_contacts {false};
 
+    // Enable continuous collision detection for this rigid body to prevent
+    // it from tunneling through others when moving fast.
+    bool ccd {false};
+
     // Whether this entity will be used for presentation and needs
     // position/orientation interpolation.
     bool presentation {true};
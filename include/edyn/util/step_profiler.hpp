@@ -0,0 +1,166 @@
+#ifndef EDYN_UTIL_STEP_PROFILER_HPP
+#define EDYN_UTIL_STEP_PROFILER_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+
+namespace edyn {
+
+/**
+ * @brief Stages of a simulation step which are measured by the profiler.
+ */
+enum class profile_stage : uint8_t {
+    // Stages executed by island workers.
+    begin_step,
+    broadphase,
+    narrowphase,
+    solver,
+    finish_step,
+    // Stages executed by the island coordinator in the main thread.
+    coordinator_update,
+    coordinator_sync
+};
+
+/**
+ * @brief Get a human readable name for a profile stage.
+ * @param stage The stage.
+ * @return Null-terminated name of the stage.
+ */
+const char * profile_stage_name(profile_stage stage);
+
+/**
+ * @brief Counters associated with a profile sample. Only the counters which
+ * are relevant to the stage are filled, the others remain zero.
+ */
+struct profile_counters {
+    // Number of constraint rows solved in the solver stage.
+    uint32_t num_rows {0};
+    // Number of contact manifolds and contact points after the narrow-phase.
+    uint32_t num_manifolds {0};
+    uint32_t num_contact_points {0};
+    // Number of AABB tree nodes moved in the broad-phase.
+    uint32_t num_tree_moves {0};
+    // Size of registry operations sent in the finish step and coordinator sync.
+    uint32_t reg_op_bytes {0};
+};
+
+/**
+ * @brief Timing information for one stage of one island.
+ */
+struct profile_sample {
+    // Island entity in the main registry. Null for coordinator stages.
+    entt::entity island {entt::null};
+    profile_stage stage;
+    // Identifier of the thread where the stage finished.
+    uint32_t thread_id;
+    // Value of `performance_time()` when the stage started.
+    double start_time;
+    // Wall time in seconds. For stages which run asynchronously, this also
+    // includes the time spent waiting for the parallel jobs to be scheduled.
+    double duration;
+    profile_counters counters;
+};
+
+/**
+ * @brief Collects profile samples recorded concurrently by island workers
+ * and the coordinator in a bounded lock-free ring buffer. Multiple threads
+ * can record samples at the same time and a single thread consumes them.
+ * Samples recorded while the ring is full are dropped and counted.
+ */
+class step_profiler {
+public:
+    /**
+     * @param capacity Maximum number of samples that can be stored before
+     * they're consumed. Rounded up to a power of two.
+     */
+    explicit step_profiler(size_t capacity = 16384);
+
+    step_profiler(const step_profiler &) = delete;
+    step_profiler & operator=(const step_profiler &) = delete;
+
+    /**
+     * @brief Insert a sample. Thread-safe and lock-free.
+     * @param sample The sample.
+     * @return False if the ring is full and the sample was dropped.
+     */
+    bool record(const profile_sample &sample);
+
+    /**
+     * @brief Insert a sample for a stage which started at the given time and
+     * ends now, in the calling thread.
+     * @param island Island entity in the main registry or null.
+     * @param stage Profiled stage.
+     * @param start_time Value of `performance_time()` when the stage started.
+     * @param counters Stage counters.
+     * @return False if the ring is full and the sample was dropped.
+     */
+    bool record(entt::entity island, profile_stage stage,
+                double start_time, const profile_counters &counters = {});
+
+    /**
+     * @brief Move all recorded samples into a vector. Must be called by one
+     * thread at a time.
+     * @param samples Samples are appended to this vector.
+     * @return Number of samples appended.
+     */
+    size_t consume(std::vector<profile_sample> &samples);
+
+    /**
+     * @brief Number of samples dropped because the ring was full.
+     */
+    size_t num_dropped() const;
+
+    /**
+     * @brief Identifier of the calling thread to be assigned to samples.
+     */
+    static uint32_t current_thread_id();
+
+private:
+    struct cell {
+        std::atomic<size_t> sequence;
+        profile_sample sample;
+    };
+
+    size_t m_mask;
+    std::unique_ptr<cell[]> m_cells;
+    alignas(64) std::atomic<size_t> m_enqueue_pos {0};
+    alignas(64) std::atomic<size_t> m_dequeue_pos {0};
+    alignas(64) std::atomic<size_t> m_num_dropped {0};
+};
+
+/**
+ * @brief Records a sample for a stage when it goes out of scope, if a
+ * profiler is provided. Counters can be assigned before that happens.
+ */
+class profile_scope {
+public:
+    profile_scope(step_profiler *profiler, entt::entity island, profile_stage stage);
+    ~profile_scope();
+
+    profile_counters counters;
+
+private:
+    step_profiler *m_profiler;
+    entt::entity m_island;
+    profile_stage m_stage;
+    double m_start_time;
+};
+
+/**
+ * @brief Write samples in the Chrome trace event format, which can be loaded
+ * in `chrome://tracing` or Perfetto. Each island is shown as a separate
+ * process and each thread as a separate track. Counters are shown as event
+ * arguments.
+ * @param os Output stream.
+ * @param samples Samples to be written.
+ */
+void write_chrome_trace(std::ostream &os, const std::vector<profile_sample> &samples);
+
+}
+
+#endif // EDYN_UTIL_STEP_PROFILER_HPP
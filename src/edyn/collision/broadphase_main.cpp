@@ -23,6 +23,7 @@ broadphase_main::broadphase_main(entt::registry &registry)
     registry.on_construct<static_tag>().connect<&broadphase_main::on_construct_static_kinematic_tag>(*this);
     registry.on_construct<kinematic_tag>().connect<&broadphase_main::on_construct_static_kinematic_tag>(*this);
     registry.on_construct<AABB>().connect<&broadphase_main::on_construct_aabb>(*this);
+    registry.on_update<AABB>().connect<&broadphase_main::on_update_aabb>(*this);
     registry.on_destroy<tree_resident>().connect<&broadphase_main::on_destroy_tree_resident>(*this);
 }
 
@@ -49,6 +50,14 @@ void broadphase_main::on_construct_aabb(entt::registry &registry, entt::entity e
     }
 }
 
+void broadphase_main::on_update_aabb(entt::registry &registry, entt::entity entity) {
+    // AABBs of kinematic entities are replaced when the island workers
+    // report their new state. Keep track of them to move only these nodes.
+    if (registry.any_of<kinematic_tag>(entity)) {
+        m_moved_np_entities.push_back(entity);
+    }
+}
+
 void broadphase_main::on_destroy_tree_resident(entt::registry &registry, entt::entity entity) {
     auto &node = registry.get<tree_resident>(entity);
 
@@ -67,12 +76,21 @@ void broadphase_main::update() {
         m_island_tree.move(node.id, tree_view.root_aabb());
     });
 
-    // Update kinematic AABBs in tree.
-    // TODO: only do this for kinematic entities that had their AABB updated.
-    auto kinematic_aabb_node_view = m_registry->view<tree_resident, AABB, kinematic_tag>();
-    kinematic_aabb_node_view.each([&](tree_resident &node, AABB &aabb) {
-        m_np_tree.move(node.id, aabb);
-    });
+    // Update AABBs of kinematic entities that moved in the tree.
+    auto np_aabb_node_view = m_registry->view<tree_resident, AABB>();
+
+    for (auto entity : m_moved_np_entities) {
+        // Entity might've been destroyed, thus skip it.
+        if (!m_registry->valid(entity) || !np_aabb_node_view.contains(entity)) continue;
+
+        auto [node, aabb] = np_aabb_node_view.get<tree_resident, AABB>(entity);
+
+        if (!node.procedural) {
+            m_np_tree.move(node.id, aabb);
+        }
+    }
+
+    m_moved_np_entities.clear();
 
     // Search for island pairs with intersecting AABBs, i.e. the AABB of the root
     // node of their trees intersect.
@@ -91,6 +109,13 @@ void broadphase_main::update() {
     const auto tree_view_view = m_registry->view<tree_view>();
     const auto multi_resident_view = m_registry->view<multi_island_resident>();
 
+    if (m_registry->ctx().at<settings>().broadphase == broadphase_backend::sweep_and_prune) {
+        update_sweep_and_prune(aabb_view, multi_resident_view, tree_view_view);
+        return;
+    } else if (m_island_sap.size() > 0) {
+        m_island_sap = {};
+    }
+
     if (awake_island_entities.size() > 1) {
         m_pair_results.resize(awake_island_entities.size());
 
@@ -145,6 +170,16 @@ entity_pair_vector broadphase_main::find_intersecting_islands(entt::entity islan
         results.insert(results.end(), pairs.begin(), pairs.end());
     });
 
+    find_intersecting_non_procedural(island_entityA, tree_viewA, island_aabb, aabb_view, resident_view, results);
+
+    return results;
+}
+
+void broadphase_main::find_intersecting_non_procedural(entt::entity island_entity, const tree_view &island_tree,
+                                                       const AABB &island_aabb,
+                                                       const aabb_view_t &aabb_view,
+                                                       const multi_resident_view_t &resident_view,
+                                                       entity_pair_vector &results) const {
     // Query the non-procedural dynamic tree to find static and kinematic
     // entities that are intersecting this island.
     m_np_tree.query(island_aabb, [&](tree_node_id_t id_np) {
@@ -154,15 +189,72 @@ entity_pair_vector broadphase_main::find_intersecting_islands(entt::entity islan
         // because if it is already in, collisions are handled in the
         // island worker.
         auto &resident = resident_view.get<multi_island_resident>(np_entity);
-        if (resident.island_entities.contains(island_entityA)) {
+        if (resident.island_entities.contains(island_entity)) {
             return;
         }
 
-        auto pairs = intersect_island_np(tree_viewA, np_entity, aabb_view);
+        auto pairs = intersect_island_np(island_tree, np_entity, aabb_view);
         results.insert(results.end(), pairs.begin(), pairs.end());
     });
+}
 
-    return results;
+void broadphase_main::update_sweep_and_prune(const aabb_view_t &aabb_view,
+                                             const multi_resident_view_t &resident_view,
+                                             const tree_view_view_t &tree_view_view) {
+    // Sleeping islands are included because awake islands can collide with
+    // them. Inflate by half the threshold so that the sum of both inflations
+    // matches the offset used in the tree queries.
+    m_island_sap.update(tree_view_view.begin(), tree_view_view.end(),
+                        [&](entt::entity entity) { return tree_view_view.contains(entity); },
+                        [&](entt::entity entity) { return tree_view_view.get<tree_view>(entity).root_aabb(); },
+                        m_threshold * scalar(0.5));
+
+    const auto sleeping_view = m_registry->view<sleeping_tag>();
+    m_pair_results.resize(m_island_sap.size());
+
+    // Each pair of islands is visited once. Pairs where both are sleeping
+    // are ignored.
+    auto sweep_island = [&](size_t index) {
+        auto island_entityA = m_island_sap.entity(index);
+        auto &tree_viewA = tree_view_view.get<tree_view>(island_entityA);
+        auto sleepingA = sleeping_view.contains(island_entityA);
+        auto &results = m_pair_results[index];
+
+        m_island_sap.sweep(index, [&](entt::entity island_entityB) {
+            if (sleepingA && sleeping_view.contains(island_entityB)) {
+                return;
+            }
+
+            auto &tree_viewB = tree_view_view.get<tree_view>(island_entityB);
+            auto pairs = intersect_islands(tree_viewA, tree_viewB, aabb_view);
+            results.insert(results.end(), pairs.begin(), pairs.end());
+        });
+
+        if (!sleepingA) {
+            auto island_aabb = tree_viewA.root_aabb().inset(m_aabb_offset);
+            find_intersecting_non_procedural(island_entityA, tree_viewA, island_aabb, aabb_view, resident_view, results);
+        }
+    };
+
+    if (m_island_sap.size() > 1) {
+        parallel_for(size_t{0}, m_island_sap.size(), sweep_island);
+    } else {
+        for (size_t index = 0; index < m_island_sap.size(); ++index) {
+            sweep_island(index);
+        }
+    }
+
+    auto &manifold_map = m_registry->ctx().at<contact_manifold_map>();
+
+    for (auto &results : m_pair_results) {
+        for (auto &pair : results) {
+            if (!manifold_map.contains(pair)) {
+                make_contact_manifold(*m_registry, pair.first, pair.second, m_separation_threshold);
+            }
+        }
+    }
+
+    m_pair_results.clear();
 }
 
 entity_pair_vector broadphase_main::intersect_islands(const tree_view &tree_viewA, const tree_view &tree_viewB,
@@ -184,14 +276,24 @@ entity_pair_vector broadphase_main::intersect_islands_a(const tree_view &tree_vi
     // `tree_viewA` is iterated and for each node an AABB query is performed in
     // `tree_viewB`, thus for better performance `tree_viewA` should be smaller
     // than `tree_viewB`.
+    // Tree views are published by island workers with entities that might
+    // have been destroyed in the meantime, thus these have to be skipped.
     tree_viewA.each([&](const tree_view::tree_node &nodeA) {
         auto entityA = nodeA.entity;
 
+        if (!aabb_view.contains(entityA)) {
+            return;
+        }
+
         auto aabbA = aabb_view.get<AABB>(entityA).inset(m_aabb_offset);
 
         tree_viewB.query(aabbA, [&](tree_node_id_t idB) {
             auto entityB = tree_viewB.get_node(idB).entity;
 
+            if (!aabb_view.contains(entityB)) {
+                return;
+            }
+
             if (should_collide(entityA, entityB) && !manifold_map.contains(entityA, entityB)) {
                 auto &aabbB = aabb_view.get<AABB>(entityB);
 
@@ -214,6 +316,10 @@ entity_pair_vector broadphase_main::intersect_island_np(const tree_view &island_
     island_tree.query(np_aabb, [&](tree_node_id_t idA) {
         auto entity = island_tree.get_node(idA).entity;
 
+        if (!aabb_view.contains(entity)) {
+            return;
+        }
+
         if (should_collide(entity, np_entity) && !manifold_map.contains(entity, np_entity)) {
             auto &aabb = aabb_view.get<AABB>(entity);
 
@@ -6,10 +6,16 @@
 #include "edyn/collision/contact_manifold_map.hpp"
 #include "edyn/collision/tree_view.hpp"
 #include "edyn/comp/tag.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/shapes/paged_mesh_shape.hpp"
 #include "edyn/util/constraint_util.hpp"
+#include "edyn/util/entity_map.hpp"
 #include "edyn/parallel/parallel_for_async.hpp"
 #include "edyn/context/settings.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <atomic>
+#include <utility>
 
 namespace edyn {
 
@@ -17,7 +23,9 @@ broadphase_worker::broadphase_worker(entt::registry &registry)
     : m_registry(&registry)
 {
     registry.on_construct<AABB>().connect<&broadphase_worker::on_construct_aabb>(*this);
+    registry.on_update<AABB>().connect<&broadphase_worker::on_update_aabb>(*this);
     registry.on_destroy<tree_resident>().connect<&broadphase_worker::on_destroy_tree_resident>(*this);
+    registry.on_destroy<contact_manifold>().connect<&broadphase_worker::on_destroy_contact_manifold>(*this);
 }
 
 void broadphase_worker::on_construct_aabb(entt::registry &, entt::entity entity) {
@@ -25,6 +33,21 @@ void broadphase_worker::on_construct_aabb(entt::registry &, entt::entity entity)
     m_new_aabb_entities.push_back(entity);
 }
 
+void broadphase_worker::on_update_aabb(entt::registry &, entt::entity entity) {
+    // AABB was replaced externally instead of being calculated by
+    // `update_aabbs`, thus it's not known how much it moved.
+    m_requery_entities.push_back(entity);
+}
+
+void broadphase_worker::on_destroy_contact_manifold(entt::registry &registry, entt::entity entity) {
+    // The bodies were not queried against each other while the manifold
+    // existed, thus they must be queried again to make sure a new manifold
+    // is created if they approach before moving far enough to be queried.
+    auto &manifold = registry.get<contact_manifold>(entity);
+    m_requery_entities.push_back(manifold.body[0]);
+    m_requery_entities.push_back(manifold.body[1]);
+}
+
 void broadphase_worker::on_destroy_tree_resident(entt::registry &registry, entt::entity entity) {
     auto &node = registry.get<tree_resident>(entity);
 
@@ -52,11 +75,59 @@ void broadphase_worker::init_new_aabb_entities() {
         auto &tree = procedural ? m_tree : m_np_tree;
         tree_node_id_t id = tree.create(aabb, entity);
         m_registry->emplace<tree_resident>(entity, id, procedural);
+        m_requery_entities.push_back(entity);
     }
 
     m_new_aabb_entities.clear();
 }
 
+void broadphase_worker::update_moved_entities() {
+    auto changed_view = m_registry->view<aabb_changed_tag>();
+    auto resident_view = m_registry->view<tree_resident>();
+
+    for (auto entity : m_requery_entities) {
+        // Entity might've been destroyed, thus skip it.
+        if (!m_registry->valid(entity) || !resident_view.contains(entity)) continue;
+
+        resident_view.get<tree_resident>(entity).requery = true;
+
+        if (!changed_view.contains(entity)) {
+            m_registry->emplace<aabb_changed_tag>(entity);
+        }
+    }
+
+    m_requery_entities.clear();
+    m_moved_entities.clear();
+    m_moved_np_entities.clear();
+    m_num_tree_moves = 0;
+
+    // Only update nodes of entities whose AABB changed. Among these, only
+    // the ones that moved far enough since their last query must be queried
+    // again, which skips most of the pairs of entities at rest.
+    const auto requery_offset = vector3_one * -m_requery_margin;
+    auto changed_node_view = m_registry->view<tree_resident, AABB, aabb_changed_tag>();
+    changed_node_view.each([&](entt::entity entity, tree_resident &node, AABB &aabb) {
+        auto &tree = node.procedural ? m_tree : m_np_tree;
+        tree.move(node.id, aabb);
+        ++m_num_tree_moves;
+
+        if (!node.requery && node.query_aabb.inset(requery_offset).contains(aabb)) {
+            return;
+        }
+
+        node.query_aabb = aabb;
+        node.requery = false;
+
+        if (node.procedural) {
+            m_moved_entities.push_back(entity);
+        } else {
+            m_moved_np_entities.push_back(entity);
+        }
+    });
+
+    m_registry->clear<aabb_changed_tag>();
+}
+
 bool broadphase_worker::parallelizable() const {
     return m_registry->view<AABB, procedural_tag>().size_hint() > 1;
 }
@@ -78,71 +149,171 @@ void destroy_separated_manifolds(entt::registry &registry) {
 }
 
 void broadphase_worker::collide_tree(const dynamic_tree &tree, entt::entity entity,
-                                     const AABB &offset_aabb) {
+                                     const AABB &offset_aabb, bool entity_first) {
     auto aabb_view = m_registry->view<AABB>();
     auto &settings = m_registry->ctx().at<edyn::settings>();
     auto &manifold_map = m_registry->ctx().at<contact_manifold_map>();
 
     tree.query(offset_aabb, [&](tree_node_id_t id) {
         auto &node = tree.get_node(id);
-        auto collides = (*settings.should_collide_func)(*m_registry, entity, node.entity);
+        auto [first, second] = entity_first ?
+            std::make_pair(entity, node.entity) : std::make_pair(node.entity, entity);
+        auto collides = (*settings.should_collide_func)(*m_registry, first, second);
 
-        if (collides && !manifold_map.contains(entity, node.entity)) {
+        if (collides && !manifold_map.contains(first, second)) {
             auto &other_aabb = aabb_view.get<AABB>(node.entity);
 
             if (intersect(offset_aabb, other_aabb)) {
-                make_contact_manifold(*m_registry, entity, node.entity, m_separation_threshold);
+                make_contact_manifold(*m_registry, first, second, m_separation_threshold);
             }
         }
     });
 }
 
 void broadphase_worker::collide_tree_async(const dynamic_tree &tree, entt::entity entity,
-                                           const AABB &offset_aabb, size_t result_index) {
+                                           const AABB &offset_aabb, size_t result_index,
+                                           bool entity_first) {
     auto aabb_view = m_registry->view<AABB>();
     auto &settings = m_registry->ctx().at<edyn::settings>();
 
     tree.query(offset_aabb, [&](tree_node_id_t id) {
         auto &node = tree.get_node(id);
+        auto [first, second] = entity_first ?
+            std::make_pair(entity, node.entity) : std::make_pair(node.entity, entity);
 
-        if ((*settings.should_collide_func)(*m_registry, entity, node.entity)) {
+        if ((*settings.should_collide_func)(*m_registry, first, second)) {
             auto &other_aabb = aabb_view.get<AABB>(node.entity);
 
             if (intersect(offset_aabb, other_aabb)) {
-                m_pair_results[result_index].emplace_back(entity, node.entity);
+                m_pair_results[result_index].emplace_back(first, second);
             }
         }
     });
 }
 
+void broadphase_worker::collide_sap(size_t index) {
+    auto &settings = m_registry->ctx().at<edyn::settings>();
+    auto &manifold_map = m_registry->ctx().at<contact_manifold_map>();
+    auto entity = m_sap.entity(index);
+
+    m_sap.sweep(index, [&](entt::entity other) {
+        if ((*settings.should_collide_func)(*m_registry, entity, other) &&
+            !manifold_map.contains(entity, other)) {
+            make_contact_manifold(*m_registry, entity, other, m_separation_threshold);
+        }
+    });
+}
+
+void broadphase_worker::collide_sap_async(size_t index) {
+    auto &settings = m_registry->ctx().at<edyn::settings>();
+    auto entity = m_sap.entity(index);
+
+    m_sap.sweep(index, [&](entt::entity other) {
+        if ((*settings.should_collide_func)(*m_registry, entity, other)) {
+            m_pair_results[index].emplace_back(entity, other);
+        }
+    });
+}
+
+bool broadphase_worker::use_sweep_and_prune() const {
+    return m_registry->ctx().at<edyn::settings>().broadphase == broadphase_backend::sweep_and_prune;
+}
+
+void broadphase_worker::prefetch_paged_meshes() {
+    auto &settings = m_registry->ctx().at<edyn::settings>();
+    auto horizon = settings.paged_mesh_prefetch_horizon;
+
+    if (horizon <= 0 || settings.paged_mesh_max_prefetch_loads == 0) {
+        return;
+    }
+
+    auto paged_mesh_view = m_registry->view<paged_mesh_shape>();
+
+    if (paged_mesh_view.empty()) {
+        return;
+    }
+
+    // Request the submeshes a moving body will touch before it gets there, by
+    // sweeping its AABB along its velocity. Submeshes around bodies at rest
+    // are loaded when the narrow-phase visits them.
+    auto body_view = m_registry->view<AABB, linvel, dynamic_tag>();
+    auto offset = vector3_one * -contact_breaking_threshold;
+
+    paged_mesh_view.each([&](paged_mesh_shape &shape) {
+        body_view.each([&](AABB &aabb, linvel &vel) {
+            auto displacement = vel * horizon;
+
+            if (length_sqr(displacement) < square(contact_breaking_threshold)) {
+                return;
+            }
+
+            auto swept_aabb = enclosing_aabb(aabb, {aabb.min + displacement, aabb.max + displacement});
+            shape.trimesh->prefetch(swept_aabb.inset(offset), settings.paged_mesh_max_prefetch_loads);
+        });
+    });
+}
+
 void broadphase_worker::common_update() {
     init_new_aabb_entities();
     destroy_separated_manifolds(*m_registry);
 
-    // Update AABBs of procedural nodes in the dynamic tree.
-    auto proc_aabb_node_view = m_registry->view<tree_resident, AABB, procedural_tag>();
-    proc_aabb_node_view.each([&](tree_resident &node, AABB &aabb) {
-        m_tree.move(node.id, aabb);
-    });
+    if (!use_sweep_and_prune() && m_sap.size() > 0) {
+        // Sweep-and-prune does not keep track of the last queries, thus all
+        // entities must be queried after switching back to the trees.
+        m_sap = {};
+        auto resident_view = m_registry->view<tree_resident>();
+        m_requery_entities.insert(m_requery_entities.end(), resident_view.begin(), resident_view.end());
+    }
 
-    // Update kinematic AABBs in non-procedural tree.
-    // TODO: only do this for kinematic entities that had their AABB updated.
-    auto kinematic_aabb_node_view = m_registry->view<tree_resident, AABB, kinematic_tag>();
-    kinematic_aabb_node_view.each([&](tree_resident &node, AABB &aabb) {
-        m_np_tree.move(node.id, aabb);
-    });
+    update_moved_entities();
+
+    // The procedural tree is still kept up to date when using sweep-and-prune
+    // since its view is used in the coordinator and for raycasts.
+    if (use_sweep_and_prune()) {
+        // Inflate by half the threshold so that the sum of both inflations
+        // matches the offset used in the tree queries.
+        auto aabb_proc_view = m_registry->view<AABB, procedural_tag>();
+        m_sap.update(aabb_proc_view.begin(), aabb_proc_view.end(),
+                     [&](entt::entity entity) { return aabb_proc_view.contains(entity); },
+                     [&](entt::entity entity) { return aabb_proc_view.get<AABB>(entity); },
+                     contact_breaking_threshold * scalar(0.5));
+    }
+
+    prefetch_paged_meshes();
 }
 
 void broadphase_worker::update() {
     common_update();
 
-    // Search for new AABB intersections and create manifolds.
-    auto aabb_proc_view = m_registry->view<AABB, procedural_tag>();
-    aabb_proc_view.each([&](entt::entity entity, AABB &aabb) {
-        auto offset_aabb = aabb.inset(m_aabb_offset);
+    if (use_sweep_and_prune()) {
+        auto aabb_view = m_registry->view<AABB>();
+
+        for (size_t index = 0; index < m_sap.size(); ++index) {
+            collide_sap(index);
+
+            auto entity = m_sap.entity(index);
+            auto offset_aabb = aabb_view.get<AABB>(entity).inset(m_aabb_offset);
+            collide_tree(m_np_tree, entity, offset_aabb);
+        }
+
+        return;
+    }
+
+    // Search for new AABB intersections of entities that moved and create
+    // manifolds. Non-procedural entities only have to be queried against
+    // the procedural tree and go second in the pair.
+    auto aabb_view = m_registry->view<AABB>();
+
+    for (auto entity : m_moved_entities) {
+        auto offset_aabb = aabb_view.get<AABB>(entity).inset(m_query_offset);
         collide_tree(m_tree, entity, offset_aabb);
         collide_tree(m_np_tree, entity, offset_aabb);
-    });
+    }
+
+    for (auto entity : m_moved_np_entities) {
+        auto offset_aabb = aabb_view.get<AABB>(entity).inset(m_query_offset);
+        collide_tree(m_tree, entity, offset_aabb, false);
+    }
 }
 
 void broadphase_worker::update_async(job &completion_job) {
@@ -150,37 +321,118 @@ void broadphase_worker::update_async(job &completion_job) {
 
     common_update();
 
-    auto aabb_proc_view = m_registry->view<AABB, procedural_tag>();
-    size_t count = 0;
-    // Have to iterate the view to get the actual size...
-    aabb_proc_view.each([&count](auto &) { ++count; });
-    m_pair_results.resize(count);
     auto &dispatcher = job_dispatcher::global();
 
-    parallel_for_each_async(dispatcher, aabb_proc_view.begin(), aabb_proc_view.end(), completion_job,
-            [this, aabb_proc_view](entt::entity entity, size_t index) {
-        auto &aabb = aabb_proc_view.get<AABB>(entity);
-        auto offset_aabb = aabb.inset(m_aabb_offset);
-        collide_tree_async(m_tree, entity, offset_aabb, index);
-        collide_tree_async(m_np_tree, entity, offset_aabb, index);
+    if (use_sweep_and_prune()) {
+        if (m_sap.size() == 0) {
+            dispatcher.async(completion_job);
+            return;
+        }
+
+        m_pair_results.resize(m_sap.size());
+        auto aabb_view = m_registry->view<AABB>();
+
+        parallel_for_async(dispatcher, size_t{0}, m_sap.size(), size_t{1}, completion_job,
+                [this, aabb_view](size_t index) {
+            collide_sap_async(index);
+
+            auto entity = m_sap.entity(index);
+            auto offset_aabb = aabb_view.get<AABB>(entity).inset(m_aabb_offset);
+            collide_tree_async(m_np_tree, entity, offset_aabb, index);
+        });
+
+        return;
+    }
+
+    auto num_moved = m_moved_entities.size() + m_moved_np_entities.size();
+
+    if (num_moved == 0) {
+        dispatcher.async(completion_job);
+        return;
+    }
+
+    m_pair_results.resize(num_moved);
+    auto aabb_view = m_registry->view<AABB>();
+
+    parallel_for_async(dispatcher, size_t{0}, num_moved, size_t{1}, completion_job,
+            [this, aabb_view](size_t index) {
+        if (index < m_moved_entities.size()) {
+            auto entity = m_moved_entities[index];
+            auto offset_aabb = aabb_view.get<AABB>(entity).inset(m_query_offset);
+            collide_tree_async(m_tree, entity, offset_aabb, index);
+            collide_tree_async(m_np_tree, entity, offset_aabb, index);
+        } else {
+            auto entity = m_moved_np_entities[index - m_moved_entities.size()];
+            auto offset_aabb = aabb_view.get<AABB>(entity).inset(m_query_offset);
+            collide_tree_async(m_tree, entity, offset_aabb, index, false);
+        }
     });
 }
 
 void broadphase_worker::finish_async_update() {
     auto &manifold_map = m_registry->ctx().at<contact_manifold_map>();
+    m_new_pairs.clear();
 
     for (auto &pairs : m_pair_results) {
-        for (auto &pair : pairs) {
-            if (!manifold_map.contains(pair.first, pair.second)) {
-                make_contact_manifold(*m_registry, pair.first, pair.second, m_separation_threshold);
+        m_pair_contained.resize(pairs.size());
+        manifold_map.contains_many(pairs.begin(), pairs.end(), m_pair_contained.begin());
+
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            if (!m_pair_contained[i]) {
+                m_new_pairs.push_back(pairs[i]);
             }
         }
+
         pairs.clear();
     }
+
+    if (m_new_pairs.empty()) {
+        return;
+    }
+
+    // The same pair could have been found from both sides. Remove duplicates
+    // while keeping the first occurrence, so the order of the bodies in the
+    // manifold is the same as if they were created one by one.
+    auto unordered_less = [](const entity_pair &a, const entity_pair &b) {
+        return std::minmax(a.first, a.second) < std::minmax(b.first, b.second);
+    };
+    std::stable_sort(m_new_pairs.begin(), m_new_pairs.end(), unordered_less);
+    m_new_pairs.erase(std::unique(m_new_pairs.begin(), m_new_pairs.end(),
+        [&](const entity_pair &a, const entity_pair &b) {
+            return !unordered_less(a, b) && !unordered_less(b, a);
+        }), m_new_pairs.end());
+
+    m_new_manifolds.clear();
+    make_contact_manifolds(*m_registry, m_new_pairs, m_separation_threshold, m_new_manifolds);
 }
 
 tree_view broadphase_worker::view() const {
     return m_tree.view();
 }
 
+tree_view broadphase_worker::publish_view(const entity_map &emap) {
+    // The last published buffer is still referenced by the island worker's
+    // registry and the one before that is usually released by the
+    // coordinator by now. If the next buffer is still in use, replace it
+    // with a new one and let the remaining views keep the old one alive.
+    m_view_buffer_index = (m_view_buffer_index + 1) % m_view_buffers.size();
+    auto &buffer = m_view_buffers[m_view_buffer_index];
+
+    if (buffer && buffer.use_count() == 1) {
+        // Synchronize with the release of the last view in another thread
+        // before writing into the buffer.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } else {
+        auto capacity = buffer ? buffer->capacity() : size_t{0};
+        buffer = std::make_shared<tree_view::node_vector>();
+        buffer->reserve(capacity);
+    }
+
+    auto root_id = m_tree.copy_nodes(*buffer, [&](entt::entity entity) {
+        return emap.find_other(entity);
+    });
+
+    return {std::shared_ptr<const tree_view::node_vector>(buffer), root_id};
+}
+
 }
@@ -5,48 +5,144 @@
 #include "edyn/math/transform.hpp"
 #include "edyn/math/constants.hpp"
 #include "edyn/util/shape_util.hpp"
+#include "edyn/collision/polyhedron_collision_cache.hpp"
+#include "edyn/collision/gjk_epa.hpp"
+#include "edyn/config/constants.hpp"
 
 namespace edyn {
 
-// Finds the direction that maximizes the projected distance between
-// A and B among all face normals of A.
+namespace {
+    struct separating_axis {
+        vector3 dir;
+        scalar distance;
+        scalar projectionA;
+        scalar projectionB;
+    };
+}
+
+// Calculates the distance between A and B along a face normal of A. The
+// support vertex of B is searched starting at `supportB`, which is updated.
+static
+separating_axis face_axis(const polyhedron_shape &shA, const rotated_mesh &rotatedA, const vector3 &posA,
+                          const polyhedron_shape &shB, const rotated_mesh &rotatedB, const vector3 &posB,
+                          size_t normal_idx, uint32_t &supportB) {
+    auto normal_world = -rotatedA.relevant_normals[normal_idx]; // Normal pointing towards A.
+    auto vertexA = rotatedA.vertices[shA.mesh->relevant_indices[normal_idx]];
+    auto projA = dot(vertexA + posA, normal_world);
+
+    // Find point on B that's furthest along the opposite direction
+    // of the face normal.
+    supportB = shB.mesh->support_vertex_index(rotatedB.vertices, normal_world, supportB);
+    auto projB = dot(rotatedB.vertices[supportB] + posB, normal_world);
+
+    return {normal_world, projA - projB, projA, projB};
+}
+
+// Calculates the distance between A and B along the cross product of an edge
+// of A and an edge of B. Returns false if the edges are parallel.
+static
+bool edge_axis(const polyhedron_shape &shA, const rotated_mesh &rotatedA, const vector3 &posA,
+               const polyhedron_shape &shB, const rotated_mesh &rotatedB, const vector3 &posB,
+               size_t edge_idxA, size_t edge_idxB, uint32_t &supportA, uint32_t &supportB,
+               separating_axis &axis) {
+    auto dir = cross(rotatedA.relevant_edges[edge_idxA], rotatedB.relevant_edges[edge_idxB]);
+
+    if (!try_normalize(dir)) {
+        return false;
+    }
+
+    if (dot(posA - posB, dir) < 0) {
+        // Make it point towards A.
+        dir *= -1;
+    }
+
+    supportA = shA.mesh->support_vertex_index(rotatedA.vertices, -dir, supportA);
+    supportB = shB.mesh->support_vertex_index(rotatedB.vertices, dir, supportB);
+    auto projA = dot(rotatedA.vertices[supportA] + posA, dir);
+    auto projB = dot(rotatedB.vertices[supportB] + posB, dir);
+    axis = {dir, projA - projB, projA, projB};
+
+    return true;
+}
+
+// Calculates the distance along the axis stored in the cache. Returns false
+// if the axis is not valid anymore.
 static
-void max_support_direction(const polyhedron_shape &shA, const rotated_mesh &rotatedA, const vector3 &posA,
-                           const polyhedron_shape &shB, const rotated_mesh &rotatedB, const vector3 &posB,
-                           vector3 &dir, scalar &distance, scalar &projectionA, scalar &projectionB) {
-    scalar max_proj_A = EDYN_SCALAR_MAX;
-    scalar max_proj_B = -EDYN_SCALAR_MAX;
-    scalar max_distance = -EDYN_SCALAR_MAX;
-    auto best_dir = vector3_zero;
-
-    for (size_t i = 0; i < rotatedA.relevant_normals.size(); ++i) {
-        auto normal_world = -rotatedA.relevant_normals[i]; // Normal pointing towards A.
-        auto vertexA = rotatedA.vertices[shA.mesh->relevant_indices[i]];
-        auto vertex_world = vertexA + posA;
-        auto projA = dot(vertex_world, normal_world);
-
-        // Find point on B that's furthest along the opposite direction
-        // of the face normal.
-        auto projB = point_cloud_support_projection(rotatedB.vertices, normal_world) + dot(posB, normal_world);
-
-        auto dist = projA - projB;
-
-        if (dist > max_distance) {
-            max_distance = dist;
-            max_proj_A = projA;
-            max_proj_B = projB;
-            best_dir = normal_world;
+bool cached_axis(const polyhedron_shape &shA, const rotated_mesh &rmeshA, const vector3 &posA,
+                 const polyhedron_shape &shB, const rotated_mesh &rmeshB, const vector3 &posB,
+                 polyhedron_collision_cache &cache, separating_axis &axis) {
+    using axis_type = polyhedron_collision_cache::axis_type;
+
+    switch (cache.type) {
+    case axis_type::face_A:
+        if (cache.indexA >= rmeshA.relevant_normals.size()) {
+            return false;
         }
+        axis = face_axis(shA, rmeshA, posA, shB, rmeshB, posB, cache.indexA, cache.supportB);
+        return true;
+    case axis_type::face_B:
+        if (cache.indexB >= rmeshB.relevant_normals.size()) {
+            return false;
+        }
+        axis = face_axis(shB, rmeshB, posB, shA, rmeshA, posA, cache.indexB, cache.supportA);
+        // Signs must be flipped because parameters were swapped above.
+        axis.dir *= -1;
+        axis.projectionA *= -1;
+        axis.projectionB *= -1;
+        std::swap(axis.projectionA, axis.projectionB);
+        return true;
+    case axis_type::edge:
+        if (cache.indexA >= rmeshA.relevant_edges.size() ||
+            cache.indexB >= rmeshB.relevant_edges.size()) {
+            return false;
+        }
+        return edge_axis(shA, rmeshA, posA, shB, rmeshB, posB,
+                         cache.indexA, cache.indexB, cache.supportA, cache.supportB, axis);
+    default:
+        return false;
     }
+}
 
-    dir = best_dir;
-    distance = max_distance;
-    projectionA = max_proj_A;
-    projectionB = max_proj_B;
+// Whether the transform of B relative to A is close enough to the one when
+// the cached axis was found for it to be used without searching again.
+static bool is_cached_axis_stable(const polyhedron_collision_cache &cache,
+                                  const quaternion &relative_orn, const vector3 &relative_pos) {
+    constexpr auto min_cos_half_angle = scalar(1) - separating_axis_angular_tolerance * separating_axis_angular_tolerance / scalar(8);
+    constexpr auto max_dist_sqr = separating_axis_linear_tolerance * separating_axis_linear_tolerance;
+    return std::abs(dot(relative_orn, cache.relative_orn)) > min_cos_half_angle &&
+           distance_sqr(relative_pos, cache.relative_pos) < max_dist_sqr;
+}
+
+// Finds the axis of minimum separation or penetration using GJK and EPA.
+// Returns false if it failed, in which case the separating axis test must be
+// used.
+static
+bool gjk_epa_axis(const polyhedron_shape &shA, const rotated_mesh &rmeshA, const vector3 &posA,
+                  const polyhedron_shape &shB, const rotated_mesh &rmeshB, const vector3 &posB,
+                  polyhedron_collision_cache &cache, separating_axis &axis) {
+    auto result = gjk_epa_result{};
+
+    if (!gjk_epa(*shA.mesh, rmeshA.vertices, posA, *shB.mesh, rmeshB.vertices, posB,
+                 cache.simplex, result)) {
+        return false;
+    }
+
+    // Projections are calculated the same way as in the separating axis test
+    // so that the closest features can be found in the same manner.
+    auto dir = result.normal;
+    cache.supportA = shA.mesh->support_vertex_index(rmeshA.vertices, -dir, cache.supportA);
+    cache.supportB = shB.mesh->support_vertex_index(rmeshB.vertices, dir, cache.supportB);
+    auto projA = dot(rmeshA.vertices[cache.supportA] + posA, dir);
+    auto projB = dot(rmeshB.vertices[cache.supportB] + posB, dir);
+    axis = {dir, projA - projB, projA, projB};
+
+    return true;
 }
 
 void collide(const polyhedron_shape &shA, const polyhedron_shape &shB,
              const collision_context &ctx, collision_result &result) {
+    using axis_type = polyhedron_collision_cache::axis_type;
+
     // Calculate collision with shape A in the origin for better floating point
     // precision. Position of shape B is modified accordingly.
     const auto posA = vector3_zero;
@@ -60,62 +156,89 @@ void collide(const polyhedron_shape &shA, const polyhedron_shape &shB,
     auto &rmeshA = *shA.rotated;
     auto &rmeshB = *shB.rotated;
 
-    scalar distance = -EDYN_SCALAR_MAX;
-    scalar projectionA = EDYN_SCALAR_MAX;
-    scalar projectionB = -EDYN_SCALAR_MAX;
-    auto sep_axis = vector3_zero;
-
-    // Find best support direction among all face normals of A.
-    max_support_direction(shA, rmeshA, posA, shB, rmeshB, posB,
-                          sep_axis, distance, projectionA, projectionB);
+    // Without a cache, support queries start at the first vertex.
+    auto local_cache = polyhedron_collision_cache{};
+    auto &cache = ctx.polyhedron_cache ? *ctx.polyhedron_cache : local_cache;
+    const auto relative_orn = conjugate(ornA) * ornB;
+    const auto relative_pos = rotate(conjugate(ornA), posB);
+
+    auto best = separating_axis{vector3_zero, -EDYN_SCALAR_MAX, EDYN_SCALAR_MAX, -EDYN_SCALAR_MAX};
+    auto search = true;
+
+    // Meshes with many vertices use GJK and EPA, whose cost grows slowly with
+    // the number of vertices.
+    if (cache.use_gjk_epa && gjk_epa_axis(shA, rmeshA, posA, shB, rmeshB, posB, cache, best)) {
+        search = false;
+    } else if (separating_axis axis; cached_axis(shA, rmeshA, posA, shB, rmeshB, posB, cache, axis)) {
+        // Test the axis found in the previous step first. If it still
+        // separates the shapes there is no collision, and if the shapes barely
+        // moved with respect to each other since it was found, it is still the
+        // best axis.
+        if (axis.distance > threshold) {
+            return;
+        }
 
-    // Find best support direction among all face normals of B.
-    {
-        scalar dist, projA, projB;
-        vector3 dir;
-        max_support_direction(shB, rmeshB, posB, shA, rmeshA, posA,
-                              dir, dist, projB, projA);
-
-        if (dist > distance) {
-            // Signs must be flipped because parameters were swapped above.
-            dir *= -1;
-            projA *= -1;
-            projB *= -1;
-
-            distance = dist;
-            projectionA = projA;
-            projectionB = projB;
-            sep_axis = dir;
+        if (is_cached_axis_stable(cache, relative_orn, relative_pos)) {
+            best = axis;
+            search = false;
         }
     }
 
-    // Edge vs edge.
-    for (auto &edgeA : rmeshA.relevant_edges) {
-        for (auto &edgeB : rmeshB.relevant_edges) {
-            auto dir = cross(edgeA, edgeB);
+    if (search) {
+        auto best_type = axis_type::none;
+        uint32_t best_indexA = 0, best_indexB = 0;
 
-            if (!try_normalize(dir)) {
-                continue;
-            }
+        // Find best support direction among all face normals of A.
+        for (size_t i = 0; i < rmeshA.relevant_normals.size(); ++i) {
+            auto axis = face_axis(shA, rmeshA, posA, shB, rmeshB, posB, i, cache.supportB);
 
-            if (dot(posA - posB, dir) < 0) {
-                // Make it point towards A.
-                dir *= -1;
+            if (axis.distance > best.distance) {
+                best = axis;
+                best_type = axis_type::face_A;
+                best_indexA = i;
             }
+        }
 
-            auto projA = -point_cloud_support_projection(rmeshA.vertices, -dir);
-            auto projB = point_cloud_support_projection(rmeshB.vertices, dir) + dot(posB, dir);
-            auto dist = projA - projB;
+        // Find best support direction among all face normals of B.
+        for (size_t i = 0; i < rmeshB.relevant_normals.size(); ++i) {
+            auto axis = face_axis(shB, rmeshB, posB, shA, rmeshA, posA, i, cache.supportA);
+
+            if (axis.distance > best.distance) {
+                // Signs must be flipped because parameters were swapped above.
+                best = {-axis.dir, axis.distance, -axis.projectionB, -axis.projectionA};
+                best_type = axis_type::face_B;
+                best_indexB = i;
+            }
+        }
 
-            if (dist > distance) {
-                distance = dist;
-                projectionA = projA;
-                projectionB = projB;
-                sep_axis = dir;
+        // Edge vs edge.
+        for (size_t i = 0; i < rmeshA.relevant_edges.size(); ++i) {
+            for (size_t j = 0; j < rmeshB.relevant_edges.size(); ++j) {
+                separating_axis axis;
+
+                if (edge_axis(shA, rmeshA, posA, shB, rmeshB, posB, i, j,
+                              cache.supportA, cache.supportB, axis) &&
+                    axis.distance > best.distance) {
+                    best = axis;
+                    best_type = axis_type::edge;
+                    best_indexA = i;
+                    best_indexB = j;
+                }
             }
         }
+
+        cache.type = best_type;
+        cache.indexA = best_indexA;
+        cache.indexB = best_indexB;
+        cache.relative_orn = relative_orn;
+        cache.relative_pos = relative_pos;
     }
 
+    auto sep_axis = best.dir;
+    auto distance = best.distance;
+    auto projectionA = best.projectionA;
+    auto projectionB = best.projectionB;
+
     if (distance > threshold) {
         return;
     }
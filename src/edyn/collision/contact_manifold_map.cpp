@@ -1,16 +1,113 @@
 #include "edyn/collision/contact_manifold_map.hpp"
 #include "edyn/collision/contact_manifold.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
 
 namespace edyn {
 
+// Minimum number of slots allocated once the first pair is inserted.
+static constexpr size_t min_capacity = 16;
+
 contact_manifold_map::contact_manifold_map(entt::registry &registry) {
     registry.on_construct<contact_manifold>().connect<&contact_manifold_map::on_construct_contact_manifold>(*this);
     registry.on_destroy<contact_manifold>().connect<&contact_manifold_map::on_destroy_contact_manifold>(*this);
 }
 
+size_t contact_manifold_map::find(key_type key) const {
+    if (m_size == 0) {
+        return m_keys.size();
+    }
+
+    const auto mask = m_keys.size() - 1;
+    auto slot = slot_of(key);
+
+    while (m_keys[slot] != empty_key) {
+        if (m_keys[slot] == key) {
+            return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return m_keys.size();
+}
+
+void contact_manifold_map::insert(key_type key, entt::entity value) {
+    // Keep the load factor below 3/4 so probe sequences stay short.
+    if ((m_size + 1) * 4 > m_keys.size() * 3) {
+        rehash(std::max(min_capacity, m_keys.size() * 2));
+    }
+
+    const auto mask = m_keys.size() - 1;
+    auto slot = slot_of(key);
+
+    while (m_keys[slot] != empty_key) {
+        EDYN_ASSERT(m_keys[slot] != key);
+        slot = (slot + 1) & mask;
+    }
+
+    m_keys[slot] = key;
+    m_values[slot] = value;
+    ++m_size;
+}
+
+void contact_manifold_map::erase(key_type key) {
+    auto slot = find(key);
+
+    if (slot == m_keys.size()) {
+        return;
+    }
+
+    // Shift back the following entries of the cluster into the hole, so
+    // no tombstones are needed and lookups never probe deleted slots.
+    const auto mask = m_keys.size() - 1;
+    auto hole = slot;
+    auto next = (hole + 1) & mask;
+
+    while (m_keys[next] != empty_key) {
+        auto ideal = slot_of(m_keys[next]);
+
+        // Move the entry if its ideal slot does not lie cyclically within
+        // (hole, next].
+        if (((next - ideal) & mask) >= ((next - hole) & mask)) {
+            m_keys[hole] = m_keys[next];
+            m_values[hole] = m_values[next];
+            hole = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+
+    m_keys[hole] = empty_key;
+    m_values[hole] = entt::null;
+    --m_size;
+}
+
+void contact_manifold_map::rehash(size_t capacity) {
+    EDYN_ASSERT((capacity & (capacity - 1)) == 0);
+
+    auto keys = std::vector<key_type>(capacity, empty_key);
+    auto values = std::vector<entt::entity>(capacity, entt::entity{entt::null});
+    keys.swap(m_keys);
+    values.swap(m_values);
+
+    m_shift = 64;
+
+    for (auto c = capacity; c > 1; c >>= 1) {
+        --m_shift;
+    }
+
+    m_size = 0;
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] != empty_key) {
+            insert(keys[i], values[i]);
+        }
+    }
+}
+
 bool contact_manifold_map::contains(entity_pair pair) const {
-    return m_pair_map.count(pair) > 0;
+    return find(make_key(pair.first, pair.second)) != m_keys.size();
 }
 
 bool contact_manifold_map::contains(entt::entity first, entt::entity second) const {
@@ -19,7 +116,7 @@ bool contact_manifold_map::contains(entt::entity first, entt::entity second) con
 
 entt::entity contact_manifold_map::get(entity_pair pair) const {
     EDYN_ASSERT(contains(pair));
-    return m_pair_map.at(pair);
+    return m_values[find(make_key(pair.first, pair.second))];
 }
 
 entt::entity contact_manifold_map::get(entt::entity first, entt::entity second) const {
@@ -28,21 +125,16 @@ entt::entity contact_manifold_map::get(entt::entity first, entt::entity second)
 
 void contact_manifold_map::on_construct_contact_manifold(entt::registry &registry, entt::entity entity) {
     auto &manifold = registry.get<contact_manifold>(entity);
-    // Insert all permutations.
-    auto p = std::make_pair(manifold.body[0], manifold.body[1]);
-    auto q = std::make_pair(manifold.body[1], manifold.body[0]);
-    EDYN_ASSERT(m_pair_map.count(p) == 0 && m_pair_map.count(q) == 0);
-    m_pair_map[p] = entity;
-    m_pair_map[q] = entity;
+    // The key is the same for both permutations.
+    auto key = make_key(manifold.body[0], manifold.body[1]);
+    EDYN_ASSERT(find(key) == m_keys.size());
+    insert(key, entity);
 }
 
 void contact_manifold_map::on_destroy_contact_manifold(entt::registry &registry, entt::entity entity) {
     auto &manifold = registry.get<contact_manifold>(entity);
     // Cleanup cached info.
-    auto p = std::make_pair(manifold.body[0], manifold.body[1]);
-    auto q = std::make_pair(manifold.body[1], manifold.body[0]);
-    m_pair_map.erase(p);
-    m_pair_map.erase(q);
+    erase(make_key(manifold.body[0], manifold.body[1]));
 }
 
 }
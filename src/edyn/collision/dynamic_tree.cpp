@@ -345,14 +345,9 @@ const tree_node & dynamic_tree::get_node(tree_node_id_t id) const {
 }
 
 tree_view dynamic_tree::view() const {
-    std::vector<tree_view::tree_node> view_nodes;
-    view_nodes.reserve(m_nodes.size());
-
-    for (auto &node : m_nodes) {
-        view_nodes.push_back(tree_view::tree_node{node.entity, node.aabb, node.child1, node.child2});
-    }
-
-    return {view_nodes, m_root};
+    tree_view::node_vector view_nodes;
+    copy_nodes(view_nodes, [](entt::entity entity) { return entity; });
+    return {std::move(view_nodes), m_root};
 }
 
 }
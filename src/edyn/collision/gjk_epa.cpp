@@ -0,0 +1,545 @@
+#include "edyn/collision/gjk_epa.hpp"
+#include "edyn/shapes/convex_mesh.hpp"
+#include "edyn/config/config.h"
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <initializer_list>
+
+namespace edyn {
+
+namespace {
+    constexpr unsigned gjk_max_iterations = 64;
+    constexpr unsigned epa_max_iterations = 64;
+
+    // GJK terminates when the distance can't be improved by more than this
+    // fraction of it.
+    constexpr auto gjk_relative_tolerance = scalar(1e-5);
+
+    // Squared distance below which the shapes are considered to intersect.
+    constexpr auto gjk_intersection_distance_sqr = scalar(1e-10);
+
+    // EPA terminates when the polytope can't be expanded by more than this
+    // distance along the normal of the closest face.
+    constexpr auto epa_tolerance = scalar(1e-4);
+
+    // Vertex of the Minkowski difference A - B.
+    struct support_vertex {
+        vector3 point;
+        uint32_t indexA;
+        uint32_t indexB;
+    };
+
+    struct minkowski_difference {
+        const convex_mesh *meshA;
+        const std::vector<vector3> *verticesA;
+        vector3 posA;
+        const convex_mesh *meshB;
+        const std::vector<vector3> *verticesB;
+        vector3 posB;
+
+        // Support queries start at the previous support vertex, which is
+        // usually close since the search direction changes little.
+        uint32_t startA {0};
+        uint32_t startB {0};
+
+        support_vertex make_vertex(uint32_t indexA, uint32_t indexB) const {
+            auto pointA = (*verticesA)[indexA] + posA;
+            auto pointB = (*verticesB)[indexB] + posB;
+            return {pointA - pointB, indexA, indexB};
+        }
+
+        support_vertex support(const vector3 &dir) {
+            startA = meshA->support_vertex_index(*verticesA, dir, startA);
+            startB = meshB->support_vertex_index(*verticesB, -dir, startB);
+            return make_vertex(startA, startB);
+        }
+    };
+
+    struct simplex_vertices {
+        std::array<support_vertex, 4> vertex;
+        size_t size {0};
+
+        bool contains(const support_vertex &v) const {
+            for (size_t i = 0; i < size; ++i) {
+                if (vertex[i].indexA == v.indexA && vertex[i].indexB == v.indexB) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+    };
+
+    struct epa_face {
+        std::array<uint32_t, 3> index;
+        vector3 normal;
+        scalar distance;
+    };
+
+    // Storage of the EPA polytope, which is reused in subsequent calls in the
+    // same thread to avoid allocations in the narrowphase.
+    struct epa_polytope {
+        std::vector<support_vertex> vertices;
+        std::vector<epa_face> faces;
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+    };
+}
+
+// Sets the simplex to the given vertices.
+static void assign_simplex(simplex_vertices &simplex, std::initializer_list<support_vertex> vertices) {
+    simplex.size = 0;
+
+    for (auto &v : vertices) {
+        simplex.vertex[simplex.size++] = v;
+    }
+}
+
+// Reduces a segment to the vertices needed to express its point closest to
+// the origin, which is returned.
+static vector3 closest_point_segment(simplex_vertices &simplex) {
+    auto a = simplex.vertex[0];
+    auto b = simplex.vertex[1];
+    auto ab = b.point - a.point;
+    auto len_sqr = length_sqr(ab);
+    auto t = len_sqr > EDYN_EPSILON * EDYN_EPSILON ? -dot(a.point, ab) / len_sqr : scalar(0);
+
+    if (t <= 0) {
+        assign_simplex(simplex, {a});
+        return a.point;
+    }
+
+    if (t >= 1) {
+        assign_simplex(simplex, {b});
+        return b.point;
+    }
+
+    return a.point + ab * t;
+}
+
+// Reduces a triangle to the vertices needed to express its point closest to
+// the origin, which is returned.
+// Reference: Real-Time Collision Detection - Christer Ericson,
+// Section 5.1.5 - Closest Point on Triangle to Point.
+static vector3 closest_point_triangle(simplex_vertices &simplex) {
+    auto a = simplex.vertex[0];
+    auto b = simplex.vertex[1];
+    auto c = simplex.vertex[2];
+    auto ab = b.point - a.point;
+    auto ac = c.point - a.point;
+
+    auto d1 = -dot(ab, a.point);
+    auto d2 = -dot(ac, a.point);
+
+    if (d1 <= 0 && d2 <= 0) {
+        assign_simplex(simplex, {a});
+        return a.point;
+    }
+
+    auto d3 = -dot(ab, b.point);
+    auto d4 = -dot(ac, b.point);
+
+    if (d3 >= 0 && d4 <= d3) {
+        assign_simplex(simplex, {b});
+        return b.point;
+    }
+
+    auto vc = d1 * d4 - d3 * d2;
+
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        auto t = d1 / (d1 - d3);
+        assign_simplex(simplex, {a, b});
+        return a.point + ab * t;
+    }
+
+    auto d5 = -dot(ab, c.point);
+    auto d6 = -dot(ac, c.point);
+
+    if (d6 >= 0 && d5 <= d6) {
+        assign_simplex(simplex, {c});
+        return c.point;
+    }
+
+    auto vb = d5 * d2 - d1 * d6;
+
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        auto t = d2 / (d2 - d6);
+        assign_simplex(simplex, {a, c});
+        return a.point + ac * t;
+    }
+
+    auto va = d3 * d6 - d5 * d4;
+
+    if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) {
+        auto t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        assign_simplex(simplex, {b, c});
+        return b.point + (c.point - b.point) * t;
+    }
+
+    auto denom = va + vb + vc;
+
+    if (!(denom > EDYN_EPSILON * EDYN_EPSILON)) {
+        // Degenerate triangle. Take the closest of its edges.
+        auto best = simplex_vertices{};
+        auto best_point = vector3_zero;
+        auto best_dist_sqr = std::numeric_limits<scalar>::max();
+
+        for (auto [i, j] : {std::pair{a, b}, std::pair{a, c}, std::pair{b, c}}) {
+            auto segment = simplex_vertices{};
+            assign_simplex(segment, {i, j});
+            auto point = closest_point_segment(segment);
+            auto dist_sqr = length_sqr(point);
+
+            if (dist_sqr < best_dist_sqr) {
+                best = segment;
+                best_point = point;
+                best_dist_sqr = dist_sqr;
+            }
+        }
+
+        simplex = best;
+        return best_point;
+    }
+
+    auto v = vb / denom;
+    auto w = vc / denom;
+    return a.point + ab * v + ac * w;
+}
+
+// Reduces a tetrahedron to the vertices needed to express its point closest
+// to the origin, which is returned in `point`. Returns true if the origin is
+// inside the tetrahedron.
+static bool closest_point_tetrahedron(simplex_vertices &simplex, vector3 &point) {
+    auto &v = simplex.vertex;
+    const std::array<std::array<size_t, 4>, 4> faces = {{
+        {0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}
+    }};
+
+    auto best = simplex_vertices{};
+    auto best_dist_sqr = std::numeric_limits<scalar>::max();
+    auto inside = true;
+
+    for (auto &face : faces) {
+        auto &a = v[face[0]].point;
+        auto normal = cross(v[face[1]].point - a, v[face[2]].point - a);
+        auto sign_origin = -dot(a, normal);
+        auto sign_opposite = dot(v[face[3]].point - a, normal);
+
+        // The origin is outside of this face if it's not on the same side as
+        // the opposite vertex. Faces of a flat tetrahedron are all treated
+        // as outside.
+        if (sign_origin * sign_opposite > 0) {
+            continue;
+        }
+
+        inside = false;
+
+        auto triangle = simplex_vertices{};
+        assign_simplex(triangle, {v[face[0]], v[face[1]], v[face[2]]});
+        auto closest = closest_point_triangle(triangle);
+        auto dist_sqr = length_sqr(closest);
+
+        if (dist_sqr < best_dist_sqr) {
+            best = triangle;
+            best_dist_sqr = dist_sqr;
+            point = closest;
+        }
+    }
+
+    if (!inside) {
+        simplex = best;
+    }
+
+    return inside;
+}
+
+// Reduces the simplex to the vertices needed to express its point closest to
+// the origin, which is returned in `point`. Returns true if the origin is
+// inside the simplex.
+static bool reduce_simplex(simplex_vertices &simplex, vector3 &point) {
+    switch (simplex.size) {
+    case 1:
+        point = simplex.vertex[0].point;
+        return false;
+    case 2:
+        point = closest_point_segment(simplex);
+        return false;
+    case 3:
+        point = closest_point_triangle(simplex);
+        return false;
+    default:
+        return closest_point_tetrahedron(simplex, point);
+    }
+}
+
+// Adds vertices to a simplex which contains the origin until it becomes a
+// tetrahedron with non-zero volume. Returns false if that's not possible.
+static bool expand_simplex(simplex_vertices &simplex, minkowski_difference &diff) {
+    constexpr auto min_distance = scalar(1e-6);
+    const std::array<vector3, 3> axes = {vector3_x, vector3_y, vector3_z};
+
+    // Tries the given directions and their opposites and adds the first
+    // support vertex that's further than `min_distance` along the direction
+    // from the current simplex.
+    auto try_add = [&](auto &&get_distance, auto &&dirs) {
+        for (auto dir : dirs) {
+            for (auto sign : {scalar(1), scalar(-1)}) {
+                auto w = diff.support(dir * sign);
+
+                if (!simplex.contains(w) && get_distance(w.point) > min_distance) {
+                    simplex.vertex[simplex.size++] = w;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    };
+
+    if (simplex.size == 1) {
+        auto &a = simplex.vertex[0].point;
+
+        if (!try_add([&](const vector3 &p) { return length(p - a); }, axes)) {
+            return false;
+        }
+    }
+
+    if (simplex.size == 2) {
+        auto &a = simplex.vertex[0].point;
+        auto dir = normalize(simplex.vertex[1].point - a);
+        auto perpendicular = std::array<vector3, 3>{};
+
+        for (size_t i = 0; i < 3; ++i) {
+            perpendicular[i] = cross(dir, axes[i]);
+        }
+
+        if (!try_add([&](const vector3 &p) { return length(cross(p - a, dir)); }, perpendicular)) {
+            return false;
+        }
+    }
+
+    if (simplex.size == 3) {
+        auto &a = simplex.vertex[0].point;
+        auto normal = cross(simplex.vertex[1].point - a, simplex.vertex[2].point - a);
+
+        if (!try_normalize(normal)) {
+            return false;
+        }
+
+        if (!try_add([&](const vector3 &p) { return std::abs(dot(p - a, normal)); },
+                     std::array<vector3, 1>{normal})) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Calculates the penetration depth of intersecting shapes starting from a
+// tetrahedron which contains the origin.
+// Reference: Collision Detection in Interactive 3D Environments - Gino van
+// den Bergen, Section 4.3.8 - Penetration Depth.
+static bool epa(const simplex_vertices &simplex, minkowski_difference &diff,
+                gjk_epa_result &result) {
+    EDYN_ASSERT(simplex.size == 4);
+
+    static thread_local epa_polytope polytope;
+    auto &vertices = polytope.vertices;
+    auto &faces = polytope.faces;
+    auto &edges = polytope.edges;
+    vertices.assign(simplex.vertex.begin(), simplex.vertex.end());
+    faces.clear();
+
+    auto add_face = [&](uint32_t a, uint32_t b, uint32_t c) {
+        auto &pa = vertices[a].point;
+        auto normal = cross(vertices[b].point - pa, vertices[c].point - pa);
+        auto len_sqr = length_sqr(normal);
+
+        if (!(len_sqr > EDYN_EPSILON * EDYN_EPSILON)) {
+            return false;
+        }
+
+        normal /= std::sqrt(len_sqr);
+        faces.push_back({{a, b, c}, normal, dot(normal, pa)});
+        return true;
+    };
+
+    // Orient faces of the tetrahedron outwards.
+    auto &v = vertices;
+    auto volume = dot(cross(v[1].point - v[0].point, v[2].point - v[0].point), v[3].point - v[0].point);
+
+    if (std::abs(volume) < EDYN_EPSILON * EDYN_EPSILON) {
+        return false;
+    }
+
+    if (volume > 0) {
+        std::swap(v[1], v[2]);
+    }
+
+    if (!add_face(0, 1, 2) || !add_face(0, 3, 1) ||
+        !add_face(0, 2, 3) || !add_face(1, 3, 2)) {
+        return false;
+    }
+
+    // The origin must be inside.
+    for (auto &face : faces) {
+        if (face.distance < -epa_tolerance) {
+            return false;
+        }
+    }
+
+    for (unsigned iteration = 0; iteration < epa_max_iterations; ++iteration) {
+        auto closest_idx = size_t{0};
+
+        for (size_t i = 1; i < faces.size(); ++i) {
+            if (faces[i].distance < faces[closest_idx].distance) {
+                closest_idx = i;
+            }
+        }
+
+        auto closest = faces[closest_idx];
+        result.normal = -closest.normal;
+        result.distance = -closest.distance;
+
+        auto w = diff.support(closest.normal);
+
+        if (dot(w.point, closest.normal) - closest.distance < epa_tolerance) {
+            return true;
+        }
+
+        for (auto &vertex : vertices) {
+            if (vertex.indexA == w.indexA && vertex.indexB == w.indexB) {
+                return true;
+            }
+        }
+
+        auto w_idx = static_cast<uint32_t>(vertices.size());
+        vertices.push_back(w);
+
+        // Remove all faces that can be seen from the new vertex and keep the
+        // edges on the boundary of the hole that is left behind.
+        edges.clear();
+
+        for (size_t i = 0; i < faces.size();) {
+            auto &face = faces[i];
+
+            if (dot(face.normal, w.point - vertices[face.index[0]].point) <= 0) {
+                ++i;
+                continue;
+            }
+
+            for (size_t j = 0; j < 3; ++j) {
+                auto edge = std::make_pair(face.index[j], face.index[(j + 1) % 3]);
+                auto reverse = std::make_pair(edge.second, edge.first);
+                auto it = std::find(edges.begin(), edges.end(), reverse);
+
+                if (it != edges.end()) {
+                    *it = edges.back();
+                    edges.pop_back();
+                } else {
+                    edges.push_back(edge);
+                }
+            }
+
+            face = faces.back();
+            faces.pop_back();
+        }
+
+        for (auto [a, b] : edges) {
+            if (!add_face(a, b, w_idx)) {
+                return false;
+            }
+        }
+
+        if (faces.empty()) {
+            return false;
+        }
+    }
+
+    // Use the best estimate if it did not converge.
+    return true;
+}
+
+bool gjk_epa(const convex_mesh &meshA, const std::vector<vector3> &verticesA, const vector3 &posA,
+             const convex_mesh &meshB, const std::vector<vector3> &verticesB, const vector3 &posB,
+             gjk_simplex &cached_simplex, gjk_epa_result &result) {
+    auto diff = minkowski_difference{&meshA, &verticesA, posA, &meshB, &verticesB, posB};
+    auto simplex = simplex_vertices{};
+
+    // Start with the vertices of the previous simplex, which are usually
+    // close to the final ones.
+    for (size_t i = 0; i < cached_simplex.size; ++i) {
+        auto indexA = cached_simplex.indexA[i];
+        auto indexB = cached_simplex.indexB[i];
+
+        if (indexA < verticesA.size() && indexB < verticesB.size()) {
+            auto vertex = diff.make_vertex(indexA, indexB);
+
+            if (!simplex.contains(vertex)) {
+                simplex.vertex[simplex.size++] = vertex;
+            }
+        }
+    }
+
+    if (simplex.size == 0) {
+        simplex.vertex[0] = diff.support(posB - posA);
+        simplex.size = 1;
+    }
+
+    diff.startA = simplex.vertex[0].indexA;
+    diff.startB = simplex.vertex[0].indexB;
+
+    auto point = vector3_zero;
+    auto intersecting = reduce_simplex(simplex, point);
+
+    for (unsigned iteration = 0; !intersecting && iteration < gjk_max_iterations; ++iteration) {
+        auto dist_sqr = length_sqr(point);
+
+        if (dist_sqr < gjk_intersection_distance_sqr) {
+            intersecting = true;
+            break;
+        }
+
+        // The support vertex in the direction of the origin gives a lower
+        // bound on the distance. Stop when it's close to the current estimate.
+        auto w = diff.support(-point);
+
+        if (simplex.contains(w) || dist_sqr - dot(point, w.point) <= gjk_relative_tolerance * dist_sqr) {
+            break;
+        }
+
+        simplex.vertex[simplex.size++] = w;
+        intersecting = reduce_simplex(simplex, point);
+    }
+
+    if (!intersecting && length_sqr(point) < gjk_intersection_distance_sqr) {
+        intersecting = true;
+    }
+
+    auto store_simplex = [&]() {
+        cached_simplex.size = static_cast<uint8_t>(simplex.size);
+
+        for (size_t i = 0; i < simplex.size; ++i) {
+            cached_simplex.indexA[i] = simplex.vertex[i].indexA;
+            cached_simplex.indexB[i] = simplex.vertex[i].indexB;
+        }
+    };
+
+    if (!intersecting) {
+        store_simplex();
+        auto dist = length(point);
+        result.normal = point / dist;
+        result.distance = dist;
+        return true;
+    }
+
+    if (simplex.size < 4 && !expand_simplex(simplex, diff)) {
+        return false;
+    }
+
+    store_simplex();
+
+    return epa(simplex, diff, result);
+}
+
+}
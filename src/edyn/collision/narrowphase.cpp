@@ -4,12 +4,35 @@
 #include "edyn/config/constants.hpp"
 #include "edyn/parallel/parallel_for_async.hpp"
 #include "edyn/comp/material.hpp"
+#include "edyn/comp/dirty.hpp"
+#include "edyn/dynamics/material_mixing.hpp"
+#include "edyn/sys/update_rotated_meshes.hpp"
+#include <algorithm>
 
 namespace edyn {
 
 narrowphase::narrowphase(entt::registry &reg)
     : m_registry(&reg)
-{}
+{
+    reg.on_construct<contact_manifold>().connect<&narrowphase::on_construct_contact_manifold>(*this);
+}
+
+void narrowphase::on_construct_contact_manifold(entt::registry &registry, entt::entity entity) {
+    // Manifolds between polyhedrons keep the separating axis found in the
+    // previous step to speed up the next collision test.
+    auto &manifold = registry.get<contact_manifold>(entity);
+    auto polyhedron_view = registry.view<polyhedron_shape>();
+
+    if (!polyhedron_view.contains(manifold.body[0]) || !polyhedron_view.contains(manifold.body[1])) {
+        return;
+    }
+
+    auto &cache = registry.emplace<polyhedron_collision_cache>(entity);
+    auto &meshA = *polyhedron_view.get<polyhedron_shape>(manifold.body[0]).mesh;
+    auto &meshB = *polyhedron_view.get<polyhedron_shape>(manifold.body[1]).mesh;
+    auto min_vertices = registry.ctx().at<settings>().polyhedron_gjk_epa_min_vertices;
+    cache.use_gjk_epa = std::max(meshA.vertices.size(), meshB.vertices.size()) >= min_vertices;
+}
 
 bool narrowphase::parallelizable() const {
     return m_registry->storage<contact_manifold>().size() > 1;
@@ -24,6 +47,7 @@ void narrowphase::clear_contact_manifold_events() {
 void narrowphase::update() {
     clear_contact_manifold_events();
     update_contact_distances(*m_registry);
+    update_contact_rotated_meshes(*m_registry);
 
     auto manifold_view = m_registry->view<contact_manifold>();
     update_contact_manifolds(manifold_view.begin(), manifold_view.end(), manifold_view);
@@ -32,14 +56,20 @@ void narrowphase::update() {
 void narrowphase::update_async(job &completion_job) {
     clear_contact_manifold_events();
     update_contact_distances(*m_registry);
+    // Must be done before the parallel update since a body can be in more
+    // than one manifold.
+    update_contact_rotated_meshes(*m_registry);
 
     EDYN_ASSERT(parallelizable());
 
     auto manifold_view = m_registry->view<contact_manifold>();
     auto events_view = m_registry->view<contact_manifold_events>();
+    auto polyhedron_cache_view = m_registry->view<polyhedron_collision_cache>();
     auto body_view = m_registry->view<AABB, shape_index, position, orientation>();
     auto tr_view = m_registry->view<position, orientation>();
     auto vel_view = m_registry->view<angvel>();
+    auto linvel_view = m_registry->view<linvel>();
+    auto ccd_view = m_registry->view<ccd_tag>();
     auto rolling_view = m_registry->view<rolling_tag>();
     auto origin_view = m_registry->view<origin>();
     auto material_view = m_registry->view<material>();
@@ -48,63 +78,74 @@ void narrowphase::update_async(job &completion_job) {
     auto paged_mesh_shape_view = m_registry->view<paged_mesh_shape>();
     auto shapes_views_tuple = get_tuple_of_shape_views(*m_registry);
     auto dt = m_registry->ctx().at<settings>().fixed_dt;
+    auto *material_table = &m_registry->ctx().at<material_mix_table>();
 
-    // Resize result collection vectors to allocate one slot for each iteration
-    // of the parallel_for.
-    m_cp_construction_infos.resize(manifold_view.size());
-    m_cp_destruction_infos.resize(manifold_view.size());
+    // Contact points are inserted into the manifolds in parallel since that
+    // does not modify the registry. Only marking the manifolds as dirty is
+    // left for `finish_async_update`.
+    m_manifold_changed.assign(manifold_view.size(), 0);
     auto &dispatcher = job_dispatcher::global();
 
     parallel_for_async(dispatcher, size_t{0}, manifold_view.size(), size_t{1}, completion_job,
-            [this, body_view, tr_view, vel_view, rolling_view, origin_view,
-             manifold_view, events_view, orn_view, material_view, mesh_shape_view,
-             paged_mesh_shape_view, shapes_views_tuple, dt](size_t index) {
+            [this, body_view, tr_view, vel_view, linvel_view, ccd_view, rolling_view, origin_view,
+             manifold_view, events_view, polyhedron_cache_view, orn_view, material_view, mesh_shape_view,
+             paged_mesh_shape_view, shapes_views_tuple, dt, material_table](size_t index) {
         auto entity = manifold_view[index];
         auto [manifold] = manifold_view.get(entity);
         auto [events] = events_view.get(entity);
+        auto *polyhedron_cache = polyhedron_cache_view.contains(entity) ?
+            &polyhedron_cache_view.get<polyhedron_collision_cache>(entity) : nullptr;
         collision_result result;
-        auto &construction_info = m_cp_construction_infos[index];
-        auto &destruction_info = m_cp_destruction_infos[index];
+        auto changed = false;
+
+        if (ccd_view.contains(manifold.body[0]) || ccd_view.contains(manifold.body[1])) {
+            detect_collision_ccd(manifold.body, result, body_view, origin_view,
+                                 linvel_view, vel_view, shapes_views_tuple, dt);
+        } else {
+            detect_collision(manifold.body, result, body_view, origin_view, shapes_views_tuple, polyhedron_cache);
+        }
 
-        detect_collision(manifold.body, result, body_view, origin_view, shapes_views_tuple);
         process_collision(entity, manifold, events, result, tr_view, vel_view,
                           rolling_view, origin_view, orn_view, material_view,
                           mesh_shape_view, paged_mesh_shape_view, dt,
-                          [&construction_info](const collision_result::collision_point &rp) {
-            construction_info.point[construction_info.count++] = rp;
-        }, [&destruction_info](auto pt_id) {
+                          [&](const collision_result::collision_point &rp) {
+            insert_contact_point(manifold, events, rp, orn_view, material_view,
+                                 mesh_shape_view, paged_mesh_shape_view, *material_table);
+            changed = true;
+        }, [&changed]([[maybe_unused]] auto pt_id) {
             EDYN_ASSERT(pt_id < max_contacts);
-            destruction_info.point_id[destruction_info.count++] = pt_id;
+            changed = true;
         });
+
+        m_manifold_changed[index] = changed;
     });
 }
 
 void narrowphase::finish_async_update() {
     auto manifold_view = m_registry->view<contact_manifold>();
+    auto dirty_view = m_registry->view<dirty>();
+    EDYN_ASSERT(m_manifold_changed.size() == manifold_view.size());
 
-    // Destroy contact points.
-    for (size_t i = 0; i < manifold_view.size(); ++i) {
-        auto entity = manifold_view[i];
-        auto &info_result = m_cp_destruction_infos[i];
+    // Assign dirty components in bulk to the changed manifolds which do not
+    // have one yet, which is equivalent to calling `destroy_contact_point`
+    // and `create_contact_point` for each point.
+    m_dirty_entities.clear();
 
-        for (size_t j = 0; j < info_result.count; ++j) {
-            destroy_contact_point(*m_registry, entity, info_result.point_id[j]);
+    for (size_t i = 0; i < manifold_view.size(); ++i) {
+        if (m_manifold_changed[i] && !dirty_view.contains(manifold_view[i])) {
+            m_dirty_entities.push_back(manifold_view[i]);
         }
     }
 
-    // Create contact points.
-    for (size_t i = 0; i < manifold_view.size(); ++i) {
-        auto entity = manifold_view[i];
-        auto &manifold = manifold_view.get<contact_manifold>(entity);
-        auto &info_result = m_cp_construction_infos[i];
+    m_registry->insert<dirty>(m_dirty_entities.begin(), m_dirty_entities.end());
 
-        for (size_t j = 0; j < info_result.count; ++j) {
-            create_contact_point(*m_registry, entity, manifold, info_result.point[j]);
+    for (size_t i = 0; i < manifold_view.size(); ++i) {
+        if (m_manifold_changed[i]) {
+            dirty_view.get<dirty>(manifold_view[i]).updated<contact_manifold, contact_manifold_events>();
         }
     }
 
-    m_cp_destruction_infos.clear();
-    m_cp_construction_infos.clear();
+    m_manifold_changed.clear();
 }
 
 }
@@ -51,7 +51,12 @@ raycast_result raycast(entt::registry &registry, vector3 p0, vector3 p1) {
             auto &tree_view = tree_view_view.get<edyn::tree_view>(island_entity);
             tree_view.raycast(p0, p1, [&](tree_node_id_t id) {
                 auto entity = tree_view.get_node(id).entity;
-                raycast_shape(entity);
+
+                // Entity might have been destroyed after the tree view was
+                // published by the island worker.
+                if (index_view.contains(entity)) {
+                    raycast_shape(entity);
+                }
             });
         });
 
@@ -0,0 +1,75 @@
+#include "edyn/collision/sweep_and_prune.hpp"
+
+namespace edyn {
+
+void sweep_and_prune::sort_and_build(bool full_sort) {
+    // Use the axis chosen in the previous update. The order is only
+    // preserved if the axis remains the same.
+    if (m_axis != m_next_axis) {
+        m_axis = m_next_axis;
+        full_sort = true;
+    }
+
+    const auto axis = m_axis;
+
+    if (full_sort) {
+        std::sort(m_entries.begin(), m_entries.end(), [axis](const entry &a, const entry &b) {
+            return a.aabb.min[axis] < b.aabb.min[axis];
+        });
+    } else {
+        for (size_t i = 1; i < m_entries.size(); ++i) {
+            auto current = m_entries[i];
+            auto key = current.aabb.min[axis];
+            auto j = i;
+
+            while (j > 0 && m_entries[j - 1].aabb.min[axis] > key) {
+                m_entries[j] = m_entries[j - 1];
+                --j;
+            }
+
+            m_entries[j] = current;
+        }
+    }
+
+    const auto count = m_entries.size();
+
+    for (size_t i = 0; i < 3; ++i) {
+        m_min[i].resize(count);
+        m_max[i].resize(count);
+    }
+
+    auto sum = vector3_zero;
+    auto sum_sq = vector3_zero;
+
+    for (size_t k = 0; k < count; ++k) {
+        auto &aabb = m_entries[k].aabb;
+
+        for (size_t i = 0; i < 3; ++i) {
+            m_min[i][k] = aabb.min[i];
+            m_max[i][k] = aabb.max[i];
+        }
+
+        auto center = aabb.center();
+        sum += center;
+        sum_sq += center * center;
+    }
+
+    // Sweep along the axis with the greatest variance in the next update
+    // since that's where the AABBs are most spread out, which results in
+    // fewer candidates per entity.
+    if (count > 0) {
+        auto inv_count = scalar(1) / count;
+        auto variance = sum_sq * inv_count - (sum * inv_count) * (sum * inv_count);
+        m_next_axis = 0;
+
+        if (variance.y > variance[m_next_axis]) {
+            m_next_axis = 1;
+        }
+
+        if (variance.z > variance[m_next_axis]) {
+            m_next_axis = 2;
+        }
+    }
+}
+
+}
@@ -14,6 +14,7 @@
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/dynamics/row_cache.hpp"
 #include "edyn/math/constants.hpp"
+#include "edyn/config/constants.hpp"
 #include "edyn/math/geom.hpp"
 #include "edyn/math/math.hpp"
 #include "edyn/math/transform.hpp"
@@ -150,6 +151,14 @@ void prepare_constraints<contact_constraint>(entt::registry &registry, row_cache
                 // penetration after the following physics update.
                 normal_options.error = cp.distance / dt;
                 normal_row.upper_limit = large_scalar;
+
+                // Speculative contacts created by continuous collision
+                // detection let the bodies close the entire gap in this step
+                // and only bounce once they actually touch.
+                if (cp.distance > contact_breaking_threshold) {
+                    normal_options.erp = 1;
+                    normal_options.restitution = 0;
+                }
             }
 
             prepare_row(normal_row, normal_options, linvelA, angvelA, linvelB, angvelB);
@@ -19,6 +19,7 @@
 #include "edyn/parallel/entity_graph.hpp"
 #include "edyn/comp/graph_node.hpp"
 #include "edyn/context/settings.hpp"
+#include "edyn/config/constants.hpp"
 #include <entt/entity/registry.hpp>
 
 namespace edyn {
@@ -42,6 +43,12 @@ scalar get_manifold_min_relvel(const contact_manifold &manifold, const BodyView
 
     for (size_t pt_idx = 0; pt_idx < manifold.num_points; ++pt_idx) {
         auto &cp = manifold.get_point(pt_idx);
+
+        // Ignore speculative contacts, which are not touching yet.
+        if (cp.distance > contact_breaking_threshold) {
+            continue;
+        }
+
         auto normal = cp.normal;
         auto pivotA = to_world_space(cp.pivotA, originA, ornA);
         auto pivotB = to_world_space(cp.pivotB, originB, ornB);
@@ -142,7 +149,9 @@ bool solve_restitution_iteration(entt::registry &registry, scalar dt, unsigned i
                 normal_row.dvA = &dvA; normal_row.dwA = &dwA;
                 normal_row.dvB = &dvB; normal_row.dwB = &dwB;
                 normal_row.lower_limit = 0;
-                normal_row.upper_limit = large_scalar;
+                // Speculative contacts must not apply any impulse since they
+                // are not touching yet.
+                normal_row.upper_limit = cp.distance > contact_breaking_threshold ? scalar(0) : large_scalar;
 
                 auto normal_options = constraint_row_options{};
                 normal_options.restitution = cp.restitution;
@@ -0,0 +1,253 @@
+#include "edyn/dynamics/row_batch.hpp"
+#include "edyn/dynamics/row_cache.hpp"
+#include "edyn/dynamics/solver.hpp"
+#include "edyn/constraints/constraint_row.hpp"
+#include "edyn/comp/delta_linvel.hpp"
+#include "edyn/comp/delta_angvel.hpp"
+#include "edyn/util/constraint_util.hpp"
+#include "edyn/parallel/parallel_for.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+
+namespace edyn {
+
+void row_batch_cache::clear() {
+    // Clear caches and keep capacity.
+    batches.clear();
+    color_offsets.clear();
+    remainder_rows.clear();
+    body_colors.clear();
+
+    for (auto &rows : color_rows) {
+        rows.clear();
+    }
+}
+
+static bool is_affected_by_impulse(scalar inv_m, const matrix3x3 &inv_I) {
+    return inv_m > 0 || inv_I != matrix3x3_zero;
+}
+
+static void assign_lane(row_batch &batch, size_t lane, size_t row_index, const constraint_row &row) {
+    auto MJ = std::array<vector3, 4>{
+        row.inv_mA * row.J[0], row.inv_IA * row.J[1],
+        row.inv_mB * row.J[2], row.inv_IB * row.J[3]
+    };
+
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            batch.J[i][j][lane] = row.J[i][j];
+            batch.MJ[i][j][lane] = MJ[i][j];
+        }
+    }
+
+    batch.eff_mass[lane] = row.eff_mass;
+    batch.rhs[lane] = row.rhs;
+    batch.row_index[lane] = row_index;
+
+    auto dynamicA = is_affected_by_impulse(row.inv_mA, row.inv_IA);
+    auto dynamicB = is_affected_by_impulse(row.inv_mB, row.inv_IB);
+    batch.dvA[lane] = dynamicA ? row.dvA : nullptr;
+    batch.dwA[lane] = dynamicA ? row.dwA : nullptr;
+    batch.dvB[lane] = dynamicB ? row.dvB : nullptr;
+    batch.dwB[lane] = dynamicB ? row.dwB : nullptr;
+}
+
+void make_row_batches(const row_cache &cache, row_batch_cache &batch_cache) {
+    batch_cache.clear();
+
+    if (batch_cache.color_rows.size() < max_row_colors) {
+        batch_cache.color_rows.resize(max_row_colors);
+    }
+
+    // Greedy coloring. Each row takes the first color that hasn't been taken
+    // by any other row acting on the same dynamic bodies. Bodies which are not
+    // affected by impulses can be shared by any number of rows of the same
+    // color since their delta velocities are never modified.
+    auto &body_colors = batch_cache.body_colors;
+    body_colors.reserve(cache.rows.size());
+
+    for (size_t row_idx = 0; row_idx < cache.rows.size(); ++row_idx) {
+        auto &row = cache.rows[row_idx];
+        auto dynamicA = is_affected_by_impulse(row.inv_mA, row.inv_IA);
+        auto dynamicB = is_affected_by_impulse(row.inv_mB, row.inv_IB);
+        auto taken = uint64_t{0};
+
+        if (dynamicA) {
+            taken |= body_colors[row.dvA];
+        }
+
+        if (dynamicB) {
+            taken |= body_colors[row.dvB];
+        }
+
+        if (taken == ~uint64_t{0}) {
+            batch_cache.remainder_rows.push_back(row_idx);
+            continue;
+        }
+
+        size_t color = 0;
+        while (taken & (uint64_t{1} << color)) {
+            ++color;
+        }
+
+        auto color_bit = uint64_t{1} << color;
+
+        if (dynamicA) {
+            body_colors[row.dvA] |= color_bit;
+        }
+
+        if (dynamicB) {
+            body_colors[row.dvB] |= color_bit;
+        }
+
+        batch_cache.color_rows[color].push_back(row_idx);
+    }
+
+    // Pack rows of each color into batches. Leftover rows which do not fill
+    // a complete batch are solved sequentially.
+    for (auto &rows : batch_cache.color_rows) {
+        if (rows.size() < row_batch_size) {
+            batch_cache.remainder_rows.insert(batch_cache.remainder_rows.end(), rows.begin(), rows.end());
+            continue;
+        }
+
+        batch_cache.color_offsets.push_back(batch_cache.batches.size());
+        auto num_batches = rows.size() / row_batch_size;
+
+        for (size_t i = 0; i < num_batches; ++i) {
+            auto &batch = batch_cache.batches.emplace_back();
+
+            for (size_t lane = 0; lane < row_batch_size; ++lane) {
+                auto row_idx = rows[i * row_batch_size + lane];
+                assign_lane(batch, lane, row_idx, cache.rows[row_idx]);
+            }
+        }
+
+        batch_cache.remainder_rows.insert(batch_cache.remainder_rows.end(),
+                                          rows.begin() + num_batches * row_batch_size, rows.end());
+    }
+
+    batch_cache.color_offsets.push_back(batch_cache.batches.size());
+
+    // Keep remainder rows in their original order to be solved in the same
+    // order as the sequential solver would.
+    std::sort(batch_cache.remainder_rows.begin(), batch_cache.remainder_rows.end());
+}
+
+template<typename T>
+static void gather_lane(const T *v, scalar (&lanes)[3][row_batch_size], size_t lane) {
+    if (v) {
+        lanes[0][lane] = v->x;
+        lanes[1][lane] = v->y;
+        lanes[2][lane] = v->z;
+    } else {
+        lanes[0][lane] = lanes[1][lane] = lanes[2][lane] = scalar(0);
+    }
+}
+
+template<typename T>
+static void scatter_lane(T *v, const scalar (&lanes)[3][row_batch_size], size_t lane) {
+    if (v) {
+        v->x = lanes[0][lane];
+        v->y = lanes[1][lane];
+        v->z = lanes[2][lane];
+    }
+}
+
+void solve_row_batch(const row_batch &batch, row_cache &cache) {
+    constexpr auto N = row_batch_size;
+
+    // Delta velocities gathered into lanes, in the same order as the elements
+    // of the Jacobian.
+    alignas(row_batch_alignment) scalar dv[4][3][N];
+    alignas(row_batch_alignment) scalar lower_limit[N];
+    alignas(row_batch_alignment) scalar upper_limit[N];
+    alignas(row_batch_alignment) scalar impulse[N];
+    alignas(row_batch_alignment) scalar delta_impulse[N];
+
+    for (size_t k = 0; k < N; ++k) {
+        auto &row = cache.rows[batch.row_index[k]];
+        lower_limit[k] = row.lower_limit;
+        upper_limit[k] = row.upper_limit;
+        impulse[k] = row.impulse;
+
+        gather_lane(batch.dvA[k], dv[0], k);
+        gather_lane(batch.dwA[k], dv[1], k);
+        gather_lane(batch.dvB[k], dv[2], k);
+        gather_lane(batch.dwB[k], dv[3], k);
+    }
+
+    // Same operations as in `solve(constraint_row &)`, one lane per row.
+    for (size_t k = 0; k < N; ++k) {
+        auto delta_relvel = scalar(0);
+
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                delta_relvel += batch.J[i][j][k] * dv[i][j][k];
+            }
+        }
+
+        auto new_impulse = impulse[k] + (batch.rhs[k] - delta_relvel) * batch.eff_mass[k];
+        new_impulse = std::min(std::max(new_impulse, lower_limit[k]), upper_limit[k]);
+        delta_impulse[k] = new_impulse - impulse[k];
+        impulse[k] = new_impulse;
+    }
+
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            for (size_t k = 0; k < N; ++k) {
+                dv[i][j][k] += batch.MJ[i][j][k] * delta_impulse[k];
+            }
+        }
+    }
+
+    for (size_t k = 0; k < N; ++k) {
+        cache.rows[batch.row_index[k]].impulse = impulse[k];
+
+        scatter_lane(batch.dvA[k], dv[0], k);
+        scatter_lane(batch.dwA[k], dv[1], k);
+        scatter_lane(batch.dvB[k], dv[2], k);
+        scatter_lane(batch.dwB[k], dv[3], k);
+    }
+}
+
+static void solve_remainder_rows(const row_batch_cache &batch_cache, row_cache &cache) {
+    for (auto row_idx : batch_cache.remainder_rows) {
+        auto &row = cache.rows[row_idx];
+        auto delta_impulse = solve(row);
+        apply_impulse(delta_impulse, row);
+    }
+}
+
+void solve_row_batches(const row_batch_cache &batch_cache, row_cache &cache) {
+    for (auto &batch : batch_cache.batches) {
+        solve_row_batch(batch, cache);
+    }
+
+    solve_remainder_rows(batch_cache, cache);
+}
+
+void solve_row_batches_parallel(job_dispatcher &dispatcher,
+                                const row_batch_cache &batch_cache,
+                                row_cache &cache) {
+    // Colors must be solved one after the other. The batches within each
+    // color can be solved concurrently because they share no bodies.
+    for (size_t i = 0; i + 1 < batch_cache.color_offsets.size(); ++i) {
+        auto first = batch_cache.color_offsets[i];
+        auto last = batch_cache.color_offsets[i + 1];
+
+        if (last - first < min_parallel_row_batches) {
+            for (auto j = first; j < last; ++j) {
+                solve_row_batch(batch_cache.batches[j], cache);
+            }
+        } else {
+            parallel_for(dispatcher, first, last, size_t{1}, [&](size_t j) {
+                solve_row_batch(batch_cache.batches[j], cache);
+            });
+        }
+    }
+
+    solve_remainder_rows(batch_cache, cache);
+}
+
+}
@@ -4,7 +4,6 @@
 #include "edyn/sys/integrate_linvel.hpp"
 #include "edyn/sys/integrate_angvel.hpp"
 #include "edyn/sys/update_aabbs.hpp"
-#include "edyn/sys/update_rotated_meshes.hpp"
 #include "edyn/sys/update_inertias.hpp"
 #include "edyn/sys/update_origins.hpp"
 #include "edyn/constraints/constraint_row.hpp"
@@ -18,6 +17,7 @@
 #include "edyn/util/constraint_util.hpp"
 #include "edyn/dynamics/restitution_solver.hpp"
 #include "edyn/context/settings.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
 #include <entt/entity/registry.hpp>
 #include <type_traits>
 
@@ -157,15 +157,29 @@ void solver::update(scalar dt) {
     // Setup constraints.
     prepare_constraints(registry, m_row_cache, dt);
 
+    const auto parallel = settings.solver_mode == constraint_solver_mode::parallel;
+    const auto batched = parallel || settings.solver_mode == constraint_solver_mode::batched;
+
+    if (batched) {
+        // Group rows into batches of independent rows.
+        make_row_batches(m_row_cache, m_row_batch_cache);
+    }
+
     // Solve constraints.
     for (unsigned i = 0; i < settings.num_solver_velocity_iterations; ++i) {
         // Prepare constraints for iteration.
         iterate_constraints(registry, m_row_cache, dt);
 
         // Solve rows.
-        for (auto &row : m_row_cache.rows) {
-            auto delta_impulse = solve(row);
-            apply_impulse(delta_impulse, row);
+        if (parallel) {
+            solve_row_batches_parallel(job_dispatcher::global(), m_row_batch_cache, m_row_cache);
+        } else if (batched) {
+            solve_row_batches(m_row_batch_cache, m_row_cache);
+        } else {
+            for (auto &row : m_row_cache.rows) {
+                auto delta_impulse = solve(row);
+                apply_impulse(delta_impulse, row);
+            }
         }
     }
 
@@ -194,11 +208,6 @@ void solver::update(scalar dt) {
 
     update_origins(registry);
 
-    // Update rotated vertices of convex meshes after rotations change. It is
-    // important to do this before `update_aabbs` because the rotated meshes
-    // will be used to calculate AABBs of polyhedrons.
-    update_rotated_meshes(registry);
-
     // Update AABBs after transforms change.
     update_aabbs(registry);
 
@@ -6,7 +6,7 @@
 #include "edyn/parallel/island_coordinator.hpp"
 #include "edyn/sys/update_presentation.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
-#include "edyn/collision/tree_view.hpp"
+#include "edyn/util/step_profiler.hpp"
 #include <entt/meta/factory.hpp>
 #include <entt/core/hashed_string.hpp>
 
@@ -25,11 +25,6 @@ static void init_meta() {
         (entt::meta<decltype(c)>().type().template data<&decltype(c)::body, entt::as_ref_t>("body"_hs), ...);
     }, constraints_tuple);
 
-    entt::meta<tree_view>().type()
-        .data<&tree_view::m_nodes, entt::as_ref_t>("nodes"_hs);
-    entt::meta<tree_view::tree_node>().type()
-        .data<&tree_view::tree_node::entity, entt::as_ref_t>("entity"_hs);
-
     entt::meta<entity_owner>().type()
         .data<&entity_owner::client_entity, entt::as_ref_t>("client_entity"_hs);
 }
@@ -267,6 +262,79 @@ void set_solver_individual_restitution_iterations(entt::registry &registry, unsi
     registry.ctx().at<island_coordinator>().settings_changed();
 }
 
+constraint_solver_mode get_solver_mode(const entt::registry &registry) {
+    return registry.ctx().at<settings>().solver_mode;
+}
+
+void set_solver_mode(entt::registry &registry, constraint_solver_mode mode) {
+    auto &settings = registry.ctx().at<edyn::settings>();
+    settings.solver_mode = mode;
+    registry.ctx().at<island_coordinator>().settings_changed();
+}
+
+broadphase_backend get_broadphase_backend(const entt::registry &registry) {
+    return registry.ctx().at<settings>().broadphase;
+}
+
+void set_broadphase_backend(entt::registry &registry, broadphase_backend backend) {
+    auto &settings = registry.ctx().at<edyn::settings>();
+    settings.broadphase = backend;
+    registry.ctx().at<island_coordinator>().settings_changed();
+}
+
+void set_paged_mesh_prefetch(entt::registry &registry, scalar horizon, unsigned max_pending_loads) {
+    auto &settings = registry.ctx().at<edyn::settings>();
+    settings.paged_mesh_prefetch_horizon = horizon;
+    settings.paged_mesh_max_prefetch_loads = max_pending_loads;
+    registry.ctx().at<island_coordinator>().settings_changed();
+}
+
+unsigned get_polyhedron_gjk_epa_min_vertices(const entt::registry &registry) {
+    return registry.ctx().at<settings>().polyhedron_gjk_epa_min_vertices;
+}
+
+void set_polyhedron_gjk_epa_min_vertices(entt::registry &registry, unsigned min_vertices) {
+    auto &settings = registry.ctx().at<edyn::settings>();
+    settings.polyhedron_gjk_epa_min_vertices = min_vertices;
+    registry.ctx().at<island_coordinator>().settings_changed();
+}
+
+void set_batched_aabb_update_enabled(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().at<edyn::settings>();
+    settings.batched_aabb_update = enabled;
+    registry.ctx().at<island_coordinator>().settings_changed();
+}
+
+bool is_batched_aabb_update_enabled(const entt::registry &registry) {
+    return registry.ctx().at<settings>().batched_aabb_update;
+}
+
+void set_profiling_enabled(entt::registry &registry, bool enabled, size_t capacity) {
+    auto &settings = registry.ctx().at<edyn::settings>();
+
+    if (enabled) {
+        settings.profiler = std::make_shared<step_profiler>(capacity);
+    } else {
+        settings.profiler.reset();
+    }
+
+    registry.ctx().at<island_coordinator>().settings_changed();
+}
+
+bool is_profiling_enabled(const entt::registry &registry) {
+    return registry.ctx().at<settings>().profiler != nullptr;
+}
+
+size_t consume_profile_samples(entt::registry &registry, std::vector<profile_sample> &samples) {
+    auto &profiler = registry.ctx().at<settings>().profiler;
+
+    if (!profiler) {
+        return 0;
+    }
+
+    return profiler->consume(samples);
+}
+
 void insert_material_mixing(entt::registry &registry, material::id_type material_id0,
                             material::id_type material_id1, const material_base &material) {
     auto &material_table = registry.ctx().at<material_mix_table>();
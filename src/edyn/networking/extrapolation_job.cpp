@@ -22,7 +22,6 @@
 #include "edyn/sys/update_aabbs.hpp"
 #include "edyn/sys/update_inertias.hpp"
 #include "edyn/sys/update_origins.hpp"
-#include "edyn/sys/update_rotated_meshes.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
 #include "edyn/math/transform.hpp"
 #include "edyn/time/time.hpp"
@@ -115,7 +114,6 @@ void extrapolation_job::load_input() {
 
     // Update calculated properties after setting initial state.
     update_origins(m_registry);
-    update_rotated_meshes(m_registry);
     update_aabbs(m_registry);
     update_inertias(m_registry);
 }
@@ -8,6 +8,7 @@
 #include "edyn/networking/networking_external.hpp"
 #include "edyn/networking/packet/edyn_packet.hpp"
 #include "edyn/networking/util/process_update_entity_map_packet.hpp"
+#include "edyn/networking/util/snapshot_encoding.hpp"
 #include "edyn/parallel/entity_graph.hpp"
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/comp/graph_node.hpp"
@@ -540,6 +541,19 @@ static void snap_to_registry_snapshot(entt::registry &registry, packet::registry
 }
 
 static void process_packet(entt::registry &registry, packet::registry_snapshot &snapshot) {
+    auto &ctx = registry.ctx().at<client_network_context>();
+
+    // Unpack quantized pools and acknowledge the snapshot so the server can
+    // use it as the baseline for the next ones. Discard it if it can't be
+    // decoded, which means its baseline is not available anymore.
+    if (snapshot.sequence != 0) {
+        if (!decode_registry_snapshot(snapshot, ctx.snapshot_baselines)) {
+            return;
+        }
+
+        ctx.packet_signal.publish(packet::edyn_packet{packet::snapshot_ack{snapshot.sequence}});
+    }
+
     if (contains_unknown_entities(registry, snapshot.entities)) {
         // Do not perform extrapolation if it contains unknown entities as the
         // result would not make much sense if all parts are not involved. Wait
@@ -548,7 +562,6 @@ static void process_packet(entt::registry &registry, packet::registry_snapshot &
         return;
     }
 
-    auto &ctx = registry.ctx().at<client_network_context>();
     auto &settings = registry.ctx().at<edyn::settings>();
     auto &client_settings = std::get<client_network_settings>(settings.network_settings);
 
@@ -709,6 +722,7 @@ static void process_packet(entt::registry &registry, const packet::server_settin
 }
 
 static void process_packet(entt::registry &, const packet::set_aabb_of_interest &) {}
+static void process_packet(entt::registry &, const packet::snapshot_ack &) {}
 
 void client_receive_packet(entt::registry &registry, packet::edyn_packet &packet) {
     std::visit([&](auto &&inner_packet) {
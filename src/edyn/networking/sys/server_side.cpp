@@ -4,6 +4,7 @@
 #include "edyn/comp/island.hpp"
 #include "edyn/comp/position.hpp"
 #include "edyn/comp/orientation.hpp"
+#include "edyn/comp/linvel.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/networking/comp/action_history.hpp"
 #include "edyn/networking/comp/network_dirty.hpp"
@@ -18,8 +19,13 @@
 #include "edyn/networking/sys/update_network_dirty.hpp"
 #include "edyn/networking/context/server_network_context.hpp"
 #include "edyn/networking/util/process_update_entity_map_packet.hpp"
+#include "edyn/networking/util/aabb_of_interest_manager.hpp"
+#include "edyn/networking/util/snapshot_encoding.hpp"
+#include "edyn/networking/util/snapshot_scheduling.hpp"
 #include "edyn/parallel/island_coordinator.hpp"
 #include "edyn/parallel/message.hpp"
+#include "edyn/parallel/parallel_for.hpp"
+#include "edyn/serialization/memory_archive.hpp"
 #include "edyn/time/time.hpp"
 #include "edyn/util/entity_map.hpp"
 #include "edyn/util/island_util.hpp"
@@ -27,7 +33,10 @@
 #include "edyn/util/aabb_util.hpp"
 #include <entt/entity/registry.hpp>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <set>
+#include <unordered_map>
 
 namespace edyn {
 
@@ -282,12 +291,22 @@ static void process_packet(entt::registry &registry, entt::entity client_entity,
     aabboi.aabb.max = aabb.max;
 }
 
+static void process_packet(entt::registry &registry, entt::entity client_entity, const packet::snapshot_ack &ack) {
+    auto &client = registry.get<remote_client>(client_entity);
+
+    // Acks may arrive out of order. Keep the latest valid one.
+    if (ack.sequence > client.acked_snapshot_sequence && ack.sequence <= client.snapshot_sequence) {
+        client.acked_snapshot_sequence = ack.sequence;
+    }
+}
+
 static void process_packet(entt::registry &, entt::entity, const packet::client_created &) {}
 static void process_packet(entt::registry &, entt::entity, const packet::set_playout_delay &) {}
 static void process_packet(entt::registry &, entt::entity, const packet::server_settings &) {}
 
 void init_network_server(entt::registry &registry) {
     registry.ctx().emplace<server_network_context>();
+    registry.ctx().emplace<aabb_of_interest_manager>(registry);
     // Assign an entity owner to every island created.
     registry.on_construct<island>().connect<&entt::registry::emplace<entity_owner>>();
 
@@ -297,6 +316,7 @@ void init_network_server(entt::registry &registry) {
 
 void deinit_network_server(entt::registry &registry) {
     registry.ctx().erase<server_network_context>();
+    registry.ctx().erase<aabb_of_interest_manager>();
     registry.on_construct<island>().disconnect<&entt::registry::emplace<entity_owner>>();
 
     auto &settings = registry.ctx().at<edyn::settings>();
@@ -412,58 +432,470 @@ static void process_aabb_of_interest_created_entities(entt::registry &registry,
     aabboi.create_entities.clear();
 }
 
-static void maybe_publish_client_registry_snapshot(entt::registry &registry,
-                                                   entt::entity client_entity,
-                                                   remote_client &client,
-                                                   aabb_of_interest &aabboi,
-                                                   double time) {
-    if (time - client.last_snapshot_time < 1 / client.snapshot_rate) {
-        return;
-    }
+// Parameters of a registry snapshot for a single client.
+struct client_snapshot_job {
+    entt::entity client_entity;
+    remote_client *client;
+    const aabb_of_interest *aabboi;
+
+    // Positions of the entities owned by the client, used to calculate the
+    // priority of the other entities.
+    std::vector<vector3> owned_positions;
+
+    packet::registry_snapshot packet;
+    bool publish {false};
+};
+
+// Dirty components of all networked entities, exported once per update and
+// shared among all clients which are due to receive a registry snapshot.
+struct server_snapshot_cache {
+    struct entity_info {
+        // Client which owns this entity.
+        entt::entity owner {entt::null};
+
+        // Client which owns all islands where this entity resides, or null if
+        // there is more than one.
+        entt::entity island_owner {entt::null};
+
+        // Whether the entity does not reside in any island.
+        bool no_island {false};
+
+        // Smallest timestamp among the islands where this entity resides.
+        // Negative if it does not reside in any island.
+        double timestamp {-1};
+
+        // Position and speed used to calculate the priority of the entity.
+        vector3 position;
+        bool has_position {false};
+        scalar speed {0};
+
+        // Range of elements of this entity in `elements`.
+        size_t elements_begin {0};
+        size_t elements_end {0};
+
+        // Range of type ids of the exported components in `component_ids`.
+        size_t components_begin {0};
+        size_t components_end {0};
+    };
+
+    struct element {
+        unsigned pool_index;
+        size_t element_index;
+    };
+
+    // All dirty and deferred entities and their components. Pools hold 32-bit
+    // entity indices since the number of dirty entities in the server might
+    // exceed the range of `pool_snapshot_data::index_type`.
+    std::vector<entt::entity> entities;
+    std::vector<indexed_pool_snapshot> pools;
+    std::vector<entity_info> infos;
 
-    client.last_snapshot_time = time;
+    // Type ids of the exported components of all entities, which are their
+    // dirty components and the components deferred by clients.
+    std::vector<entt::id_type> component_ids;
 
+    // Pool elements sorted by entity.
+    std::vector<element> elements;
+
+    // Index of entities in `entities`.
+    std::unordered_map<entt::entity, size_t> entity_index;
+
+    // Whether each pool contains input components, which must not be sent to
+    // the client which owns the entity.
+    std::vector<bool> pool_is_input;
+
+    // Estimated size in bits of an element of each pool in a snapshot. Only
+    // calculated if there is a snapshot byte budget.
+    std::vector<size_t> pool_element_bits;
+};
+
+static void build_snapshot_cache(entt::registry &registry,
+                                 const server_network_settings &server_settings,
+                                 const std::vector<client_snapshot_job> &jobs,
+                                 server_snapshot_cache &cache) {
     auto &ctx = registry.ctx().at<server_network_context>();
-    auto packet = packet::registry_snapshot{};
+    auto networked_view = registry.view<networked_tag>();
+    auto network_dirty_view = registry.view<network_dirty>();
+
+    for (auto entity : registry.view<networked_tag, network_dirty>(entt::exclude_t<sleeping_tag>{})) {
+        cache.entity_index[entity] = cache.entities.size();
+        cache.entities.push_back(entity);
+    }
+
+    // Entities deferred by clients must be exported until they're sent, even
+    // if they're not dirty anymore or went to sleep.
+    auto deferred_component_ids = std::unordered_map<entt::entity, std::vector<entt::id_type>>{};
+
+    for (auto &job : jobs) {
+        for (auto &[entity, deferred] : job.client->deferred_snapshot_entities) {
+            if (!registry.valid(entity) || !networked_view.contains(entity)) {
+                continue;
+            }
+
+            if (cache.entity_index.count(entity) == 0) {
+                cache.entity_index[entity] = cache.entities.size();
+                cache.entities.push_back(entity);
+            }
+
+            auto &ids = deferred_component_ids[entity];
+            ids.insert(ids.end(), deferred.component_ids.begin(), deferred.component_ids.end());
+        }
+    }
+
+    EDYN_ASSERT(cache.entities.size() <= size_t(std::numeric_limits<uint32_t>::max()));
+    cache.infos.resize(cache.entities.size());
+
+    for (size_t i = 0; i < cache.entities.size(); ++i) {
+        auto entity = cache.entities[i];
+        auto &info = cache.infos[i];
+        info.components_begin = cache.component_ids.size();
+
+        if (network_dirty_view.contains(entity)) {
+            auto [n_dirty] = network_dirty_view.get(entity);
+            n_dirty.each([&](entt::id_type id) { cache.component_ids.push_back(id); });
+        }
+
+        if (auto it = deferred_component_ids.find(entity); it != deferred_component_ids.end()) {
+            cache.component_ids.insert(cache.component_ids.end(), it->second.begin(), it->second.end());
+        }
+
+        auto first = cache.component_ids.begin() + info.components_begin;
+        std::sort(first, cache.component_ids.end());
+        cache.component_ids.erase(std::unique(first, cache.component_ids.end()), cache.component_ids.end());
+        info.components_end = cache.component_ids.size();
+
+        ctx.snapshot_exporter->export_components(registry, entity, static_cast<uint32_t>(i),
+                                                 cache.component_ids.data() + info.components_begin,
+                                                 cache.component_ids.data() + info.components_end,
+                                                 cache.pools);
+    }
+
+    auto owner_view = registry.view<entity_owner>();
+    auto timestamp_view = registry.view<island_timestamp>();
+    auto position_view = registry.view<position>();
+    auto linvel_view = registry.view<linvel>();
+
+    auto visit_island = [&](server_snapshot_cache::entity_info &info, entt::entity island_entity, bool first) {
+        auto [island_owner] = owner_view.get(island_entity);
+        auto [isle_time] = timestamp_view.get(island_entity);
+
+        if (first) {
+            info.island_owner = island_owner.client_entity;
+            info.timestamp = isle_time.value;
+        } else {
+            if (info.island_owner != island_owner.client_entity) {
+                info.island_owner = entt::null;
+            }
+
+            info.timestamp = std::min(isle_time.value, info.timestamp);
+        }
+    };
+
+    for (size_t i = 0; i < cache.entities.size(); ++i) {
+        auto entity = cache.entities[i];
+        auto &info = cache.infos[i];
+
+        if (owner_view.contains(entity)) {
+            info.owner = std::get<0>(owner_view.get(entity)).client_entity;
+        }
+
+        if (position_view.contains(entity)) {
+            info.position = std::get<0>(position_view.get(entity));
+            info.has_position = true;
+        }
+
+        if (linvel_view.contains(entity)) {
+            info.speed = length(std::get<0>(linvel_view.get(entity)));
+        }
+
+        if (auto *resident = registry.try_get<island_resident>(entity)) {
+            if (resident->island_entity != entt::null) {
+                visit_island(info, resident->island_entity, true);
+            }
+        } else if (auto *resident = registry.try_get<multi_island_resident>(entity)) {
+            auto first = true;
+
+            for (auto island_entity : resident->island_entities) {
+                visit_island(info, island_entity, first);
+                first = false;
+            }
+
+            info.no_island = first;
+        } else {
+            info.no_island = true;
+        }
+    }
+
+    // Sort pool elements by entity using a counting sort.
+    for (auto &pool : cache.pools) {
+        for (auto entity_index : pool.entity_indices) {
+            ++cache.infos[entity_index].elements_end;
+        }
+    }
+
+    size_t offset = 0;
+
+    for (auto &info : cache.infos) {
+        info.elements_begin = offset;
+        offset += info.elements_end;
+        info.elements_end = info.elements_begin;
+    }
+
+    cache.elements.resize(offset);
+    cache.pool_is_input.resize(cache.pools.size());
+    cache.pool_element_bits.resize(cache.pools.size());
+    auto estimate_size = server_settings.snapshot_byte_budget > 0;
+    auto pool_data = std::vector<uint8_t>{};
+
+    // Bit counts of the quantised components. The bounds do not matter since
+    // only the number of bits is used.
+    auto quant = snapshot_quantization{};
+    quant.position_bits = server_settings.snapshot_position_bits;
+    quant.orientation_bits = server_settings.snapshot_orientation_bits;
+    quant.velocity_bits = server_settings.snapshot_velocity_bits;
+
+    for (unsigned pool_index = 0; pool_index < cache.pools.size(); ++pool_index) {
+        auto &pool = cache.pools[pool_index];
+        auto type_id = pool.pool.ptr->get_type_id();
+        cache.pool_is_input[pool_index] =
+            (*g_is_networked_input_component)(type_id) || (*g_is_action_list_component)(type_id);
+
+        if (estimate_size && !pool.entity_indices.empty()) {
+            auto bits = server_settings.snapshot_encoding_enabled ?
+                quantized_component_bits(type_id, quant) : size_t{0};
+
+            if (bits == 0) {
+                // Serialize the pool once to estimate the size of its elements,
+                // which might not have a fixed size. The entity indices of the
+                // pool data are empty thus only components are written.
+                pool_data.clear();
+                auto archive = memory_output_archive(pool_data);
+                pool.pool.ptr->write(archive);
+                bits = pool_data.size() * 8 / pool.entity_indices.size();
+            }
+
+            cache.pool_element_bits[pool_index] = bits;
+        }
+
+        for (size_t i = 0; i < pool.entity_indices.size(); ++i) {
+            auto &info = cache.infos[pool.entity_indices[i]];
+            cache.elements[info.elements_end++] = {pool_index, i};
+        }
+    }
+}
+
+static scalar snapshot_entity_priority(const server_snapshot_cache::entity_info &info,
+                                       const server_network_settings &server_settings,
+                                       const client_snapshot_job &job) {
+    auto priority = scalar(1) + info.speed * server_settings.snapshot_priority_velocity;
+
+    if (info.owner == job.client_entity) {
+        priority *= server_settings.snapshot_priority_owned;
+    }
+
+    if (info.has_position) {
+        // Use the center of the AABB of interest if the client does not own
+        // any entities.
+        scalar dist_sqr = job.owned_positions.empty() ?
+            distance_sqr(job.aabboi->aabb.center(), info.position) : EDYN_SCALAR_MAX;
+
+        for (auto &pos : job.owned_positions) {
+            dist_sqr = std::min(distance_sqr(pos, info.position), dist_sqr);
+        }
+
+        priority /= scalar(1) + std::sqrt(dist_sqr) / server_settings.snapshot_priority_distance;
+    }
+
+    return priority;
+}
+
+// Assemble a registry snapshot for a client from the cache. It does not access
+// the registry and thus can be run in parallel for all clients.
+static void assemble_client_registry_snapshot(const server_snapshot_cache &cache,
+                                              const server_network_settings &server_settings,
+                                              client_snapshot_job &job, double time) {
+    auto &client = *job.client;
+    auto &packet = job.packet;
 
     // Only include entities which are in islands not fully owned by the client
     // since the server allows the client to have full control over entities in
     // the islands where there are no other clients present.
-    auto should_include = [&](entt::entity entity) {
-        return
-            !registry.any_of<sleeping_tag>(entity) &&
-            registry.all_of<networked_tag, network_dirty>(entity) &&
-            !is_fully_owned_by_client(registry, client_entity, entity);
+    auto fully_owned = [&](const server_snapshot_cache::entity_info &info) {
+        return client.allow_full_ownership &&
+            (info.no_island || info.island_owner == job.client_entity);
     };
 
-    for (auto entity : aabboi.entities) {
-        if (should_include(entity)) {
-            packet.entities.push_back(entity);
+    // Do not include input components of entities owned by destination
+    // client as to not override client input on the client-side.
+    // Clients own their input.
+    auto is_excluded = [&](const server_snapshot_cache::entity_info &info,
+                           const server_snapshot_cache::element &elem) {
+        return info.owner == job.client_entity && cache.pool_is_input[elem.pool_index];
+    };
+
+    auto candidates = std::vector<snapshot_candidate>{};
+
+    for (auto entity : job.aabboi->entities) {
+        auto index_it = cache.entity_index.find(entity);
+
+        if (index_it == cache.entity_index.end()) {
+            continue;
         }
+
+        auto &info = cache.infos[index_it->second];
+
+        if (fully_owned(info)) {
+            continue;
+        }
+
+        auto size = size_t{0};
+
+        if (server_settings.snapshot_byte_budget > 0) {
+            auto bits = sizeof(entt::entity) * 8;
+
+            for (auto i = info.elements_begin; i < info.elements_end; ++i) {
+                auto &elem = cache.elements[i];
+
+                if (!is_excluded(info, elem)) {
+                    bits += sizeof(pool_snapshot_data::index_type) * 8 + cache.pool_element_bits[elem.pool_index];
+                }
+            }
+
+            size = (bits + 7) / 8;
+        }
+
+        auto priority = snapshot_entity_priority(info, server_settings, job);
+        candidates.push_back(snapshot_candidate{entity, index_it->second, size, priority});
+    }
+
+    if (candidates.empty()) {
+        client.deferred_snapshot_entities.clear();
+        return;
     }
 
-    ctx.snapshot_exporter->export_dirty(registry, packet, client_entity);
+    schedule_snapshot_candidates(candidates, server_settings.snapshot_byte_budget,
+                                 client.deferred_snapshot_entities);
+
+    // Keep the components of the deferred entities, which will be exported
+    // in the next snapshots even if they're not dirty anymore.
+    for (auto &[entity, deferred] : client.deferred_snapshot_entities) {
+        auto &info = cache.infos[cache.entity_index.at(entity)];
+        deferred.component_ids.assign(cache.component_ids.begin() + info.components_begin,
+                                      cache.component_ids.begin() + info.components_end);
+    }
+
+    // Map of pool index in the cache to pool index in the packet.
+    auto pool_map = std::vector<size_t>(cache.pools.size(), SIZE_MAX);
+    auto has_timestamp = false;
+
+    for (auto &candidate : candidates) {
+        auto entity = candidate.entity;
+        auto &info = cache.infos[candidate.cache_index];
+        // Narrow the entity index now that it refers to the packet.
+        EDYN_ASSERT(packet.entities.size() <= size_t(std::numeric_limits<pool_snapshot_data::index_type>::max()));
+        auto entity_index = static_cast<pool_snapshot_data::index_type>(packet.entities.size());
+        packet.entities.push_back(entity);
+
+        for (auto i = info.elements_begin; i < info.elements_end; ++i) {
+            auto &elem = cache.elements[i];
+
+            if (is_excluded(info, elem)) {
+                continue;
+            }
+
+            auto &cached_pool = cache.pools[elem.pool_index].pool;
+
+            if (pool_map[elem.pool_index] == SIZE_MAX) {
+                pool_map[elem.pool_index] = packet.pools.size();
+                auto pool = pool_snapshot{cached_pool.component_index};
+                pool.ptr = (*g_make_pool_snapshot_data)(cached_pool.component_index);
+                packet.pools.push_back(std::move(pool));
+            }
+
+            auto &pool = packet.pools[pool_map[elem.pool_index]];
+            pool.ptr->insert_from(*cached_pool.ptr, elem.element_index, entity_index);
+        }
 
-    if (!packet.entities.empty() && !packet.pools.empty()) {
         // Assign island timestamp as packet timestamp if available.
         // Use current time otherwise.
-        auto island_entities = collect_islands_from_residents(registry,
-                                                              packet.entities.begin(),
-                                                              packet.entities.end());
+        if (info.timestamp >= 0) {
+            packet.timestamp = has_timestamp ? std::min(info.timestamp, packet.timestamp) : info.timestamp;
+            has_timestamp = true;
+        }
+    }
 
-        if (island_entities.empty()) {
-            packet.timestamp = time;
-        } else {
-            auto timestamp_view = registry.view<island_timestamp>();
-            packet.timestamp = timestamp_view.get<island_timestamp>(*island_entities.begin()).value;
+    if (packet.entities.empty() || packet.pools.empty()) {
+        return;
+    }
 
-            for (auto island_entity : island_entities) {
-                auto [isle_time] = timestamp_view.get(island_entity);
-                packet.timestamp = std::min(isle_time.value, packet.timestamp);
+    if (!has_timestamp) {
+        packet.timestamp = time;
+    }
+
+    if (server_settings.snapshot_encoding_enabled) {
+        auto quant = snapshot_quantization{};
+        quant.bounds = job.aabboi->aabb;
+        quant.position_bits = server_settings.snapshot_position_bits;
+        quant.orientation_bits = server_settings.snapshot_orientation_bits;
+        quant.velocity_bits = server_settings.snapshot_velocity_bits;
+        quant.max_linear_velocity = server_settings.snapshot_max_linear_velocity;
+        quant.max_angular_velocity = server_settings.snapshot_max_angular_velocity;
+
+        encode_registry_snapshot(packet, quant, client.snapshot_baselines,
+                                 ++client.snapshot_sequence, client.acked_snapshot_sequence);
+    }
+
+    job.publish = true;
+}
+
+static void publish_client_registry_snapshots(entt::registry &registry, double time) {
+    auto jobs = std::vector<client_snapshot_job>{};
+    auto position_view = registry.view<position>();
+
+    for (auto [client_entity, client, aabboi] : registry.view<remote_client, aabb_of_interest>().each()) {
+        if (time - client.last_snapshot_time < 1 / client.snapshot_rate) {
+            continue;
+        }
+
+        client.last_snapshot_time = time;
+        auto &job = jobs.emplace_back(client_snapshot_job{client_entity, &client, &aabboi});
+
+        for (auto entity : client.owned_entities) {
+            if (position_view.contains(entity)) {
+                job.owned_positions.push_back(std::get<0>(position_view.get(entity)));
             }
         }
+    }
 
-        ctx.packet_signal.publish(client_entity, packet::edyn_packet{packet});
+    if (jobs.empty()) {
+        return;
+    }
+
+    // Export dirty components once for all clients and then assemble the
+    // snapshot of each client in parallel.
+    auto &settings = registry.ctx().at<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+    auto cache = server_snapshot_cache{};
+    build_snapshot_cache(registry, server_settings, jobs, cache);
+
+    if (cache.entities.empty()) {
+        return;
+    }
+
+    if (jobs.size() > 1) {
+        parallel_for(size_t{0}, jobs.size(), [&](size_t index) {
+            assemble_client_registry_snapshot(cache, server_settings, jobs[index], time);
+        });
+    } else {
+        assemble_client_registry_snapshot(cache, server_settings, jobs.front(), time);
+    }
+
+    auto &ctx = registry.ctx().at<server_network_context>();
+
+    for (auto &job : jobs) {
+        if (job.publish) {
+            ctx.packet_signal.publish(job.client_entity, packet::edyn_packet{std::move(job.packet)});
+        }
     }
 }
 
@@ -505,7 +937,11 @@ static void process_aabbs_of_interest(entt::registry &registry, double time) {
     for (auto [client_entity, client, aabboi] : registry.view<remote_client, aabb_of_interest>().each()) {
         process_aabb_of_interest_destroyed_entities(registry, client_entity, client, aabboi, time);
         process_aabb_of_interest_created_entities(registry, client_entity, client, aabboi, time);
-        maybe_publish_client_registry_snapshot(registry, client_entity, client, aabboi, time);
+    }
+
+    publish_client_registry_snapshots(registry, time);
+
+    for (auto [client_entity, client, aabboi] : registry.view<remote_client, aabb_of_interest>().each()) {
         calculate_client_playout_delay(registry, client_entity, client, aabboi);
     }
 }
@@ -0,0 +1,408 @@
+#include "edyn/networking/util/aabb_of_interest_manager.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/collision/broadphase_main.hpp"
+#include "edyn/collision/tree_view.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/comp/aabb_oi_follow.hpp"
+#include "edyn/networking/comp/entity_owner.hpp"
+#include "edyn/parallel/island_coordinator.hpp"
+#include "edyn/util/vector.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <iterator>
+
+namespace edyn {
+
+aabb_of_interest_manager::aabb_of_interest_manager(entt::registry &registry)
+    : m_registry(&registry)
+{
+    auto &coordinator = registry.ctx().at<island_coordinator>();
+    coordinator.island_changed_sink().connect<&aabb_of_interest_manager::on_island_changed>(*this);
+    registry.on_destroy<island>().connect<&aabb_of_interest_manager::on_destroy_island>(*this);
+    registry.on_destroy<aabb_of_interest>().connect<&aabb_of_interest_manager::on_destroy_aabb_of_interest>(*this);
+    registry.on_construct<entity_owner>().connect<&aabb_of_interest_manager::on_entity_owner_changed>(*this);
+    registry.on_update<entity_owner>().connect<&aabb_of_interest_manager::on_entity_owner_changed>(*this);
+    registry.on_destroy<entity_owner>().connect<&aabb_of_interest_manager::on_entity_owner_changed>(*this);
+}
+
+aabb_of_interest_manager::~aabb_of_interest_manager() {
+    if (auto *coordinator = m_registry->ctx().find<island_coordinator>()) {
+        coordinator->island_changed_sink().disconnect<&aabb_of_interest_manager::on_island_changed>(*this);
+    }
+
+    m_registry->on_destroy<island>().disconnect<&aabb_of_interest_manager::on_destroy_island>(*this);
+    m_registry->on_destroy<aabb_of_interest>().disconnect<&aabb_of_interest_manager::on_destroy_aabb_of_interest>(*this);
+    m_registry->on_construct<entity_owner>().disconnect<&aabb_of_interest_manager::on_entity_owner_changed>(*this);
+    m_registry->on_update<entity_owner>().disconnect<&aabb_of_interest_manager::on_entity_owner_changed>(*this);
+    m_registry->on_destroy<entity_owner>().disconnect<&aabb_of_interest_manager::on_entity_owner_changed>(*this);
+}
+
+void aabb_of_interest_manager::on_island_changed(entt::entity island_entity) {
+    if (!m_changed_islands.contains(island_entity)) {
+        m_changed_islands.emplace(island_entity);
+    }
+}
+
+void aabb_of_interest_manager::on_entity_owner_changed(entt::registry &registry, entt::entity entity) {
+    // Owners are part of the entities of an island, thus the islands where
+    // the entity resides must be refreshed.
+    if (auto *resident = registry.try_get<island_resident>(entity)) {
+        if (resident->island_entity != entt::null) {
+            on_island_changed(resident->island_entity);
+        }
+    } else if (auto *resident = registry.try_get<multi_island_resident>(entity)) {
+        for (auto island_entity : resident->island_entities) {
+            on_island_changed(island_entity);
+        }
+    }
+}
+
+void aabb_of_interest_manager::on_destroy_island(entt::registry &registry, entt::entity island_entity) {
+    if (m_changed_islands.contains(island_entity)) {
+        m_changed_islands.erase(island_entity);
+    }
+
+    auto island_it = m_islands.find(island_entity);
+
+    if (island_it == m_islands.end()) {
+        return;
+    }
+
+    auto &island = island_it->second;
+
+    for (auto client_entity : island.client_entities) {
+        auto &client = m_clients.at(client_entity);
+        auto &aabboi = registry.get<aabb_of_interest>(client_entity);
+        aabboi.island_entities.erase(island_entity);
+        remove_refs(client, island.entities);
+    }
+
+    m_islands.erase(island_it);
+}
+
+void aabb_of_interest_manager::on_destroy_aabb_of_interest(entt::registry &registry, entt::entity client_entity) {
+    auto client_it = m_clients.find(client_entity);
+
+    if (client_it == m_clients.end()) {
+        return;
+    }
+
+    auto &aabboi = registry.get<aabb_of_interest>(client_entity);
+
+    for (auto island_entity : aabboi.island_entities) {
+        if (auto island_it = m_islands.find(island_entity); island_it != m_islands.end()) {
+            vector_erase(island_it->second.client_entities, client_entity);
+        }
+    }
+
+    m_client_tree.destroy(client_it->second.node_id);
+    m_clients.erase(client_it);
+}
+
+AABB aabb_of_interest_manager::expanded(const AABB &aabb) const {
+    return aabb.inset(vector3_one * -m_margin);
+}
+
+void aabb_of_interest_manager::add_refs(client_info &client, const std::vector<entt::entity> &entities) {
+    for (auto entity : entities) {
+        if (client.entity_refs[entity]++ == 0) {
+            client.touched_entities.push_back(entity);
+        }
+    }
+}
+
+void aabb_of_interest_manager::remove_refs(client_info &client, const std::vector<entt::entity> &entities) {
+    for (auto entity : entities) {
+        auto it = client.entity_refs.find(entity);
+        EDYN_ASSERT(it != client.entity_refs.end());
+
+        if (--it->second == 0) {
+            client.entity_refs.erase(it);
+            client.touched_entities.push_back(entity);
+        }
+    }
+}
+
+void aabb_of_interest_manager::set_interest(entt::entity island_entity, island_info &island,
+                                            entt::entity client_entity, client_info &client,
+                                            aabb_of_interest &aabboi, bool interested) {
+    if (aabboi.island_entities.contains(island_entity) == interested) {
+        return;
+    }
+
+    if (interested) {
+        aabboi.island_entities.emplace(island_entity);
+        island.client_entities.push_back(client_entity);
+        add_refs(client, island.entities);
+    } else {
+        aabboi.island_entities.erase(island_entity);
+        vector_erase(island.client_entities, client_entity);
+        remove_refs(client, island.entities);
+    }
+}
+
+void aabb_of_interest_manager::update_island_clients(entt::entity island_entity, island_info &island) {
+    auto aabboi_view = m_registry->view<aabb_of_interest>();
+    auto candidates = std::vector<entt::entity>{};
+
+    // The tree contains the AABBs of interest expanded by the margin.
+    m_client_tree.query(island.aabb, [&](tree_node_id_t id) {
+        candidates.push_back(m_client_tree.get_node(id).entity);
+    });
+
+    // An island enters an AABB of interest when they intersect and it exits
+    // when it does not intersect the expanded AABB of interest anymore.
+    for (auto client_entity : candidates) {
+        auto &client = m_clients.at(client_entity);
+        auto [aabboi] = aabboi_view.get(client_entity);
+        auto interested = aabboi.island_entities.contains(island_entity) ?
+            intersect(expanded(client.aabb), island.aabb) : intersect(client.aabb, island.aabb);
+        set_interest(island_entity, island, client_entity, client, aabboi, interested);
+    }
+
+    auto client_entities = island.client_entities;
+
+    for (auto client_entity : client_entities) {
+        if (!vector_contains(candidates, client_entity)) {
+            auto [aabboi] = aabboi_view.get(client_entity);
+            set_interest(island_entity, island, client_entity, m_clients.at(client_entity), aabboi, false);
+        }
+    }
+}
+
+void aabb_of_interest_manager::update_client_islands(entt::entity client_entity, client_info &client,
+                                                     aabb_of_interest &aabboi) {
+    auto &bphase = m_registry->ctx().at<broadphase_main>();
+    auto candidates = std::vector<entt::entity>{};
+
+    bphase.query_islands(expanded(client.aabb), [&](entt::entity island_entity) {
+        candidates.push_back(island_entity);
+    });
+
+    for (auto island_entity : candidates) {
+        auto island_it = m_islands.find(island_entity);
+
+        if (island_it == m_islands.end() || !island_it->second.has_aabb) {
+            continue;
+        }
+
+        auto &island = island_it->second;
+        auto interested = aabboi.island_entities.contains(island_entity) ?
+            intersect(expanded(client.aabb), island.aabb) : intersect(client.aabb, island.aabb);
+        set_interest(island_entity, island, client_entity, client, aabboi, interested);
+    }
+
+    auto island_entities = std::vector<entt::entity>(aabboi.island_entities.begin(), aabboi.island_entities.end());
+
+    for (auto island_entity : island_entities) {
+        if (!vector_contains(candidates, island_entity)) {
+            set_interest(island_entity, m_islands.at(island_entity), client_entity, client, aabboi, false);
+        }
+    }
+}
+
+void aabb_of_interest_manager::update_client_np_entities(client_info &client, const aabb_of_interest &aabboi) {
+    // Static and kinematic entities are not in islands. Query them directly
+    // using the same hysteresis as islands.
+    auto &bphase = m_registry->ctx().at<broadphase_main>();
+    auto aabb_view = m_registry->view<AABB>();
+    auto owner_view = m_registry->view<entity_owner>();
+    auto np_entities = std::vector<entt::entity>{};
+
+    bphase.query_non_procedural(expanded(client.aabb), [&](entt::entity np_entity) {
+        if (!aabb_view.contains(np_entity)) {
+            np_entities.push_back(np_entity);
+            return;
+        }
+
+        auto [aabb] = aabb_view.get(np_entity);
+        auto was_contained = aabboi.entities.contains(np_entity);
+
+        if (was_contained ? intersect(expanded(client.aabb), aabb) : intersect(client.aabb, aabb)) {
+            np_entities.push_back(np_entity);
+        }
+    });
+
+    auto num_np_entities = np_entities.size();
+
+    for (size_t i = 0; i < num_np_entities; ++i) {
+        if (owner_view.contains(np_entities[i])) {
+            auto [owner] = owner_view.get(np_entities[i]);
+
+            if (owner.client_entity != entt::null) {
+                np_entities.push_back(owner.client_entity);
+            }
+        }
+    }
+
+    std::sort(np_entities.begin(), np_entities.end());
+    np_entities.erase(std::unique(np_entities.begin(), np_entities.end()), np_entities.end());
+
+    auto added = std::vector<entt::entity>{};
+    auto removed = std::vector<entt::entity>{};
+    std::set_difference(np_entities.begin(), np_entities.end(),
+                        client.np_entities.begin(), client.np_entities.end(),
+                        std::back_inserter(added));
+    std::set_difference(client.np_entities.begin(), client.np_entities.end(),
+                        np_entities.begin(), np_entities.end(),
+                        std::back_inserter(removed));
+
+    add_refs(client, added);
+    remove_refs(client, removed);
+    client.np_entities = std::move(np_entities);
+}
+
+void aabb_of_interest_manager::collect_island_entities(entt::entity island_entity,
+                                                       std::vector<entt::entity> &entities) {
+    auto &island = m_registry->get<edyn::island>(island_entity);
+    auto manifold_view = m_registry->view<contact_manifold>();
+    auto owner_view = m_registry->view<entity_owner>();
+
+    entities.clear();
+    entities.insert(entities.end(), island.nodes.begin(), island.nodes.end());
+
+    for (auto entity : island.edges) {
+        // Ignore contact manifolds.
+        if (!manifold_view.contains(entity)) {
+            entities.push_back(entity);
+        }
+    }
+
+    // Insert owners of each entity.
+    auto num_entities = entities.size();
+
+    for (size_t i = 0; i < num_entities; ++i) {
+        if (owner_view.contains(entities[i])) {
+            auto [owner] = owner_view.get(entities[i]);
+
+            if (owner.client_entity != entt::null) {
+                entities.push_back(owner.client_entity);
+            }
+        }
+    }
+
+    // Keep it sorted to be able to calculate differences.
+    std::sort(entities.begin(), entities.end());
+    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+}
+
+void aabb_of_interest_manager::refresh_island(entt::entity island_entity) {
+    auto &island = m_islands.at(island_entity);
+    auto entities = std::vector<entt::entity>{};
+    collect_island_entities(island_entity, entities);
+
+    if (!island.client_entities.empty()) {
+        auto added = std::vector<entt::entity>{};
+        auto removed = std::vector<entt::entity>{};
+        std::set_difference(entities.begin(), entities.end(),
+                            island.entities.begin(), island.entities.end(),
+                            std::back_inserter(added));
+        std::set_difference(island.entities.begin(), island.entities.end(),
+                            entities.begin(), entities.end(),
+                            std::back_inserter(removed));
+
+        for (auto client_entity : island.client_entities) {
+            auto &client = m_clients.at(client_entity);
+            add_refs(client, added);
+            remove_refs(client, removed);
+        }
+    }
+
+    island.entities = std::move(entities);
+}
+
+void aabb_of_interest_manager::update() {
+    auto &registry = *m_registry;
+    auto &settings = registry.ctx().at<edyn::settings>();
+    m_margin = std::get<server_network_settings>(settings.network_settings).aabb_of_interest_margin;
+
+    auto position_view = registry.view<position>();
+
+    registry.view<aabb_of_interest, aabb_oi_follow>().each([&](aabb_of_interest &aabboi, aabb_oi_follow &follow) {
+        auto [pos] = position_view.get(follow.entity);
+        auto half_size = (aabboi.aabb.max - aabboi.aabb.min) / 2;
+        aabboi.aabb.min = pos - half_size;
+        aabboi.aabb.max = pos + half_size;
+    });
+
+    // Insert new AABBs of interest into the tree and move the ones that
+    // changed.
+    auto moved_client_entities = std::vector<entt::entity>{};
+
+    for (auto [client_entity, aabboi] : registry.view<aabb_of_interest>().each()) {
+        auto [client_it, inserted] = m_clients.try_emplace(client_entity);
+        auto &client = client_it->second;
+
+        if (inserted) {
+            client.aabb = aabboi.aabb;
+            client.node_id = m_client_tree.create(expanded(client.aabb), client_entity);
+            moved_client_entities.push_back(client_entity);
+        } else if (aabboi.aabb.min != client.aabb.min || aabboi.aabb.max != client.aabb.max) {
+            client.aabb = aabboi.aabb;
+            m_client_tree.move(client.node_id, expanded(client.aabb));
+            moved_client_entities.push_back(client_entity);
+        }
+    }
+
+    // Update entities of islands whose nodes or edges changed.
+    for (auto island_entity : m_changed_islands) {
+        if (m_islands.count(island_entity)) {
+            refresh_island(island_entity);
+        }
+    }
+
+    m_changed_islands.clear();
+
+    // Find which AABBs of interest contain the islands that moved.
+    for (auto [island_entity, tree_view] : registry.view<island, edyn::tree_view>().each()) {
+        auto [island_it, inserted] = m_islands.try_emplace(island_entity);
+        auto &island = island_it->second;
+
+        if (inserted) {
+            collect_island_entities(island_entity, island.entities);
+        }
+
+        auto aabb = tree_view.root_aabb();
+
+        if (!island.has_aabb || aabb.min != island.aabb.min || aabb.max != island.aabb.max) {
+            island.aabb = aabb;
+            island.has_aabb = true;
+            update_island_clients(island_entity, island);
+        }
+    }
+
+    // Find which islands are contained in the AABBs of interest that moved.
+    auto aabboi_view = registry.view<aabb_of_interest>();
+
+    for (auto client_entity : moved_client_entities) {
+        auto [aabboi] = aabboi_view.get(client_entity);
+        update_client_islands(client_entity, m_clients.at(client_entity), aabboi);
+    }
+
+    // Calculate which entities have entered and exited the AABBs of interest.
+    // Only entities whose reference count went from or to zero need to be
+    // checked. An entity could have left and reentered in this update.
+    for (auto [client_entity, aabboi] : aabboi_view.each()) {
+        auto &client = m_clients.at(client_entity);
+        update_client_np_entities(client, aabboi);
+
+        for (auto entity : client.touched_entities) {
+            auto contained = client.entity_refs.count(entity) > 0;
+
+            if (contained && !aabboi.entities.contains(entity)) {
+                aabboi.entities.emplace(entity);
+                aabboi.create_entities.push_back(entity);
+            } else if (!contained && aabboi.entities.contains(entity)) {
+                aabboi.entities.erase(entity);
+                aabboi.destroy_entities.push_back(entity);
+            }
+        }
+
+        client.touched_entities.clear();
+    }
+}
+
+}
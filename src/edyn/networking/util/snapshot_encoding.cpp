@@ -0,0 +1,535 @@
+#include "edyn/networking/util/snapshot_encoding.hpp"
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/serialization/bit_archive.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/math/math.hpp"
+#include <entt/core/type_info.hpp>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace edyn {
+
+// Index of each encoded component in `snapshot_baseline::values`.
+enum snapshot_value_kind : unsigned {
+    snapshot_value_position,
+    snapshot_value_orientation,
+    snapshot_value_linvel,
+    snapshot_value_angvel
+};
+
+// Bits used to store the index of the largest quaternion component.
+static constexpr unsigned largest_component_bits = 2;
+
+// Bits used to store component indices and quantisation bit counts.
+static constexpr unsigned component_index_bits = 16;
+static constexpr unsigned bit_count_bits = 5;
+
+static uint32_t quantize_scalar(scalar value, scalar min, scalar max, unsigned bits) {
+    if (!(max > min)) {
+        return 0;
+    }
+
+    auto max_int = (uint64_t(1) << bits) - 1;
+    auto fraction = std::clamp((value - min) / (max - min), scalar(0), scalar(1));
+    return static_cast<uint32_t>(std::round(fraction * max_int));
+}
+
+static scalar dequantize_scalar(uint32_t value, scalar min, scalar max, unsigned bits) {
+    auto max_int = (uint64_t(1) << bits) - 1;
+    return min + (max - min) * (scalar(value) / scalar(max_int));
+}
+
+quantized_value quantize_vector3(const vector3 &v, const vector3 &min, const vector3 &max, unsigned bits) {
+    auto value = quantized_value{};
+
+    for (auto i = 0; i < 3; ++i) {
+        value[i] = quantize_scalar(v[i], min[i], max[i], bits);
+    }
+
+    return value;
+}
+
+vector3 dequantize_vector3(const quantized_value &value, const vector3 &min, const vector3 &max, unsigned bits) {
+    auto v = vector3{};
+
+    for (auto i = 0; i < 3; ++i) {
+        v[i] = dequantize_scalar(value[i], min[i], max[i], bits);
+    }
+
+    return v;
+}
+
+// The three smallest components of a unit quaternion lie in this range.
+static const scalar smallest_three_limit = scalar(1) / std::sqrt(scalar(2));
+
+quantized_value quantize_quaternion(const quaternion &q, unsigned bits) {
+    auto largest_idx = size_t{0};
+
+    for (size_t i = 1; i < 4; ++i) {
+        if (std::abs(q[i]) > std::abs(q[largest_idx])) {
+            largest_idx = i;
+        }
+    }
+
+    // `q` and `-q` represent the same rotation. Make the largest component
+    // positive so it can be omitted.
+    auto sign = q[largest_idx] < 0 ? scalar(-1) : scalar(1);
+    auto value = quantized_value{};
+    value[0] = static_cast<uint32_t>(largest_idx);
+
+    for (size_t i = 0, j = 1; i < 4; ++i) {
+        if (i != largest_idx) {
+            value[j++] = quantize_scalar(q[i] * sign, -smallest_three_limit, smallest_three_limit, bits);
+        }
+    }
+
+    return value;
+}
+
+quaternion dequantize_quaternion(const quantized_value &value, unsigned bits) {
+    auto largest_idx = size_t(value[0] & 3);
+    auto q = quaternion{};
+    auto sum_sqr = scalar(0);
+
+    for (size_t i = 0, j = 1; i < 4; ++i) {
+        if (i != largest_idx) {
+            q[i] = dequantize_scalar(value[j++], -smallest_three_limit, smallest_three_limit, bits);
+            sum_sqr += q[i] * q[i];
+        }
+    }
+
+    q[largest_idx] = std::sqrt(std::max(scalar(1) - sum_sqr, scalar(0)));
+
+    return normalize(q);
+}
+
+const snapshot_baseline * snapshot_baseline_history::find(uint32_t sequence) const {
+    auto it = std::find_if(baselines.begin(), baselines.end(),
+                           [sequence](auto &&baseline) { return baseline.sequence == sequence; });
+    return it == baselines.end() ? nullptr : &*it;
+}
+
+void snapshot_baseline_history::push(snapshot_baseline &&baseline) {
+    if (baselines.size() == max_size) {
+        baselines.erase(baselines.begin());
+    }
+
+    baselines.push_back(std::move(baseline));
+}
+
+// Number of bits needed to represent all values up to `n`, inclusive.
+static unsigned bits_for(size_t n) {
+    auto bits = 1u;
+
+    while (bits < 32 && (size_t(1) << bits) <= n) {
+        ++bits;
+    }
+
+    return bits;
+}
+
+static void write_scalar(bit_output_archive &archive, scalar value) {
+    if constexpr(std::is_same_v<scalar, double>) {
+        archive.write_double(value);
+    } else {
+        archive.write_float(value);
+    }
+}
+
+static scalar read_scalar(bit_input_archive &archive) {
+    if constexpr(std::is_same_v<scalar, double>) {
+        return archive.read_double();
+    } else {
+        return archive.read_float();
+    }
+}
+
+static void write_vector3(bit_output_archive &archive, const vector3 &v) {
+    write_scalar(archive, v.x);
+    write_scalar(archive, v.y);
+    write_scalar(archive, v.z);
+}
+
+static vector3 read_vector3(bit_input_archive &archive) {
+    auto x = read_scalar(archive);
+    auto y = read_scalar(archive);
+    auto z = read_scalar(archive);
+    return {x, y, z};
+}
+
+// Quantized values are written as the difference relative to the baseline.
+// Unchanged values take a single bit, small differences take half the bits
+// and large differences are written in full.
+static void write_delta(bit_output_archive &archive, uint32_t value, uint32_t base, unsigned bits) {
+    if (value == base) {
+        archive.write_bool(false);
+        return;
+    }
+
+    archive.write_bool(true);
+
+    auto diff = int64_t(value) - int64_t(base);
+    auto zigzag = uint64_t(diff >= 0 ? diff * 2 : -diff * 2 - 1);
+    auto small_bits = std::max(bits / 2, 1u);
+
+    if (zigzag < (uint64_t(1) << small_bits)) {
+        archive.write_bool(false);
+        archive.write_bits(zigzag, small_bits);
+    } else {
+        archive.write_bool(true);
+        archive.write_bits(value, bits);
+    }
+}
+
+static uint32_t read_delta(bit_input_archive &archive, uint32_t base, unsigned bits) {
+    if (!archive.read_bool()) {
+        return base;
+    }
+
+    auto small_bits = std::max(bits / 2, 1u);
+
+    if (archive.read_bool()) {
+        return static_cast<uint32_t>(archive.read_bits(bits));
+    }
+
+    auto zigzag = archive.read_bits(small_bits);
+    auto diff = (zigzag & 1) ? -int64_t(zigzag / 2) - 1 : int64_t(zigzag / 2);
+    return static_cast<uint32_t>(int64_t(base) + diff);
+}
+
+static void write_quantized(bit_output_archive &archive, const quantized_value &value,
+                            const quantized_value *base, unsigned count, const unsigned *bits) {
+    for (unsigned i = 0; i < count; ++i) {
+        if (base) {
+            write_delta(archive, value[i], (*base)[i], bits[i]);
+        } else {
+            archive.write_bits(value[i], bits[i]);
+        }
+    }
+}
+
+static quantized_value read_quantized(bit_input_archive &archive, const quantized_value *base,
+                                      unsigned count, const unsigned *bits) {
+    auto value = quantized_value{};
+
+    for (unsigned i = 0; i < count; ++i) {
+        if (base) {
+            value[i] = read_delta(archive, (*base)[i], bits[i]);
+        } else {
+            value[i] = static_cast<uint32_t>(archive.read_bits(bits[i]));
+        }
+    }
+
+    return value;
+}
+
+template<typename Component>
+static bool is_pool_of(const pool_snapshot &pool) {
+    return pool.ptr->get_type_id() == entt::type_index<Component>::value();
+}
+
+template<typename Component>
+static auto & typed_components(pool_snapshot &pool) {
+    return static_cast<pool_snapshot_data_impl<Component> *>(pool.ptr.get())->components;
+}
+
+// Quantisation layout of one kind of encoded component.
+struct snapshot_value_layout {
+    unsigned count;
+    unsigned bits[4];
+    vector3 min;
+    vector3 max;
+};
+
+static snapshot_value_layout get_value_layout(const snapshot_quantization &quant, unsigned kind) {
+    auto layout = snapshot_value_layout{};
+
+    switch (kind) {
+    case snapshot_value_position:
+        layout = {3, {quant.position_bits, quant.position_bits, quant.position_bits},
+                  quant.bounds.min, quant.bounds.max};
+        break;
+    case snapshot_value_orientation:
+        layout = {4, {largest_component_bits, quant.orientation_bits, quant.orientation_bits, quant.orientation_bits}};
+        break;
+    case snapshot_value_linvel:
+        layout = {3, {quant.velocity_bits, quant.velocity_bits, quant.velocity_bits},
+                  vector3_one * -quant.max_linear_velocity, vector3_one * quant.max_linear_velocity};
+        break;
+    case snapshot_value_angvel:
+        layout = {3, {quant.velocity_bits, quant.velocity_bits, quant.velocity_bits},
+                  vector3_one * -quant.max_angular_velocity, vector3_one * quant.max_angular_velocity};
+        break;
+    }
+
+    return layout;
+}
+
+size_t quantized_component_bits(entt::id_type type_id, const snapshot_quantization &quant) {
+    unsigned kind;
+
+    if (type_id == entt::type_index<position>::value()) {
+        kind = snapshot_value_position;
+    } else if (type_id == entt::type_index<orientation>::value()) {
+        kind = snapshot_value_orientation;
+    } else if (type_id == entt::type_index<linvel>::value()) {
+        kind = snapshot_value_linvel;
+    } else if (type_id == entt::type_index<angvel>::value()) {
+        kind = snapshot_value_angvel;
+    } else {
+        return 0;
+    }
+
+    auto layout = get_value_layout(quant, kind);
+    // Bit indicating whether there is a baseline value.
+    size_t bits = 1;
+
+    // Bit indicating whether the vector is in range.
+    if (kind != snapshot_value_orientation) {
+        bits += 1;
+    }
+
+    for (unsigned i = 0; i < layout.count; ++i) {
+        bits += layout.bits[i];
+    }
+
+    return bits;
+}
+
+static void write_quantization(bit_output_archive &archive, const snapshot_quantization &quant) {
+    write_vector3(archive, quant.bounds.min);
+    write_vector3(archive, quant.bounds.max);
+    archive.write_bits(quant.position_bits, bit_count_bits);
+    archive.write_bits(quant.orientation_bits, bit_count_bits);
+    archive.write_bits(quant.velocity_bits, bit_count_bits);
+    write_scalar(archive, quant.max_linear_velocity);
+    write_scalar(archive, quant.max_angular_velocity);
+}
+
+static snapshot_quantization read_quantization(bit_input_archive &archive) {
+    auto quant = snapshot_quantization{};
+    quant.bounds.min = read_vector3(archive);
+    quant.bounds.max = read_vector3(archive);
+    quant.position_bits = static_cast<uint8_t>(archive.read_bits(bit_count_bits));
+    quant.orientation_bits = static_cast<uint8_t>(archive.read_bits(bit_count_bits));
+    quant.velocity_bits = static_cast<uint8_t>(archive.read_bits(bit_count_bits));
+    quant.max_linear_velocity = read_scalar(archive);
+    quant.max_angular_velocity = read_scalar(archive);
+    return quant;
+}
+
+template<typename Component>
+static void encode_pool(bit_output_archive &archive, pool_snapshot &pool,
+                        const std::vector<entt::entity> &entities, unsigned kind,
+                        const snapshot_quantization &quant,
+                        const snapshot_baseline *base, snapshot_baseline &next) {
+    auto &components = typed_components<Component>(pool);
+    auto &entity_indices = pool.ptr->entity_indices;
+    auto layout = get_value_layout(quant, kind);
+    auto index_bits = bits_for(entities.size());
+
+    archive.write_bits(pool.component_index, component_index_bits);
+    archive.write_bits(entity_indices.size(), index_bits);
+
+    for (size_t i = 0; i < entity_indices.size(); ++i) {
+        auto entity = entities[entity_indices[i]];
+        auto &comp = components[i];
+        archive.write_bits(entity_indices[i], index_bits);
+
+        quantized_value value;
+
+        if constexpr(std::is_same_v<Component, orientation>) {
+            value = quantize_quaternion(comp, layout.bits[1]);
+        } else {
+            // Values out of range are sent at full precision and are not
+            // recorded in the baseline.
+            auto in_range = comp >= layout.min && layout.max >= comp;
+            archive.write_bool(in_range);
+
+            if (!in_range) {
+                write_vector3(archive, comp);
+                continue;
+            }
+
+            value = quantize_vector3(comp, layout.min, layout.max, layout.bits[0]);
+        }
+
+        const quantized_value *base_value = nullptr;
+
+        if (base) {
+            if (auto it = base->values[kind].find(entity); it != base->values[kind].end()) {
+                base_value = &it->second;
+            }
+        }
+
+        archive.write_bool(base_value != nullptr);
+        write_quantized(archive, value, base_value, layout.count, layout.bits);
+        next.values[kind][entity] = value;
+    }
+}
+
+template<typename Component>
+static bool decode_pool(bit_input_archive &archive, packet::registry_snapshot &snap,
+                        unsigned kind, const snapshot_quantization &quant,
+                        const snapshot_baseline *base, snapshot_baseline &next) {
+    auto layout = get_value_layout(quant, kind);
+    auto index_bits = bits_for(snap.entities.size());
+
+    auto pool = pool_snapshot{};
+    pool.component_index = static_cast<unsigned>(archive.read_bits(component_index_bits));
+    auto *data = new pool_snapshot_data_impl<Component>;
+    pool.ptr.reset(data);
+
+    auto count = archive.read_bits(index_bits);
+
+    if (archive.failed() || count > snap.entities.size()) {
+        return false;
+    }
+
+    data->entity_indices.resize(count);
+    data->components.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        auto entity_index = archive.read_bits(index_bits);
+
+        if (archive.failed() || entity_index >= snap.entities.size()) {
+            return false;
+        }
+
+        auto entity = snap.entities[entity_index];
+        data->entity_indices[i] = static_cast<pool_snapshot_data::index_type>(entity_index);
+
+        if constexpr(!std::is_same_v<Component, orientation>) {
+            if (!archive.read_bool()) {
+                data->components[i] = read_vector3(archive);
+                continue;
+            }
+        }
+
+        const quantized_value *base_value = nullptr;
+
+        if (archive.read_bool()) {
+            if (!base) {
+                return false;
+            }
+
+            auto it = base->values[kind].find(entity);
+
+            if (it == base->values[kind].end()) {
+                return false;
+            }
+
+            base_value = &it->second;
+        }
+
+        auto value = read_quantized(archive, base_value, layout.count, layout.bits);
+
+        if constexpr(std::is_same_v<Component, orientation>) {
+            data->components[i] = dequantize_quaternion(value, layout.bits[1]);
+        } else {
+            data->components[i] = dequantize_vector3(value, layout.min, layout.max, layout.bits[0]);
+        }
+
+        next.values[kind][entity] = value;
+    }
+
+    snap.pools.push_back(std::move(pool));
+
+    return !archive.failed();
+}
+
+// Write a bit indicating whether the pool is present followed by its data.
+template<typename Component>
+static void encode_pool_if_present(bit_output_archive &archive, packet::registry_snapshot &snap,
+                                   unsigned kind, const snapshot_quantization &quant,
+                                   const snapshot_baseline *base, snapshot_baseline &next) {
+    auto pool_it = std::find_if(snap.pools.begin(), snap.pools.end(), [](auto &&pool) {
+        return is_pool_of<Component>(pool);
+    });
+    archive.write_bool(pool_it != snap.pools.end());
+
+    if (pool_it != snap.pools.end()) {
+        encode_pool<Component>(archive, *pool_it, snap.entities, kind, quant, base, next);
+        snap.pools.erase(pool_it);
+    }
+}
+
+template<typename Component>
+static bool decode_pool_if_present(bit_input_archive &archive, packet::registry_snapshot &snap,
+                                   unsigned kind, const snapshot_quantization &quant,
+                                   const snapshot_baseline *base, snapshot_baseline &next) {
+    if (!archive.read_bool()) {
+        return !archive.failed();
+    }
+
+    return decode_pool<Component>(archive, snap, kind, quant, base, next);
+}
+
+void encode_registry_snapshot(packet::registry_snapshot &snap,
+                              const snapshot_quantization &quant,
+                              snapshot_baseline_history &history,
+                              uint32_t sequence, uint32_t baseline_sequence) {
+    EDYN_ASSERT(sequence != 0);
+    auto *base = baseline_sequence != 0 ? history.find(baseline_sequence) : nullptr;
+
+    snap.sequence = sequence;
+    snap.baseline_sequence = base ? baseline_sequence : 0;
+    snap.quantized_pools.clear();
+
+    auto archive = bit_output_archive(snap.quantized_pools);
+    write_quantization(archive, quant);
+
+    auto next = snapshot_baseline{};
+    next.sequence = sequence;
+
+    encode_pool_if_present<position>(archive, snap, snapshot_value_position, quant, base, next);
+    encode_pool_if_present<orientation>(archive, snap, snapshot_value_orientation, quant, base, next);
+    encode_pool_if_present<linvel>(archive, snap, snapshot_value_linvel, quant, base, next);
+    encode_pool_if_present<angvel>(archive, snap, snapshot_value_angvel, quant, base, next);
+
+    history.push(std::move(next));
+}
+
+bool decode_registry_snapshot(packet::registry_snapshot &snap,
+                              snapshot_baseline_history &history) {
+    if (snap.sequence == 0) {
+        return true;
+    }
+
+    const snapshot_baseline *base = nullptr;
+
+    if (snap.baseline_sequence != 0) {
+        base = history.find(snap.baseline_sequence);
+
+        if (!base) {
+            return false;
+        }
+    }
+
+    auto archive = bit_input_archive(snap.quantized_pools.data(), snap.quantized_pools.size());
+    auto quant = read_quantization(archive);
+
+    auto next = snapshot_baseline{};
+    next.sequence = snap.sequence;
+
+    auto success =
+        decode_pool_if_present<position>(archive, snap, snapshot_value_position, quant, base, next) &&
+        decode_pool_if_present<orientation>(archive, snap, snapshot_value_orientation, quant, base, next) &&
+        decode_pool_if_present<linvel>(archive, snap, snapshot_value_linvel, quant, base, next) &&
+        decode_pool_if_present<angvel>(archive, snap, snapshot_value_angvel, quant, base, next);
+
+    if (!success) {
+        return false;
+    }
+
+    snap.quantized_pools.clear();
+    history.push(std::move(next));
+
+    return true;
+}
+
+}
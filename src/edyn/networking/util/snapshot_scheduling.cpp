@@ -0,0 +1,57 @@
+#include "edyn/networking/util/snapshot_scheduling.hpp"
+#include <algorithm>
+
+namespace edyn {
+
+void schedule_snapshot_candidates(std::vector<snapshot_candidate> &candidates,
+                                  size_t byte_budget,
+                                  deferred_snapshot_entity_map &deferred) {
+    auto total_size = size_t{0};
+
+    for (auto &candidate : candidates) {
+        total_size += candidate.size;
+    }
+
+    if (byte_budget == 0 || total_size <= byte_budget) {
+        deferred.clear();
+        return;
+    }
+
+    for (auto &candidate : candidates) {
+        if (auto it = deferred.find(candidate.entity); it != deferred.end()) {
+            candidate.priority += it->second.priority;
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](auto &&lhs, auto &&rhs) {
+        return lhs.priority > rhs.priority;
+    });
+
+    // Always send at least one entity, even if it exceeds the budget.
+    auto size = candidates.front().size;
+    size_t num_selected = 1;
+
+    for (; num_selected < candidates.size(); ++num_selected) {
+        if (size + candidates[num_selected].size > byte_budget) {
+            break;
+        }
+
+        size += candidates[num_selected].size;
+    }
+
+    auto remaining = deferred_snapshot_entity_map{};
+
+    for (auto i = num_selected; i < candidates.size(); ++i) {
+        auto &entry = remaining[candidates[i].entity];
+        entry.priority = candidates[i].priority;
+
+        if (auto it = deferred.find(candidates[i].entity); it != deferred.end()) {
+            entry.component_ids = std::move(it->second.component_ids);
+        }
+    }
+
+    deferred = std::move(remaining);
+    candidates.resize(num_selected);
+}
+
+}
@@ -20,6 +20,7 @@
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/util/vector.hpp"
 #include "edyn/util/registry_operation.hpp"
+#include "edyn/util/step_profiler.hpp"
 #include "edyn/context/settings.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
 #include <entt/entity/registry.hpp>
@@ -106,6 +107,8 @@ void island_coordinator::on_destroy_island_resident(entt::registry &registry, en
         island.edges.erase(entity);
     }
 
+    m_island_changed_signal.publish(resident.island_entity);
+
     if (m_importing) return;
 
     auto &ctx = m_island_ctx_map.at(resident.island_entity);
@@ -135,6 +138,7 @@ void island_coordinator::on_destroy_multi_island_resident(entt::registry &regist
     for (auto island_entity : resident.island_entities) {
         auto &island = registry.get<edyn::island>(island_entity);
         island.nodes.erase(entity);
+        m_island_changed_signal.publish(island_entity);
 
         if (!m_importing)  {
             auto &ctx = m_island_ctx_map.at(island_entity);
@@ -310,6 +314,7 @@ void island_coordinator::init_new_non_procedural_node(entt::entity node_entity)
 
         auto &island = m_registry->get<edyn::island>(other_resident.island_entity);
         island.nodes.emplace(node_entity);
+        m_island_changed_signal.publish(other_resident.island_entity);
 
         if (!resident.island_entities.contains(other_resident.island_entity)) {
             resident.island_entities.emplace(other_resident.island_entity);
@@ -411,6 +416,8 @@ void island_coordinator::insert_to_island(island_worker_context &ctx,
         }
     }
 
+    m_island_changed_signal.publish(ctx.island_entity());
+
     auto resident_view = m_registry->view<island_resident>();
     auto multi_resident_view = m_registry->view<multi_island_resident>();
     auto procedural_view = m_registry->view<procedural_tag>();
@@ -600,6 +607,7 @@ void island_coordinator::on_island_reg_ops(entt::entity source_island_entity, co
     auto procedural_view = registry.view<procedural_tag>();
     auto node_view = registry.view<graph_node>();
     auto &island = registry.get<edyn::island>(source_island_entity);
+    auto island_changed = false;
 
     // Insert nodes in the graph for each rigid body.
     auto &graph = registry.ctx().at<entity_graph>();
@@ -617,6 +625,7 @@ void island_coordinator::on_island_reg_ops(entt::entity source_island_entity, co
         }
 
         island.nodes.emplace(local_entity);
+        island_changed = true;
     };
 
     msg.ops.emplace_for_each<rigidbody_tag, external_tag>(insert_node);
@@ -633,10 +642,15 @@ void island_coordinator::on_island_reg_ops(entt::entity source_island_entity, co
         registry.emplace<graph_edge>(local_entity, edge_index);
         registry.emplace<island_resident>(local_entity, source_island_entity);
         island.edges.emplace(local_entity);
+        island_changed = true;
     });
 
     m_importing = false;
 
+    if (island_changed) {
+        m_island_changed_signal.publish(source_island_entity);
+    }
+
     // Only do the following if this message wasn't generated during an island split,
     // since components are not really being replaced, they're just being moved.
     if (m_splitting_island) {
@@ -731,6 +745,10 @@ void island_coordinator::split_island(entt::entity split_island_entity) {
 
     auto &island = m_registry->get<edyn::island>(split_island_entity);
 
+    if (connected_components.size() > 1) {
+        m_island_changed_signal.publish(split_island_entity);
+    }
+
     for (size_t i = 1; i < connected_components.size(); ++i) {
         auto &connected = connected_components[i];
         bool contains_procedural = false;
@@ -771,12 +789,16 @@ void island_coordinator::split_island(entt::entity split_island_entity) {
 }
 
 void island_coordinator::sync() {
+    auto *profiler = m_registry->ctx().at<settings>().profiler.get();
+    profile_scope scope(profiler, entt::null, profile_stage::coordinator_sync);
+
     for (auto &pair : m_island_ctx_map) {
         auto island_entity = pair.first;
         auto &ctx = pair.second;
 
         if (!ctx->reg_ops_empty()) {
-            ctx->send_reg_ops();
+            auto num_bytes = ctx->send_reg_ops();
+            scope.counters.reg_op_bytes += static_cast<uint32_t>(num_bytes);
 
             if (m_registry->any_of<sleeping_tag>(island_entity)) {
                 ctx->send<msg::wake_up_island>();
@@ -790,6 +812,9 @@ void island_coordinator::sync() {
 void island_coordinator::update() {
     m_timestamp = performance_time();
 
+    auto *profiler = m_registry->ctx().at<settings>().profiler.get();
+    profile_scope scope(profiler, entt::null, profile_stage::coordinator_update);
+
     for (auto &pair : m_island_ctx_map) {
         pair.second->read_messages();
     }
@@ -20,7 +20,6 @@
 #include "edyn/shapes/polyhedron_shape.hpp"
 #include "edyn/sys/update_aabbs.hpp"
 #include "edyn/sys/update_inertias.hpp"
-#include "edyn/sys/update_rotated_meshes.hpp"
 #include "edyn/time/time.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
 #include "edyn/parallel/message.hpp"
@@ -70,6 +69,8 @@ island_worker::island_worker(entt::entity island_entity, const settings &setting
                              message_queue_in_out message_queue)
     : m_message_queue(message_queue)
     , m_splitting(false)
+    , m_stage_start_time(0)
+    , m_last_reg_op_bytes(0)
     , m_state(state::init)
     , m_solver(m_registry)
     , m_op_builder((*settings.make_reg_op_builder)())
@@ -93,6 +94,7 @@ island_worker::island_worker(entt::entity island_entity, const settings &setting
     static_cast<void>(m_registry.storage<collision_exclusion>());
 
     m_island_entity = m_registry.create();
+    m_remote_island_entity = island_entity;
     m_entity_map.insert(island_entity, m_island_entity);
 
     m_this_job.func = &island_worker_func;
@@ -141,8 +143,9 @@ void island_worker::init() {
     auto &bphase = m_registry.ctx().at<broadphase_worker>();
     bphase.update();
 
-    // Assign tree view containing the updated broad-phase tree.
-    auto tview = bphase.view();
+    // Assign tree view containing the updated broad-phase tree. Its entities
+    // are in the coordinator's space so that it can be shared as is.
+    auto tview = bphase.publish_view(m_entity_map);
     m_registry.emplace<tree_view>(m_island_entity, tview);
 
     m_state = state::step;
@@ -221,6 +224,48 @@ void island_worker::on_destroy_rotated_mesh_list(entt::registry &registry, entt:
     }
 }
 
+step_profiler * island_worker::profiler() const {
+    return m_registry.ctx().at<edyn::settings>().profiler.get();
+}
+
+void island_worker::begin_profile_stage() {
+    if (profiler()) {
+        m_stage_start_time = performance_time();
+    }
+}
+
+void island_worker::end_profile_stage(profile_stage stage) {
+    auto *profiler = this->profiler();
+
+    if (!profiler) {
+        return;
+    }
+
+    auto counters = profile_counters{};
+
+    switch (stage) {
+    case profile_stage::broadphase:
+        counters.num_tree_moves = static_cast<uint32_t>(m_registry.ctx().at<broadphase_worker>().num_tree_moves());
+        break;
+    case profile_stage::narrowphase:
+        m_registry.view<contact_manifold>().each([&](contact_manifold &manifold) {
+            ++counters.num_manifolds;
+            counters.num_contact_points += manifold.num_points;
+        });
+        break;
+    case profile_stage::solver:
+        counters.num_rows = static_cast<uint32_t>(m_solver.num_rows());
+        break;
+    case profile_stage::finish_step:
+        counters.reg_op_bytes = static_cast<uint32_t>(m_last_reg_op_bytes);
+        break;
+    default:
+        break;
+    }
+
+    profiler->record(m_remote_island_entity, stage, m_stage_start_time, counters);
+}
+
 void island_worker::on_island_reg_ops(const msg::island_reg_ops &msg) {
     // Import components from main registry.
     m_importing = true;
@@ -253,7 +298,8 @@ void island_worker::on_island_reg_ops(const msg::island_reg_ops &msg) {
     });
 
     // When orientation is set manually, a few dependent components must be
-    // updated, e.g. AABB, cached origin, inertia_world_inv, rotated meshes...
+    // updated, e.g. AABB, cached origin, inertia_world_inv... Rotated meshes
+    // are updated on demand in the narrowphase.
     msg.ops.replace_for_each<orientation>([&](entt::entity remote_entity, const orientation &orn) {
         auto local_entity = m_entity_map.at(remote_entity);
 
@@ -270,10 +316,6 @@ void island_worker::on_island_reg_ops(const msg::island_reg_ops &msg) {
         if (m_registry.any_of<dynamic_tag>(local_entity)) {
             update_inertia(m_registry, local_entity);
         }
-
-        if (m_registry.any_of<rotated_mesh_list>(local_entity)) {
-            update_rotated_mesh(m_registry, local_entity);
-        }
     });
 
     // When position is set manually, the AABB and cached origin must be updated.
@@ -349,6 +391,7 @@ void island_worker::sync() {
     sync_dirty();
 
     auto op = m_op_builder->finish();
+    m_last_reg_op_bytes = op.size_bytes();
     m_message_queue.send<msg::island_reg_ops>(std::move(op));
 }
 
@@ -469,6 +512,7 @@ bool island_worker::should_step() {
 
 void island_worker::begin_step() {
     EDYN_ASSERT(m_state == state::begin_step);
+    begin_profile_stage();
 
     auto &settings = m_registry.ctx().at<edyn::settings>();
     if (settings.external_system_pre_step) {
@@ -479,11 +523,13 @@ void island_worker::begin_step() {
     // imported polyhedron shapes.
     init_new_shapes();
 
+    end_profile_stage(profile_stage::begin_step);
     m_state = state::broadphase;
 }
 
 bool island_worker::run_broadphase() {
     EDYN_ASSERT(m_state == state::broadphase);
+    begin_profile_stage();
     auto &bphase = m_registry.ctx().at<broadphase_worker>();
 
     if (bphase.parallelizable()) {
@@ -492,6 +538,7 @@ bool island_worker::run_broadphase() {
         return false;
     } else {
         bphase.update();
+        end_profile_stage(profile_stage::broadphase);
         m_state = state::narrowphase;
         return true;
     }
@@ -501,11 +548,13 @@ void island_worker::finish_broadphase() {
     EDYN_ASSERT(m_state == state::broadphase_async);
     auto &bphase = m_registry.ctx().at<broadphase_worker>();
     bphase.finish_async_update();
+    end_profile_stage(profile_stage::broadphase);
     m_state = state::narrowphase;
 }
 
 bool island_worker::run_narrowphase() {
     EDYN_ASSERT(m_state == state::narrowphase);
+    begin_profile_stage();
     auto &nphase = m_registry.ctx().at<narrowphase>();
 
     if (nphase.parallelizable()) {
@@ -520,6 +569,7 @@ bool island_worker::run_narrowphase() {
         // next to be missing in the registry op.
         sync_dirty();
         nphase.update();
+        end_profile_stage(profile_stage::narrowphase);
         m_state = state::solve;
         return true;
     }
@@ -534,12 +584,15 @@ void island_worker::finish_narrowphase() {
     sync_dirty();
     auto &nphase = m_registry.ctx().at<narrowphase>();
     nphase.finish_async_update();
+    end_profile_stage(profile_stage::narrowphase);
     m_state = state::solve;
 }
 
 void island_worker::run_solver() {
     EDYN_ASSERT(m_state == state::solve);
+    begin_profile_stage();
     m_solver.update(m_registry.ctx().at<edyn::settings>().fixed_dt);
+    end_profile_stage(profile_stage::solver);
     m_state = state::finish_step;
 }
 
@@ -553,6 +606,7 @@ static void decay_discontinuities(entt::registry &registry, scalar rate) {
 
 void island_worker::finish_step() {
     EDYN_ASSERT(m_state == state::finish_step);
+    begin_profile_stage();
 
     auto &isle_time = m_registry.get<island_timestamp>(m_island_entity);
     auto dt = m_step_start_time - isle_time.value;
@@ -577,7 +631,7 @@ void island_worker::finish_step() {
 
     // Update tree view.
     auto &bphase = m_registry.ctx().at<broadphase_worker>();
-    auto tview = bphase.view();
+    auto tview = bphase.publish_view(m_entity_map);
     m_registry.replace<tree_view>(m_island_entity, tview);
     m_op_builder->replace<tree_view>(m_registry, m_island_entity);
 
@@ -599,6 +653,7 @@ void island_worker::finish_step() {
 
     sync();
 
+    end_profile_stage(profile_stage::finish_step);
     m_state = state::step;
 
     // Unfortunately, an island cannot be split immediately, because a merge could
@@ -990,7 +1045,7 @@ entity_graph::connected_components_t island_worker::split() {
     // Refresh island tree view after nodes are removed and send it back to
     // the coordinator via the message queue.
     auto &bphase = m_registry.ctx().at<broadphase_worker>();
-    auto tview = bphase.view();
+    auto tview = bphase.publish_view(m_entity_map);
     m_registry.replace<tree_view>(m_island_entity, tview);
     m_op_builder->replace<tree_view>(m_registry, m_island_entity);
     auto ops = m_op_builder->finish();
@@ -39,8 +39,11 @@ void island_worker_context::read_messages() {
     m_message_queue.update();
 }
 
-void island_worker_context::send_reg_ops() {
-    send<msg::island_reg_ops>(m_op_builder->finish());
+size_t island_worker_context::send_reg_ops() {
+    auto ops = m_op_builder->finish();
+    auto size = ops.size_bytes();
+    send<msg::island_reg_ops>(std::move(ops));
+    return size;
 }
 
 void island_worker_context::flush() {
@@ -0,0 +1,131 @@
+#include "edyn/parallel/job_deque.hpp"
+#include "edyn/config/config.h"
+#include <cstring>
+#include <type_traits>
+
+namespace edyn {
+
+static_assert(std::is_trivially_copyable_v<job>);
+static_assert(sizeof(job) % sizeof(uint64_t) == 0);
+
+void atomic_job_slot::store(const job &j) {
+    uint64_t words[num_words];
+    std::memcpy(words, &j, sizeof(job));
+
+    for (size_t i = 0; i < num_words; ++i) {
+        m_words[i].store(words[i], std::memory_order_relaxed);
+    }
+}
+
+job atomic_job_slot::load() const {
+    uint64_t words[num_words];
+
+    for (size_t i = 0; i < num_words; ++i) {
+        words[i] = m_words[i].load(std::memory_order_relaxed);
+    }
+
+    job j;
+    std::memcpy(&j, words, sizeof(job));
+    return j;
+}
+
+job_deque::buffer::buffer(int64_t capacity)
+    : m_capacity(capacity)
+    , m_mask(capacity - 1)
+    , m_slots(new atomic_job_slot[capacity])
+{
+    // Capacity must be a power of two.
+    EDYN_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+}
+
+job_deque::job_deque(int64_t initial_capacity)
+    : m_top(0)
+    , m_bottom(0)
+{
+    auto &buf = m_buffers.emplace_back(std::make_unique<buffer>(initial_capacity));
+    m_buffer.store(buf.get(), std::memory_order_relaxed);
+}
+
+job_deque::buffer * job_deque::grow(buffer *buf, int64_t bottom, int64_t top) {
+    auto &new_buf = m_buffers.emplace_back(std::make_unique<buffer>(buf->capacity() * 2));
+
+    for (auto i = top; i < bottom; ++i) {
+        new_buf->put(i, buf->get(i));
+    }
+
+    m_buffer.store(new_buf.get(), std::memory_order_release);
+
+    return new_buf.get();
+}
+
+void job_deque::push(const job &j) {
+    auto bottom = m_bottom.load(std::memory_order_relaxed);
+    auto top = m_top.load(std::memory_order_acquire);
+    auto *buf = m_buffer.load(std::memory_order_relaxed);
+
+    if (bottom - top > buf->capacity() - 1) {
+        buf = grow(buf, bottom, top);
+    }
+
+    buf->put(bottom, j);
+    // Publish the job to thieves.
+    m_bottom.store(bottom + 1, std::memory_order_release);
+}
+
+bool job_deque::pop(job &j) {
+    auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    auto *buf = m_buffer.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        // Deque is empty.
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    j = buf->get(bottom);
+
+    if (top == bottom) {
+        // Last job. Compete against thieves for it.
+        auto won = m_top.compare_exchange_strong(top, top + 1,
+                                                 std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    return true;
+}
+
+bool job_deque::steal(job &j) {
+    auto top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom = m_bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+        return false;
+    }
+
+    auto *buf = m_buffer.load(std::memory_order_acquire);
+    auto stolen = buf->get(top);
+
+    if (!m_top.compare_exchange_strong(top, top + 1,
+                                       std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+        // Lost the race against the owner or another thief.
+        return false;
+    }
+
+    j = stolen;
+    return true;
+}
+
+bool job_deque::empty() const {
+    auto bottom = m_bottom.load(std::memory_order_relaxed);
+    auto top = m_top.load(std::memory_order_relaxed);
+    return top >= bottom;
+}
+
+}
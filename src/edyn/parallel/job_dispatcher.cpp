@@ -3,12 +3,19 @@
 #include "edyn/parallel/job_queue_scheduler.hpp"
 #include "edyn/parallel/worker.hpp"
 #include "edyn/config/config.h"
-#include <cstdint>
+#include <functional>
 
 namespace edyn {
 
 thread_local job_queue job_dispatcher::m_queue;
 
+// Dispatcher and worker running in the current thread, if any.
+static thread_local job_dispatcher *current_dispatcher = nullptr;
+static thread_local worker *current_worker = nullptr;
+
+// Number of attempts at finding a job before a worker goes to sleep.
+static constexpr unsigned max_idle_spins = 32;
+
 job_dispatcher &job_dispatcher::global() {
     static job_dispatcher instance;
     return instance;
@@ -34,14 +41,19 @@ void job_dispatcher::start() {
 
 void job_dispatcher::start(size_t num_worker_threads) {
     EDYN_ASSERT(m_workers.empty());
+    EDYN_ASSERT(num_worker_threads > 0);
 
+    m_running.store(true, std::memory_order_release);
+
+    // Create all workers before starting the threads since workers access
+    // one another to steal jobs.
     for (size_t i = 0; i < num_worker_threads; ++i) {
-        auto w = std::make_unique<worker>();
-        auto t = std::make_unique<std::thread>(&worker::run, w.get());
-        auto id = t->get_id();
+        m_workers.push_back(std::make_unique<worker>(i));
+    }
 
+    for (auto &w : m_workers) {
+        auto t = std::make_unique<std::thread>(&job_dispatcher::run_worker, this, std::ref(*w));
         m_threads.push_back(std::move(t));
-        m_workers[id] = std::move(w);
     }
 
     m_scheduler.start();
@@ -50,58 +62,160 @@ void job_dispatcher::start(size_t num_worker_threads) {
 void job_dispatcher::stop() {
     m_scheduler.stop();
 
-    for (auto &pair : m_workers) {
-        pair.second->stop();
+    {
+        auto lock = std::lock_guard(m_sleep_mutex);
+        m_running.store(false, std::memory_order_release);
     }
 
+    m_sleep_cv.notify_all();
+
     for (auto &t : m_threads) {
         t->join();
     }
 
-    m_workers.clear();
     m_threads.clear();
+    m_workers.clear();
 }
 
 bool job_dispatcher::running() const {
     return !m_threads.empty();
 }
 
-void job_dispatcher::async(const job &j) {
-    EDYN_ASSERT(!m_workers.empty());
+void job_dispatcher::run_worker(worker &w) {
+    current_dispatcher = this;
+    current_worker = &w;
 
-    if (m_workers.size() == 1) {
-        m_workers.begin()->second->push_job(j);
-        return;
+    job j;
+
+    while (m_running.load(std::memory_order_acquire)) {
+        if (try_get_job(w, j)) {
+            j();
+            continue;
+        }
+
+        // Jobs often come in shortly after the worker runs out of them, e.g.
+        // the continuation of a job that is running in another worker. Try a
+        // few more times before going to sleep.
+        auto found = false;
+
+        for (unsigned i = 0; i < max_idle_spins; ++i) {
+            std::this_thread::yield();
+
+            if (try_get_job(w, j)) {
+                found = true;
+                break;
+            }
+        }
+
+        if (found) {
+            j();
+        } else {
+            wait_for_jobs();
+        }
+    }
+
+    // Run the jobs which are still pending before exiting, since they might
+    // hold resources which are released once they complete, such as the
+    // context of an async parallel-for. Jobs spawned by these are run as well.
+    while (try_get_job(w, j)) {
+        j();
+    }
+
+    current_dispatcher = nullptr;
+    current_worker = nullptr;
+}
+
+bool job_dispatcher::try_get_job(worker &w, job &j) {
+    if (w.get_deque().pop(j)) {
+        return true;
+    }
+
+    if (m_injection_queue.try_pop(j)) {
+        return true;
     }
 
-    // Find least busy worker to insert job into. Start search from a different
-    // worker each time to create a better spread. This prevents the first
-    // worker from being prioritized and getting most jobs.
-    auto best_id = std::thread::id();
-    auto min_num_jobs = SIZE_MAX;
-    auto start = m_start.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
-    auto end = start + m_workers.size();
-
-    for (size_t i = start; i < end; ++i) {
-        auto k = i % m_workers.size();
-        auto first = m_workers.begin();
-        std::advance(first, k);
-        auto &pair = *first;
-
-        auto s = pair.second->size();
-        if (s == 0) {
-            pair.second->push_job(j);
-            return;
+    auto num_workers = m_workers.size();
+
+    if (num_workers < 2) {
+        return false;
+    }
+
+    // Try to steal from all other workers starting at a random one.
+    auto start = w.random_victim(num_workers);
+
+    for (size_t i = 0; i < num_workers; ++i) {
+        auto k = (start + i) % num_workers;
+
+        if (k != w.index() && m_workers[k]->get_deque().steal(j)) {
+            return true;
         }
-        if (s < min_num_jobs) {
-            min_num_jobs = s;
-            best_id = pair.first;
+    }
+
+    return false;
+}
+
+bool job_dispatcher::has_pending_jobs() const {
+    if (!m_injection_queue.empty()) {
+        return true;
+    }
+
+    for (auto &w : m_workers) {
+        if (!w->get_deque().empty()) {
+            return true;
         }
     }
 
-    EDYN_ASSERT(m_workers.count(best_id));
+    return false;
+}
+
+void job_dispatcher::wait_for_jobs() {
+    auto lock = std::unique_lock(m_sleep_mutex);
+
+    // Register as sleeping before checking for jobs one last time. Paired
+    // with the fence in `notify_workers`, this guarantees that either a job
+    // which was just scheduled is seen here or the thread that scheduled it
+    // sees this worker sleeping and wakes it up.
+    m_num_sleeping.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!has_pending_jobs() && m_running.load(std::memory_order_acquire)) {
+        m_sleep_cv.wait(lock, [&] {
+            return m_num_wakeups > 0 || !m_running.load(std::memory_order_acquire);
+        });
+
+        if (m_num_wakeups > 0) {
+            --m_num_wakeups;
+        }
+    }
 
-    m_workers[best_id]->push_job(j);
+    m_num_sleeping.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void job_dispatcher::notify_workers() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_num_sleeping.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    auto lock = std::lock_guard(m_sleep_mutex);
+
+    if (m_num_wakeups < m_num_sleeping.load(std::memory_order_relaxed)) {
+        ++m_num_wakeups;
+        m_sleep_cv.notify_one();
+    }
+}
+
+void job_dispatcher::async(const job &j) {
+    EDYN_ASSERT(!m_workers.empty());
+
+    if (current_dispatcher == this) {
+        current_worker->get_deque().push(j);
+    } else {
+        m_injection_queue.push(j);
+    }
+
+    notify_workers();
 }
 
 void job_dispatcher::async_after(double delta_time, const job &j) {
@@ -130,9 +244,9 @@ job_queue_scheduler job_dispatcher::get_current_scheduler() {
 }
 
 void job_dispatcher::assure_current_queue() {
-    auto id = std::this_thread::get_id();
     // Must not be called from a worker thread.
-    EDYN_ASSERT(!m_workers.count(id));
+    EDYN_ASSERT(current_dispatcher != this);
+    auto id = std::this_thread::get_id();
 
     auto lock = std::lock_guard(m_queues_mutex);
     if (!m_queues_map.count(id)) {
@@ -0,0 +1,118 @@
+#include "edyn/parallel/job_injection_queue.hpp"
+#include "edyn/config/config.h"
+#include <cstdint>
+
+namespace edyn {
+
+job_injection_queue::job_injection_queue(size_t capacity)
+    : m_mask(capacity - 1)
+    , m_cells(new cell[capacity])
+    , m_enqueue_pos(0)
+    , m_dequeue_pos(0)
+    , m_overflow_size(0)
+{
+    // Capacity must be a power of two.
+    EDYN_ASSERT(capacity > 1 && (capacity & (capacity - 1)) == 0);
+
+    for (size_t i = 0; i < capacity; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool job_injection_queue::try_push_ring(const job &j) {
+    auto pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    cell *c;
+
+    while (true) {
+        c = &m_cells[pos & m_mask];
+        auto seq = c->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            // Cell is free. Try to claim it.
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Ring is full.
+            return false;
+        } else {
+            // Another producer claimed this cell.
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    c->data = j;
+    c->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+bool job_injection_queue::try_pop_ring(job &j) {
+    auto pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    cell *c;
+
+    while (true) {
+        c = &m_cells[pos & m_mask];
+        auto seq = c->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+        if (diff == 0) {
+            // Cell holds a job. Try to claim it.
+            if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Ring is empty.
+            return false;
+        } else {
+            // Another consumer claimed this cell.
+            pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    j = c->data;
+    c->sequence.store(pos + m_mask + 1, std::memory_order_release);
+
+    return true;
+}
+
+void job_injection_queue::push(const job &j) {
+    if (try_push_ring(j)) {
+        return;
+    }
+
+    auto lock = std::lock_guard(m_overflow_mutex);
+    m_overflow.push_back(j);
+    m_overflow_size.store(m_overflow.size(), std::memory_order_release);
+}
+
+bool job_injection_queue::try_pop(job &j) {
+    if (try_pop_ring(j)) {
+        return true;
+    }
+
+    if (m_overflow_size.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    auto lock = std::lock_guard(m_overflow_mutex);
+
+    if (m_overflow.empty()) {
+        return false;
+    }
+
+    j = m_overflow.front();
+    m_overflow.pop_front();
+    m_overflow_size.store(m_overflow.size(), std::memory_order_release);
+
+    return true;
+}
+
+bool job_injection_queue::empty() const {
+    auto enqueue_pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    auto dequeue_pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    return enqueue_pos == dequeue_pos && m_overflow_size.load(std::memory_order_relaxed) == 0;
+}
+
+}
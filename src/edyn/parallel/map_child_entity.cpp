@@ -23,13 +23,7 @@ void map_child_entity_sequence(const entity_map &emap, entt::meta_sequence_conta
 
     for (size_t i = 0; i < seq.size(); ++i) {
         auto &entity_ref = seq[i].cast<entt::entity &>();
-        auto local_entity = entt::entity{entt::null};
-
-        if (emap.contains(entity_ref)) {
-            local_entity = emap.at(entity_ref);
-        }
-
-        entity_ref = local_entity;
+        entity_ref = emap.find(entity_ref);
     }
 
     remove_null_entities_in_sequence(seq);
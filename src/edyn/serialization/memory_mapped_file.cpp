@@ -0,0 +1,144 @@
+#include "edyn/serialization/memory_mapped_file.hpp"
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace edyn {
+
+memory_mapped_file::~memory_mapped_file() {
+    close();
+}
+
+#if defined(_WIN32)
+
+bool memory_mapped_file::open(const std::string &path) {
+    close();
+
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+
+    auto *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file_handle = file;
+    m_mapping_handle = mapping;
+    m_data = static_cast<const uint8_t *>(data);
+    m_size = static_cast<size_t>(file_size.QuadPart);
+
+    return true;
+}
+
+void memory_mapped_file::close() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping_handle);
+        CloseHandle(m_file_handle);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file_handle = nullptr;
+    m_mapping_handle = nullptr;
+}
+
+void memory_mapped_file::will_need(size_t offset, size_t size) const {
+    if (m_data == nullptr || offset >= m_size) {
+        return;
+    }
+
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t *>(m_data + offset);
+    range.NumberOfBytes = std::min(size, m_size - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool memory_mapped_file::open(const std::string &path) {
+    close();
+
+    auto fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) == -1 || file_stat.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    auto size = static_cast<size_t>(file_stat.st_size);
+    auto *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping remains valid after the descriptor is closed.
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t *>(data);
+    m_size = size;
+
+    return true;
+}
+
+void memory_mapped_file::close() {
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void memory_mapped_file::will_need(size_t offset, size_t size) const {
+    if (m_data == nullptr || offset >= m_size) {
+        return;
+    }
+
+    // The start address must be aligned to the page size.
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto start = offset / page_size * page_size;
+    auto end = offset + std::min(size, m_size - offset);
+    madvise(const_cast<uint8_t *>(m_data + start), end - start, MADV_WILLNEED);
+}
+
+#endif
+
+}
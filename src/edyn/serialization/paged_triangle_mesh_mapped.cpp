@@ -0,0 +1,222 @@
+#include "edyn/serialization/paged_triangle_mesh_mapped.hpp"
+#include "edyn/serialization/mapped_archive.hpp"
+#include "edyn/serialization/triangle_mesh_s11n.hpp"
+#include "edyn/serialization/static_tree_s11n.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/shapes/triangle_mesh.hpp"
+#include <memory>
+#include <cstring>
+#include <fstream>
+
+namespace edyn {
+
+static constexpr char mapped_magic[8] = {'E', 'D', 'Y', 'N', 'P', 'T', 'M', 'M'};
+
+static uint64_t align_offset(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+static void write_padding(std::ofstream &file, uint64_t &position, uint64_t target) {
+    EDYN_ASSERT(target >= position);
+    static const char zeros[64] = {};
+
+    while (position < target) {
+        auto count = std::min<uint64_t>(target - position, sizeof(zeros));
+        file.write(zeros, count);
+        position += count;
+    }
+}
+
+bool write_mapped_paged_triangle_mesh(const std::string &path,
+                                      paged_triangle_mesh &paged_tri_mesh) {
+    auto file = std::ofstream(path, std::ios::binary | std::ios::out | std::ios::trunc);
+
+    if (!file.is_open()) {
+        return false;
+    }
+
+    auto buffer = std::vector<uint8_t>{};
+    auto tree_archive = mapped_output_archive(buffer);
+    tree_archive(paged_tri_mesh.m_tree);
+
+    auto num_submeshes = paged_tri_mesh.m_cache.size();
+
+    auto header = mapped_paged_triangle_mesh_header{};
+    std::memcpy(header.magic, mapped_magic, sizeof(mapped_magic));
+    header.version = mapped_paged_triangle_mesh_header::current_version;
+    header.scalar_size = sizeof(scalar);
+    header.tree_offset = align_offset(sizeof(header), mapped_archive_alignment);
+    header.tree_size = buffer.size();
+    header.table_offset = align_offset(header.tree_offset + header.tree_size, mapped_archive_alignment);
+    header.num_submeshes = num_submeshes;
+
+    uint64_t position = 0;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    position += sizeof(header);
+
+    write_padding(file, position, header.tree_offset);
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+    position += buffer.size();
+
+    // The table is written after the submeshes, once their offsets are known.
+    auto entries = std::vector<mapped_submesh_entry>(num_submeshes);
+    write_padding(file, position, header.table_offset + num_submeshes * sizeof(mapped_submesh_entry));
+
+    for (size_t i = 0; i < num_submeshes; ++i) {
+        auto &node = paged_tri_mesh.m_cache[i];
+        EDYN_ASSERT(node.trimesh);
+
+        buffer.clear();
+        auto archive = mapped_output_archive(buffer);
+        archive(*node.trimesh);
+
+        write_padding(file, position, align_offset(position, mapped_submesh_alignment));
+
+        auto &entry = entries[i];
+        entry.offset = position;
+        entry.size = buffer.size();
+        entry.num_vertices = node.num_vertices;
+        entry.num_indices = node.num_indices;
+
+        file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+        position += buffer.size();
+    }
+
+    file.seekp(header.table_offset);
+    file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(mapped_submesh_entry));
+
+    return file.good();
+}
+
+bool paged_triangle_mesh_mapped_loader::open(const std::string &path) {
+    close();
+
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    auto *data = m_file.data();
+    auto size = m_file.size();
+    auto header = mapped_paged_triangle_mesh_header{};
+
+    if (size < sizeof(header)) {
+        close();
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    // Ranges are checked without adding offsets and sizes, which could wrap
+    // around in a corrupt file.
+    if (std::memcmp(header.magic, mapped_magic, sizeof(mapped_magic)) != 0 ||
+        header.version != mapped_paged_triangle_mesh_header::current_version ||
+        header.scalar_size != sizeof(scalar) ||
+        header.tree_offset > size || header.tree_size > size - header.tree_offset ||
+        header.table_offset > size ||
+        header.num_submeshes > (size - header.table_offset) / sizeof(mapped_submesh_entry)) {
+        close();
+        return false;
+    }
+
+    m_submeshes.resize(header.num_submeshes);
+    std::memcpy(m_submeshes.data(), data + header.table_offset,
+                m_submeshes.size() * sizeof(mapped_submesh_entry));
+
+    for (auto &entry : m_submeshes) {
+        if (entry.offset > size || entry.size > size - entry.offset) {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void paged_triangle_mesh_mapped_loader::close() {
+    m_file.close();
+    m_submeshes.clear();
+}
+
+bool read_mapped_paged_triangle_mesh(paged_triangle_mesh_mapped_loader &loader,
+                                     paged_triangle_mesh &paged_tri_mesh) {
+    EDYN_ASSERT(loader.is_open());
+    auto header = mapped_paged_triangle_mesh_header{};
+    std::memcpy(&header, loader.m_file.data(), sizeof(header));
+
+    auto archive = mapped_input_archive(loader.m_file.data() + header.tree_offset, header.tree_size);
+    archive(paged_tri_mesh.m_tree);
+
+    if (archive.failed()) {
+        return false;
+    }
+
+    auto num_submeshes = loader.m_submeshes.size();
+    paged_tri_mesh.m_cache.resize(num_submeshes);
+
+    for (size_t i = 0; i < num_submeshes; ++i) {
+        auto &node = paged_tri_mesh.m_cache[i];
+        node.num_vertices = loader.m_submeshes[i].num_vertices;
+        node.num_indices = loader.m_submeshes[i].num_indices;
+    }
+
+    paged_tri_mesh.init_cache();
+
+    return true;
+}
+
+struct load_mapped_mesh_context {
+    // Integral value of a pointer to an instance of
+    // `paged_triangle_mesh_mapped_loader`.
+    intptr_t m_loader;
+    // Index of submesh to be loaded.
+    size_t m_index;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, load_mapped_mesh_context &ctx) {
+    archive(ctx.m_loader);
+    archive(ctx.m_index);
+}
+
+void paged_triangle_mesh_mapped_loader::load(size_t index) {
+    EDYN_ASSERT(index < m_submeshes.size());
+    auto &entry = m_submeshes[index];
+
+    // Let the kernel read the pages of this submesh while the job is waiting
+    // to be executed.
+    m_file.will_need(entry.offset, entry.size);
+
+    auto ctx = load_mapped_mesh_context();
+    ctx.m_loader = reinterpret_cast<intptr_t>(this);
+    ctx.m_index = index;
+
+    auto j = job();
+    j.func = &load_mapped_mesh_job_func;
+    auto archive = fixed_memory_output_archive(j.data.data(), j.data.size());
+    serialize(archive, ctx);
+    job_dispatcher::global().async(j);
+}
+
+void load_mapped_mesh_job_func(job::data_type &data) {
+    load_mapped_mesh_context ctx;
+    auto archive = memory_input_archive(data.data(), data.size());
+    serialize(archive, ctx);
+
+    auto *loader = reinterpret_cast<paged_triangle_mesh_mapped_loader *>(ctx.m_loader);
+    auto &entry = loader->m_submeshes[ctx.m_index];
+    auto mesh = std::make_shared<triangle_mesh>();
+
+    auto mesh_archive = mapped_input_archive(loader->m_file.data() + entry.offset, entry.size);
+    serialize(mesh_archive, *mesh);
+
+    // Do not publish a partially read submesh.
+    if (mesh_archive.failed()) {
+        loader->m_load_failed_signal.publish(ctx.m_index);
+        return;
+    }
+
+    loader->m_loaded_signal.publish(ctx.m_index, mesh);
+}
+
+}
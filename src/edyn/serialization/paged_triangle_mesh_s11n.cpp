@@ -95,12 +95,7 @@ void serialize(paged_triangle_mesh_file_input_archive &archive,
         archive.m_base_offset = archive.tell_position();
     }
 
-    // Resize LRU queue to have the number of submeshes.
-    paged_tri_mesh.m_lru_indices.resize(num_submeshes);
-    std::iota(paged_tri_mesh.m_lru_indices.begin(),
-              paged_tri_mesh.m_lru_indices.end(), 0);
-
-    paged_tri_mesh.m_is_loading_submesh = std::make_unique<std::atomic<bool>[]>(num_submeshes);
+    paged_tri_mesh.init_cache();
 }
 
 template<typename Archive>
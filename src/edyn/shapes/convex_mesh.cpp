@@ -18,6 +18,7 @@ void convex_mesh::update_calculated_properties() {
     calculate_edges();
     calculate_relevant_normals();
     calculate_relevant_edges();
+    calculate_vertex_neighbors();
 }
 
 void convex_mesh::shift_to_centroid() {
@@ -46,6 +47,55 @@ std::array<vector3, 2> convex_mesh::get_rotated_edge(const rotated_mesh &rmesh,
     };
 }
 
+uint32_t convex_mesh::support_vertex_index(const std::vector<vector3> &points, const vector3 &dir,
+                                           uint32_t start_idx) const {
+    EDYN_ASSERT(points.size() == vertices.size());
+    EDYN_ASSERT(start_idx < points.size());
+
+    if (vertex_neighbors.empty()) {
+        auto max_proj = -EDYN_SCALAR_MAX;
+        uint32_t max_idx = 0;
+
+        for (uint32_t i = 0; i < points.size(); ++i) {
+            auto proj = dot(points[i], dir);
+
+            if (proj > max_proj) {
+                max_proj = proj;
+                max_idx = i;
+            }
+        }
+
+        return max_idx;
+    }
+
+    auto max_idx = start_idx;
+    auto max_proj = dot(points[max_idx], dir);
+    auto improved = true;
+
+    // Move to the neighbor with greatest projection until there's none
+    // greater than the current vertex.
+    while (improved) {
+        improved = false;
+        auto first = vertex_neighbors[max_idx * 2];
+        auto count = vertex_neighbors[max_idx * 2 + 1];
+        auto curr_idx = max_idx;
+
+        for (auto i = first; i < first + count; ++i) {
+            auto neighbor_idx = neighbor_indices[i];
+            auto proj = dot(points[neighbor_idx], dir);
+
+            if (proj > max_proj) {
+                max_proj = proj;
+                max_idx = neighbor_idx;
+            }
+        }
+
+        improved = max_idx != curr_idx;
+    }
+
+    return max_idx;
+}
+
 void convex_mesh::calculate_normals() {
     normals.clear();
 
@@ -144,6 +194,33 @@ void convex_mesh::calculate_relevant_edges() {
     }
 }
 
+void convex_mesh::calculate_vertex_neighbors() {
+    // Count neighbors of each vertex, then assign the first index of each
+    // range and finally fill in the neighbors.
+    vertex_neighbors.assign(vertices.size() * 2, 0);
+
+    for (auto idx : edges) {
+        ++vertex_neighbors[idx * 2 + 1];
+    }
+
+    uint32_t first = 0;
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        vertex_neighbors[i * 2] = first;
+        first += vertex_neighbors[i * 2 + 1];
+        vertex_neighbors[i * 2 + 1] = 0;
+    }
+
+    neighbor_indices.resize(first);
+
+    for (size_t i = 0; i < edges.size(); i += 2) {
+        auto i0 = edges[i];
+        auto i1 = edges[i + 1];
+        neighbor_indices[vertex_neighbors[i0 * 2] + vertex_neighbors[i0 * 2 + 1]++] = i1;
+        neighbor_indices[vertex_neighbors[i1 * 2] + vertex_neighbors[i1 * 2 + 1]++] = i0;
+    }
+}
+
 #ifdef EDYN_DEBUG
 void convex_mesh::validate() const {
 #ifndef EDYN_DISABLE_ASSERT
@@ -11,6 +11,7 @@ paged_triangle_mesh::paged_triangle_mesh(std::shared_ptr<triangle_mesh_page_load
     : m_page_loader(loader)
 {
     m_page_loader->on_load_sink().connect<&paged_triangle_mesh::assign_mesh>(*this);
+    m_page_loader->on_load_failed_sink().connect<&paged_triangle_mesh::cancel_load>(*this);
 }
 
 size_t paged_triangle_mesh::cache_num_vertices() const {
@@ -27,47 +28,122 @@ size_t paged_triangle_mesh::cache_num_vertices() const {
     return count;
 }
 
+void paged_triangle_mesh::init_cache() {
+    auto num_submeshes = m_cache.size();
+    m_is_loading_submesh = std::make_unique<std::atomic<bool>[]>(num_submeshes);
+    m_referenced = std::make_unique<std::atomic<bool>[]>(num_submeshes);
+
+    m_resident.clear();
+    m_clock_hand = 0;
+    size_t size_bytes = 0;
+
+    for (size_t i = 0; i < num_submeshes; ++i) {
+        auto &node = m_cache[i];
+
+        if (node.trimesh) {
+            node.size_bytes = node.trimesh->memory_size();
+            size_bytes += node.size_bytes;
+            m_resident.push_back(i);
+        }
+    }
+
+    m_cache_size_bytes.store(size_bytes, std::memory_order_relaxed);
+}
+
 void paged_triangle_mesh::load_node_if_needed(size_t trimesh_idx) {
     EDYN_ASSERT(m_is_loading_submesh && trimesh_idx < m_cache.size());
+    auto &node = m_cache[trimesh_idx];
+
+    // Most visits hit the cache. Return before touching any shared state.
+    if (node.trimesh) {
+        m_num_hits.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
     auto already_loading = m_is_loading_submesh[trimesh_idx].exchange(true, std::memory_order_relaxed);
 
     if (already_loading) {
         return;
     }
 
-    auto &node = m_cache[trimesh_idx];
-
     if (node.trimesh) {
         m_is_loading_submesh[trimesh_idx].store(false, std::memory_order_relaxed);
         return;
     }
 
-    EDYN_ASSERT(node.num_vertices < m_max_cache_num_vertices);
-    // Load triangle mesh into cache. Clear cache if it would go
-    // above limits.
-    while (cache_num_vertices() + node.num_vertices > m_max_cache_num_vertices) {
-        unload_least_recently_visited_node();
+    m_num_misses.fetch_add(1, std::memory_order_relaxed);
+
+    // Use the actual size if it has been loaded before. Note that
+    // `num_indices` holds the number of index triples, i.e. triangles.
+    auto size_bytes = node.size_bytes > 0 ? node.size_bytes :
+        triangle_mesh::estimate_memory_size(node.num_vertices, node.num_indices);
+    EDYN_ASSERT(size_bytes < m_max_cache_size_bytes);
+
+    {
+        // Unload submeshes until the new one fits in the budget.
+        auto lock = std::lock_guard(m_cache_mutex);
+
+        while (m_cache_size_bytes.load(std::memory_order_relaxed) + size_bytes > m_max_cache_size_bytes) {
+            if (!evict_one()) {
+                break;
+            }
+        }
     }
 
+    m_num_pending_loads.fetch_add(1, std::memory_order_relaxed);
     m_page_loader->load(trimesh_idx);
 }
 
+void paged_triangle_mesh::prefetch(const AABB &aabb, size_t max_pending_loads) {
+    m_tree.query(aabb, [&](auto tree_node_idx) {
+        auto mesh_idx = m_tree.get_node(tree_node_idx).id;
+
+        if (!m_cache[mesh_idx].trimesh &&
+            !m_is_loading_submesh[mesh_idx].load(std::memory_order_relaxed) &&
+            num_pending_loads() < max_pending_loads) {
+            load_node_if_needed(mesh_idx);
+        }
+    });
+}
+
 void paged_triangle_mesh::mark_recent_visit(size_t trimesh_idx) {
-    auto lock = std::lock_guard(m_lru_mutex);
-    auto it = std::find(m_lru_indices.begin(), m_lru_indices.end(), trimesh_idx);
-    std::rotate(m_lru_indices.begin(), it, it + 1);
+    // Avoid writing to the cache line if the bit is already set, since many
+    // threads visit the same submeshes.
+    if (!m_referenced[trimesh_idx].load(std::memory_order_relaxed)) {
+        m_referenced[trimesh_idx].store(true, std::memory_order_relaxed);
+    }
 }
 
-void paged_triangle_mesh::unload_least_recently_visited_node() {
-    auto lock = std::lock_guard(m_lru_mutex);
+bool paged_triangle_mesh::evict_one() {
+    // Must be called with `m_cache_mutex` locked. Each resident submesh has
+    // its reference bit cleared at most once, thus it takes at most two
+    // turns of the clock to find a victim.
+    while (!m_resident.empty()) {
+        if (m_clock_hand >= m_resident.size()) {
+            m_clock_hand = 0;
+        }
 
-    for (auto it = m_lru_indices.rbegin(); it != m_lru_indices.rend(); ++it) {
-        auto &node = m_cache[*it];
-        if (node.trimesh) {
-            node.trimesh.reset();
-            break;
+        auto mesh_idx = m_resident[m_clock_hand];
+
+        if (m_referenced[mesh_idx].exchange(false, std::memory_order_relaxed)) {
+            ++m_clock_hand;
+            continue;
         }
+
+        auto &node = m_cache[mesh_idx];
+        node.trimesh.reset();
+        m_cache_size_bytes.fetch_sub(node.size_bytes, std::memory_order_relaxed);
+        m_num_evictions.fetch_add(1, std::memory_order_relaxed);
+
+        // Swap with last. The hand now points at the submesh that was moved
+        // in, which hasn't been inspected in this turn.
+        m_resident[m_clock_hand] = m_resident.back();
+        m_resident.pop_back();
+
+        return true;
     }
+
+    return false;
 }
 
 triangle_vertices paged_triangle_mesh::get_triangle_vertices(size_t mesh_idx, size_t tri_idx) {
@@ -77,17 +153,66 @@ triangle_vertices paged_triangle_mesh::get_triangle_vertices(size_t mesh_idx, si
 }
 
 void paged_triangle_mesh::clear_cache() {
-    for (auto &node : m_cache) {
-        node.trimesh.reset();
+    auto lock = std::lock_guard(m_cache_mutex);
+
+    for (auto idx : m_resident) {
+        m_cache[idx].trimesh.reset();
+        m_referenced[idx].store(false, std::memory_order_relaxed);
     }
+
+    m_resident.clear();
+    m_clock_hand = 0;
+    m_cache_size_bytes.store(0, std::memory_order_relaxed);
 }
 
 void paged_triangle_mesh::assign_mesh(size_t index, std::shared_ptr<triangle_mesh> mesh) {
+    EDYN_ASSERT(mesh);
     // Use lock to prevent assigning to the same trimesh shared_ptr concurrently
-    // if `unload_least_recently_visited_node` is executing in another thread.
-    auto lock = std::lock_guard(m_lru_mutex);
-    m_cache[index].trimesh = mesh;
-    m_is_loading_submesh[index].store(false, std::memory_order_release);
+    // if `evict_one` is executing in another thread.
+    auto lock = std::lock_guard(m_cache_mutex);
+    auto &node = m_cache[index];
+
+    if (node.trimesh) {
+        m_cache_size_bytes.fetch_sub(node.size_bytes, std::memory_order_relaxed);
+    } else {
+        m_resident.push_back(index);
+    }
+
+    node.trimesh = mesh;
+    node.size_bytes = mesh->memory_size();
+    m_cache_size_bytes.fetch_add(node.size_bytes, std::memory_order_relaxed);
+    // Give it a full turn of the clock before it can be evicted.
+    m_referenced[index].store(true, std::memory_order_relaxed);
+
+    // Only meshes requested via `load_node_if_needed` count as pending.
+    if (m_is_loading_submesh[index].exchange(false, std::memory_order_release)) {
+        m_num_pending_loads.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void paged_triangle_mesh::cancel_load(size_t index) {
+    if (m_is_loading_submesh[index].exchange(false, std::memory_order_release)) {
+        m_num_pending_loads.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+paged_triangle_mesh::cache_statistics paged_triangle_mesh::get_cache_statistics() const {
+    auto stats = cache_statistics{};
+    stats.num_hits = m_num_hits.load(std::memory_order_relaxed);
+    stats.num_misses = m_num_misses.load(std::memory_order_relaxed);
+    stats.num_evictions = m_num_evictions.load(std::memory_order_relaxed);
+    stats.size_bytes = m_cache_size_bytes.load(std::memory_order_relaxed);
+
+    auto lock = std::lock_guard(m_cache_mutex);
+    stats.num_resident = m_resident.size();
+
+    return stats;
+}
+
+void paged_triangle_mesh::reset_cache_statistics() {
+    m_num_hits.store(0, std::memory_order_relaxed);
+    m_num_misses.store(0, std::memory_order_relaxed);
+    m_num_evictions.store(0, std::memory_order_relaxed);
 }
 
 bool paged_triangle_mesh::has_per_vertex_friction() const {
@@ -12,6 +12,42 @@ void triangle_mesh::initialize() {
     build_triangle_tree();
 }
 
+size_t triangle_mesh::memory_size() const {
+    return
+        m_vertices.capacity() * sizeof(vector3) +
+        m_indices.capacity() * sizeof(std::array<index_type, 3>) +
+        m_normals.capacity() * sizeof(vector3) +
+        m_adjacent_normals.capacity() * sizeof(std::array<vector3, 3>) +
+        m_edge_vertex_indices.capacity() * sizeof(unordered_pair<index_type>) +
+        m_vertex_edge_indices.memory_size() +
+        m_face_edge_indices.capacity() * sizeof(std::array<index_type, 3>) +
+        m_edge_face_indices.capacity() * sizeof(std::array<index_type, 2>) +
+        m_is_boundary_edge.capacity() / 8 +
+        m_is_convex_edge.capacity() / 8 +
+        m_friction.capacity() * sizeof(scalar) +
+        m_restitution.capacity() * sizeof(scalar) +
+        m_triangle_tree.memory_size();
+}
+
+size_t triangle_mesh::estimate_memory_size(size_t num_vertices, size_t num_triangles) {
+    // Approximate number of edges using Euler's formula for planar graphs.
+    auto num_edges = num_vertices + num_triangles;
+    // A binary tree with one triangle per leaf.
+    auto num_tree_nodes = num_triangles * 2;
+
+    return
+        num_vertices * sizeof(vector3) +
+        num_triangles * sizeof(std::array<index_type, 3>) +
+        num_triangles * sizeof(vector3) +
+        num_triangles * sizeof(std::array<vector3, 3>) +
+        num_edges * sizeof(unordered_pair<index_type>) +
+        num_edges * 2 * sizeof(index_type) + num_vertices * sizeof(size_t) +
+        num_triangles * sizeof(std::array<index_type, 3>) +
+        num_edges * sizeof(std::array<index_type, 2>) +
+        num_edges / 4 +
+        num_tree_nodes * sizeof(static_tree::tree_node);
+}
+
 void triangle_mesh::calculate_face_normals() {
     m_normals.reserve(m_indices.size());
 
@@ -3,66 +3,194 @@
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/position.hpp"
 #include "edyn/comp/aabb.hpp"
+#include "edyn/comp/linvel.hpp"
 #include "edyn/comp/tag.hpp"
+#include "edyn/context/settings.hpp"
 #include "edyn/util/aabb_util.hpp"
+#include "edyn/util/aabb_batch.hpp"
 #include <entt/entity/registry.hpp>
+#include <type_traits>
+#include <array>
 
 namespace edyn {
 
-template<typename ShapeType>
-AABB updated_aabb(const ShapeType &shape, const vector3 &pos, const quaternion &orn) {
-    return shape_aabb(shape, pos, orn);
-}
+// Expands the AABB to enclose the motion during the next step if the entity
+// has continuous collision detection enabled. Must only be applied to an AABB
+// which was just calculated from the shape.
+template<typename CCDView>
+void sweep_ccd_aabb(entt::entity entity, AABB &aabb, CCDView &ccd_view, scalar dt) {
+    if (!ccd_view.contains(entity)) {
+        return;
+    }
 
-template<>
-AABB updated_aabb(const polyhedron_shape &polyhedron,
-                  const vector3 &pos, const quaternion &orn) {
-    // `shape_aabb(const polyhedron_shape &, ...)` rotates each vertex of a
-    // polyhedron to calculate the AABB. Specialize `updated_aabb` for
-    // polyhedrons to use the rotated mesh.
-    auto aabb = point_cloud_aabb(polyhedron.rotated->vertices);
-    aabb.min += pos;
-    aabb.max += pos;
-    return aabb;
+    auto displacement = ccd_view.template get<linvel>(entity) * dt;
+    aabb.min = min(aabb.min, aabb.min + displacement);
+    aabb.max = max(aabb.max, aabb.max + displacement);
 }
 
-template<typename ShapeType, typename TransformView, typename OriginView>
-void update_aabb(entt::entity entity, ShapeType &shape, TransformView &tr_view, OriginView &origin_view) {
+template<typename ShapeType, typename TransformView, typename OriginView, typename CCDView>
+bool update_aabb(entt::entity entity, ShapeType &shape, TransformView &tr_view,
+                 OriginView &origin_view, CCDView &ccd_view, scalar dt) {
     auto [orn, aabb] = tr_view.template get<orientation, AABB>(entity);
     auto origin = origin_view.contains(entity) ?
         static_cast<vector3>(origin_view.template get<edyn::origin>(entity)) :
         static_cast<vector3>(tr_view.template get<edyn::position>(entity));
-    aabb = updated_aabb(shape, origin, orn);
+    auto new_aabb = shape_aabb(shape, origin, orn);
+    sweep_ccd_aabb(entity, new_aabb, ccd_view, dt);
+
+    if (new_aabb.min == aabb.min && new_aabb.max == aabb.max) {
+        return false;
+    }
+
+    aabb = new_aabb;
+    return true;
+}
+
+static void mark_aabb_changed(entt::registry &registry, entt::entity entity) {
+    if (!registry.all_of<aabb_changed_tag>(entity)) {
+        registry.emplace<aabb_changed_tag>(entity);
+    }
 }
 
 void update_aabb(entt::registry &registry, entt::entity entity) {
     auto tr_view = registry.view<position, orientation, AABB>();
     auto origin_view = registry.view<origin>();
+    auto ccd_view = registry.view<linvel, ccd_tag>();
+    auto dt = registry.ctx().at<settings>().fixed_dt;
 
     visit_shape(registry, entity, [&](auto &&shape) {
-        update_aabb(entity, shape, tr_view, origin_view);
+        if (update_aabb(entity, shape, tr_view, origin_view, ccd_view, dt)) {
+            mark_aabb_changed(registry, entity);
+        }
     });
 }
 
+// Shapes with a closed-form AABB which can be calculated in batches.
 template<typename ShapeType>
-void update_aabbs(entt::registry &registry) {
+constexpr bool has_aabb_batch_v =
+    std::is_same_v<ShapeType, box_shape> ||
+    std::is_same_v<ShapeType, sphere_shape> ||
+    std::is_same_v<ShapeType, capsule_shape> ||
+    std::is_same_v<ShapeType, cylinder_shape>;
+
+template<typename ShapeType>
+void assign_aabb_batch_params(aabb_batch &batch, size_t lane, const ShapeType &shape) {
+    if constexpr(std::is_same_v<ShapeType, box_shape>) {
+        batch.params[0][lane] = shape.half_extents.x;
+        batch.params[1][lane] = shape.half_extents.y;
+        batch.params[2][lane] = shape.half_extents.z;
+    } else if constexpr(std::is_same_v<ShapeType, sphere_shape>) {
+        batch.params[0][lane] = shape.radius;
+    } else {
+        batch.params[0][lane] = shape.radius;
+        batch.params[1][lane] = shape.half_length;
+    }
+}
+
+template<typename ShapeType>
+void calculate_aabb_batch(aabb_batch &batch) {
+    if constexpr(std::is_same_v<ShapeType, box_shape>) {
+        box_aabb_batch(batch);
+    } else if constexpr(std::is_same_v<ShapeType, sphere_shape>) {
+        sphere_aabb_batch(batch);
+    } else if constexpr(std::is_same_v<ShapeType, capsule_shape>) {
+        capsule_aabb_batch(batch);
+    } else {
+        cylinder_aabb_batch(batch);
+    }
+}
+
+template<typename ShapeType>
+void update_aabbs_batched(entt::registry &registry, scalar dt) {
     auto origin_view = registry.view<origin>();
     auto tr_view = registry.view<position, orientation, ShapeType, AABB>();
+    auto ccd_view = registry.view<linvel, ccd_tag>();
+    // Lanes that are not in use in the last batch hold zeros or values of
+    // the previous batch, which are harmless.
+    auto batch = aabb_batch{};
+    auto entities = std::array<entt::entity, aabb_batch_size>{};
+    size_t count = 0;
+
+    auto flush = [&]() {
+        calculate_aabb_batch<ShapeType>(batch);
+
+        for (size_t k = 0; k < count; ++k) {
+            auto entity = entities[k];
+            auto &aabb = tr_view.template get<AABB>(entity);
+            auto new_aabb = AABB{
+                {batch.min[0][k], batch.min[1][k], batch.min[2][k]},
+                {batch.max[0][k], batch.max[1][k], batch.max[2][k]}
+            };
+            sweep_ccd_aabb(entity, new_aabb, ccd_view, dt);
+
+            if (new_aabb.min != aabb.min || new_aabb.max != aabb.max) {
+                aabb = new_aabb;
+                mark_aabb_changed(registry, entity);
+            }
+        }
+
+        count = 0;
+    };
+
+    for (auto entity : tr_view) {
+        auto [pos, orn, shape] = tr_view.template get<position, orientation, ShapeType>(entity);
+        auto origin = origin_view.contains(entity) ?
+            static_cast<vector3>(origin_view.template get<edyn::origin>(entity)) :
+            static_cast<vector3>(pos);
+
+        entities[count] = entity;
+
+        for (size_t i = 0; i < 3; ++i) {
+            batch.pos[i][count] = origin[i];
+        }
+
+        batch.orn[0][count] = orn.x;
+        batch.orn[1][count] = orn.y;
+        batch.orn[2][count] = orn.z;
+        batch.orn[3][count] = orn.w;
+        assign_aabb_batch_params(batch, count, shape);
+
+        if (++count == aabb_batch_size) {
+            flush();
+        }
+    }
+
+    if (count > 0) {
+        flush();
+    }
+}
+
+template<typename ShapeType>
+void update_aabbs(entt::registry &registry, bool batched, scalar dt) {
+    if constexpr(has_aabb_batch_v<ShapeType>) {
+        if (batched) {
+            update_aabbs_batched<ShapeType>(registry, dt);
+            return;
+        }
+    }
+
+    auto origin_view = registry.view<origin>();
+    auto tr_view = registry.view<position, orientation, ShapeType, AABB>();
+    auto ccd_view = registry.view<linvel, ccd_tag>();
 
     for (auto entity : tr_view) {
         auto &shape = tr_view.template get<ShapeType>(entity);
-        update_aabb(entity, shape, tr_view, origin_view);
+
+        if (update_aabb(entity, shape, tr_view, origin_view, ccd_view, dt)) {
+            mark_aabb_changed(registry, entity);
+        }
     }
 }
 
 template<typename... Ts>
-void update_aabbs(entt::registry &registry, std::tuple<Ts...>) {
-    (update_aabbs<Ts>(registry), ...);
+void update_aabbs(entt::registry &registry, bool batched, scalar dt, std::tuple<Ts...>) {
+    (update_aabbs<Ts>(registry, batched, dt), ...);
 }
 
 void update_aabbs(entt::registry &registry) {
     // Update AABBs for all shapes that can be transformed.
-    update_aabbs(registry, dynamic_shapes_tuple);
+    auto &settings = registry.ctx().at<edyn::settings>();
+    update_aabbs(registry, settings.batched_aabb_update, settings.fixed_dt, dynamic_shapes_tuple);
 }
 
 }
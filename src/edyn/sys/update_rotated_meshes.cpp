@@ -2,45 +2,32 @@
 #include "edyn/comp/position.hpp"
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/rotated_mesh_list.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/math/matrix3x3.hpp"
 #include <entt/entity/registry.hpp>
 #include <variant>
 
 namespace edyn {
 
-static void update_rotated_mesh_vertices(rotated_mesh &rotated, const convex_mesh &mesh,
-                                         const quaternion &orn) {
-    EDYN_ASSERT(mesh.vertices.size() == rotated.vertices.size());
-    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
-        auto &vertex_local = mesh.vertices[i];
-        rotated.vertices[i] = rotate(orn, vertex_local);
-    }
-}
-
-static void update_rotated_mesh_normals(rotated_mesh &rotated, const convex_mesh &mesh,
-                                        const quaternion &orn) {
-    EDYN_ASSERT(mesh.relevant_normals.size() == rotated.relevant_normals.size());
-
-    for (size_t i = 0; i < mesh.relevant_normals.size(); ++i) {
-        auto &normal_local = mesh.relevant_normals[i];
-        rotated.relevant_normals[i] = rotate(orn, normal_local);
-    }
-}
+// Rotation is done with a matrix which is calculated once per mesh and is
+// cheaper to apply than a quaternion. The loops have no dependencies between
+// iterations and can be vectorized by the compiler.
+static void rotate_vectors(std::vector<vector3> &rotated, const std::vector<vector3> &local,
+                           const matrix3x3 &basis) {
+    EDYN_ASSERT(local.size() == rotated.size());
 
-static void update_rotated_mesh_edges(rotated_mesh &rotated, const convex_mesh &mesh,
-                                      const quaternion &orn) {
-    EDYN_ASSERT(mesh.relevant_edges.size() == rotated.relevant_edges.size());
-
-    for (size_t i = 0; i < mesh.relevant_edges.size(); ++i) {
-        auto &edge_local = mesh.relevant_edges[i];
-        rotated.relevant_edges[i] = rotate(orn, edge_local);
+    for (size_t i = 0; i < local.size(); ++i) {
+        rotated[i] = basis * local[i];
     }
 }
 
 void update_rotated_mesh(rotated_mesh &rotated, const convex_mesh &mesh,
                          const quaternion &orn) {
-    update_rotated_mesh_vertices(rotated, mesh, orn);
-    update_rotated_mesh_normals(rotated, mesh, orn);
-    update_rotated_mesh_edges(rotated, mesh, orn);
+    auto basis = to_matrix3x3(orn);
+    rotate_vectors(rotated.vertices, mesh.vertices, basis);
+    rotate_vectors(rotated.relevant_normals, mesh.relevant_normals, basis);
+    rotate_vectors(rotated.relevant_edges, mesh.relevant_edges, basis);
+    rotated.orientation = orn;
 }
 
 template<typename RotatedView, typename OrientationView>
@@ -51,9 +38,15 @@ void update_rotated_mesh(entt::entity entity, RotatedView &rotated_view, Orienta
     auto *rot_list_ptr = &rotated_list;
 
     while (true) {
-        // TODO: `rot_list_ptr->orientation` is often `quaternion_identity`.
-        // What could be done to avoid this often unnecessary multiplication?
-        update_rotated_mesh(*rot_list_ptr->rotated, *rot_list_ptr->mesh, orn * rot_list_ptr->orientation);
+        // The local orientation is the identity for all polyhedron shapes and
+        // for most nodes of compound shapes.
+        auto world_orn = rot_list_ptr->orientation == quaternion_identity ?
+            static_cast<quaternion>(orn) : orn * rot_list_ptr->orientation;
+        auto &rotated = *rot_list_ptr->rotated;
+
+        if (rotated.orientation != world_orn) {
+            update_rotated_mesh(rotated, *rot_list_ptr->mesh, world_orn);
+        }
 
         if (rot_list_ptr->next == entt::null) {
             break;
@@ -78,4 +71,20 @@ void update_rotated_meshes(entt::registry &registry) {
     }
 }
 
+void update_contact_rotated_meshes(entt::registry &registry) {
+    auto manifold_view = registry.view<contact_manifold>();
+    auto rotated_view = registry.view<rotated_mesh_list>();
+    auto orn_view = registry.view<orientation>();
+
+    for (auto entity : manifold_view) {
+        auto &manifold = manifold_view.get<contact_manifold>(entity);
+
+        for (auto body : manifold.body) {
+            if (rotated_view.contains(body)) {
+                update_rotated_mesh(body, rotated_view, orn_view);
+            }
+        }
+    }
+}
+
 }
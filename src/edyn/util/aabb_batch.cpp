@@ -0,0 +1,103 @@
+#include "edyn/util/aabb_batch.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace edyn {
+
+// The kernels are written as plain loops over the lanes without branches,
+// which the compiler packs into vector instructions.
+
+// Fills `basis` with the rotation matrices of the orientations in the batch,
+// i.e. `basis[i][j]` is the element in row `i` and column `j`.
+static void batch_basis(const aabb_batch &batch, scalar (&basis)[3][3][aabb_batch_size]) {
+    for (size_t k = 0; k < aabb_batch_size; ++k) {
+        auto x = batch.orn[0][k], y = batch.orn[1][k];
+        auto z = batch.orn[2][k], w = batch.orn[3][k];
+        auto xx = x * x, yy = y * y, zz = z * z;
+        auto xy = x * y, xz = x * z, yz = y * z;
+        auto wx = w * x, wy = w * y, wz = w * z;
+
+        basis[0][0][k] = scalar(1) - scalar(2) * (yy + zz);
+        basis[0][1][k] = scalar(2) * (xy - wz);
+        basis[0][2][k] = scalar(2) * (xz + wy);
+        basis[1][0][k] = scalar(2) * (xy + wz);
+        basis[1][1][k] = scalar(1) - scalar(2) * (xx + zz);
+        basis[1][2][k] = scalar(2) * (yz - wx);
+        basis[2][0][k] = scalar(2) * (xz - wy);
+        basis[2][1][k] = scalar(2) * (yz + wx);
+        basis[2][2][k] = scalar(1) - scalar(2) * (xx + yy);
+    }
+}
+
+// Assigns AABBs centered at the positions with the given half extents.
+static void assign_extents(aabb_batch &batch, const scalar (&extents)[3][aabb_batch_size]) {
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t k = 0; k < aabb_batch_size; ++k) {
+            batch.min[i][k] = batch.pos[i][k] - extents[i][k];
+            batch.max[i][k] = batch.pos[i][k] + extents[i][k];
+        }
+    }
+}
+
+void box_aabb_batch(aabb_batch &batch) {
+    // Reference: Real-Time Collision Detection - Christer Ericson, section 4.2.6.
+    alignas(aabb_batch_alignment) scalar basis[3][3][aabb_batch_size];
+    alignas(aabb_batch_alignment) scalar extents[3][aabb_batch_size];
+    batch_basis(batch, basis);
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t k = 0; k < aabb_batch_size; ++k) {
+            extents[i][k] = std::abs(basis[i][0][k]) * batch.params[0][k] +
+                            std::abs(basis[i][1][k]) * batch.params[1][k] +
+                            std::abs(basis[i][2][k]) * batch.params[2][k];
+        }
+    }
+
+    assign_extents(batch, extents);
+}
+
+void sphere_aabb_batch(aabb_batch &batch) {
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t k = 0; k < aabb_batch_size; ++k) {
+            batch.min[i][k] = batch.pos[i][k] - batch.params[0][k];
+            batch.max[i][k] = batch.pos[i][k] + batch.params[0][k];
+        }
+    }
+}
+
+void capsule_aabb_batch(aabb_batch &batch) {
+    // The axis is the first column of the rotation matrix. The extent along
+    // each world axis is the projection of the half segment plus the radius.
+    alignas(aabb_batch_alignment) scalar basis[3][3][aabb_batch_size];
+    alignas(aabb_batch_alignment) scalar extents[3][aabb_batch_size];
+    batch_basis(batch, basis);
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t k = 0; k < aabb_batch_size; ++k) {
+            extents[i][k] = std::abs(basis[i][0][k]) * batch.params[1][k] + batch.params[0][k];
+        }
+    }
+
+    assign_extents(batch, extents);
+}
+
+void cylinder_aabb_batch(aabb_batch &batch) {
+    // The extent along a world axis `e` for a cylinder with axis `a` is
+    // `|a·e| * half_length + radius * sqrt(1 - (a·e)^2)`, i.e. the projection
+    // of the half segment plus the projection of the cap disc.
+    alignas(aabb_batch_alignment) scalar basis[3][3][aabb_batch_size];
+    alignas(aabb_batch_alignment) scalar extents[3][aabb_batch_size];
+    batch_basis(batch, basis);
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t k = 0; k < aabb_batch_size; ++k) {
+            auto a = basis[i][0][k];
+            auto s = std::sqrt(std::max(scalar(1) - a * a, scalar(0)));
+            extents[i][k] = std::abs(a) * batch.params[1][k] + s * batch.params[0][k];
+        }
+    }
+
+    assign_extents(batch, extents);
+}
+
+}
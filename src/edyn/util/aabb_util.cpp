@@ -1,6 +1,7 @@
 #include "edyn/util/aabb_util.hpp"
 #include "edyn/util/shape_util.hpp"
 #include "edyn/math/transform.hpp"
+#include "edyn/math/matrix3x3.hpp"
 #include <variant>
 
 namespace edyn {
@@ -190,8 +191,28 @@ AABB shape_aabb(const box_shape &sh, const vector3 &pos, const quaternion &orn)
     return box_aabb(sh.half_extents, pos, orn);
 }
 
+AABB convex_mesh_aabb(const convex_mesh &mesh, const vector3 &pos, const quaternion &orn) {
+    auto basis = to_matrix3x3(orn);
+    auto aabb = AABB{pos, pos};
+    // Warm start each query with the support vertex of the previous axis,
+    // which is usually a few steps away.
+    uint32_t max_idx = 0, min_idx = 0;
+
+    for (size_t i = 0; i < 3; ++i) {
+        // Row `i` of the rotation matrix is the world space axis `i` in
+        // object space.
+        auto &dir = basis.row[i];
+        max_idx = mesh.support_vertex_index(mesh.vertices, dir, max_idx);
+        min_idx = mesh.support_vertex_index(mesh.vertices, -dir, min_idx);
+        aabb.max[i] += dot(mesh.vertices[max_idx], dir);
+        aabb.min[i] += dot(mesh.vertices[min_idx], dir);
+    }
+
+    return aabb;
+}
+
 AABB shape_aabb(const polyhedron_shape &sh, const vector3 &pos, const quaternion &orn) {
-    return point_cloud_aabb(sh.mesh->vertices, pos, orn);
+    return convex_mesh_aabb(*sh.mesh, pos, orn);
 }
 
 AABB shape_aabb(const paged_mesh_shape &sh, const vector3 &pos, const quaternion &orn) {
@@ -10,6 +10,7 @@
 #include "edyn/util/constraint_util.hpp"
 #include "edyn/constraints/contact_constraint.hpp"
 #include "edyn/collision/collide.hpp"
+#include "edyn/collision/time_of_impact.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/math/math.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
@@ -253,13 +254,14 @@ size_t find_nearest_contact_rolling(const collision_result &result, const vector
     return nearest_idx;
 }
 
-static void assign_material_properties(entt::registry &registry, contact_manifold &manifold, contact_point &cp) {
-    auto material_view = registry.view<material>();
+static void assign_material_properties(const contact_manifold &manifold, contact_point &cp,
+                                       const material_view_t &material_view,
+                                       const mesh_shape_view_t &mesh_shape_view,
+                                       const paged_mesh_shape_view_t &paged_mesh_shape_view,
+                                       const material_mix_table &material_table) {
     auto [materialA] = material_view.get(manifold.body[0]);
     auto [materialB] = material_view.get(manifold.body[1]);
 
-    auto &material_table = registry.ctx().at<material_mix_table>();
-
     if (auto *material = material_table.try_get({materialA.id, materialB.id})) {
         cp.restitution = material->restitution;
         cp.friction = material->friction;
@@ -268,9 +270,6 @@ static void assign_material_properties(entt::registry &registry, contact_manifol
         cp.stiffness = material->stiffness;
         cp.damping = material->damping;
     } else {
-        auto mesh_shape_view = registry.view<mesh_shape>();
-        auto paged_mesh_shape_view = registry.view<paged_mesh_shape>();
-
         if (!try_assign_per_vertex_friction(manifold.body, cp, material_view, mesh_shape_view, paged_mesh_shape_view)) {
             cp.friction = material_mix_friction(materialA.friction, materialB.friction);
         }
@@ -289,10 +288,14 @@ static void assign_material_properties(entt::registry &registry, contact_manifol
     }
 }
 
-void create_contact_point(entt::registry& registry,
-                          entt::entity manifold_entity,
-                          contact_manifold& manifold,
-                          const collision_result::collision_point& rp) {
+void insert_contact_point(contact_manifold &manifold,
+                          contact_manifold_events &events,
+                          const collision_result::collision_point &rp,
+                          const orientation_view_t &orn_view,
+                          const material_view_t &material_view,
+                          const mesh_shape_view_t &mesh_shape_view,
+                          const paged_mesh_shape_view_t &paged_mesh_shape_view,
+                          const material_mix_table &material_table) {
     EDYN_ASSERT(manifold.num_points < max_contacts);
 
     // Find available index.
@@ -333,22 +336,33 @@ void create_contact_point(entt::registry& registry,
 
     if (rp.normal_attachment != contact_normal_attachment::none) {
         auto idx = rp.normal_attachment == contact_normal_attachment::normal_on_A ? 0 : 1;
-        auto &orn = registry.get<orientation>(manifold.body[idx]);
+        auto &orn = orn_view.get<orientation>(manifold.body[idx]);
         cp.local_normal = rotate(conjugate(orn), rp.normal);
     } else {
         cp.local_normal = vector3_zero;
     }
 
     // Assign material properties to contact point.
-    if (registry.all_of<material>(manifold.body[0]) && registry.all_of<material>(manifold.body[1])) {
-        assign_material_properties(registry, manifold, cp);
+    if (material_view.contains(manifold.body[0]) && material_view.contains(manifold.body[1])) {
+        assign_material_properties(manifold, cp, material_view, mesh_shape_view,
+                                   paged_mesh_shape_view, material_table);
     }
 
     // Add contact created event.
-    auto &events = registry.get<contact_manifold_events>(manifold_entity);
     events.contact_started |= is_first_contact;
     EDYN_ASSERT(events.num_contacts_created < max_contacts);
     events.contacts_created[events.num_contacts_created++] = pt_id;
+}
+
+void create_contact_point(entt::registry& registry,
+                          entt::entity manifold_entity,
+                          contact_manifold& manifold,
+                          const collision_result::collision_point& rp) {
+    auto &events = registry.get<contact_manifold_events>(manifold_entity);
+    insert_contact_point(manifold, events, rp,
+                         registry.view<orientation>(), registry.view<material>(),
+                         registry.view<mesh_shape>(), registry.view<paged_mesh_shape>(),
+                         registry.ctx().at<material_mix_table>());
 
     registry.get_or_emplace<dirty>(manifold_entity).updated<contact_manifold, contact_manifold_events>();
 }
@@ -399,7 +413,8 @@ void destroy_contact_point(entt::registry &registry, entt::entity manifold_entit
 
 void detect_collision(std::array<entt::entity, 2> body, collision_result &result,
                       const detect_collision_body_view_t &body_view, const origin_view_t &origin_view,
-                      const tuple_of_shape_views_t &views_tuple) {
+                      const tuple_of_shape_views_t &views_tuple,
+                      polyhedron_collision_cache *polyhedron_cache) {
     auto &aabbA = body_view.get<AABB>(body[0]);
     auto &aabbB = body_view.get<AABB>(body[1]);
     const auto offset = vector3_one * -contact_breaking_threshold;
@@ -425,6 +440,16 @@ void detect_collision(std::array<entt::entity, 2> body, collision_result &result
 
         visit_shape(shape_indexA, body[0], views_tuple, [&](auto &&shA) {
             visit_shape(shape_indexB, body[1], views_tuple, [&](auto &&shB) {
+                using ShapeA = std::decay_t<decltype(shA)>;
+                using ShapeB = std::decay_t<decltype(shB)>;
+
+                // The cache is only meant for the polyhedron pair. It must not
+                // reach the children of compound shapes.
+                if constexpr(std::is_same_v<ShapeA, polyhedron_shape> &&
+                             std::is_same_v<ShapeB, polyhedron_shape>) {
+                    ctx.polyhedron_cache = polyhedron_cache;
+                }
+
                 collide(shA, shB, ctx, result);
             });
         });
@@ -433,4 +458,60 @@ void detect_collision(std::array<entt::entity, 2> body, collision_result &result
     }
 }
 
+void detect_collision_ccd(std::array<entt::entity, 2> body, collision_result &result,
+                          const detect_collision_body_view_t &body_view, const origin_view_t &origin_view,
+                          const linvel_view_t &linvel_view, const angvel_view_t &angvel_view,
+                          const tuple_of_shape_views_t &views_tuple, scalar dt) {
+    result.num_points = 0;
+    auto &aabbA = body_view.get<AABB>(body[0]);
+    auto &aabbB = body_view.get<AABB>(body[1]);
+    const auto offset = vector3_one * -contact_breaking_threshold;
+
+    // The AABB of bodies with continuous collision detection encloses their
+    // motion during the next step.
+    if (!intersect(aabbA.inset(offset), aabbB)) {
+        return;
+    }
+
+    auto get_toi_body = [&](entt::entity entity) {
+        auto toi = toi_body{};
+        toi.origin = origin_view.contains(entity) ?
+            static_cast<vector3>(origin_view.get<origin>(entity)) :
+            static_cast<vector3>(body_view.get<position>(entity));
+        toi.orn = body_view.get<orientation>(entity);
+        toi.aabb = body_view.get<AABB>(entity);
+        toi.linvel = linvel_view.contains(entity) ? static_cast<vector3>(linvel_view.get<linvel>(entity)) : vector3_zero;
+        toi.angvel = angvel_view.contains(entity) ? static_cast<vector3>(angvel_view.get<angvel>(entity)) : vector3_zero;
+        return toi;
+    };
+
+    auto a = get_toi_body(body[0]);
+    auto b = get_toi_body(body[1]);
+    auto shape_indexA = body_view.get<shape_index>(body[0]);
+    auto shape_indexB = body_view.get<shape_index>(body[1]);
+    auto time = scalar(0);
+
+    visit_shape(shape_indexA, body[0], views_tuple, [&](auto &&shA) {
+        visit_shape(shape_indexB, body[1], views_tuple, [&](auto &&shB) {
+            time = time_of_impact(shA, a, shB, b, dt, contact_breaking_threshold, result);
+        });
+    });
+
+    if (time <= 0 || result.num_points == 0) {
+        // Touching already or not touching at all during this step.
+        return;
+    }
+
+    // Keep the pivots and normals found at the time of impact. The
+    // distance along the normal at the current pose is the gap that the
+    // speculative contact allows the bodies to close in this step.
+    for (size_t i = 0; i < result.num_points; ++i) {
+        auto &rp = result.point[i];
+        auto pivotA = to_world_space(rp.pivotA, a.origin, a.orn);
+        auto pivotB = to_world_space(rp.pivotB, b.origin, b.orn);
+        rp.distance = dot(pivotA - pivotB, rp.normal);
+        rp.normal_attachment = contact_normal_attachment::none;
+    }
+}
+
 }
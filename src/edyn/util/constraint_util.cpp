@@ -48,16 +48,10 @@ entt::entity make_contact_manifold(entt::registry &registry,
     return manifold_entity;
 }
 
-void make_contact_manifold(entt::entity manifold_entity, entt::registry &registry,
-                           entt::entity body0, entt::entity body1,
-                           scalar separation_threshold) {
-    EDYN_ASSERT(registry.valid(body0) && registry.valid(body1));
-    registry.emplace<contact_manifold>(manifold_entity, body0, body1, separation_threshold);
-    registry.emplace<contact_manifold_events>(manifold_entity);
-
-    auto &dirty = registry.get_or_emplace<edyn::dirty>(manifold_entity);
-    dirty.set_new().created<contact_manifold, contact_manifold_events>();
-
+// Assigns the components of a contact manifold which depend on the bodies,
+// after the manifold itself has been assigned.
+static void finish_contact_manifold(entt::entity manifold_entity, entt::registry &registry,
+                                    entt::entity body0, entt::entity body1, dirty &dirty) {
     if (registry.any_of<continuous_contacts_tag>(body0) ||
         registry.any_of<continuous_contacts_tag>(body1)) {
 
@@ -97,6 +91,58 @@ void make_contact_manifold(entt::entity manifold_entity, entt::registry &registr
     make_constraint<contact_constraint>(manifold_entity, registry, body0, body1);
 }
 
+void make_contact_manifold(entt::entity manifold_entity, entt::registry &registry,
+                           entt::entity body0, entt::entity body1,
+                           scalar separation_threshold) {
+    EDYN_ASSERT(registry.valid(body0) && registry.valid(body1));
+    registry.emplace<contact_manifold>(manifold_entity, body0, body1, separation_threshold);
+    registry.emplace<contact_manifold_events>(manifold_entity);
+
+    auto &dirty = registry.get_or_emplace<edyn::dirty>(manifold_entity);
+    dirty.set_new().created<contact_manifold, contact_manifold_events>();
+
+    finish_contact_manifold(manifold_entity, registry, body0, body1, dirty);
+}
+
+void make_contact_manifolds(entt::registry &registry, const entity_pair_vector &pairs,
+                            scalar separation_threshold,
+                            std::vector<entt::entity> &manifold_entities) {
+    if (pairs.empty()) {
+        return;
+    }
+
+    auto offset = manifold_entities.size();
+    manifold_entities.resize(offset + pairs.size());
+    auto first = manifold_entities.begin() + offset;
+    auto last = manifold_entities.end();
+    registry.create(first, last);
+
+    auto manifolds = std::vector<contact_manifold>{};
+    manifolds.reserve(pairs.size());
+
+    for (auto &pair : pairs) {
+        EDYN_ASSERT(registry.valid(pair.first) && registry.valid(pair.second));
+        auto &manifold = manifolds.emplace_back();
+        manifold.body = {pair.first, pair.second};
+        manifold.separation_threshold = separation_threshold;
+    }
+
+    auto new_dirty = dirty{};
+    new_dirty.set_new().created<contact_manifold, contact_manifold_events>();
+
+    registry.insert<contact_manifold>(first, last, manifolds.begin());
+    registry.insert<contact_manifold_events>(first, last);
+    registry.insert<dirty>(first, last, new_dirty);
+
+    auto dirty_view = registry.view<dirty>();
+
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        auto manifold_entity = *(first + i);
+        auto &dirty = dirty_view.get<edyn::dirty>(manifold_entity);
+        finish_contact_manifold(manifold_entity, registry, pairs[i].first, pairs[i].second, dirty);
+    }
+}
+
 void swap_manifold(contact_manifold &manifold) {
     std::swap(manifold.body[0], manifold.body[1]);
 
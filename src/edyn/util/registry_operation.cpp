@@ -0,0 +1,168 @@
+#include "edyn/util/registry_operation.hpp"
+#include <cstring>
+
+namespace edyn {
+
+static void execute_create(entt::registry &registry, const registry_operation &op,
+                           entity_map &entity_map) {
+    // Create all entities which are not yet mapped at once.
+    auto &remote_entities = detail::registry_operation_scratch_entities();
+    remote_entities.clear();
+    auto *entities = op.entities();
+
+    for (size_t i = 0; i < op.num_entities; ++i) {
+        auto remote_entity = entities[i];
+
+        if (!entity_map.contains(remote_entity) && detail::registry_operation_mark(remote_entity)) {
+            remote_entities.push_back(remote_entity);
+        }
+    }
+
+    detail::registry_operation_unmark(remote_entities);
+
+    static thread_local std::vector<entt::entity> local_entities;
+    local_entities.resize(remote_entities.size());
+    registry.create(local_entities.begin(), local_entities.end());
+
+    for (size_t i = 0; i < remote_entities.size(); ++i) {
+        entity_map.insert(remote_entities[i], local_entities[i]);
+    }
+}
+
+static void execute_destroy(entt::registry &registry, const registry_operation &op,
+                            entity_map &entity_map) {
+    auto *entities = op.entities();
+
+    for (size_t i = 0; i < op.num_entities; ++i) {
+        auto remote_entity = entities[i];
+
+        auto local_entity = entity_map.find(remote_entity);
+
+        if (local_entity == entt::null) {
+            continue;
+        }
+
+        entity_map.erase(remote_entity);
+
+        if (registry.valid(local_entity)) {
+            registry.destroy(local_entity);
+        }
+    }
+}
+
+void registry_operation::execute(entt::registry &registry, entity_map &entity_map) const {
+    switch (operation) {
+    case registry_op_type::create:
+        execute_create(registry, *this, entity_map);
+        break;
+    case registry_op_type::destroy:
+        execute_destroy(registry, *this, entity_map);
+        break;
+    default:
+        EDYN_ASSERT(components);
+        components->execute(registry, operation, entities(),
+                            num_components > 0 ? component_data() : nullptr,
+                            num_entities, entity_map);
+    }
+}
+
+void registry_operation::remap(const entity_map &emap) {
+    auto *ents = entities();
+
+    emap.find_many(ents, ents + num_entities, ents);
+
+#ifndef EDYN_DISABLE_ASSERT
+    // All entities in the operation must be present in the map.
+    for (size_t i = 0; i < num_entities; ++i) {
+        EDYN_ASSERT(ents[i] != entt::entity{entt::null});
+    }
+#endif
+
+    if (components && num_components > 0) {
+        components->remap(component_data(), num_components, emap);
+    }
+}
+
+registry_operation_collection::registry_operation_collection(const registry_operation_collection &other) {
+    *this = other;
+}
+
+registry_operation_collection::registry_operation_collection(registry_operation_collection &&other) noexcept {
+    *this = std::move(other);
+}
+
+registry_operation_collection & registry_operation_collection::operator=(const registry_operation_collection &other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    destroy_components();
+    m_data.reset();
+    m_size = 0;
+
+    if (other.m_size == 0) {
+        return *this;
+    }
+
+    auto num_blocks = other.m_size / sizeof(registry_operation_block);
+    m_data.reset(new registry_operation_block[num_blocks]);
+    m_size = other.m_size;
+
+    // Headers and entities are trivially copyable. Components are copy
+    // constructed.
+    other.for_each_operation([&](const registry_operation &op) {
+        auto offset = static_cast<size_t>(reinterpret_cast<const std::byte *>(&op) - other.data());
+        auto *dst = data() + offset;
+
+        if (op.num_components > 0) {
+            std::memcpy(dst, &op, op.components_offset);
+            op.components->copy(op.component_data(), dst + op.components_offset, op.num_components);
+        } else {
+            std::memcpy(dst, &op, op.size);
+        }
+    });
+
+    return *this;
+}
+
+registry_operation_collection & registry_operation_collection::operator=(registry_operation_collection &&other) noexcept {
+    if (this != &other) {
+        destroy_components();
+        m_data = std::move(other.m_data);
+        m_size = other.m_size;
+        other.m_size = 0;
+    }
+
+    return *this;
+}
+
+registry_operation_collection::~registry_operation_collection() {
+    destroy_components();
+}
+
+void registry_operation_collection::destroy_components() {
+    for_each_operation([](registry_operation &op) {
+        if (op.num_components > 0) {
+            op.components->destroy(op.component_data(), op.num_components);
+        }
+    });
+}
+
+void registry_operation_collection::execute(entt::registry &registry, entity_map &entity_map) const {
+    for_each_operation([&](const registry_operation &op) {
+        op.execute(registry, entity_map);
+    });
+}
+
+void registry_operation_collection::remap(const entity_map &emap) {
+    for_each_operation([&](registry_operation &op) {
+        op.remap(emap);
+    });
+}
+
+bool registry_operation_collection::empty() const {
+    // Operations with no entities are never encoded.
+    return m_size == 0;
+}
+
+}
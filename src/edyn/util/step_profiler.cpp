@@ -0,0 +1,201 @@
+#include "edyn/util/step_profiler.hpp"
+#include "edyn/time/time.hpp"
+#include <set>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+
+namespace edyn {
+
+const char * profile_stage_name(profile_stage stage) {
+    switch (stage) {
+    case profile_stage::begin_step:
+        return "begin_step";
+    case profile_stage::broadphase:
+        return "broadphase";
+    case profile_stage::narrowphase:
+        return "narrowphase";
+    case profile_stage::solver:
+        return "solver";
+    case profile_stage::finish_step:
+        return "finish_step";
+    case profile_stage::coordinator_update:
+        return "coordinator_update";
+    case profile_stage::coordinator_sync:
+        return "coordinator_sync";
+    }
+
+    return "unknown";
+}
+
+static size_t next_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+step_profiler::step_profiler(size_t capacity) {
+    capacity = next_power_of_two(std::max(capacity, size_t(2)));
+    m_mask = capacity - 1;
+    m_cells.reset(new cell[capacity]);
+
+    for (size_t i = 0; i < capacity; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool step_profiler::record(const profile_sample &sample) {
+    auto pos = m_enqueue_pos.load(std::memory_order_relaxed);
+
+    while (true) {
+        auto &c = m_cells[pos & m_mask];
+        auto seq = c.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                c.sample = sample;
+                c.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // Ring is full. Profiling must never block the simulation.
+            m_num_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool step_profiler::record(entt::entity island, profile_stage stage,
+                           double start_time, const profile_counters &counters) {
+    auto sample = profile_sample{};
+    sample.island = island;
+    sample.stage = stage;
+    sample.thread_id = current_thread_id();
+    sample.start_time = start_time;
+    sample.duration = performance_time() - start_time;
+    sample.counters = counters;
+    return record(sample);
+}
+
+size_t step_profiler::consume(std::vector<profile_sample> &samples) {
+    size_t count = 0;
+    auto pos = m_dequeue_pos.load(std::memory_order_relaxed);
+
+    while (true) {
+        auto &c = m_cells[pos & m_mask];
+        auto seq = c.sequence.load(std::memory_order_acquire);
+
+        if (seq != pos + 1) {
+            // Next sample is not ready yet.
+            break;
+        }
+
+        samples.push_back(c.sample);
+        c.sequence.store(pos + m_mask + 1, std::memory_order_release);
+        ++pos;
+        ++count;
+    }
+
+    m_dequeue_pos.store(pos, std::memory_order_relaxed);
+
+    return count;
+}
+
+size_t step_profiler::num_dropped() const {
+    return m_num_dropped.load(std::memory_order_relaxed);
+}
+
+uint32_t step_profiler::current_thread_id() {
+    static std::atomic<uint32_t> next_id {0};
+    static thread_local uint32_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+profile_scope::profile_scope(step_profiler *profiler, entt::entity island, profile_stage stage)
+    : m_profiler(profiler)
+    , m_island(island)
+    , m_stage(stage)
+    , m_start_time(profiler ? performance_time() : 0)
+{}
+
+profile_scope::~profile_scope() {
+    if (m_profiler) {
+        m_profiler->record(m_island, m_stage, m_start_time, counters);
+    }
+}
+
+static uint64_t chrome_trace_pid(entt::entity island) {
+    // Reserve process zero for the coordinator.
+    return island == entt::null ? 0 : uint64_t(entt::to_integral(island)) + 1;
+}
+
+void write_chrome_trace(std::ostream &os, const std::vector<profile_sample> &samples) {
+    constexpr double seconds_to_microseconds = 1e6;
+
+    // Timestamps are large values in microseconds. Avoid scientific notation.
+    auto flags = os.flags();
+    auto precision = os.precision();
+    os << std::fixed << std::setprecision(3);
+
+    os << "{\"traceEvents\":[";
+    auto first = true;
+    auto separator = [&] {
+        if (!first) {
+            os << ",";
+        }
+        first = false;
+    };
+
+    // Name processes after the islands.
+    auto pids = std::set<uint64_t>{};
+
+    for (auto &sample : samples) {
+        auto pid = chrome_trace_pid(sample.island);
+
+        if (!pids.insert(pid).second) {
+            continue;
+        }
+
+        separator();
+        os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+           << ",\"args\":{\"name\":\"";
+
+        if (sample.island == entt::null) {
+            os << "coordinator";
+        } else {
+            os << "island " << entt::to_integral(sample.island);
+        }
+
+        os << "\"}}";
+    }
+
+    for (auto &sample : samples) {
+        auto &counters = sample.counters;
+        separator();
+        os << "{\"name\":\"" << profile_stage_name(sample.stage) << "\""
+           << ",\"cat\":\"edyn\",\"ph\":\"X\""
+           << ",\"pid\":" << chrome_trace_pid(sample.island)
+           << ",\"tid\":" << sample.thread_id
+           << ",\"ts\":" << sample.start_time * seconds_to_microseconds
+           << ",\"dur\":" << sample.duration * seconds_to_microseconds
+           << ",\"args\":{"
+           << "\"rows\":" << counters.num_rows
+           << ",\"manifolds\":" << counters.num_manifolds
+           << ",\"contact_points\":" << counters.num_contact_points
+           << ",\"tree_moves\":" << counters.num_tree_moves
+           << ",\"reg_op_bytes\":" << counters.reg_op_bytes
+           << "}}";
+    }
+
+    os << "],\"displayTimeUnit\":\"ms\"}";
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+}
@@ -1,4 +1,14 @@
 #include "../common/common.hpp"
+#include <edyn/collision/sweep_and_prune.hpp>
+#include <edyn/collision/broadphase_worker.hpp>
+#include <edyn/collision/dynamic_tree.hpp>
+#include <edyn/collision/tree_view.hpp>
+#include <edyn/util/entity_map.hpp>
+#include <edyn/collision/contact_manifold_map.hpp>
+#include <edyn/comp/tree_resident.hpp>
+#include <random>
+#include <map>
+#include <set>
 
 TEST(test_broadphase, collision_filtering) {
     entt::registry registry;
@@ -31,3 +41,288 @@ TEST(test_broadphase, collision_filtering) {
     edyn::detach(registry);
     edyn::deinit();
 }
+
+TEST(test_broadphase, sweep_and_prune_pairs) {
+    entt::registry registry;
+    auto aabbs = std::vector<std::pair<entt::entity, edyn::AABB>>{};
+    auto rng = std::mt19937{42};
+    auto dist_pos = std::uniform_real_distribution<edyn::scalar>(-10, 10);
+    auto dist_size = std::uniform_real_distribution<edyn::scalar>(0.1, 2);
+    const edyn::scalar margin = 0.1;
+
+    auto get_aabb = [&](entt::entity entity) {
+        for (auto &[e, aabb] : aabbs) {
+            if (e == entity) return aabb;
+        }
+        return edyn::AABB{};
+    };
+
+    auto contains = [&](entt::entity entity) {
+        for (auto &[e, aabb] : aabbs) {
+            if (e == entity) return true;
+        }
+        return false;
+    };
+
+    auto sap = edyn::sweep_and_prune{};
+
+    for (int round = 0; round < 5; ++round) {
+        // Add a few entities, remove some and move all others.
+        for (int i = 0; i < 50; ++i) {
+            aabbs.emplace_back(registry.create(), edyn::AABB{});
+        }
+
+        for (int i = 0; i < 10; ++i) {
+            aabbs.erase(aabbs.begin() + i * 3);
+        }
+
+        for (auto &[e, aabb] : aabbs) {
+            auto pos = edyn::vector3{dist_pos(rng), dist_pos(rng), dist_pos(rng)};
+            auto half = edyn::vector3{dist_size(rng), dist_size(rng), dist_size(rng)};
+            aabb = {pos - half, pos + half};
+        }
+
+        auto entities = std::vector<entt::entity>{};
+
+        for (auto &[e, aabb] : aabbs) {
+            entities.push_back(e);
+        }
+
+        sap.update(entities.begin(), entities.end(), contains, get_aabb, margin);
+        ASSERT_EQ(sap.size(), aabbs.size());
+
+        auto sap_pairs = std::set<std::pair<entt::entity, entt::entity>>{};
+
+        for (size_t i = 0; i < sap.size(); ++i) {
+            auto entityA = sap.entity(i);
+            sap.sweep(i, [&](entt::entity entityB) {
+                ASSERT_TRUE(sap_pairs.emplace(std::min(entityA, entityB), std::max(entityA, entityB)).second);
+            });
+        }
+
+        auto brute_pairs = std::set<std::pair<entt::entity, entt::entity>>{};
+
+        for (size_t i = 0; i < aabbs.size(); ++i) {
+            for (size_t j = i + 1; j < aabbs.size(); ++j) {
+                auto inflated = aabbs[i].second.inset(edyn::vector3_one * -margin * 2);
+
+                if (intersect(inflated, aabbs[j].second)) {
+                    auto entityA = aabbs[i].first, entityB = aabbs[j].first;
+                    brute_pairs.emplace(std::min(entityA, entityB), std::max(entityA, entityB));
+                }
+            }
+        }
+
+        ASSERT_EQ(sap_pairs, brute_pairs);
+    }
+}
+
+TEST(test_broadphase, contact_manifold_map) {
+    entt::registry registry;
+    auto manifold_map = edyn::contact_manifold_map(registry);
+    auto bodies = std::vector<entt::entity>(64);
+    registry.create(bodies.begin(), bodies.end());
+
+    auto manifolds = std::map<std::pair<size_t, size_t>, entt::entity>{};
+
+    // Create manifolds between a subset of all pairs, which forces the
+    // table to grow a few times.
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        for (size_t j = i + 1; j < bodies.size(); ++j) {
+            if ((i + j) % 3 == 0) {
+                auto entity = registry.create();
+                auto &manifold = registry.emplace<edyn::contact_manifold>(entity);
+                manifold.body = {bodies[i], bodies[j]};
+                manifolds[{i, j}] = entity;
+            }
+        }
+    }
+
+    ASSERT_EQ(manifold_map.size(), manifolds.size());
+
+    // Destroy every other manifold.
+    auto parity = false;
+
+    for (auto it = manifolds.begin(); it != manifolds.end();) {
+        if (parity) {
+            registry.destroy(it->second);
+            it = manifolds.erase(it);
+        } else {
+            ++it;
+        }
+        parity = !parity;
+    }
+
+    ASSERT_EQ(manifold_map.size(), manifolds.size());
+
+    auto pairs = edyn::entity_pair_vector{};
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        for (size_t j = 0; j < bodies.size(); ++j) {
+            pairs.emplace_back(bodies[i], bodies[j]);
+        }
+    }
+
+    auto contained = std::vector<bool>(pairs.size());
+    manifold_map.contains_many(pairs.begin(), pairs.end(), contained.begin());
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        for (size_t j = 0; j < bodies.size(); ++j) {
+            auto it = manifolds.find({std::min(i, j), std::max(i, j)});
+            auto exists = it != manifolds.end();
+            ASSERT_EQ(manifold_map.contains(bodies[i], bodies[j]), exists);
+            ASSERT_EQ(contained[i * bodies.size() + j], exists);
+
+            if (exists) {
+                ASSERT_EQ(manifold_map.get(bodies[i], bodies[j]), it->second);
+            }
+        }
+    }
+}
+
+TEST(test_broadphase, published_tree_view) {
+    entt::registry registry;
+    auto entities = std::vector<entt::entity>(16);
+    registry.create(entities.begin(), entities.end());
+
+    // Map to entities offset by a constant, as if they belonged to another
+    // registry.
+    auto emap = edyn::entity_map{};
+
+    for (auto entity : entities) {
+        auto other = static_cast<entt::entity>(entt::to_integral(entity) + 100);
+        emap.insert(other, entity);
+    }
+
+    auto tree = edyn::dynamic_tree{};
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        auto min = edyn::vector3{edyn::scalar(i), 0, 0};
+        tree.create({min, min + edyn::vector3_one * edyn::scalar(0.5)}, entities[i]);
+    }
+
+    auto nodes = edyn::tree_view::node_vector{};
+    auto root_id = tree.copy_nodes(nodes, [&](entt::entity entity) { return emap.at_other(entity); });
+    auto view = edyn::tree_view(std::move(nodes), root_id);
+    ASSERT_EQ(view.count_leaves(), entities.size());
+
+    // Copies share the nodes.
+    auto view_copy = view;
+    ASSERT_EQ(view_copy.nodes().get(), view.nodes().get());
+
+    auto found = std::set<entt::entity>{};
+    view_copy.query({{2.1, 0.1, 0.1}, {2.2, 0.2, 0.2}}, [&](edyn::tree_node_id_t id) {
+        found.insert(view_copy.get_node(id).entity);
+    });
+    ASSERT_EQ(found, std::set<entt::entity>{emap.at_other(entities[2])});
+
+    // Buffers are reused once no view refers to them anymore.
+    auto bphase = edyn::broadphase_worker(registry);
+    auto first = bphase.publish_view(emap).nodes().get();
+    auto held = bphase.publish_view(emap);
+    bphase.publish_view(emap);
+    ASSERT_EQ(bphase.publish_view(emap).nodes().get(), first);
+    ASSERT_NE(bphase.publish_view(emap).nodes().get(), held.nodes().get());
+}
+
+static std::vector<std::pair<entt::entity, entt::entity>> queried_pairs;
+
+static bool should_collide_record(entt::registry &, entt::entity first, entt::entity second) {
+    queried_pairs.emplace_back(first, second);
+    return false;
+}
+
+TEST(test_broadphase, only_moved_entities_are_queried) {
+    entt::registry registry;
+    auto &settings = registry.ctx().emplace<edyn::settings>();
+    settings.should_collide_func = &should_collide_record;
+    registry.ctx().emplace<edyn::contact_manifold_map>(registry);
+    auto bphase = edyn::broadphase_worker(registry);
+
+    // A row of touching boxes and a kinematic box above them.
+    auto bodies = std::vector<entt::entity>(8);
+    registry.create(bodies.begin(), bodies.end());
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        auto min = edyn::vector3{edyn::scalar(i), 0, 0};
+        registry.emplace<edyn::procedural_tag>(bodies[i]);
+        registry.emplace<edyn::AABB>(bodies[i], min, min + edyn::vector3_one);
+    }
+
+    auto kinematic = registry.create();
+    registry.emplace<edyn::kinematic_tag>(kinematic);
+    registry.emplace<edyn::AABB>(kinematic, edyn::vector3{0, 5, 0}, edyn::vector3{1, 6, 0});
+
+    // New entities are queried.
+    queried_pairs.clear();
+    bphase.update();
+    ASSERT_FALSE(queried_pairs.empty());
+
+    // Nothing is done while no AABB changes.
+    queried_pairs.clear();
+    bphase.update();
+    ASSERT_TRUE(queried_pairs.empty());
+    ASSERT_EQ(bphase.num_tree_moves(), size_t{0});
+
+    // Tiny displacements move the node but don't trigger a query.
+    auto &aabb = registry.get<edyn::AABB>(bodies[3]);
+    aabb.min.y += edyn::scalar(0.0001);
+    aabb.max.y += edyn::scalar(0.0001);
+    registry.emplace<edyn::aabb_changed_tag>(bodies[3]);
+    bphase.update();
+    ASSERT_TRUE(queried_pairs.empty());
+    ASSERT_EQ(bphase.num_tree_moves(), size_t{1});
+    ASSERT_FALSE(registry.all_of<edyn::aabb_changed_tag>(bodies[3]));
+
+    // Larger displacements do.
+    aabb.min.y += edyn::scalar(0.1);
+    aabb.max.y += edyn::scalar(0.1);
+    registry.emplace<edyn::aabb_changed_tag>(bodies[3]);
+    bphase.update();
+    ASSERT_FALSE(queried_pairs.empty());
+
+    for (auto &[first, second] : queried_pairs) {
+        ASSERT_EQ(first, bodies[3]);
+    }
+
+    // Kinematic entities query the procedural tree and go second in the pair.
+    queried_pairs.clear();
+    registry.patch<edyn::AABB>(kinematic, [](edyn::AABB &aabb) {
+        aabb.min.y = aabb.max.y = 1;
+    });
+    bphase.update();
+    ASSERT_FALSE(queried_pairs.empty());
+
+    for (auto &[first, second] : queried_pairs) {
+        ASSERT_EQ(second, kinematic);
+        ASSERT_TRUE(registry.all_of<edyn::procedural_tag>(first));
+    }
+}
+
+TEST(test_broadphase, sweep_and_prune_single_island) {
+    entt::registry registry;
+    edyn::init();
+    edyn::attach(registry);
+    edyn::set_broadphase_backend(registry, edyn::broadphase_backend::sweep_and_prune);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    auto floor = edyn::make_rigidbody(registry, floor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.position = {0, 0.6, 0};
+    auto box = edyn::make_rigidbody(registry, def);
+
+    // A single awake island must be handled without running in parallel.
+    for (int i = 0; i < 20; ++i) {
+        edyn::update(registry);
+        edyn::delay(5);
+    }
+
+    ASSERT_EQ(registry.view<edyn::island>().size(), 1u);
+    ASSERT_TRUE(registry.ctx().at<edyn::contact_manifold_map>().contains(floor, box));
+
+    edyn::detach(registry);
+}
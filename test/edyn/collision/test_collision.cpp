@@ -6,8 +6,10 @@
 #include "edyn/shapes/convex_mesh.hpp"
 #include "edyn/shapes/cylinder_shape.hpp"
 #include "edyn/shapes/polyhedron_shape.hpp"
+#include "edyn/collision/polyhedron_collision_cache.hpp"
 #include "edyn/util/shape_util.hpp"
 #include <edyn/collision/collide.hpp>
+#include <edyn/collision/time_of_impact.hpp>
 #include <memory>
 
 TEST(test_collision, collide_box_box_face_face) {
@@ -146,6 +148,171 @@ TEST(test_collision, collide_polyhedron_sphere) {
     ASSERT_SCALAR_EQ(pt.distance, 0.2071067812);
 }
 
+// Creates a prism with a regular polygon as base, centered at the origin.
+static std::shared_ptr<edyn::convex_mesh> make_prism_mesh(size_t num_sides, edyn::scalar radius, edyn::scalar half_height) {
+    auto mesh = std::make_shared<edyn::convex_mesh>();
+
+    for (size_t i = 0; i < num_sides; ++i) {
+        auto angle = edyn::scalar(2) * edyn::pi * edyn::scalar(i) / edyn::scalar(num_sides);
+        auto x = std::cos(angle) * radius;
+        auto z = std::sin(angle) * radius;
+        mesh->vertices.push_back({x, half_height, z});
+        mesh->vertices.push_back({x, -half_height, z});
+    }
+
+    auto add_face = [&](std::vector<uint32_t> face_indices) {
+        mesh->faces.push_back(static_cast<uint32_t>(mesh->indices.size()));
+        mesh->faces.push_back(static_cast<uint32_t>(face_indices.size()));
+        mesh->indices.insert(mesh->indices.end(), face_indices.begin(), face_indices.end());
+    };
+
+    // Faces are counter-clockwise when seen from outside.
+    std::vector<uint32_t> top, bottom;
+
+    for (size_t i = 0; i < num_sides; ++i) {
+        top.push_back(static_cast<uint32_t>((num_sides - 1 - i) * 2));
+        bottom.push_back(static_cast<uint32_t>(i * 2 + 1));
+    }
+
+    add_face(top);
+    add_face(bottom);
+
+    for (size_t i = 0; i < num_sides; ++i) {
+        auto j = (i + 1) % num_sides;
+        add_face({static_cast<uint32_t>(i * 2), static_cast<uint32_t>(j * 2),
+                  static_cast<uint32_t>(j * 2 + 1), static_cast<uint32_t>(i * 2 + 1)});
+    }
+
+    mesh->initialize();
+
+    return mesh;
+}
+
+TEST(test_collision, convex_mesh_support_vertex) {
+    auto mesh = make_prism_mesh(12, 0.5, 0.3);
+    auto rotated = edyn::make_rotated_mesh(*mesh, edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{1, 2, 3}), 0.7));
+    uint32_t start_idx = 0;
+
+    for (size_t i = 0; i < 64; ++i) {
+        auto angle = edyn::scalar(i) * edyn::scalar(0.37);
+        auto dir = edyn::normalize(edyn::vector3{std::cos(angle), std::sin(angle * edyn::scalar(1.3)), std::sin(angle)});
+        start_idx = mesh->support_vertex_index(rotated.vertices, dir, start_idx);
+        auto expected = edyn::point_cloud_support_projection(rotated.vertices, dir);
+        ASSERT_SCALAR_EQ(edyn::dot(rotated.vertices[start_idx], dir), expected);
+    }
+}
+
+TEST(test_collision, convex_mesh_aabb) {
+    auto mesh = make_prism_mesh(12, 0.5, 0.3);
+    auto pos = edyn::vector3{1, -2, 3};
+
+    for (size_t i = 0; i < 32; ++i) {
+        auto angle = edyn::scalar(i) * edyn::scalar(0.41);
+        auto axis = edyn::normalize(edyn::vector3{std::cos(angle), 1, std::sin(angle * 2)});
+        auto orn = edyn::quaternion_axis_angle(axis, angle);
+        auto aabb = edyn::convex_mesh_aabb(*mesh, pos, orn);
+        auto rotated = edyn::make_rotated_mesh(*mesh, orn);
+        auto expected = edyn::point_cloud_aabb(rotated.vertices);
+
+        ASSERT_EQ(rotated.orientation, orn);
+        ASSERT_NEAR(aabb.min.x, expected.min.x + pos.x, 1e-5);
+        ASSERT_NEAR(aabb.min.y, expected.min.y + pos.y, 1e-5);
+        ASSERT_NEAR(aabb.min.z, expected.min.z + pos.z, 1e-5);
+        ASSERT_NEAR(aabb.max.x, expected.max.x + pos.x, 1e-5);
+        ASSERT_NEAR(aabb.max.y, expected.max.y + pos.y, 1e-5);
+        ASSERT_NEAR(aabb.max.z, expected.max.z + pos.z, 1e-5);
+    }
+}
+
+TEST(test_collision, collide_polyhedron_polyhedron_cache) {
+    auto mesh = make_prism_mesh(12, 0.5, 0.3);
+    auto rotatedA = edyn::make_rotated_mesh(*mesh);
+    auto polyhedronA = edyn::polyhedron_shape{};
+    polyhedronA.mesh = mesh;
+    polyhedronA.rotated = &rotatedA;
+
+    auto rotatedB = edyn::make_rotated_mesh(*mesh);
+    auto polyhedronB = edyn::polyhedron_shape{};
+    polyhedronB.mesh = mesh;
+    polyhedronB.rotated = &rotatedB;
+
+    auto cache = edyn::polyhedron_collision_cache{};
+
+    // B tumbles and slides over A. Results with the cache must match the
+    // results of a full search.
+    for (size_t i = 0; i < 40; ++i) {
+        auto t = edyn::scalar(i) * edyn::scalar(0.05);
+        auto ctx = edyn::collision_context{};
+        ctx.posA = edyn::vector3_zero;
+        ctx.ornA = edyn::quaternion_identity;
+        ctx.posB = edyn::vector3{t * edyn::scalar(0.2), edyn::scalar(0.62) + t * edyn::scalar(0.05), 0};
+        ctx.ornB = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{1, 0, 1}), t * edyn::scalar(0.3));
+        ctx.threshold = edyn::collision_threshold;
+        rotatedB = edyn::make_rotated_mesh(*mesh, ctx.ornB);
+
+        auto expected = edyn::collision_result{};
+        edyn::collide(polyhedronA, polyhedronB, ctx, expected);
+
+        ctx.polyhedron_cache = &cache;
+        auto result = edyn::collision_result{};
+        edyn::collide(polyhedronA, polyhedronB, ctx, result);
+
+        ASSERT_EQ(result.num_points, expected.num_points);
+
+        for (size_t j = 0; j < result.num_points; ++j) {
+            ASSERT_VECTOR3_EQ(result.point[j].normal, expected.point[j].normal);
+            ASSERT_SCALAR_EQ(result.point[j].distance, expected.point[j].distance);
+        }
+    }
+
+    ASSERT_NE(cache.type, edyn::polyhedron_collision_cache::axis_type::none);
+}
+
+TEST(test_collision, collide_polyhedron_polyhedron_gjk_epa) {
+    auto mesh = make_prism_mesh(24, 0.5, 0.3);
+    auto rotatedA = edyn::make_rotated_mesh(*mesh);
+    auto polyhedronA = edyn::polyhedron_shape{};
+    polyhedronA.mesh = mesh;
+    polyhedronA.rotated = &rotatedA;
+
+    auto rotatedB = edyn::make_rotated_mesh(*mesh);
+    auto polyhedronB = edyn::polyhedron_shape{};
+    polyhedronB.mesh = mesh;
+    polyhedronB.rotated = &rotatedB;
+
+    auto cache = edyn::polyhedron_collision_cache{};
+    cache.use_gjk_epa = true;
+
+    // B approaches A from above while tumbling, going from separated to
+    // penetrating. Distances and normals must match the separating axis test.
+    for (size_t i = 0; i < 40; ++i) {
+        auto t = edyn::scalar(i) * edyn::scalar(0.05);
+        auto ctx = edyn::collision_context{};
+        ctx.posA = edyn::vector3_zero;
+        ctx.ornA = edyn::quaternion_identity;
+        ctx.posB = edyn::vector3{t * edyn::scalar(0.1), edyn::scalar(0.65) - t * edyn::scalar(0.05), 0};
+        ctx.ornB = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{1, 0, 1}), t * edyn::scalar(0.2));
+        ctx.threshold = edyn::collision_threshold;
+        rotatedB = edyn::make_rotated_mesh(*mesh, ctx.ornB);
+
+        auto expected = edyn::collision_result{};
+        edyn::collide(polyhedronA, polyhedronB, ctx, expected);
+
+        ctx.polyhedron_cache = &cache;
+        auto result = edyn::collision_result{};
+        edyn::collide(polyhedronA, polyhedronB, ctx, result);
+
+        ASSERT_EQ(result.num_points, expected.num_points);
+
+        for (size_t j = 0; j < result.num_points; ++j) {
+            ASSERT_NEAR(result.point[j].distance, expected.point[j].distance, 1e-3);
+            ASSERT_GT(edyn::dot(result.point[j].normal, expected.point[j].normal), edyn::scalar(0.999));
+        }
+    }
+
+    ASSERT_GT(cache.simplex.size, 0);
+}
+
 TEST(test_collision, collide_capsule_cylinder_parallel) {
     auto capsule = edyn::capsule_shape{0.1, 0.2};
     auto cylinder = edyn::cylinder_shape{0.2, 0.5};
@@ -488,4 +655,78 @@ TEST(test_collision, collide_cylinder_box_face_face) {
         ASSERT_TRUE(containsA);
         ASSERT_TRUE(containsB);
     }
-}
\ No newline at end of file
+}
+
+TEST(test_collision, time_of_impact_sphere_box) {
+    auto sphere = edyn::sphere_shape{0.1};
+    auto wall = edyn::box_shape{edyn::vector3{0.05, 1, 1}};
+
+    auto a = edyn::toi_body{};
+    a.origin = {-5, 0, 0};
+    a.orn = edyn::quaternion_identity;
+    a.aabb = edyn::shape_aabb(sphere, a.origin, a.orn);
+    a.linvel = {100, 0, 0};
+    a.angvel = edyn::vector3_zero;
+
+    auto b = edyn::toi_body{};
+    b.origin = edyn::vector3_zero;
+    b.orn = edyn::quaternion_identity;
+    b.aabb = edyn::shape_aabb(wall, b.origin, b.orn);
+    b.linvel = edyn::vector3_zero;
+    b.angvel = edyn::vector3_zero;
+
+    // The sphere would go through the wall in a single step.
+    auto dt = edyn::scalar(0.1);
+    auto tolerance = edyn::scalar(0.02);
+    auto result = edyn::collision_result{};
+    auto time = edyn::time_of_impact(sphere, a, wall, b, dt, tolerance, result);
+    ASSERT_GE(time, (4.85 - tolerance) / 100 - 1e-4);
+    ASSERT_LE(time, 4.85 / 100);
+    ASSERT_GT(result.num_points, 0);
+    ASSERT_VECTOR3_EQ(result.point[0].normal, -edyn::vector3_x);
+
+    // Moving away.
+    a.linvel = {-100, 0, 0};
+    time = edyn::time_of_impact(sphere, a, wall, b, dt, tolerance, result);
+    ASSERT_GT(time, dt);
+    ASSERT_EQ(result.num_points, 0);
+
+    // Passing by.
+    a.linvel = {100, 0, 0};
+    a.origin = {-5, 2, 0};
+    time = edyn::time_of_impact(sphere, a, wall, b, dt, tolerance, result);
+    ASSERT_GT(time, dt);
+}
+
+TEST(test_collision, time_of_impact_rotating_capsule) {
+    // A spinning capsule which hits a sphere only due to its rotation.
+    auto capsule = edyn::capsule_shape{0.05, 1};
+    auto sphere = edyn::sphere_shape{0.1};
+
+    auto a = edyn::toi_body{};
+    a.origin = edyn::vector3_zero;
+    a.orn = edyn::quaternion_identity;
+    a.aabb = edyn::shape_aabb(capsule, a.origin, a.orn);
+    a.linvel = edyn::vector3_zero;
+    a.angvel = {0, 0, 10};
+
+    auto b = edyn::toi_body{};
+    b.origin = {0, 0.8, 0};
+    b.orn = edyn::quaternion_identity;
+    b.aabb = edyn::shape_aabb(sphere, b.origin, b.orn);
+    b.linvel = edyn::vector3_zero;
+    b.angvel = edyn::vector3_zero;
+
+    auto dt = edyn::scalar(0.2);
+    auto tolerance = edyn::scalar(0.02);
+    auto result = edyn::collision_result{};
+    auto time = edyn::time_of_impact(capsule, a, sphere, b, dt, tolerance, result);
+    ASSERT_GT(time, 0);
+    ASSERT_LE(time, dt);
+    ASSERT_GT(result.num_points, 0);
+
+    // The capsule doesn't rotate enough to reach the sphere.
+    a.angvel = {0, 0, 1};
+    time = edyn::time_of_impact(capsule, a, sphere, b, dt, tolerance, result);
+    ASSERT_GT(time, dt);
+}
@@ -0,0 +1,269 @@
+#include "../common/common.hpp"
+#include <edyn/collision/broadphase_worker.hpp>
+#include <edyn/collision/narrowphase.hpp>
+#include <edyn/collision/contact_manifold_map.hpp>
+#include <edyn/collision/contact_manifold_events.hpp>
+#include <edyn/constraints/contact_constraint.hpp>
+#include <edyn/constraints/null_constraint.hpp>
+#include <edyn/comp/continuous.hpp>
+#include <edyn/comp/dirty.hpp>
+#include <edyn/comp/graph_edge.hpp>
+#include <edyn/dynamics/material_mixing.hpp>
+#include <edyn/parallel/entity_graph.hpp>
+#include <edyn/parallel/job.hpp>
+#include <edyn/serialization/memory_archive.hpp>
+#include <atomic>
+#include <set>
+
+// Sets up a registry in the same way as the registry of an island worker.
+static void setup_worker_registry(entt::registry &registry) {
+    registry.ctx().emplace<edyn::contact_manifold_map>(registry);
+    registry.ctx().emplace<edyn::broadphase_worker>(registry);
+    registry.ctx().emplace<edyn::narrowphase>(registry);
+    registry.ctx().emplace<edyn::entity_graph>();
+    registry.ctx().emplace<edyn::settings>();
+    registry.ctx().emplace<edyn::material_mix_table>();
+}
+
+static void set_flag_job(edyn::job::data_type &data) {
+    auto archive = edyn::memory_input_archive(data.data(), data.size());
+    intptr_t flag_ptr;
+    archive(flag_ptr);
+    reinterpret_cast<std::atomic<bool> *>(flag_ptr)->store(true, std::memory_order_release);
+}
+
+static edyn::job make_set_flag_job(std::atomic<bool> &flag) {
+    auto j = edyn::job();
+    auto archive = edyn::fixed_memory_output_archive(j.data.data(), j.data.size());
+    auto flag_ptr = reinterpret_cast<intptr_t>(&flag);
+    archive(flag_ptr);
+    j.func = &set_flag_job;
+    return j;
+}
+
+static void wait_for_flag(std::atomic<bool> &flag) {
+    while (!flag.load(std::memory_order_acquire)) {
+        edyn::delay(1);
+    }
+}
+
+static std::vector<entt::entity> make_box_row(entt::registry &registry) {
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    auto entities = std::vector<entt::entity>{};
+
+    // Each box overlaps the next.
+    for (int i = 0; i < 4; ++i) {
+        def.position = {edyn::scalar(i) * edyn::scalar(0.9), 0, 0};
+        entities.push_back(edyn::make_rigidbody(registry, def));
+    }
+
+    // A static box overlapping the first.
+    def.kind = edyn::rigidbody_kind::rb_static;
+    def.position = {-0.6, -0.9, 0};
+    entities.push_back(edyn::make_rigidbody(registry, def));
+
+    return entities;
+}
+
+static std::set<std::pair<entt::entity, entt::entity>> manifold_pairs(entt::registry &registry) {
+    auto pairs = std::set<std::pair<entt::entity, entt::entity>>{};
+
+    for (auto [entity, manifold] : registry.view<edyn::contact_manifold>().each()) {
+        auto inserted = pairs.insert(std::minmax(manifold.body[0], manifold.body[1])).second;
+        EXPECT_TRUE(inserted);
+    }
+
+    return pairs;
+}
+
+TEST(test_narrowphase, async_broadphase_creates_one_manifold_per_pair) {
+    edyn::init();
+
+    entt::registry registry_sync;
+    setup_worker_registry(registry_sync);
+    make_box_row(registry_sync);
+    registry_sync.ctx().at<edyn::broadphase_worker>().update();
+
+    // Each pair of boxes is found from both sides in the async update, i.e.
+    // the pairs are duplicated and reversed.
+    entt::registry registry_async;
+    setup_worker_registry(registry_async);
+    make_box_row(registry_async);
+    auto &bphase = registry_async.ctx().at<edyn::broadphase_worker>();
+    ASSERT_TRUE(bphase.parallelizable());
+
+    std::atomic<bool> done {false};
+    auto completion_job = make_set_flag_job(done);
+    bphase.update_async(completion_job);
+    wait_for_flag(done);
+    bphase.finish_async_update();
+
+    auto pairs_sync = manifold_pairs(registry_sync);
+    auto pairs_async = manifold_pairs(registry_async);
+    ASSERT_EQ(pairs_sync.size(), 4u);
+    ASSERT_EQ(pairs_async, pairs_sync);
+    ASSERT_EQ(registry_async.view<edyn::contact_manifold>().size(), 4u);
+
+    auto &manifold_map = registry_async.ctx().at<edyn::contact_manifold_map>();
+
+    for (auto &pair : pairs_async) {
+        ASSERT_TRUE(manifold_map.contains(pair));
+    }
+}
+
+TEST(test_narrowphase, batch_manifolds_match_single_manifolds) {
+    edyn::init();
+
+    entt::registry registry_single, registry_batch;
+    setup_worker_registry(registry_single);
+    setup_worker_registry(registry_batch);
+
+    auto make_bodies = [](entt::registry &registry) {
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+        auto entities = std::vector<entt::entity>{};
+
+        // Bouncy body.
+        def.material->restitution = 0.5;
+        entities.push_back(edyn::make_rigidbody(registry, def));
+
+        // Regular body.
+        def.material->restitution = 0;
+        entities.push_back(edyn::make_rigidbody(registry, def));
+
+        // Body with continuous contacts.
+        def.continuous_contacts = true;
+        entities.push_back(edyn::make_rigidbody(registry, def));
+
+        // Body without material.
+        def.continuous_contacts = false;
+        def.material.reset();
+        entities.push_back(edyn::make_rigidbody(registry, def));
+
+        return entities;
+    };
+
+    auto bodies_single = make_bodies(registry_single);
+    auto bodies_batch = make_bodies(registry_batch);
+    ASSERT_EQ(bodies_single, bodies_batch);
+
+    auto pairs = edyn::entity_pair_vector{
+        {bodies_single[0], bodies_single[1]},
+        {bodies_single[1], bodies_single[2]},
+        {bodies_single[2], bodies_single[3]}
+    };
+
+    auto threshold = edyn::scalar(0.05);
+    auto manifolds_single = std::vector<entt::entity>{};
+
+    for (auto &pair : pairs) {
+        manifolds_single.push_back(edyn::make_contact_manifold(registry_single, pair.first, pair.second, threshold));
+    }
+
+    auto manifolds_batch = std::vector<entt::entity>{};
+    edyn::make_contact_manifolds(registry_batch, pairs, threshold, manifolds_batch);
+    ASSERT_EQ(manifolds_batch.size(), pairs.size());
+
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        auto single = manifolds_single[i];
+        auto batch = manifolds_batch[i];
+
+        auto &manifold_single = registry_single.get<edyn::contact_manifold>(single);
+        auto &manifold_batch = registry_batch.get<edyn::contact_manifold>(batch);
+        ASSERT_EQ(manifold_single.body, manifold_batch.body);
+        ASSERT_EQ(manifold_single.separation_threshold, manifold_batch.separation_threshold);
+
+        ASSERT_TRUE(registry_batch.all_of<edyn::contact_manifold_events>(batch));
+        ASSERT_TRUE(registry_batch.all_of<edyn::graph_edge>(batch));
+
+        ASSERT_EQ(registry_single.all_of<edyn::continuous>(single),
+                  registry_batch.all_of<edyn::continuous>(batch));
+        ASSERT_EQ(registry_single.all_of<edyn::contact_manifold_with_restitution>(single),
+                  registry_batch.all_of<edyn::contact_manifold_with_restitution>(batch));
+        ASSERT_EQ(registry_single.all_of<edyn::contact_constraint>(single),
+                  registry_batch.all_of<edyn::contact_constraint>(batch));
+        ASSERT_EQ(registry_single.all_of<edyn::null_constraint>(single),
+                  registry_batch.all_of<edyn::null_constraint>(batch));
+
+        auto &dirty_single = registry_single.get<edyn::dirty>(single);
+        auto &dirty_batch = registry_batch.get<edyn::dirty>(batch);
+        ASSERT_EQ(dirty_single.is_new_entity, dirty_batch.is_new_entity);
+        ASSERT_EQ(dirty_single.created_ids, dirty_batch.created_ids);
+        ASSERT_EQ(dirty_single.updated_ids, dirty_batch.updated_ids);
+        ASSERT_EQ(dirty_single.destroyed_ids, dirty_batch.destroyed_ids);
+    }
+
+    // Make sure each kind of manifold was covered.
+    ASSERT_TRUE(registry_batch.all_of<edyn::contact_manifold_with_restitution>(manifolds_batch[0]));
+    ASSERT_TRUE(registry_batch.all_of<edyn::continuous>(manifolds_batch[1]));
+    ASSERT_TRUE(registry_batch.all_of<edyn::null_constraint>(manifolds_batch[2]));
+}
+
+TEST(test_narrowphase, async_update_matches_sync_update) {
+    edyn::init();
+
+    auto make_stack = [](entt::registry &registry) {
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+        auto entities = std::vector<entt::entity>{};
+
+        // Slightly rotated boxes stacked with some penetration.
+        for (int i = 0; i < 3; ++i) {
+            def.position = {edyn::scalar(0.1) * i, edyn::scalar(0.95) * i, 0};
+            def.orientation = edyn::quaternion_axis_angle(edyn::vector3_y, edyn::scalar(0.2) * i);
+            entities.push_back(edyn::make_rigidbody(registry, def));
+        }
+
+        edyn::make_contact_manifold(registry, entities[0], entities[1], 0.05);
+        edyn::make_contact_manifold(registry, entities[1], entities[2], 0.05);
+    };
+
+    entt::registry registry_sync, registry_async;
+    setup_worker_registry(registry_sync);
+    setup_worker_registry(registry_async);
+    make_stack(registry_sync);
+    make_stack(registry_async);
+
+    registry_sync.ctx().at<edyn::narrowphase>().update();
+
+    auto &nphase = registry_async.ctx().at<edyn::narrowphase>();
+    ASSERT_TRUE(nphase.parallelizable());
+
+    std::atomic<bool> done {false};
+    auto completion_job = make_set_flag_job(done);
+    nphase.update_async(completion_job);
+    wait_for_flag(done);
+    nphase.finish_async_update();
+
+    auto view_sync = registry_sync.view<edyn::contact_manifold>();
+    auto view_async = registry_async.view<edyn::contact_manifold>();
+    ASSERT_EQ(view_sync.size(), view_async.size());
+
+    for (auto entity : view_sync) {
+        auto &manifold_sync = view_sync.get<edyn::contact_manifold>(entity);
+        auto &manifold_async = view_async.get<edyn::contact_manifold>(entity);
+        ASSERT_GT(manifold_sync.num_points, 0);
+        ASSERT_EQ(manifold_sync.num_points, manifold_async.num_points);
+
+        for (unsigned i = 0; i < manifold_sync.num_points; ++i) {
+            auto &cp_sync = manifold_sync.get_point(i);
+            auto &cp_async = manifold_async.get_point(i);
+            ASSERT_TRUE(cp_sync.pivotA == cp_async.pivotA);
+            ASSERT_TRUE(cp_sync.pivotB == cp_async.pivotB);
+            ASSERT_TRUE(cp_sync.normal == cp_async.normal);
+            ASSERT_EQ(cp_sync.distance, cp_async.distance);
+            ASSERT_EQ(cp_sync.friction, cp_async.friction);
+            ASSERT_EQ(cp_sync.restitution, cp_async.restitution);
+        }
+
+        auto &dirty_sync = registry_sync.get<edyn::dirty>(entity);
+        auto &dirty_async = registry_async.get<edyn::dirty>(entity);
+        ASSERT_EQ(dirty_sync.created_ids, dirty_async.created_ids);
+        ASSERT_EQ(dirty_sync.updated_ids, dirty_async.updated_ids);
+
+        auto &events_sync = registry_sync.get<edyn::contact_manifold_events>(entity);
+        auto &events_async = registry_async.get<edyn::contact_manifold_events>(entity);
+        ASSERT_EQ(events_sync.num_contacts_created, events_async.num_contacts_created);
+    }
+}
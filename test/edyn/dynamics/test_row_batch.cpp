@@ -0,0 +1,178 @@
+#include "../common/common.hpp"
+#include <edyn/dynamics/row_batch.hpp>
+#include <edyn/dynamics/row_cache.hpp>
+#include <edyn/dynamics/solver.hpp>
+#include <edyn/comp/delta_linvel.hpp>
+#include <edyn/comp/delta_angvel.hpp>
+#include <set>
+
+class row_batch_test: public ::testing::Test {
+protected:
+    void SetUp() override {
+        dv.resize(num_bodies);
+        dw.resize(num_bodies);
+
+        for (size_t i = 0; i < num_bodies; ++i) {
+            dv[i] = edyn::vector3_zero;
+            dw[i] = edyn::vector3_zero;
+        }
+    }
+
+    edyn::constraint_row & make_row(edyn::row_cache &cache, size_t bodyA, size_t bodyB,
+                                    edyn::scalar inv_mB = 1) {
+        auto &row = cache.rows.emplace_back();
+        auto normal = edyn::vector3_y;
+        auto rA = edyn::vector3{0.5, -0.5, 0.1};
+        auto rB = edyn::vector3{-0.2, 0.5, 0.3};
+        row.J = {normal, edyn::cross(rA, normal), -normal, -edyn::cross(rB, normal)};
+        row.inv_mA = 1; row.inv_IA = edyn::matrix3x3_identity;
+        row.inv_mB = inv_mB; row.inv_IB = inv_mB > 0 ? edyn::matrix3x3_identity : edyn::matrix3x3_zero;
+        row.dvA = &dv[bodyA]; row.dwA = &dw[bodyA];
+        row.dvB = &dv[bodyB]; row.dwB = &dw[bodyB];
+        row.eff_mass = edyn::get_effective_mass(row);
+        row.rhs = 1;
+        row.lower_limit = 0;
+        row.upper_limit = edyn::large_scalar;
+        row.impulse = 0;
+        return row;
+    }
+
+    static constexpr size_t num_bodies = 1024;
+    std::vector<edyn::delta_linvel> dv;
+    std::vector<edyn::delta_angvel> dw;
+};
+
+TEST_F(row_batch_test, rows_in_batch_do_not_share_bodies) {
+    edyn::row_cache cache;
+
+    // Chain of bodies where each body is connected to the next two.
+    for (size_t i = 0; i < num_bodies - 2; ++i) {
+        make_row(cache, i, i + 1);
+        make_row(cache, i, i + 2);
+    }
+
+    edyn::row_batch_cache batch_cache;
+    edyn::make_row_batches(cache, batch_cache);
+
+    // All rows must be present exactly once.
+    auto num_batched_rows = batch_cache.batches.size() * edyn::row_batch_size;
+    ASSERT_EQ(num_batched_rows + batch_cache.remainder_rows.size(), cache.rows.size());
+
+    for (size_t c = 0; c + 1 < batch_cache.color_offsets.size(); ++c) {
+        std::set<const void *> bodies;
+
+        for (auto i = batch_cache.color_offsets[c]; i < batch_cache.color_offsets[c + 1]; ++i) {
+            auto &batch = batch_cache.batches[i];
+
+            for (size_t lane = 0; lane < edyn::row_batch_size; ++lane) {
+                ASSERT_TRUE(bodies.insert(batch.dvA[lane]).second);
+                ASSERT_TRUE(bodies.insert(batch.dvB[lane]).second);
+            }
+        }
+    }
+}
+
+TEST_F(row_batch_test, static_bodies_are_shared) {
+    edyn::row_cache cache;
+
+    // All bodies resting on the same static body, which has the last index.
+    for (size_t i = 0; i < num_bodies - 1; ++i) {
+        make_row(cache, i, num_bodies - 1, 0);
+    }
+
+    edyn::row_batch_cache batch_cache;
+    edyn::make_row_batches(cache, batch_cache);
+
+    // All rows get the same color.
+    ASSERT_EQ(batch_cache.color_offsets.size(), size_t{2});
+    ASSERT_EQ(batch_cache.batches.size(), (num_bodies - 1) / edyn::row_batch_size);
+    ASSERT_EQ(batch_cache.remainder_rows.size(), (num_bodies - 1) % edyn::row_batch_size);
+
+    for (auto &batch : batch_cache.batches) {
+        for (size_t lane = 0; lane < edyn::row_batch_size; ++lane) {
+            ASSERT_EQ(batch.dvB[lane], nullptr);
+        }
+    }
+}
+
+TEST_F(row_batch_test, batched_matches_sequential) {
+    edyn::row_cache cache;
+
+    // Independent pairs of bodies, thus the order in which rows are solved
+    // does not matter.
+    for (size_t i = 0; i < num_bodies; i += 2) {
+        make_row(cache, i, i + 1);
+    }
+
+    auto sequential_cache = cache;
+
+    for (auto &row : sequential_cache.rows) {
+        auto delta_impulse = edyn::solve(row);
+        edyn::apply_impulse(delta_impulse, row);
+    }
+
+    // Store results of the sequential solve and reset deltas before solving
+    // in batches.
+    auto sequential_dv = dv;
+    auto sequential_dw = dw;
+
+    for (size_t i = 0; i < num_bodies; ++i) {
+        dv[i] = edyn::vector3_zero;
+        dw[i] = edyn::vector3_zero;
+    }
+
+    edyn::row_batch_cache batch_cache;
+    edyn::make_row_batches(cache, batch_cache);
+    edyn::solve_row_batches(batch_cache, cache);
+
+    for (size_t i = 0; i < cache.rows.size(); ++i) {
+        ASSERT_SCALAR_EQ(cache.rows[i].impulse, sequential_cache.rows[i].impulse);
+    }
+
+    for (size_t i = 0; i < num_bodies; ++i) {
+        ASSERT_VECTOR3_EQ(sequential_dv[i], dv[i]);
+        ASSERT_VECTOR3_EQ(sequential_dw[i], dw[i]);
+    }
+}
+
+TEST_F(row_batch_test, parallel_matches_batched) {
+    edyn::row_cache cache;
+
+    // Long chain of bodies which needs only a few colors, thus each color has
+    // enough batches to be solved in parallel.
+    for (size_t i = 0; i < num_bodies - 1; ++i) {
+        make_row(cache, i, i + 1);
+    }
+
+    edyn::row_batch_cache batch_cache;
+    edyn::make_row_batches(cache, batch_cache);
+
+    auto batched_cache = cache;
+    edyn::solve_row_batches(batch_cache, batched_cache);
+
+    auto batched_dv = dv;
+    auto batched_dw = dw;
+
+    for (size_t i = 0; i < num_bodies; ++i) {
+        dv[i] = edyn::vector3_zero;
+        dw[i] = edyn::vector3_zero;
+    }
+
+    edyn::job_dispatcher dispatcher;
+    dispatcher.start(4);
+    edyn::solve_row_batches_parallel(dispatcher, batch_cache, cache);
+    dispatcher.stop();
+
+    for (size_t i = 0; i < cache.rows.size(); ++i) {
+        ASSERT_EQ(cache.rows[i].impulse, batched_cache.rows[i].impulse);
+    }
+
+    for (size_t i = 0; i < num_bodies; ++i) {
+        ASSERT_EQ(batched_dv[i].x, dv[i].x);
+        ASSERT_EQ(batched_dv[i].y, dv[i].y);
+        ASSERT_EQ(batched_dv[i].z, dv[i].z);
+        ASSERT_EQ(batched_dw[i].x, dw[i].x);
+        ASSERT_EQ(batched_dw[i].y, dw[i].y);
+        ASSERT_EQ(batched_dw[i].z, dw[i].z);
+    }
+}
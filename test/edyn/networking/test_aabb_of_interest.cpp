@@ -0,0 +1,327 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/comp/aabb_oi_follow.hpp"
+#include "edyn/networking/comp/entity_owner.hpp"
+#include "edyn/networking/util/aabb_of_interest_manager.hpp"
+#include "edyn/collision/tree_view.hpp"
+#include <set>
+
+class aabb_of_interest_test : public ::testing::Test {
+protected:
+    void SetUp() override {
+        edyn::init();
+        edyn::attach(registry);
+        edyn::init_network_server(registry);
+
+        auto &settings = registry.ctx().at<edyn::settings>();
+        margin = std::get<edyn::server_network_settings>(settings.network_settings).aabb_of_interest_margin;
+
+        client_entity = edyn::server_make_client(registry);
+        registry.get<edyn::aabb_of_interest>(client_entity).aabb = {{-10, -10, -10}, {10, 10, 10}};
+    }
+
+    void TearDown() override {
+        edyn::deinit_network_server(registry);
+        edyn::detach(registry);
+    }
+
+    entt::entity make_body(edyn::vector3 pos, edyn::vector3 vel = edyn::vector3_zero) {
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+        def.position = pos;
+        def.linvel = vel;
+        def.gravity = edyn::vector3_zero;
+        def.sleeping_disabled = true;
+        def.networked = true;
+        return edyn::make_rigidbody(registry, def);
+    }
+
+    // Bodies must be 3 units apart along the x axis.
+    entt::entity make_distance_constraint(entt::entity body0, entt::entity body1) {
+        auto [con_entity, con] = edyn::make_constraint<edyn::distance_constraint>(registry, body0, body1);
+        con.pivot[0] = {0.5, 0, 0};
+        con.pivot[1] = {-0.5, 0, 0};
+        con.distance = 2;
+        return con_entity;
+    }
+
+    // Updates the AABBs of interest and accumulates the entities that entered
+    // and exited the AABB of interest of the client.
+    void update() {
+        edyn::update(registry);
+        registry.ctx().at<edyn::aabb_of_interest_manager>().update();
+
+        auto *aabboi = registry.try_get<edyn::aabb_of_interest>(client_entity);
+
+        if (!aabboi) {
+            return;
+        }
+
+        created.insert(created.end(), aabboi->create_entities.begin(), aabboi->create_entities.end());
+        destroyed.insert(destroyed.end(), aabboi->destroy_entities.begin(), aabboi->destroy_entities.end());
+        aabboi->create_entities.clear();
+        aabboi->destroy_entities.clear();
+    }
+
+    // Updates until the predicate is satisfied, which usually depends on the
+    // island workers.
+    template<typename Predicate>
+    bool update_until(Predicate predicate) {
+        for (int i = 0; i < 5000; ++i) {
+            update();
+
+            if (predicate()) {
+                return true;
+            }
+
+            edyn::delay(1);
+        }
+
+        return false;
+    }
+
+    // Number of islands whose AABB is known.
+    size_t num_islands() {
+        return registry.view<edyn::island, edyn::tree_view>().size_hint();
+    }
+
+    entt::entity island_of(entt::entity entity) {
+        return registry.get<edyn::island_resident>(entity).island_entity;
+    }
+
+    edyn::AABB island_aabb(entt::entity entity) {
+        return registry.get<edyn::tree_view>(island_of(entity)).root_aabb();
+    }
+
+    bool contains(entt::entity entity) {
+        return registry.get<edyn::aabb_of_interest>(client_entity).entities.contains(entity);
+    }
+
+    void clear_events() {
+        created.clear();
+        destroyed.clear();
+    }
+
+    entt::registry registry;
+    entt::entity client_entity;
+    edyn::scalar margin;
+    std::vector<entt::entity> created;
+    std::vector<entt::entity> destroyed;
+};
+
+TEST_F(aabb_of_interest_test, enter_and_leave_beyond_margin) {
+    ASSERT_GT(margin, edyn::scalar(0.5));
+
+    auto body = make_body({0, 0, 0});
+    ASSERT_TRUE(update_until([&] { return registry.all_of<edyn::tree_view>(island_of(body)); }));
+
+    auto aabb = island_aabb(body);
+    auto &aabboi = registry.get<edyn::aabb_of_interest>(client_entity);
+
+    // Place the AABB of interest to the right of the island with the given gap.
+    auto place = [&](edyn::scalar gap) {
+        aabboi.aabb.min = {aabb.max.x + gap, -1, -1};
+        aabboi.aabb.max = {aabb.max.x + gap + 2, 1, 1};
+        update();
+    };
+
+    place(margin * edyn::scalar(0.5));
+    clear_events();
+    ASSERT_FALSE(contains(body));
+
+    // Enter only when intersecting.
+    place(-0.1);
+    ASSERT_TRUE(contains(body));
+    ASSERT_EQ(created, std::vector<entt::entity>{body});
+    clear_events();
+
+    // Do not leave while within the margin.
+    for (auto gap : {0.1, 0.5, 0.9, 0.2, 0.7}) {
+        place(margin * edyn::scalar(gap));
+        ASSERT_TRUE(contains(body));
+    }
+
+    ASSERT_TRUE(created.empty());
+    ASSERT_TRUE(destroyed.empty());
+
+    // Leave beyond the margin.
+    place(margin * edyn::scalar(1.5));
+    ASSERT_FALSE(contains(body));
+    ASSERT_EQ(destroyed, std::vector<entt::entity>{body});
+    clear_events();
+
+    // Do not reenter until intersecting again.
+    place(margin * edyn::scalar(0.5));
+    ASSERT_FALSE(contains(body));
+    ASSERT_TRUE(created.empty());
+}
+
+TEST_F(aabb_of_interest_test, moving_island_enters_and_leaves_once) {
+    auto &aabboi = registry.get<edyn::aabb_of_interest>(client_entity);
+    aabboi.aabb = {{4, -1, -1}, {6, 1, 1}};
+
+    auto body = make_body({0, 0, 0}, {10, 0, 0});
+    auto was_contained = false;
+
+    // Check the containment of the island against its last known AABB in
+    // every update.
+    auto passed = update_until([&] {
+        if (!registry.all_of<edyn::tree_view>(island_of(body))) {
+            return false;
+        }
+
+        auto aabb = island_aabb(body);
+        auto expanded = aabboi.aabb.inset(edyn::vector3_one * -margin);
+        auto expected = was_contained ? edyn::intersect(expanded, aabb) : edyn::intersect(aabboi.aabb, aabb);
+        EXPECT_EQ(contains(body), expected);
+        was_contained = contains(body);
+
+        return aabb.min.x > expanded.max.x + 1;
+    });
+
+    ASSERT_TRUE(passed);
+    ASSERT_EQ(created, std::vector<entt::entity>{body});
+    ASSERT_EQ(destroyed, std::vector<entt::entity>{body});
+}
+
+TEST_F(aabb_of_interest_test, island_merge_and_split) {
+    // Both bodies are owned by the same client, thus the owner is reachable
+    // via both islands.
+    auto owner_client_entity = edyn::server_make_client(registry);
+    registry.get<edyn::aabb_of_interest>(owner_client_entity).aabb = {{100, 100, 100}, {101, 101, 101}};
+
+    auto body0 = make_body({0, 0, 0});
+    auto body1 = make_body({3, 0, 0});
+    registry.emplace<edyn::entity_owner>(body0, owner_client_entity);
+    registry.emplace<edyn::entity_owner>(body1, owner_client_entity);
+
+    ASSERT_TRUE(update_until([&] { return num_islands() == 2; }));
+    ASSERT_TRUE(contains(body0));
+    ASSERT_TRUE(contains(body1));
+    ASSERT_TRUE(contains(owner_client_entity));
+    clear_events();
+
+    // Merge islands.
+    auto con_entity = make_distance_constraint(body0, body1);
+
+    ASSERT_TRUE(update_until([&] { return num_islands() == 1 && island_of(body0) == island_of(body1); }));
+    ASSERT_EQ(created, std::vector<entt::entity>{con_entity});
+    ASSERT_TRUE(destroyed.empty());
+    ASSERT_TRUE(contains(body0));
+    ASSERT_TRUE(contains(body1));
+    ASSERT_TRUE(contains(owner_client_entity));
+    clear_events();
+
+    // Split islands.
+    registry.destroy(con_entity);
+
+    ASSERT_TRUE(update_until([&] { return num_islands() == 2 && island_of(body0) != island_of(body1); }));
+    ASSERT_TRUE(created.empty());
+    ASSERT_EQ(destroyed, std::vector<entt::entity>{con_entity});
+    ASSERT_TRUE(contains(body0));
+    ASSERT_TRUE(contains(body1));
+    ASSERT_TRUE(contains(owner_client_entity));
+}
+
+TEST_F(aabb_of_interest_test, island_destroyed) {
+    auto body0 = make_body({0, 0, 0});
+    auto body1 = make_body({3, 0, 0});
+    ASSERT_TRUE(update_until([&] { return num_islands() == 2; }));
+    auto island_entity0 = island_of(body0);
+    auto island_entity1 = island_of(body1);
+    clear_events();
+
+    // One of the islands is destroyed when they're merged.
+    auto con_entity = make_distance_constraint(body0, body1);
+
+    ASSERT_TRUE(update_until([&] { return !registry.valid(island_entity0) || !registry.valid(island_entity1); }));
+    auto destroyed_island_entity = registry.valid(island_entity0) ? island_entity1 : island_entity0;
+    auto &aabboi = registry.get<edyn::aabb_of_interest>(client_entity);
+    ASSERT_FALSE(aabboi.island_entities.contains(destroyed_island_entity));
+    ASSERT_TRUE(aabboi.island_entities.contains(island_of(body0)));
+    ASSERT_EQ(created, std::vector<entt::entity>{con_entity});
+    ASSERT_TRUE(destroyed.empty());
+
+    // No stale references are left behind.
+    aabboi.aabb = {{100, 100, 100}, {101, 101, 101}};
+    update();
+    ASSERT_EQ(std::set<entt::entity>(destroyed.begin(), destroyed.end()),
+              (std::set<entt::entity>{body0, body1, con_entity}));
+    ASSERT_TRUE(aabboi.entities.empty());
+    ASSERT_TRUE(aabboi.island_entities.empty());
+}
+
+TEST_F(aabb_of_interest_test, aabb_of_interest_destroyed) {
+    auto body0 = make_body({0, 0, 0});
+    auto body1 = make_body({3, 0, 0});
+    ASSERT_TRUE(update_until([&] { return num_islands() == 2; }));
+    ASSERT_TRUE(contains(body0));
+    ASSERT_TRUE(contains(body1));
+
+    registry.remove<edyn::aabb_of_interest>(client_entity);
+
+    // The destroyed island must not refer to the destroyed AABB of interest.
+    auto con_entity = make_distance_constraint(body0, body1);
+    ASSERT_TRUE(update_until([&] { return registry.view<edyn::island>().size() == 1; }));
+
+    // Contents are calculated from scratch when it is assigned again.
+    registry.emplace<edyn::aabb_of_interest>(client_entity);
+    clear_events();
+    update();
+    ASSERT_EQ(std::set<entt::entity>(created.begin(), created.end()),
+              (std::set<entt::entity>{body0, body1, con_entity}));
+}
+
+TEST_F(aabb_of_interest_test, aabb_of_interest_follows_entity) {
+    auto &aabboi = registry.get<edyn::aabb_of_interest>(client_entity);
+    aabboi.aabb = {{-1, -1, -1}, {1, 1, 1}};
+    auto half_size = (aabboi.aabb.max - aabboi.aabb.min) / 2;
+
+    auto body = make_body({0, 0, 0}, {10, 0, 0});
+    registry.emplace<edyn::aabb_oi_follow>(client_entity, body);
+
+    auto passed = update_until([&] {
+        auto &pos = registry.get<edyn::position>(body);
+        EXPECT_LT(edyn::distance_sqr(aabboi.aabb.center(), pos), edyn::scalar(1e-6));
+        EXPECT_LT(edyn::distance_sqr((aabboi.aabb.max - aabboi.aabb.min) / 2, half_size), edyn::scalar(1e-6));
+        return pos.x > 5;
+    });
+
+    ASSERT_TRUE(passed);
+    ASSERT_TRUE(contains(body));
+    ASSERT_TRUE(destroyed.empty());
+}
+
+TEST_F(aabb_of_interest_test, owner_changed) {
+    auto body = make_body({0, 0, 0});
+    auto owner_client_entity0 = edyn::server_make_client(registry);
+    auto owner_client_entity1 = edyn::server_make_client(registry);
+    registry.get<edyn::aabb_of_interest>(owner_client_entity0).aabb = {{100, 100, 100}, {101, 101, 101}};
+    registry.get<edyn::aabb_of_interest>(owner_client_entity1).aabb = {{100, 100, 100}, {101, 101, 101}};
+
+    ASSERT_TRUE(update_until([&] { return num_islands() == 1; }));
+    ASSERT_TRUE(contains(body));
+    clear_events();
+
+    // Owners are included when assigned to an entity in an island.
+    registry.emplace<edyn::entity_owner>(body, owner_client_entity0);
+    update();
+    ASSERT_TRUE(contains(owner_client_entity0));
+    ASSERT_EQ(created, std::vector<entt::entity>{owner_client_entity0});
+    clear_events();
+
+    // And excluded when replaced.
+    registry.replace<edyn::entity_owner>(body, owner_client_entity1);
+    update();
+    ASSERT_FALSE(contains(owner_client_entity0));
+    ASSERT_TRUE(contains(owner_client_entity1));
+    ASSERT_EQ(created, std::vector<entt::entity>{owner_client_entity1});
+    ASSERT_EQ(destroyed, std::vector<entt::entity>{owner_client_entity0});
+    clear_events();
+
+    registry.remove<edyn::entity_owner>(body);
+    update();
+    ASSERT_FALSE(contains(owner_client_entity1));
+    ASSERT_EQ(destroyed, std::vector<entt::entity>{owner_client_entity1});
+}
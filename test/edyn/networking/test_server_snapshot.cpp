@@ -0,0 +1,305 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/networking_external.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/comp/entity_owner.hpp"
+#include "edyn/networking/comp/network_dirty.hpp"
+#include "edyn/networking/comp/remote_client.hpp"
+#include "edyn/networking/context/server_network_context.hpp"
+#include "edyn/util/island_util.hpp"
+#include <map>
+#include <set>
+
+struct test_input : edyn::network_input {
+    int value;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, test_input &input) {
+    archive(input.value);
+}
+
+// Builds the snapshot of a client in the same manner it was done before the
+// shared snapshot cache, where each client exported its entities separately.
+static edyn::packet::registry_snapshot
+export_client_snapshot(entt::registry &registry, entt::entity client_entity) {
+    auto &aabboi = registry.get<edyn::aabb_of_interest>(client_entity);
+    auto snap = edyn::packet::registry_snapshot{};
+
+    for (auto entity : aabboi.entities) {
+        if (!registry.any_of<edyn::sleeping_tag>(entity) &&
+            registry.all_of<edyn::networked_tag, edyn::network_dirty>(entity) &&
+            !edyn::is_fully_owned_by_client(registry, client_entity, entity)) {
+            snap.entities.push_back(entity);
+        }
+    }
+
+    auto &ctx = registry.ctx().at<edyn::server_network_context>();
+    ctx.snapshot_exporter->export_dirty(registry, snap, client_entity);
+
+    auto island_entities = edyn::collect_islands_from_residents(registry, snap.entities.begin(), snap.entities.end());
+    auto timestamp_view = registry.view<edyn::island_timestamp>();
+    auto first = true;
+
+    for (auto island_entity : island_entities) {
+        auto [isle_time] = timestamp_view.get(island_entity);
+        snap.timestamp = first ? isle_time.value : std::min(isle_time.value, snap.timestamp);
+        first = false;
+    }
+
+    return snap;
+}
+
+static std::vector<uint8_t> write_pool(const edyn::pool_snapshot &pool) {
+    auto data = std::vector<uint8_t>{};
+    auto archive = edyn::memory_output_archive(data);
+    pool.ptr->write(archive);
+    return data;
+}
+
+static bool contains_entity(const edyn::packet::registry_snapshot &snap, entt::entity entity) {
+    auto it = std::find(snap.entities.begin(), snap.entities.end(), entity);
+    return it != snap.entities.end();
+}
+
+TEST(test_server_snapshot, shared_cache_matches_per_client_export) {
+    edyn::init();
+
+    entt::registry registry;
+    edyn::attach(registry);
+    edyn::init_network_server(registry);
+    edyn::register_networked_components<test_input>(registry);
+
+    auto &settings = registry.ctx().at<edyn::settings>();
+    auto &server_settings = std::get<edyn::server_network_settings>(settings.network_settings);
+    // Compare raw snapshots.
+    server_settings.snapshot_encoding_enabled = false;
+
+    auto client0 = edyn::server_make_client(registry);
+    auto client1 = edyn::server_make_client(registry);
+
+    auto make_body = [&](edyn::vector3 pos, entt::entity client_entity) {
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+        def.position = pos;
+        def.gravity = edyn::vector3_zero;
+        def.networked = true;
+        def.sleeping_disabled = true;
+        auto entity = edyn::make_rigidbody(registry, def);
+
+        if (client_entity != entt::null) {
+            registry.emplace<edyn::entity_owner>(entity, client_entity);
+            registry.emplace<test_input>(entity);
+            registry.get<edyn::remote_client>(client_entity).owned_entities.push_back(entity);
+        }
+
+        return entity;
+    };
+
+    // Bodies alone in their islands are fully owned by their client. The
+    // constrained bodies share an island owned by both clients. The last body
+    // has no owner.
+    auto alone0 = make_body({0, 0, 0}, client0);
+    auto shared0 = make_body({2, 0, 0}, client0);
+    auto shared1 = make_body({3, 0, 0}, client1);
+    auto alone1 = make_body({5, 0, 0}, client1);
+    auto unowned = make_body({2.5, 2, 0}, entt::null);
+    edyn::make_constraint<edyn::distance_constraint>(registry, shared0, shared1);
+    auto bodies = std::vector<entt::entity>{alone0, shared0, shared1, alone1, unowned};
+
+    // Overlapping AABBs of interest.
+    registry.get<edyn::aabb_of_interest>(client0).aabb = {{-1, -1, -1}, {4, 3, 1}};
+    registry.get<edyn::aabb_of_interest>(client1).aabb = {{1, -1, -1}, {6, 3, 1}};
+
+    auto packets = std::map<entt::entity, std::vector<edyn::packet::registry_snapshot>>{};
+
+    struct packet_observer {
+        std::map<entt::entity, std::vector<edyn::packet::registry_snapshot>> *packets;
+
+        void receive(entt::entity client_entity, const edyn::packet::edyn_packet &packet) {
+            if (auto *snap = std::get_if<edyn::packet::registry_snapshot>(&packet.var)) {
+                (*packets)[client_entity].push_back(*snap);
+            }
+        }
+    } observer {&packets};
+
+    edyn::network_server_packet_sink(registry).connect<&packet_observer::receive>(observer);
+
+    auto num_compared = std::map<entt::entity, unsigned>{};
+    auto shared_seen = std::map<entt::entity, bool>{};
+
+    for (int i = 0; i < 1000 && (!shared_seen[client0] || !shared_seen[client1]); ++i) {
+        edyn::update(registry);
+
+        // Mark an input and a regular component as dirty in all bodies.
+        auto time = edyn::performance_time();
+
+        for (auto entity : bodies) {
+            auto &n_dirty = registry.get_or_emplace<edyn::network_dirty>(entity);
+            n_dirty.insert<edyn::position>(time);
+
+            if (registry.all_of<test_input>(entity)) {
+                n_dirty.insert<test_input>(time);
+            }
+        }
+
+        edyn::update_network_server(registry);
+
+        // The registry does not change until the next update, thus the
+        // snapshots exported now must match the ones that were published.
+        for (auto client_entity : {client0, client1}) {
+            for (auto &snap : packets[client_entity]) {
+                auto expected = export_client_snapshot(registry, client_entity);
+                ASSERT_EQ(snap.entities, expected.entities);
+                ASSERT_EQ(snap.pools.size(), expected.pools.size());
+                ASSERT_EQ(snap.timestamp, expected.timestamp);
+
+                for (auto &expected_pool : expected.pools) {
+                    auto pool_it = std::find_if(snap.pools.begin(), snap.pools.end(), [&](auto &&pool) {
+                        return pool.component_index == expected_pool.component_index;
+                    });
+                    ASSERT_NE(pool_it, snap.pools.end());
+                    ASSERT_EQ(pool_it->ptr->entity_indices, expected_pool.ptr->entity_indices);
+                    ASSERT_EQ(write_pool(*pool_it), write_pool(expected_pool));
+                }
+
+                // Bodies in islands fully owned by the destination client are
+                // never included.
+                auto alone = client_entity == client0 ? alone0 : alone1;
+                ASSERT_FALSE(contains_entity(snap, alone));
+
+                // Input of the entities owned by the destination client is
+                // not included.
+                auto owned = client_entity == client0 ? shared0 : shared1;
+                auto input_index = edyn::tuple_index_of<unsigned, test_input>(
+                    std::tuple_cat(edyn::networked_components, std::tuple<test_input>{}));
+
+                for (auto &pool : snap.pools) {
+                    if (pool.component_index == input_index) {
+                        auto it = std::find(snap.entities.begin(), snap.entities.end(), owned);
+
+                        if (it != snap.entities.end()) {
+                            auto owned_index = std::distance(snap.entities.begin(), it);
+                            auto &indices = pool.ptr->entity_indices;
+                            ASSERT_EQ(std::count(indices.begin(), indices.end(), owned_index), 0);
+                        }
+                    }
+                }
+
+                if (contains_entity(snap, shared0) && contains_entity(snap, shared1)) {
+                    shared_seen[client_entity] = true;
+                }
+
+                ++num_compared[client_entity];
+            }
+
+            packets[client_entity].clear();
+        }
+
+        edyn::delay(2);
+    }
+
+    ASSERT_TRUE(shared_seen[client0]);
+    ASSERT_TRUE(shared_seen[client1]);
+    ASSERT_GT(num_compared[client0], 0u);
+    ASSERT_GT(num_compared[client1], 0u);
+
+    edyn::network_server_packet_sink(registry).disconnect(observer);
+    edyn::unregister_networked_components(registry);
+    edyn::deinit_network_server(registry);
+    edyn::detach(registry);
+}
+
+TEST(test_server_snapshot, deferred_entities_sent_after_dirty_expires) {
+    edyn::init();
+
+    entt::registry registry;
+    edyn::attach(registry);
+    edyn::init_network_server(registry);
+
+    auto &settings = registry.ctx().at<edyn::settings>();
+    auto &server_settings = std::get<edyn::server_network_settings>(settings.network_settings);
+    server_settings.snapshot_encoding_enabled = false;
+    // Only one entity fits in each snapshot.
+    server_settings.snapshot_byte_budget = 1;
+
+    auto client_entity = edyn::server_make_client(registry);
+    auto &client = registry.get<edyn::remote_client>(client_entity);
+    auto &aabboi = registry.get<edyn::aabb_of_interest>(client_entity);
+    aabboi.aabb = {{-10, -10, -10}, {10, 10, 10}};
+
+    auto bodies = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 3; ++i) {
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+        def.position = {edyn::scalar(i) * 2, 0, 0};
+        def.gravity = edyn::vector3_zero;
+        def.networked = true;
+        def.sleeping_disabled = true;
+        bodies.push_back(edyn::make_rigidbody(registry, def));
+    }
+
+    auto sent_entities = std::vector<entt::entity>{};
+    auto num_snapshots = 0u;
+
+    struct packet_observer {
+        std::vector<entt::entity> *sent_entities;
+        unsigned *num_snapshots;
+
+        void receive(entt::entity, const edyn::packet::edyn_packet &packet) {
+            if (auto *snap = std::get_if<edyn::packet::registry_snapshot>(&packet.var)) {
+                sent_entities->insert(sent_entities->end(), snap->entities.begin(), snap->entities.end());
+                ++*num_snapshots;
+            }
+        }
+    } observer {&sent_entities, &num_snapshots};
+
+    edyn::network_server_packet_sink(registry).connect<&packet_observer::receive>(observer);
+
+    auto in_aabboi = [&] {
+        for (auto entity : bodies) {
+            if (!aabboi.entities.contains(entity)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (int i = 0; i < 5000 && !in_aabboi(); ++i) {
+        edyn::update(registry);
+        edyn::update_network_server(registry);
+        edyn::delay(1);
+    }
+
+    ASSERT_TRUE(in_aabboi());
+
+    // Mark all bodies as dirty once.
+    registry.clear<edyn::network_dirty>();
+    client.deferred_snapshot_entities.clear();
+    sent_entities.clear();
+    num_snapshots = 0;
+    auto time = edyn::performance_time();
+
+    for (auto entity : bodies) {
+        registry.emplace<edyn::network_dirty>(entity).insert<edyn::position>(time);
+    }
+
+    // Send snapshots without delay and expire dirty components right after the
+    // first snapshot. The bodies that did not fit must still be sent.
+    client.snapshot_rate = 1e9;
+
+    for (int i = 0; i < 3; ++i) {
+        edyn::update_network_server(registry);
+        registry.clear<edyn::network_dirty>();
+    }
+
+    ASSERT_EQ(num_snapshots, 3u);
+    ASSERT_EQ(std::set<entt::entity>(sent_entities.begin(), sent_entities.end()),
+              std::set<entt::entity>(bodies.begin(), bodies.end()));
+    ASSERT_TRUE(client.deferred_snapshot_entities.empty());
+
+    edyn::network_server_packet_sink(registry).disconnect(observer);
+    edyn::deinit_network_server(registry);
+    edyn::detach(registry);
+}
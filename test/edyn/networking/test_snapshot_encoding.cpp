@@ -0,0 +1,171 @@
+#include "../common/common.hpp"
+#include "edyn/networking/networking.hpp"
+#include "edyn/networking/util/snapshot_encoding.hpp"
+#include "edyn/serialization/bit_archive.hpp"
+#include "edyn/serialization/entt_s11n.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/std_s11n.hpp"
+
+TEST(snapshot_encoding_test, bit_archive) {
+    auto data = std::vector<uint8_t>{};
+    auto output = edyn::bit_output_archive(data);
+    output.write_bits(5, 3);
+    output.write_bool(true);
+    output.write_bits(0x12345, 17);
+    output.write_float(3.5f);
+
+    ASSERT_EQ(output.bit_position(), 3u + 1u + 17u + 32u);
+    ASSERT_EQ(data.size(), 7u);
+
+    auto input = edyn::bit_input_archive(data.data(), data.size());
+    ASSERT_EQ(input.read_bits(3), 5u);
+    ASSERT_TRUE(input.read_bool());
+    ASSERT_EQ(input.read_bits(17), 0x12345u);
+    ASSERT_EQ(input.read_float(), 3.5f);
+    ASSERT_FALSE(input.failed());
+
+    input.read_bits(8);
+    ASSERT_TRUE(input.failed());
+}
+
+TEST(snapshot_encoding_test, quantize_quaternion) {
+    auto q = edyn::normalize(edyn::quaternion{0.3, -0.8, 0.1, -0.4});
+    auto value = edyn::quantize_quaternion(q, 12);
+    auto p = edyn::dequantize_quaternion(value, 12);
+
+    // Either `p` or `-p` equals `q`.
+    auto d = std::abs(edyn::dot(p, q));
+    ASSERT_NEAR(d, 1, 1e-5);
+}
+
+TEST(snapshot_encoding_test, quantize_vector3) {
+    auto min = edyn::vector3{-100, -10, 0};
+    auto max = edyn::vector3{100, 10, 50};
+    auto v = edyn::vector3{12.345, -9.99, 49};
+    auto p = edyn::dequantize_vector3(edyn::quantize_vector3(v, min, max, 20), min, max, 20);
+
+    ASSERT_NEAR(p.x, v.x, 200.0 / (1 << 20));
+    ASSERT_NEAR(p.y, v.y, 20.0 / (1 << 20));
+    ASSERT_NEAR(p.z, v.z, 50.0 / (1 << 20));
+}
+
+static edyn::packet::registry_snapshot
+make_snapshot(const std::vector<entt::entity> &entities, edyn::scalar offset) {
+    auto snap = edyn::packet::registry_snapshot{};
+    snap.entities = entities;
+
+    auto pos_pool = edyn::pool_snapshot{0};
+    auto *pos_data = new edyn::pool_snapshot_data_impl<edyn::position>;
+    pos_pool.ptr.reset(pos_data);
+
+    auto orn_pool = edyn::pool_snapshot{1};
+    auto *orn_data = new edyn::pool_snapshot_data_impl<edyn::orientation>;
+    orn_pool.ptr.reset(orn_data);
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        pos_data->entity_indices.push_back(i);
+        pos_data->components.push_back({edyn::vector3{edyn::scalar(i), 2, -3} + edyn::vector3_x * offset});
+        orn_data->entity_indices.push_back(i);
+        orn_data->components.push_back({edyn::quaternion_axis_angle(edyn::vector3_y, offset)});
+    }
+
+    // The first entity is far outside the quantisation bounds.
+    pos_data->components[0] = {edyn::vector3{1e4, 0, 0}};
+
+    snap.pools.push_back(std::move(pos_pool));
+    snap.pools.push_back(std::move(orn_pool));
+
+    return snap;
+}
+
+static void check_decoded(edyn::packet::registry_snapshot &decoded,
+                          const std::vector<entt::entity> &entities, edyn::scalar offset) {
+    ASSERT_EQ(decoded.pools.size(), 2u);
+    auto &pos_pool = *static_cast<edyn::pool_snapshot_data_impl<edyn::position> *>(decoded.pools[0].ptr.get());
+    auto &orn_pool = *static_cast<edyn::pool_snapshot_data_impl<edyn::orientation> *>(decoded.pools[1].ptr.get());
+
+    ASSERT_EQ(decoded.pools[0].component_index, 0u);
+    ASSERT_EQ(decoded.pools[1].component_index, 1u);
+    ASSERT_EQ(pos_pool.components.size(), entities.size());
+    ASSERT_EQ(orn_pool.components.size(), entities.size());
+    ASSERT_EQ(pos_pool.components[0].x, 1e4);
+
+    for (size_t i = 1; i < entities.size(); ++i) {
+        ASSERT_EQ(pos_pool.entity_indices[i], i);
+        ASSERT_NEAR(pos_pool.components[i].x, edyn::scalar(i) + offset, 1e-3);
+        ASSERT_NEAR(pos_pool.components[i].y, 2, 1e-3);
+        ASSERT_NEAR(pos_pool.components[i].z, -3, 1e-3);
+
+        auto q = edyn::quaternion_axis_angle(edyn::vector3_y, offset);
+        ASSERT_NEAR(std::abs(edyn::dot(orn_pool.components[i], q)), 1, 1e-5);
+    }
+}
+
+TEST(snapshot_encoding_test, delta_encode_against_baseline) {
+    auto entities = std::vector<entt::entity>{};
+
+    // More than 256 entities to exercise the wider pool entity indices.
+    for (unsigned i = 0; i < 300; ++i) {
+        entities.push_back(entt::entity{i * 2 + 1});
+    }
+
+    auto quant = edyn::snapshot_quantization{};
+    auto server_history = edyn::snapshot_baseline_history{};
+    auto client_history = edyn::snapshot_baseline_history{};
+
+    auto transmit = [](edyn::packet::registry_snapshot &snap) {
+        auto data = std::vector<uint8_t>{};
+        auto output = edyn::memory_output_archive(data);
+        edyn::packet::serialize(output, snap);
+
+        auto received = edyn::packet::registry_snapshot{};
+        auto input = edyn::memory_input_archive(data.data(), data.size());
+        edyn::packet::serialize(input, received);
+        return std::make_pair(received, data.size());
+    };
+
+    // First snapshot is encoded without a baseline.
+    auto snap0 = make_snapshot(entities, 0);
+    edyn::encode_registry_snapshot(snap0, quant, server_history, 1, 0);
+    ASSERT_TRUE(snap0.pools.empty());
+    ASSERT_EQ(snap0.baseline_sequence, 0u);
+
+    auto [recv0, size0] = transmit(snap0);
+    ASSERT_TRUE(edyn::decode_registry_snapshot(recv0, client_history));
+    check_decoded(recv0, entities, 0);
+
+    // Second snapshot uses the first as baseline, which was acknowledged.
+    auto snap1 = make_snapshot(entities, 0.01);
+    edyn::encode_registry_snapshot(snap1, quant, server_history, 2, 1);
+    ASSERT_EQ(snap1.baseline_sequence, 1u);
+
+    auto [recv1, size1] = transmit(snap1);
+    ASSERT_LT(size1, size0);
+    ASSERT_TRUE(edyn::decode_registry_snapshot(recv1, client_history));
+    check_decoded(recv1, entities, 0.01);
+
+    // A snapshot whose baseline is unknown cannot be decoded.
+    auto snap2 = make_snapshot(entities, 0.02);
+    edyn::encode_registry_snapshot(snap2, quant, server_history, 3, 2);
+    auto [recv2, size2] = transmit(snap2);
+    recv2.baseline_sequence = 42;
+    ASSERT_FALSE(edyn::decode_registry_snapshot(recv2, client_history));
+}
+
+TEST(snapshot_encoding_test, quantized_component_bits) {
+    auto quant = edyn::snapshot_quantization{};
+
+    // Baseline and range flags followed by the quantized coordinates.
+    auto position_bits = edyn::quantized_component_bits(entt::type_index<edyn::position>::value(), quant);
+    ASSERT_EQ(position_bits, 2u + 3u * quant.position_bits);
+
+    auto linvel_bits = edyn::quantized_component_bits(entt::type_index<edyn::linvel>::value(), quant);
+    ASSERT_EQ(linvel_bits, 2u + 3u * quant.velocity_bits);
+
+    // Baseline flag, largest component index and the smallest three.
+    auto orientation_bits = edyn::quantized_component_bits(entt::type_index<edyn::orientation>::value(), quant);
+    ASSERT_EQ(orientation_bits, 1u + 2u + 3u * quant.orientation_bits);
+
+    // Other components are not quantised.
+    ASSERT_EQ(edyn::quantized_component_bits(entt::type_index<edyn::mass>::value(), quant), 0u);
+}
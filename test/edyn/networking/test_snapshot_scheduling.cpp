@@ -0,0 +1,114 @@
+#include "../common/common.hpp"
+#include "edyn/networking/util/snapshot_scheduling.hpp"
+#include <set>
+
+static std::set<entt::entity> candidate_entities(const std::vector<edyn::snapshot_candidate> &candidates) {
+    auto entities = std::set<entt::entity>{};
+
+    for (auto &candidate : candidates) {
+        entities.insert(candidate.entity);
+    }
+
+    return entities;
+}
+
+TEST(test_snapshot_scheduling, all_selected_within_budget) {
+    auto e0 = entt::entity{0}, e1 = entt::entity{1}, e2 = entt::entity{2};
+    auto candidates = std::vector<edyn::snapshot_candidate>{
+        {e0, 0, 10, 1}, {e1, 1, 10, 2}, {e2, 2, 10, 3}
+    };
+
+    auto deferred = edyn::deferred_snapshot_entity_map{};
+    deferred[e0].priority = 5;
+
+    edyn::schedule_snapshot_candidates(candidates, 30, deferred);
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e0, e1, e2}));
+    ASSERT_TRUE(deferred.empty());
+
+    // No limit if the budget is zero.
+    edyn::schedule_snapshot_candidates(candidates, 0, deferred);
+    ASSERT_EQ(candidates.size(), 3u);
+    ASSERT_TRUE(deferred.empty());
+}
+
+TEST(test_snapshot_scheduling, highest_priorities_within_budget) {
+    auto e0 = entt::entity{0}, e1 = entt::entity{1}, e2 = entt::entity{2}, e3 = entt::entity{3};
+    auto candidates = std::vector<edyn::snapshot_candidate>{
+        {e0, 0, 10, 1}, {e1, 1, 10, 3}, {e2, 2, 10, 2}, {e3, 3, 10, 4}
+    };
+
+    auto deferred = edyn::deferred_snapshot_entity_map{};
+    edyn::schedule_snapshot_candidates(candidates, 25, deferred);
+
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e1, e3}));
+    ASSERT_EQ(deferred.size(), 2u);
+    ASSERT_EQ(deferred.at(e0).priority, 1);
+    ASSERT_EQ(deferred.at(e2).priority, 2);
+}
+
+TEST(test_snapshot_scheduling, priority_accumulates) {
+    auto e0 = entt::entity{0}, e1 = entt::entity{1};
+    auto make_candidates = [&] {
+        return std::vector<edyn::snapshot_candidate>{{e0, 0, 10, 1}, {e1, 1, 10, 1.5}};
+    };
+
+    auto deferred = edyn::deferred_snapshot_entity_map{};
+    auto candidates = make_candidates();
+    edyn::schedule_snapshot_candidates(candidates, 10, deferred);
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e1}));
+    ASSERT_EQ(deferred.at(e0).priority, 1);
+
+    // The lower priority entity is eventually sent since its priority
+    // accumulates while it's deferred.
+    candidates = make_candidates();
+    edyn::schedule_snapshot_candidates(candidates, 10, deferred);
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e0}));
+    ASSERT_EQ(candidates.front().priority, 2);
+    ASSERT_EQ(deferred.size(), 1u);
+    ASSERT_EQ(deferred.at(e1).priority, 1.5);
+
+    candidates = make_candidates();
+    edyn::schedule_snapshot_candidates(candidates, 10, deferred);
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e1}));
+    ASSERT_EQ(deferred.at(e0).priority, 1);
+}
+
+TEST(test_snapshot_scheduling, at_least_one_selected) {
+    auto e0 = entt::entity{0}, e1 = entt::entity{1};
+    auto candidates = std::vector<edyn::snapshot_candidate>{{e0, 0, 100, 1}, {e1, 1, 100, 2}};
+    auto deferred = edyn::deferred_snapshot_entity_map{};
+
+    edyn::schedule_snapshot_candidates(candidates, 10, deferred);
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e1}));
+    ASSERT_EQ(deferred.size(), 1u);
+    ASSERT_TRUE(deferred.count(e0));
+
+    candidates = {{e0, 0, 100, 1}};
+    edyn::schedule_snapshot_candidates(candidates, 10, deferred);
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e0}));
+    ASSERT_TRUE(deferred.empty());
+}
+
+TEST(test_snapshot_scheduling, deferred_entities) {
+    auto e0 = entt::entity{0}, e1 = entt::entity{1}, e2 = entt::entity{2};
+    auto deferred = edyn::deferred_snapshot_entity_map{};
+    deferred[e0] = {1, {7, 8}};
+    deferred[e2] = {1, {9}};
+
+    // Deferred entities keep their components when deferred again and are
+    // discarded when they're not candidates anymore.
+    auto candidates = std::vector<edyn::snapshot_candidate>{{e0, 0, 10, 0.5}, {e1, 1, 10, 2}};
+    edyn::schedule_snapshot_candidates(candidates, 10, deferred);
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e1}));
+    ASSERT_EQ(deferred.size(), 1u);
+    ASSERT_EQ(deferred.at(e0).priority, 1.5);
+    ASSERT_EQ(deferred.at(e0).component_ids, (std::vector<entt::id_type>{7, 8}));
+
+    // And are removed once sent.
+    candidates = {{e0, 0, 10, 0.5}, {e1, 1, 10, 0.5}};
+    edyn::schedule_snapshot_candidates(candidates, 10, deferred);
+    ASSERT_EQ(candidate_entities(candidates), (std::set<entt::entity>{e0}));
+    ASSERT_EQ(deferred.size(), 1u);
+    ASSERT_TRUE(deferred.count(e1));
+    ASSERT_TRUE(deferred.at(e1).component_ids.empty());
+}
@@ -2,6 +2,8 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
+#include <thread>
 
 class job_dispatcher_test: public ::testing::Test {
 protected:
@@ -126,7 +128,6 @@ TEST_F(job_dispatcher_test, parallel_for_async) {
     }
 }
 
-/*
 TEST_F(job_dispatcher_test, nested_parallel_for) {
     constexpr size_t rows = 2012;
     constexpr size_t columns = 2459;
@@ -151,4 +152,102 @@ TEST_F(job_dispatcher_test, nested_parallel_for) {
             ASSERT_EQ((*A)[i][j], 33 + 17);
         }
     }
-}*/
+}
+
+struct counter_job_data {
+    edyn::job_dispatcher *dispatcher;
+    std::atomic<size_t> *counter;
+};
+
+void increment_counter_job(edyn::job::data_type &data) {
+    auto archive = edyn::memory_input_archive(data.data(), data.size());
+    intptr_t data_ptr;
+    bool spawn_child;
+    archive(data_ptr);
+    archive(spawn_child);
+    auto *job_data = reinterpret_cast<counter_job_data *>(data_ptr);
+    job_data->counter->fetch_add(1, std::memory_order_relaxed);
+
+    if (spawn_child) {
+        // Scheduled from a worker thread, thus it goes into the worker's own
+        // deque where it can be stolen by other workers.
+        auto child = edyn::job();
+        auto child_archive = edyn::fixed_memory_output_archive(child.data.data(), child.data.size());
+        auto child_spawn = false;
+        child_archive(data_ptr);
+        child_archive(child_spawn);
+        child.func = &increment_counter_job;
+        job_data->dispatcher->async(child);
+    }
+}
+
+TEST_F(job_dispatcher_test, async_from_many_threads) {
+    constexpr size_t num_threads = 4;
+    constexpr size_t num_jobs_per_thread = 20000;
+    std::atomic<size_t> counter {0};
+    auto job_data = counter_job_data{&dispatcher, &counter};
+
+    auto j = edyn::job();
+    auto archive = edyn::fixed_memory_output_archive(j.data.data(), j.data.size());
+    auto data_ptr = reinterpret_cast<intptr_t>(&job_data);
+    auto spawn_child = true;
+    archive(data_ptr);
+    archive(spawn_child);
+    j.func = &increment_counter_job;
+
+    // Schedule jobs from external threads at the same time, which go through
+    // the injection queue.
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&] {
+            for (size_t k = 0; k < num_jobs_per_thread; ++k) {
+                dispatcher.async(j);
+            }
+        });
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    // Each job spawns one child.
+    constexpr auto total_jobs = num_threads * num_jobs_per_thread * 2;
+
+    while (counter.load(std::memory_order_relaxed) < total_jobs) {
+        edyn::delay(1);
+    }
+
+    ASSERT_EQ(counter.load(), total_jobs);
+}
+
+void slow_increment_counter_job(edyn::job::data_type &data) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    increment_counter_job(data);
+}
+
+TEST(job_dispatcher_stop_test, stop_runs_pending_jobs) {
+    constexpr size_t num_jobs = 200;
+    std::atomic<size_t> counter {0};
+    auto dispatcher = edyn::job_dispatcher{};
+    dispatcher.start(2);
+    auto job_data = counter_job_data{&dispatcher, &counter};
+
+    auto j = edyn::job();
+    auto archive = edyn::fixed_memory_output_archive(j.data.data(), j.data.size());
+    auto data_ptr = reinterpret_cast<intptr_t>(&job_data);
+    auto spawn_child = true;
+    archive(data_ptr);
+    archive(spawn_child);
+    j.func = &slow_increment_counter_job;
+
+    for (size_t i = 0; i < num_jobs; ++i) {
+        dispatcher.async(j);
+    }
+
+    // Stop while most jobs are still pending. All jobs and their children
+    // must have run once it returns.
+    dispatcher.stop();
+
+    ASSERT_EQ(counter.load(), num_jobs * 2);
+}
@@ -1,12 +1,16 @@
 #include "../common/common.hpp"
 
+#include <thread>
+
 class message_queue_test: public ::testing::Test {
 public:
     void on_int(int i) {
         m_value = i;
+        m_values.push_back(i);
     }
 
     int m_value;
+    std::vector<int> m_values;
 
     std::unique_ptr<edyn::message_queue_input> m_input;
     std::unique_ptr<edyn::message_queue_output> m_output;
@@ -14,6 +18,7 @@ public:
 protected:
     void SetUp() override {
         m_value = 0;
+        m_values.clear();
         auto [msgq_in, msgq_out] = edyn::make_message_queue_input_output();
         m_input = std::make_unique<edyn::message_queue_input>(msgq_in);
         m_output = std::make_unique<edyn::message_queue_output>(msgq_out);
@@ -30,4 +35,45 @@ TEST_F(message_queue_test, write_read_messages) {
     ASSERT_NE(m_value, 667);
     m_output->update();
     ASSERT_EQ(m_value, 667);
-}
\ No newline at end of file
+}
+
+TEST_F(message_queue_test, overflow_preserves_order) {
+    // Send more messages than fit in the ring buffer.
+    constexpr size_t num_messages = 1000;
+
+    for (size_t i = 0; i < num_messages; ++i) {
+        m_input->send<int>(static_cast<int>(i));
+    }
+
+    m_output->update();
+    ASSERT_EQ(m_values.size(), num_messages);
+
+    for (size_t i = 0; i < num_messages; ++i) {
+        ASSERT_EQ(m_values[i], static_cast<int>(i));
+    }
+
+    // Ring buffer must be used again after the overflow is consumed.
+    m_input->send<int>(-1);
+    m_output->update();
+    ASSERT_EQ(m_value, -1);
+}
+
+TEST_F(message_queue_test, concurrent_producer) {
+    constexpr size_t num_messages = 100000;
+
+    auto producer = std::thread([input = *m_input] () mutable {
+        for (size_t i = 0; i < num_messages; ++i) {
+            input.send<int>(static_cast<int>(i));
+        }
+    });
+
+    while (m_values.size() < num_messages) {
+        m_output->update();
+    }
+
+    producer.join();
+
+    for (size_t i = 0; i < num_messages; ++i) {
+        ASSERT_EQ(m_values[i], static_cast<int>(i));
+    }
+}
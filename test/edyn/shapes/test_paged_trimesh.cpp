@@ -1,4 +1,9 @@
 #include "../common/common.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
 
 class triangle_mesh_page_loader: public edyn::triangle_mesh_page_loader_base {
 public:
@@ -51,3 +56,285 @@ TEST(test_paged_trimesh, voronoi_regions) {
 
 	edyn::deinit();
 }
+
+TEST(test_paged_trimesh, memory_mapped_loader) {
+    edyn::init({2});
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(10, 10, 16, 16, vertices, indices);
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        vertices[i].y = std::sin(edyn::scalar(i) * edyn::scalar(0.3));
+    }
+
+    auto trimesh = edyn::paged_triangle_mesh(std::make_shared<triangle_mesh_page_loader>());
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(), indices.begin(), indices.end(), 32, {});
+
+    auto filename = "paged_trimesh_mapped.bin";
+    ASSERT_TRUE(edyn::write_mapped_paged_triangle_mesh(filename, trimesh));
+
+    auto loader = std::make_shared<edyn::paged_triangle_mesh_mapped_loader>();
+    ASSERT_TRUE(loader->open(filename));
+
+    auto input_trimesh = edyn::paged_triangle_mesh(loader);
+    ASSERT_TRUE(edyn::read_mapped_paged_triangle_mesh(*loader, input_trimesh));
+    ASSERT_EQ(input_trimesh.num_submeshes(), trimesh.num_submeshes());
+
+    for (size_t i = 0; i < trimesh.num_submeshes(); ++i) {
+        loader->load(i);
+    }
+
+    // Wait for all submeshes to be loaded in the background.
+    auto deadline = edyn::performance_time() + 5;
+
+    for (size_t i = 0; i < input_trimesh.num_submeshes(); ++i) {
+        while (!input_trimesh.get_submesh(i) && edyn::performance_time() < deadline);
+        ASSERT_TRUE(input_trimesh.get_submesh(i));
+
+        auto submesh = trimesh.get_submesh(i);
+        auto input_submesh = input_trimesh.get_submesh(i);
+        ASSERT_EQ(submesh->num_vertices(), input_submesh->num_vertices());
+        ASSERT_EQ(submesh->num_triangles(), input_submesh->num_triangles());
+        ASSERT_EQ(submesh->num_edges(), input_submesh->num_edges());
+
+        for (size_t j = 0; j < submesh->num_triangles(); ++j) {
+            for (size_t k = 0; k < 3; ++k) {
+                ASSERT_EQ(submesh->get_face_vertex_index(j, k), input_submesh->get_face_vertex_index(j, k));
+            }
+        }
+
+        for (size_t j = 0; j < submesh->num_edges(); ++j) {
+            ASSERT_EQ(submesh->is_convex_edge(j), input_submesh->is_convex_edge(j));
+        }
+    }
+
+    // Triangles found via the prebuilt trees must match.
+    auto query_aabb = edyn::AABB{{-2, -2, -2}, {2, 2, 2}};
+    size_t count = 0, input_count = 0;
+    trimesh.visit_cached_triangles(query_aabb, [&](auto, auto) { ++count; });
+    input_trimesh.visit_cached_triangles(query_aabb, [&](auto, auto) { ++input_count; });
+    ASSERT_GT(count, 0u);
+    ASSERT_EQ(count, input_count);
+
+    // Files with an invalid header are rejected.
+    {
+        auto output = edyn::file_output_archive("paged_trimesh_invalid.bin");
+        auto value = uint64_t{42};
+        output(value);
+    }
+
+    ASSERT_FALSE(edyn::paged_triangle_mesh_mapped_loader().open("paged_trimesh_invalid.bin"));
+
+    edyn::deinit();
+}
+
+// Reads a file written by `write_mapped_paged_triangle_mesh`, lets the caller
+// modify its bytes and writes it to another file.
+template<typename Func>
+static void write_modified_mapped_file(const std::string &input, const std::string &output, Func func) {
+    auto in_file = std::ifstream(input, std::ios::binary);
+    auto data = std::vector<char>(std::istreambuf_iterator<char>(in_file), std::istreambuf_iterator<char>());
+    auto header = edyn::mapped_paged_triangle_mesh_header{};
+    std::memcpy(&header, data.data(), sizeof(header));
+    auto entries = std::vector<edyn::mapped_submesh_entry>(header.num_submeshes);
+    std::memcpy(entries.data(), data.data() + header.table_offset, entries.size() * sizeof(edyn::mapped_submesh_entry));
+
+    func(header, entries);
+
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + header.table_offset, entries.data(), entries.size() * sizeof(edyn::mapped_submesh_entry));
+    auto out_file = std::ofstream(output, std::ios::binary | std::ios::trunc);
+    out_file.write(data.data(), data.size());
+}
+
+TEST(test_paged_trimesh, memory_mapped_loader_corrupt) {
+    edyn::init({2});
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(10, 10, 16, 16, vertices, indices);
+
+    auto trimesh = edyn::paged_triangle_mesh(std::make_shared<triangle_mesh_page_loader>());
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(), indices.begin(), indices.end(), 32, {});
+
+    auto filename = "paged_trimesh_mapped.bin";
+    ASSERT_TRUE(edyn::write_mapped_paged_triangle_mesh(filename, trimesh));
+
+    // Offsets and sizes whose sum wraps around are rejected.
+    auto corrupt_filename = "paged_trimesh_mapped_corrupt.bin";
+    write_modified_mapped_file(filename, corrupt_filename, [](auto &header, auto &) {
+        header.tree_size = std::numeric_limits<uint64_t>::max() - header.tree_offset + 1;
+    });
+    ASSERT_FALSE(edyn::paged_triangle_mesh_mapped_loader().open(corrupt_filename));
+
+    write_modified_mapped_file(filename, corrupt_filename, [](auto &, auto &entries) {
+        entries.back().size = std::numeric_limits<uint64_t>::max() - entries.back().offset + 1;
+    });
+    ASSERT_FALSE(edyn::paged_triangle_mesh_mapped_loader().open(corrupt_filename));
+
+    // A submesh which cannot be read is not assigned and is not left pending.
+    write_modified_mapped_file(filename, corrupt_filename, [](auto &, auto &entries) {
+        entries.front().size = 8;
+    });
+
+    auto loader = std::make_shared<edyn::paged_triangle_mesh_mapped_loader>();
+    ASSERT_TRUE(loader->open(corrupt_filename));
+
+    auto input_trimesh = edyn::paged_triangle_mesh(loader);
+    ASSERT_TRUE(edyn::read_mapped_paged_triangle_mesh(*loader, input_trimesh));
+    input_trimesh.prefetch(input_trimesh.get_aabb(), input_trimesh.num_submeshes());
+
+    auto deadline = edyn::performance_time() + 5;
+    while (input_trimesh.num_pending_loads() > 0 && edyn::performance_time() < deadline);
+    ASSERT_EQ(input_trimesh.num_pending_loads(), 0u);
+    ASSERT_FALSE(input_trimesh.get_submesh(0));
+
+    for (size_t i = 1; i < input_trimesh.num_submeshes(); ++i) {
+        ASSERT_TRUE(input_trimesh.get_submesh(i));
+    }
+
+    // It can be requested again.
+    auto num_misses = input_trimesh.get_cache_statistics().num_misses;
+    input_trimesh.prefetch(input_trimesh.get_aabb(), input_trimesh.num_submeshes());
+    ASSERT_EQ(input_trimesh.get_cache_statistics().num_misses, num_misses + 1);
+
+    deadline = edyn::performance_time() + 5;
+    while (input_trimesh.num_pending_loads() > 0 && edyn::performance_time() < deadline);
+    ASSERT_EQ(input_trimesh.num_pending_loads(), 0u);
+    ASSERT_FALSE(input_trimesh.get_submesh(0));
+
+    edyn::deinit();
+}
+
+TEST(test_paged_trimesh, prefetch_budget) {
+    // Loader which never finishes loading, so that loads remain pending.
+    class counting_page_loader: public triangle_mesh_page_loader {
+    public:
+        void load(size_t index) override {
+            indices.push_back(index);
+        }
+
+        std::vector<size_t> indices;
+    };
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(10, 10, 16, 16, vertices, indices);
+
+    auto loader = std::make_shared<counting_page_loader>();
+    auto trimesh = edyn::paged_triangle_mesh(loader);
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(), indices.begin(), indices.end(), 32, {});
+    ASSERT_GT(trimesh.num_submeshes(), 3u);
+    trimesh.clear_cache();
+
+    trimesh.prefetch(trimesh.get_aabb(), 2);
+    ASSERT_EQ(loader->indices.size(), 2u);
+    ASSERT_EQ(trimesh.num_pending_loads(), 2u);
+
+    // Budget exhausted.
+    trimesh.prefetch(trimesh.get_aabb(), 2);
+    ASSERT_EQ(loader->indices.size(), 2u);
+
+    // Finishing a load frees up the budget and the same submesh is not
+    // requested twice.
+    trimesh.assign_mesh(loader->indices[0], std::make_shared<edyn::triangle_mesh>());
+    ASSERT_EQ(trimesh.num_pending_loads(), 1u);
+    trimesh.prefetch(trimesh.get_aabb(), 2);
+    ASSERT_EQ(loader->indices.size(), 3u);
+    ASSERT_NE(loader->indices[2], loader->indices[0]);
+    ASSERT_NE(loader->indices[2], loader->indices[1]);
+    ASSERT_EQ(trimesh.num_pending_loads(), 2u);
+
+    // Assigning a submesh which was not requested does not affect the
+    // pending loads, nor does assigning a requested one twice.
+    auto not_requested = size_t{0};
+
+    while (std::find(loader->indices.begin(), loader->indices.end(), not_requested) != loader->indices.end()) {
+        ++not_requested;
+    }
+
+    ASSERT_LT(not_requested, trimesh.num_submeshes());
+    trimesh.assign_mesh(not_requested, std::make_shared<edyn::triangle_mesh>());
+    ASSERT_EQ(trimesh.num_pending_loads(), 2u);
+
+    trimesh.assign_mesh(loader->indices[1], std::make_shared<edyn::triangle_mesh>());
+    trimesh.assign_mesh(loader->indices[1], std::make_shared<edyn::triangle_mesh>());
+    ASSERT_EQ(trimesh.num_pending_loads(), 1u);
+}
+
+TEST(test_paged_trimesh, cache_byte_budget) {
+    // Loader which assigns submeshes from a list immediately.
+    class list_page_loader: public edyn::triangle_mesh_page_loader_base {
+    public:
+        void load(size_t index) override {
+            ++num_loads;
+            m_loaded_signal.publish(index, meshes[index]);
+        }
+
+        entt::sink<entt::sigh<loaded_mesh_func_t>> on_load_sink() override {
+            return {m_loaded_signal};
+        }
+
+        std::vector<std::shared_ptr<edyn::triangle_mesh>> meshes;
+        size_t num_loads {0};
+
+    private:
+        entt::sigh<loaded_mesh_func_t> m_loaded_signal;
+    };
+
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(10, 10, 16, 16, vertices, indices);
+
+    auto loader = std::make_shared<list_page_loader>();
+    auto trimesh = edyn::paged_triangle_mesh(loader);
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(), indices.begin(), indices.end(), 32, {});
+
+    auto num_submeshes = trimesh.num_submeshes();
+    ASSERT_GT(num_submeshes, 3u);
+
+    size_t total_size = 0;
+    size_t max_size = 0;
+
+    for (size_t i = 0; i < num_submeshes; ++i) {
+        auto submesh = trimesh.get_submesh(i);
+        loader->meshes.push_back(submesh);
+        total_size += submesh->memory_size();
+        max_size = std::max(max_size, submesh->memory_size());
+    }
+
+    ASSERT_EQ(trimesh.cache_size_bytes(), total_size);
+    ASSERT_EQ(trimesh.get_cache_statistics().num_resident, num_submeshes);
+
+    // Fit at most two submeshes in the cache.
+    trimesh.m_max_cache_size_bytes = max_size * 2 + 1;
+    trimesh.clear_cache();
+    trimesh.reset_cache_statistics();
+    ASSERT_EQ(trimesh.cache_size_bytes(), 0u);
+
+    trimesh.visit_triangles(trimesh.get_aabb(), [](auto, auto) {});
+
+    auto stats = trimesh.get_cache_statistics();
+    ASSERT_EQ(loader->num_loads, num_submeshes);
+    ASSERT_EQ(stats.num_misses, num_submeshes);
+    ASSERT_EQ(stats.num_hits, 0u);
+    ASSERT_LE(stats.num_resident, 2u);
+    ASSERT_EQ(stats.num_evictions, num_submeshes - stats.num_resident);
+    ASSERT_LE(stats.size_bytes, trimesh.m_max_cache_size_bytes);
+    ASSERT_EQ(stats.size_bytes, trimesh.cache_size_bytes());
+
+    // Visiting a resident submesh again counts as a hit.
+    size_t resident_idx = 0;
+
+    while (!trimesh.get_submesh(resident_idx)) {
+        ++resident_idx;
+    }
+
+    auto verts = trimesh.get_triangle_vertices(resident_idx, 0);
+    auto centroid = (verts[0] + verts[1] + verts[2]) / edyn::scalar(3);
+    auto offset = edyn::vector3_one * edyn::scalar(0.001);
+    trimesh.reset_cache_statistics();
+    trimesh.visit_submeshes({centroid - offset, centroid + offset}, [](auto) {});
+    ASSERT_GE(trimesh.get_cache_statistics().num_hits, 1u);
+}
@@ -0,0 +1,193 @@
+#include "../common/common.hpp"
+#include <edyn/util/aabb_batch.hpp>
+#include <edyn/util/aabb_util.hpp>
+#include <edyn/sys/update_aabbs.hpp>
+#include <random>
+
+class aabb_batch_test: public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto rng = std::mt19937{7};
+        auto dist = std::uniform_real_distribution<edyn::scalar>(-1, 1);
+        auto dist_size = std::uniform_real_distribution<edyn::scalar>(0.05, 2);
+
+        for (size_t k = 0; k < edyn::aabb_batch_size; ++k) {
+            auto pos = edyn::vector3{dist(rng), dist(rng), dist(rng)} * edyn::scalar(10);
+            auto orn = edyn::normalize(edyn::quaternion{dist(rng), dist(rng), dist(rng), dist(rng)});
+            positions[k] = pos;
+            orientations[k] = orn;
+
+            for (size_t i = 0; i < 3; ++i) {
+                batch.pos[i][k] = pos[i];
+                batch.params[i][k] = dist_size(rng);
+            }
+
+            batch.orn[0][k] = orn.x;
+            batch.orn[1][k] = orn.y;
+            batch.orn[2][k] = orn.z;
+            batch.orn[3][k] = orn.w;
+        }
+
+        // Cover an axis-aligned orientation as well.
+        orientations[0] = edyn::quaternion_identity;
+        batch.orn[0][0] = batch.orn[1][0] = batch.orn[2][0] = 0;
+        batch.orn[3][0] = 1;
+    }
+
+    void check(size_t k, const edyn::AABB &expected) {
+        for (size_t i = 0; i < 3; ++i) {
+            ASSERT_NEAR(batch.min[i][k], expected.min[i], 1e-4);
+            ASSERT_NEAR(batch.max[i][k], expected.max[i], 1e-4);
+        }
+    }
+
+    edyn::aabb_batch batch;
+    edyn::vector3 positions[edyn::aabb_batch_size];
+    edyn::quaternion orientations[edyn::aabb_batch_size];
+};
+
+TEST_F(aabb_batch_test, box) {
+    edyn::box_aabb_batch(batch);
+
+    for (size_t k = 0; k < edyn::aabb_batch_size; ++k) {
+        auto half_extents = edyn::vector3{batch.params[0][k], batch.params[1][k], batch.params[2][k]};
+        check(k, edyn::box_aabb(half_extents, positions[k], orientations[k]));
+    }
+}
+
+TEST_F(aabb_batch_test, sphere) {
+    edyn::sphere_aabb_batch(batch);
+
+    for (size_t k = 0; k < edyn::aabb_batch_size; ++k) {
+        check(k, edyn::sphere_aabb(batch.params[0][k], positions[k]));
+    }
+}
+
+TEST_F(aabb_batch_test, capsule) {
+    edyn::capsule_aabb_batch(batch);
+
+    for (size_t k = 0; k < edyn::aabb_batch_size; ++k) {
+        check(k, edyn::capsule_aabb(batch.params[0][k], batch.params[1][k], positions[k], orientations[k]));
+    }
+}
+
+TEST_F(aabb_batch_test, cylinder) {
+    edyn::cylinder_aabb_batch(batch);
+
+    for (size_t k = 0; k < edyn::aabb_batch_size; ++k) {
+        check(k, edyn::cylinder_aabb(batch.params[0][k], batch.params[1][k], positions[k], orientations[k]));
+    }
+}
+
+// Updates the AABBs of shapes with random transforms in batches and one at a
+// time and compares them with `shape_aabb`.
+template<typename ShapeType, typename MakeShape>
+void check_update_aabbs(MakeShape make_shape) {
+    auto rng = std::mt19937{11};
+    auto dist = std::uniform_real_distribution<edyn::scalar>(-1, 1);
+    auto dist_size = std::uniform_real_distribution<edyn::scalar>(0.05, 2);
+
+    entt::registry registry;
+    registry.ctx().emplace<edyn::settings>();
+
+    // Not a multiple of the batch size, so that the last batch is partial.
+    auto num_entities = edyn::aabb_batch_size * 3 + 1;
+
+    for (size_t i = 0; i < num_entities; ++i) {
+        auto entity = registry.create();
+        auto pos = edyn::vector3{dist(rng), dist(rng), dist(rng)} * edyn::scalar(10);
+        auto orn = edyn::normalize(edyn::quaternion{dist(rng), dist(rng), dist(rng), dist(rng)});
+        registry.emplace<edyn::position>(entity, pos);
+        registry.emplace<edyn::orientation>(entity, orn);
+        registry.emplace<ShapeType>(entity, make_shape(rng, dist_size));
+        registry.emplace<edyn::AABB>(entity);
+    }
+
+    for (auto batched : {true, false}) {
+        registry.ctx().at<edyn::settings>().batched_aabb_update = batched;
+        edyn::update_aabbs(registry);
+
+        for (auto [entity, pos, orn, shape, aabb] :
+             registry.view<edyn::position, edyn::orientation, ShapeType, edyn::AABB>().each()) {
+            auto expected = edyn::shape_aabb(shape, pos, orn);
+
+            for (size_t i = 0; i < 3; ++i) {
+                ASSERT_NEAR(aabb.min[i], expected.min[i], 1e-4);
+                ASSERT_NEAR(aabb.max[i], expected.max[i], 1e-4);
+            }
+        }
+    }
+}
+
+TEST(aabb_batch_update_test, matches_shape_aabb) {
+    check_update_aabbs<edyn::box_shape>([](auto &rng, auto &dist) {
+        return edyn::box_shape{edyn::vector3{dist(rng), dist(rng), dist(rng)}};
+    });
+    check_update_aabbs<edyn::sphere_shape>([](auto &rng, auto &dist) {
+        return edyn::sphere_shape{dist(rng)};
+    });
+    check_update_aabbs<edyn::capsule_shape>([](auto &rng, auto &dist) {
+        return edyn::capsule_shape{dist(rng), dist(rng)};
+    });
+    check_update_aabbs<edyn::cylinder_shape>([](auto &rng, auto &dist) {
+        return edyn::cylinder_shape{dist(rng), dist(rng)};
+    });
+}
+
+TEST(aabb_batch_update_test, ccd_swept_aabb) {
+    entt::registry registry;
+    registry.ctx().emplace<edyn::settings>();
+    auto dt = registry.ctx().at<edyn::settings>().fixed_dt;
+
+    auto entity = registry.create();
+    auto pos = edyn::vector3{1, 2, 3};
+    auto orn = edyn::quaternion_axis_angle(edyn::vector3_y, 0.3);
+    auto shape = edyn::box_shape{edyn::vector3{0.5, 0.5, 0.5}};
+    registry.emplace<edyn::position>(entity, pos);
+    registry.emplace<edyn::orientation>(entity, orn);
+    registry.emplace<edyn::box_shape>(entity, shape);
+    registry.emplace<edyn::AABB>(entity);
+    registry.emplace<edyn::linvel>(entity, edyn::vector3{20, 0, 0});
+    registry.emplace<edyn::ccd_tag>(entity);
+
+    auto expected_aabb = [&]() {
+        auto aabb = edyn::shape_aabb(shape, pos, orn);
+        auto displacement = registry.get<edyn::linvel>(entity) * dt;
+        aabb.min = edyn::min(aabb.min, aabb.min + displacement);
+        aabb.max = edyn::max(aabb.max, aabb.max + displacement);
+        return aabb;
+    };
+
+    auto check = [&]() {
+        auto &aabb = registry.get<edyn::AABB>(entity);
+        auto expected = expected_aabb();
+
+        for (size_t i = 0; i < 3; ++i) {
+            ASSERT_NEAR(aabb.min[i], expected.min[i], 1e-4);
+            ASSERT_NEAR(aabb.max[i], expected.max[i], 1e-4);
+        }
+    };
+
+    for (auto batched : {true, false}) {
+        registry.ctx().at<edyn::settings>().batched_aabb_update = batched;
+        registry.get<edyn::linvel>(entity) = edyn::vector3{20, 0, 0};
+        registry.clear<edyn::aabb_changed_tag>();
+
+        edyn::update_aabbs(registry);
+        check();
+
+        // Repeated updates do not keep enlarging the swept AABB.
+        registry.clear<edyn::aabb_changed_tag>();
+        edyn::update_aabbs(registry);
+        edyn::update_aabb(registry, entity);
+        edyn::update_aabb(registry, entity);
+        check();
+        ASSERT_FALSE(registry.all_of<edyn::aabb_changed_tag>(entity));
+
+        // A change in velocity alone changes the swept AABB.
+        registry.get<edyn::linvel>(entity) = edyn::vector3{0, -20, 0};
+        edyn::update_aabbs(registry);
+        check();
+        ASSERT_TRUE(registry.all_of<edyn::aabb_changed_tag>(entity));
+    }
+}
@@ -0,0 +1,94 @@
+#include "../common/common.hpp"
+#include <edyn/util/entity_map.hpp>
+#include <map>
+#include <random>
+
+TEST(test_entity_map, insert_erase) {
+    auto emap = edyn::entity_map{};
+    emap.insert(entt::entity{1}, entt::entity{10});
+    emap.insert(entt::entity{2}, entt::entity{20});
+
+    ASSERT_TRUE(emap.contains(entt::entity{1}));
+    ASSERT_TRUE(emap.contains_other(entt::entity{20}));
+    ASSERT_FALSE(emap.contains(entt::entity{10}));
+    ASSERT_EQ(emap.at(entt::entity{2}), entt::entity{20});
+    ASSERT_EQ(emap.at_other(entt::entity{10}), entt::entity{1});
+    ASSERT_EQ(emap.find(entt::entity{3}), entt::entity{entt::null});
+
+    emap.erase(entt::entity{1});
+    ASSERT_FALSE(emap.contains(entt::entity{1}));
+    ASSERT_FALSE(emap.contains_other(entt::entity{10}));
+
+    emap.erase_other(entt::entity{20});
+    ASSERT_EQ(emap.size(), 0u);
+
+    emap.insert(entt::entity{5}, entt::entity{50});
+    emap.swap();
+    ASSERT_EQ(emap.at(entt::entity{50}), entt::entity{5});
+}
+
+TEST(test_entity_map, matches_std_map) {
+    // Perform random insertions and erasures and compare against a reference.
+    auto emap = edyn::entity_map{};
+    auto reference = std::map<entt::entity, entt::entity>{};
+    auto rng = std::mt19937{42};
+    auto dist = std::uniform_int_distribution<unsigned>(0, 2000);
+
+    for (unsigned i = 0; i < 20000; ++i) {
+        auto entity = entt::entity{dist(rng)};
+
+        if (reference.count(entity)) {
+            emap.erase(entity);
+            reference.erase(entity);
+        } else {
+            auto other = entt::entity{dist(rng) + 5000};
+
+            if (emap.contains_other(other)) {
+                continue;
+            }
+
+            emap.insert(entity, other);
+            reference[entity] = other;
+        }
+    }
+
+    ASSERT_EQ(emap.size(), reference.size());
+
+    for (unsigned i = 0; i <= 2000; ++i) {
+        auto entity = entt::entity{i};
+        auto it = reference.find(entity);
+
+        if (it == reference.end()) {
+            ASSERT_FALSE(emap.contains(entity));
+        } else {
+            ASSERT_EQ(emap.at(entity), it->second);
+            ASSERT_EQ(emap.at_other(it->second), entity);
+        }
+    }
+
+    emap.erase_if([](entt::entity entity, entt::entity) {
+        return entt::to_integral(entity) % 2 == 0;
+    });
+
+    auto count = size_t{0};
+    emap.each([&](entt::entity entity, entt::entity other) {
+        ASSERT_EQ(entt::to_integral(entity) % 2, 1u);
+        ASSERT_EQ(reference.at(entity), other);
+        ++count;
+    });
+
+    ASSERT_EQ(count, emap.size());
+}
+
+TEST(test_entity_map, find_many) {
+    auto emap = edyn::entity_map{};
+    emap.insert(entt::entity{1}, entt::entity{10});
+    emap.insert(entt::entity{2}, entt::entity{20});
+
+    auto entities = std::vector<entt::entity>{entt::entity{2}, entt::entity{3}, entt::entity{1}};
+    emap.find_many(entities.begin(), entities.end(), entities.begin());
+
+    ASSERT_EQ(entities[0], entt::entity{20});
+    ASSERT_EQ(entities[1], entt::entity{entt::null});
+    ASSERT_EQ(entities[2], entt::entity{10});
+}
@@ -11,9 +11,9 @@ TEST(test_registry_operation, test_create_destroy) {
 
     auto ent0 = reg0.create();
 
-    edyn::registry_operation opc;
-    opc.operation = edyn::registry_op_type::create;
-    opc.entities.push_back(ent0);
+    auto builder = edyn::registry_operation_builder_impl<>{};
+    builder.create(ent0);
+    auto opc = builder.finish();
 
     auto emap = edyn::entity_map{};
     // Should create a corresponding entity in reg1 and add it to the emap.
@@ -23,9 +23,8 @@ TEST(test_registry_operation, test_create_destroy) {
     auto ent1 = emap.at(ent0);
     ASSERT_TRUE(reg1.valid(ent1));
 
-    edyn::registry_operation opd;
-    opd.operation = edyn::registry_op_type::destroy;
-    opd.entities.push_back(ent0);
+    builder.destroy(ent0);
+    auto opd = builder.finish();
     // Should destroy entity in reg1 and remove it from emap.
     opd.execute(reg1, emap);
 
@@ -158,3 +157,50 @@ TEST(test_registry_operation, test_impl) {
 
     ASSERT_FALSE(reg1.all_of<another_comp>(ent11));
 }
+
+TEST(test_registry_operation, test_emplace_skips_unmapped) {
+    auto reg0 = entt::registry{};
+    auto reg1 = entt::registry{};
+
+    auto ents0 = std::array<entt::entity, 4>{};
+    reg0.create(ents0.begin(), ents0.end());
+
+    for (size_t i = 0; i < ents0.size(); ++i) {
+        reg0.emplace<another_comp>(ents0[i], double(i));
+    }
+
+    // Create only the entities at odd indices in the other registry. The
+    // components of the others must not be inserted.
+    auto builder = edyn::registry_operation_builder_impl<another_comp>{};
+    builder.create(ents0[1]);
+    builder.create(ents0[3]);
+    builder.emplace<another_comp>(reg0, ents0.begin(), ents0.end());
+    auto ops = builder.finish();
+
+    // Copies are deep and can be executed independently.
+    auto ops_copy = ops;
+    ops = {};
+    ASSERT_TRUE(ops.empty());
+    ASSERT_FALSE(ops_copy.empty());
+
+    auto emap = edyn::entity_map{};
+    ops_copy.execute(reg1, emap);
+
+    ASSERT_FALSE(emap.contains(ents0[0]));
+    ASSERT_FALSE(emap.contains(ents0[2]));
+
+    for (auto i : {1, 3}) {
+        ASSERT_TRUE(emap.contains(ents0[i]));
+        auto local_entity = emap.at(ents0[i]);
+        ASSERT_EQ(reg1.get<another_comp>(local_entity).d, double(i));
+    }
+
+    ASSERT_EQ(reg1.view<another_comp>().size(), size_t{2});
+
+    // Builder reuses its memory for the next collection.
+    ASSERT_TRUE(builder.empty());
+    builder.replace<another_comp>(ents0[3], another_comp{7.0});
+    ops = builder.finish();
+    ops.execute(reg1, emap);
+    ASSERT_EQ(reg1.get<another_comp>(emap.at(ents0[3])).d, 7.0);
+}
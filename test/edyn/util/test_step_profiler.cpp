@@ -0,0 +1,84 @@
+#include "../common/common.hpp"
+#include <sstream>
+#include <thread>
+
+TEST(test_step_profiler, record_and_consume) {
+    auto profiler = edyn::step_profiler(4);
+    auto counters = edyn::profile_counters{};
+    counters.num_rows = 12;
+
+    for (int i = 0; i < 6; ++i) {
+        profiler.record(entt::null, edyn::profile_stage::solver, edyn::performance_time(), counters);
+    }
+
+    // Capacity is 4, thus 2 samples must have been dropped.
+    auto samples = std::vector<edyn::profile_sample>{};
+    ASSERT_EQ(profiler.consume(samples), size_t(4));
+    ASSERT_EQ(profiler.num_dropped(), size_t(2));
+    ASSERT_EQ(samples.size(), size_t(4));
+
+    for (auto &sample : samples) {
+        ASSERT_EQ(sample.stage, edyn::profile_stage::solver);
+        ASSERT_EQ(sample.counters.num_rows, 12u);
+        ASSERT_GE(sample.duration, 0);
+    }
+
+    // Space must be available again after consuming.
+    ASSERT_TRUE(profiler.record(entt::null, edyn::profile_stage::begin_step, edyn::performance_time()));
+    ASSERT_EQ(profiler.consume(samples), size_t(1));
+}
+
+TEST(test_step_profiler, concurrent_record) {
+    constexpr size_t num_threads = 4;
+    constexpr size_t num_samples_per_thread = 1000;
+    auto profiler = edyn::step_profiler(num_threads * num_samples_per_thread);
+    auto threads = std::vector<std::thread>{};
+
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&profiler, i] {
+            for (size_t j = 0; j < num_samples_per_thread; ++j) {
+                auto counters = edyn::profile_counters{};
+                counters.num_tree_moves = static_cast<uint32_t>(i);
+                profiler.record(entt::null, edyn::profile_stage::broadphase, edyn::performance_time(), counters);
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    auto samples = std::vector<edyn::profile_sample>{};
+    ASSERT_EQ(profiler.consume(samples), num_threads * num_samples_per_thread);
+    ASSERT_EQ(profiler.num_dropped(), size_t(0));
+
+    auto counts = std::vector<size_t>(num_threads, 0);
+    for (auto &sample : samples) {
+        ++counts[sample.counters.num_tree_moves];
+    }
+
+    for (auto count : counts) {
+        ASSERT_EQ(count, num_samples_per_thread);
+    }
+}
+
+TEST(test_step_profiler, chrome_trace) {
+    auto sample = edyn::profile_sample{};
+    sample.island = entt::null;
+    sample.stage = edyn::profile_stage::coordinator_sync;
+    sample.thread_id = 3;
+    sample.start_time = 1000.5;
+    sample.duration = 0.002;
+    sample.counters.reg_op_bytes = 256;
+
+    auto ss = std::stringstream{};
+    edyn::write_chrome_trace(ss, {sample});
+    auto str = ss.str();
+
+    ASSERT_NE(str.find("\"name\":\"coordinator_sync\""), std::string::npos);
+    ASSERT_NE(str.find("\"ts\":1000500000.000"), std::string::npos);
+    ASSERT_NE(str.find("\"dur\":2000.000"), std::string::npos);
+    ASSERT_NE(str.find("\"reg_op_bytes\":256"), std::string::npos);
+    ASSERT_EQ(str.front(), '{');
+    ASSERT_EQ(str.back(), '}');
+}